@@ -0,0 +1,385 @@
+//
+//  AccuracyTest.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "ReferenceProcessors.h"
+#include "../../TheKnobDSP/Source/Engine.h"
+
+/*
+ Holds TheKnobDSP to the reference processors (ReferenceProcessors.h), so an optimisation can't quietly change the sound. Every stage on
+ its own, and the whole chain, is run through a set of test signals for each mode and a grid of knob values. Each output is compared with
+ the reference's:
+
+ -max error: the largest difference between any two samples, in dBFS
+ -null depth: the level of the difference relative to the reference's output, in dB (how deep the two cancel)
+ -magnitude and phase: the largest differences between the spectra of the two responses to an exponential sine sweep, over 20 Hz to
+  20 kHz, wherever the reference is within 60 dB of its peak
+
+ Each stage has its own tolerances (see getTolerance()). Returns 1 if anything is outside them, so it can gate a build.
+
+ Options:
+    --rate N        sample rate (default 48000)
+    --stage NAME    only test one stage: filter, eq, special-eq, reverb, delay, distortion or chain
+    --verbose       print every case, not just the failures
+ */
+
+namespace accuracy
+{
+
+//==============================================================================
+struct Tolerance
+{
+    double maxErrorDb;
+    double nullDepthDb;
+    double magnitudeDb;
+    double phaseDegrees;
+};
+
+struct Comparison
+{
+    double maxErrorDb = -std::numeric_limits<double>::infinity();
+    double nullDepthDb = -std::numeric_limits<double>::infinity();
+    double magnitudeDb = 0.0;
+    double phaseDegrees = 0.0;
+
+    void merge (const Comparison& other)
+    {
+        maxErrorDb = juce::jmax (maxErrorDb, other.maxErrorDb);
+        nullDepthDb = juce::jmax (nullDepthDb, other.nullDepthDb);
+        magnitudeDb = juce::jmax (magnitudeDb, other.magnitudeDb);
+        phaseDegrees = juce::jmax (phaseDegrees, other.phaseDegrees);
+    }
+
+    bool isWithin (const Tolerance& tolerance) const
+    {
+        return maxErrorDb <= tolerance.maxErrorDb
+            && nullDepthDb <= tolerance.nullDepthDb
+            && magnitudeDb <= tolerance.magnitudeDb
+            && phaseDegrees <= tolerance.phaseDegrees;
+    }
+
+    juce::String toString() const
+    {
+        auto db = [] (double value) { return std::isinf (value) ? juce::String ("-inf") : juce::String (value, 1); };
+
+        return "max error " + db (maxErrorDb).paddedLeft (' ', 7) + " dBFS"
+             + "   null " + db (nullDepthDb).paddedLeft (' ', 7) + " dB"
+             + "   magnitude " + juce::String (magnitudeDb, 4).paddedLeft (' ', 7) + " dB"
+             + "   phase " + juce::String (phaseDegrees, 3).paddedLeft (' ', 7) + " deg";
+    }
+};
+
+//==============================================================================
+// Processes a stereo buffer in place, one host-sized block at a time
+using Processor = std::function<void (juce::AudioSampleBuffer&)>;
+
+// Makes a freshly prepared processor for a knob value, mode and sample rate
+using ProcessorFactory = std::function<Processor (float knob, int mode, double sampleRate)>;
+
+struct StageTest
+{
+    const char* name;
+    ProcessorFactory makeReference;
+    ProcessorFactory makeCandidate;
+    Tolerance tolerance;
+};
+
+const int blockSize = 512;
+const int sweepOrder = 17;
+
+//==============================================================================
+template <typename ReferenceProcessor>
+Processor makeReferenceStage (float knob, int mode, double sampleRate)
+{
+    struct State
+    {
+        std::atomic<float> knob, mode;
+        ReferenceProcessor processor { &knob, &mode };
+        juce::MidiBuffer midi;
+    };
+
+    auto state = std::make_shared<State>();
+    state->knob = knob;
+    state->mode = (float) mode;
+    state->processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+    state->processor.prepareToPlay (sampleRate, blockSize);
+
+    return [state] (juce::AudioSampleBuffer& buffer) { state->processor.processBlock (buffer, state->midi); };
+}
+
+template <typename Stage>
+Processor makeCandidateStage (float knob, int mode, double sampleRate)
+{
+    // the same calls, in the same order, as theknob::Engine makes
+    auto stage = std::make_shared<Stage>();
+    stage->setParameters (knob, mode);
+    stage->prepare (sampleRate);
+    stage->setParameters (knob, mode);
+
+    return [stage] (juce::AudioSampleBuffer& buffer) { stage->process (buffer.getArrayOfWritePointers(), buffer.getNumSamples()); };
+}
+
+inline Processor makeReferenceChain (float knob, int mode, double sampleRate)
+{
+    auto chain = std::make_shared<reference::Chain>();
+    chain->setParameters (knob, mode);
+    chain->prepare (sampleRate, blockSize);
+
+    return [chain] (juce::AudioSampleBuffer& buffer) { chain->process (buffer); };
+}
+
+inline Processor makeCandidateChain (float knob, int mode, double sampleRate)
+{
+    auto engine = std::make_shared<theknob::Engine>();
+    engine->setParameters (knob, mode);
+    engine->prepare (sampleRate, blockSize);
+
+    return [engine] (juce::AudioSampleBuffer& buffer) { engine->process (buffer.getArrayOfWritePointers(), 2, buffer.getNumSamples()); };
+}
+
+// The linear stages have to match to within float rounding. The reverb and delay run long feedback loops, where rounding differences
+// build up, and the whole chain adds up all of them.
+inline std::vector<StageTest> getStageTests()
+{
+    return
+    {
+        { "filter",     makeReferenceStage<reference::FilterProcessor>,     makeCandidateStage<theknob::FilterStage>,     { -100.0, -100.0, 0.01, 0.1 } },
+        { "eq",         makeReferenceStage<reference::EQProcessor>,         makeCandidateStage<theknob::EQStage>,         { -100.0, -100.0, 0.01, 0.1 } },
+        { "special-eq", makeReferenceStage<reference::SpecialEQProcessor>,  makeCandidateStage<theknob::SpecialEQStage>,  { -100.0, -100.0, 0.01, 0.1 } },
+        { "reverb",     makeReferenceStage<reference::ReverbProcessor>,     makeCandidateStage<theknob::ReverbStage>,     {  -90.0,  -90.0, 0.05, 0.5 } },
+        { "delay",      makeReferenceStage<reference::DelayProcessor>,      makeCandidateStage<theknob::DelayStage>,      {  -90.0,  -90.0, 0.05, 0.5 } },
+        { "distortion", makeReferenceStage<reference::DistortionProcessor>, makeCandidateStage<theknob::DistortionStage>, { -100.0, -100.0, 0.01, 0.1 } },
+        { "chain",      makeReferenceChain,                                 makeCandidateChain,                           {  -80.0,  -80.0, 0.1,  1.0 } },
+    };
+}
+
+//==============================================================================
+struct TestSignal
+{
+    juce::String name;
+    juce::AudioSampleBuffer audio;
+    bool isSweep = false;
+};
+
+// Every signal leaves room at the end for the delay and reverb tails
+inline std::vector<TestSignal> makeTestSignals (double sampleRate)
+{
+    std::vector<TestSignal> signals;
+    auto seconds = [sampleRate] (double s) { return (int) (s * sampleRate); };
+
+    // impulse
+    {
+        TestSignal signal { "impulse", juce::AudioSampleBuffer (2, seconds (2.0)) };
+        signal.audio.clear();
+        signal.audio.setSample (0, 0, 1.0f);
+        signal.audio.setSample (1, 0, 1.0f);
+        signals.push_back (std::move (signal));
+    }
+
+    // exponential sine sweep, 20 Hz to 20 kHz at -12 dBFS, over the first half of the FFT
+    {
+        TestSignal signal { "sweep", juce::AudioSampleBuffer (2, 1 << sweepOrder), true };
+        signal.audio.clear();
+
+        auto sweepLength = signal.audio.getNumSamples() / 2;
+        auto f1 = 20.0, f2 = juce::jmin (20000.0, sampleRate * 0.45);
+        auto duration = sweepLength / sampleRate;
+        auto k = std::log (f2 / f1);
+
+        for (int i = 0; i < sweepLength; ++i)
+        {
+            auto t = i / sampleRate;
+            auto phase = juce::MathConstants<double>::twoPi * f1 * duration / k * (std::exp (t / duration * k) - 1.0);
+            auto sample = (float) (0.25 * std::sin (phase));
+            signal.audio.setSample (0, i, sample);
+            signal.audio.setSample (1, i, sample);
+        }
+
+        signals.push_back (std::move (signal));
+    }
+
+    // uncorrelated white noise at -12 dBFS, then silence
+    {
+        TestSignal signal { "noise", juce::AudioSampleBuffer (2, seconds (2.0)) };
+        signal.audio.clear();
+        juce::Random random (0x7e4b);
+
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < seconds (1.0); ++i)
+                signal.audio.setSample (ch, i, 0.25f * (random.nextFloat() * 2.0f - 1.0f));
+
+        signals.push_back (std::move (signal));
+    }
+
+    // a full scale 110 Hz burst, to drive the distortion and the delay's tanh
+    {
+        TestSignal signal { "burst", juce::AudioSampleBuffer (2, seconds (1.5)) };
+        signal.audio.clear();
+
+        for (int i = 0; i < seconds (0.5); ++i)
+        {
+            auto sample = (float) std::sin (juce::MathConstants<double>::twoPi * 110.0 * i / sampleRate);
+            signal.audio.setSample (0, i, sample);
+            signal.audio.setSample (1, i, -sample);
+        }
+
+        signals.push_back (std::move (signal));
+    }
+
+    return signals;
+}
+
+inline juce::AudioSampleBuffer render (Processor& processor, const juce::AudioSampleBuffer& input)
+{
+    juce::AudioSampleBuffer output (input);
+
+    for (int start = 0; start < output.getNumSamples(); start += blockSize)
+    {
+        juce::AudioSampleBuffer block (output.getArrayOfWritePointers(), 2, start, juce::jmin (blockSize, output.getNumSamples() - start));
+        processor (block);
+    }
+
+    return output;
+}
+
+//==============================================================================
+inline Comparison compareSamples (const juce::AudioSampleBuffer& reference, const juce::AudioSampleBuffer& candidate)
+{
+    double maxError = 0.0, errorEnergy = 0.0, referenceEnergy = 0.0;
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        auto* r = reference.getReadPointer (ch);
+        auto* c = candidate.getReadPointer (ch);
+
+        for (int i = 0; i < reference.getNumSamples(); ++i)
+        {
+            auto error = (double) c[i] - (double) r[i];
+            maxError = juce::jmax (maxError, std::abs (error));
+            errorEnergy += error * error;
+            referenceEnergy += (double) r[i] * r[i];
+        }
+    }
+
+    Comparison comparison;
+    comparison.maxErrorDb = maxError > 0.0 ? 20.0 * std::log10 (maxError) : comparison.maxErrorDb;
+
+    if (errorEnergy > 0.0)
+        comparison.nullDepthDb = referenceEnergy > 0.0 ? 10.0 * std::log10 (errorEnergy / referenceEnergy) : 0.0;
+
+    return comparison;
+}
+
+// Both outputs come from the same sweep, so the ratio of their spectra is the ratio of the two frequency responses
+inline void compareSpectra (const juce::AudioSampleBuffer& reference, const juce::AudioSampleBuffer& candidate, double sampleRate, Comparison& comparison)
+{
+    const int fftSize = 1 << sweepOrder;
+    juce::dsp::FFT fft (sweepOrder);
+    std::vector<float> r ((size_t) fftSize * 2), c ((size_t) fftSize * 2);
+
+    auto firstBin = (int) std::ceil (20.0 * fftSize / sampleRate);
+    auto lastBin = (int) std::floor (juce::jmin (20000.0, sampleRate * 0.45) * fftSize / sampleRate);
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        std::fill (r.begin(), r.end(), 0.0f);
+        std::fill (c.begin(), c.end(), 0.0f);
+        std::copy (reference.getReadPointer (ch), reference.getReadPointer (ch) + fftSize, r.begin());
+        std::copy (candidate.getReadPointer (ch), candidate.getReadPointer (ch) + fftSize, c.begin());
+        fft.performRealOnlyForwardTransform (r.data(), true);
+        fft.performRealOnlyForwardTransform (c.data(), true);
+
+        auto bin = [] (const std::vector<float>& data, int k) { return std::complex<double> (data[(size_t) (2 * k)], data[(size_t) (2 * k + 1)]); };
+
+        double peak = 0.0;
+        for (int k = firstBin; k <= lastBin; ++k)
+            peak = juce::jmax (peak, std::abs (bin (r, k)));
+
+        // deep notches are all rounding noise, both in level and in phase
+        auto floor = peak * std::pow (10.0, -60.0 / 20.0);
+
+        for (int k = firstBin; k <= lastBin; ++k)
+        {
+            auto referenceBin = bin (r, k);
+
+            if (std::abs (referenceBin) < floor)
+                continue;
+
+            auto ratio = bin (c, k) / referenceBin;
+            comparison.magnitudeDb = juce::jmax (comparison.magnitudeDb, std::abs (20.0 * std::log10 (std::abs (ratio))));
+            comparison.phaseDegrees = juce::jmax (comparison.phaseDegrees, std::abs (juce::radiansToDegrees (std::arg (ratio))));
+        }
+    }
+}
+
+} // namespace accuracy
+
+//==============================================================================
+inline int runAccuracyTest (const juce::StringArray& args)
+{
+    using namespace accuracy;
+
+    auto sampleRate = (double) getIntArgument (args, "rate", 48000);
+    auto stageIndex = args.indexOf ("--stage");
+    auto onlyStage = stageIndex >= 0 ? args[stageIndex + 1] : juce::String();
+    auto verbose = args.contains ("--verbose");
+
+    // knob 0 bypasses everything, so the grid starts at the lowest setting that does anything
+    const float knobs[] = { 1.0f, 25.0f, 50.0f, 75.0f, 100.0f };
+    const char* modeNames[] = { "violet", "teal", "crimson" };
+
+    auto signals = makeTestSignals (sampleRate);
+    int numFailures = 0;
+
+    std::cout << "Comparing against the reference processors at " << sampleRate << " Hz" << std::endl;
+
+    for (auto& test : getStageTests())
+    {
+        if (onlyStage.isNotEmpty() && onlyStage != test.name)
+            continue;
+
+        Comparison worst;
+
+        for (int mode = VIOLET; mode <= CRIMSON; ++mode)
+        {
+            for (auto knob : knobs)
+            {
+                Comparison comparison;
+
+                for (auto& signal : signals)
+                {
+                    auto referenceProcessor = test.makeReference (knob, mode, sampleRate);
+                    auto candidateProcessor = test.makeCandidate (knob, mode, sampleRate);
+                    auto referenceOutput = render (referenceProcessor, signal.audio);
+                    auto candidateOutput = render (candidateProcessor, signal.audio);
+
+                    comparison.merge (compareSamples (referenceOutput, candidateOutput));
+
+                    if (signal.isSweep)
+                        compareSpectra (referenceOutput, candidateOutput, sampleRate, comparison);
+                }
+
+                auto passed = comparison.isWithin (test.tolerance);
+                numFailures += passed ? 0 : 1;
+                worst.merge (comparison);
+
+                if (verbose || ! passed)
+                    std::cout << (passed ? "    " : "FAIL") << " " << juce::String (test.name).paddedRight (' ', 12)
+                              << juce::String (modeNames[mode]).paddedRight (' ', 8) << "knob " << juce::String ((int) knob).paddedLeft (' ', 3)
+                              << "   " << comparison.toString() << std::endl;
+            }
+        }
+
+        std::cout << juce::String (test.name).paddedRight (' ', 12) << (worst.isWithin (test.tolerance) ? "ok    " : "FAILED")
+                  << "   worst: " << worst.toString() << std::endl;
+    }
+
+    std::cout << (numFailures == 0 ? "All within tolerance" : juce::String (numFailures) + " case(s) outside tolerance") << std::endl;
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+//
+//  AutomationBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "../../TheKnobDSP/Source/Engine.h"
+
+/*
+ What sample-accurate automation costs the engine. The same blocks are processed with no changes, with a change on every sample that
+ repeats the current values (a host sending a flat automation lane point by point), with one real change per block, with a knob sweep
+ that moves every 64 samples, and with the knob moving on every sample (the worst case).
+
+ Each one is also checked against the engine run the slow way, one setParameters() and process() per segment, and has to match exactly.
+
+ Options:
+    --count N   number of blocks (default 20000)
+    --block N   samples per block (default 512)
+ */
+
+inline int runAutomationBenchmark (const juce::StringArray& args)
+{
+    auto count = getIntArgument (args, "count", 20000);
+    auto blockSize = juce::jmax (2, getIntArgument (args, "block", 512));
+    const double sampleRate = 48000.0;
+
+    juce::AudioSampleBuffer noise (2, blockSize);
+    juce::Random random (1);
+
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            noise.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+    // the changes for the i-th block
+    using ChangeList = std::vector<theknob::ParameterChange>;
+
+    auto makeChanges = [blockSize] (int every, bool moving)
+    {
+        return [blockSize, every, moving] (int block)
+        {
+            ChangeList changes;
+
+            for (int offset = 0; offset < blockSize; offset += every)
+            {
+                auto step = moving ? (block * blockSize + offset) / every : 0;
+                changes.push_back ({ offset, 50.0f + (float) (step % 40), TEAL });
+            }
+
+            return changes;
+        };
+    };
+
+    struct Pattern
+    {
+        const char* name;
+        std::function<ChangeList (int)> getChanges;
+    };
+
+    const Pattern patterns[] =
+    {
+        { "no changes",                 [] (int) { return ChangeList { { 0, 50.0f, TEAL } }; } },
+        { "every sample, same values",  makeChanges (1, false) },
+        { "one real change per block",  [blockSize] (int block) { return ChangeList { { blockSize / 2, block % 2 == 0 ? 40.0f : 60.0f, TEAL } }; } },
+        { "knob moving every 64",       makeChanges (64, true) },
+        { "knob moving every sample",   makeChanges (1, true) },
+    };
+
+    std::cout << count << " stereo blocks of " << blockSize << " samples" << std::endl;
+
+    juce::AudioSampleBuffer audio (2, blockSize), expected (2, blockSize);
+    bool allMatch = true;
+
+    for (auto& pattern : patterns)
+    {
+        // made up front, so the timing is only the engine
+        std::vector<ChangeList> changes;
+
+        for (int block = 0; block < juce::jmin (count, 256); ++block)
+            changes.push_back (pattern.getChanges (block));
+
+        theknob::Engine engine, reference;
+
+        for (auto* e : { &engine, &reference })
+        {
+            e->setParameters (50.0f, TEAL);
+            e->prepare (sampleRate, blockSize);
+        }
+
+        // correctness first: the same blocks, split by hand
+        float maxError = 0.0f;
+
+        for (auto& list : changes)
+        {
+            audio.makeCopyOf (noise, true);
+            expected.makeCopyOf (noise, true);
+            engine.process (audio.getArrayOfWritePointers(), 2, blockSize, list.data(), (int) list.size());
+
+            int position = 0;
+
+            for (size_t i = 0; i <= list.size(); ++i)
+            {
+                auto end = i < list.size() ? list[i].sampleOffset : blockSize;
+                float* range[] = { expected.getWritePointer (0, position), expected.getWritePointer (1, position) };
+                reference.process (range, 2, end - position);
+                position = end;
+
+                if (i < list.size())
+                    reference.setParameters (list[i].knob, list[i].mode);
+            }
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    maxError = juce::jmax (maxError, std::abs (audio.getSample (ch, i) - expected.getSample (ch, i)));
+        }
+
+        allMatch = allMatch && maxError == 0.0f;
+
+        auto result = measure (pattern.name, count, [&] (int i)
+        {
+            auto& list = changes[(size_t) i % changes.size()];
+            audio.makeCopyOf (noise, true);
+            engine.process (audio.getArrayOfWritePointers(), 2, blockSize, list.data(), (int) list.size());
+        });
+
+        result.print();
+
+        if (maxError != 0.0f)
+            std::cout << "    differs from splitting the block by hand by up to " << maxError << std::endl;
+    }
+
+    std::cout << (allMatch ? "All patterns match splitting by hand" : "FAILED: the split processing doesn't match") << std::endl;
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+//
+//  BatchBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "../../TheKnobDSP/Source/BatchEngine.h"
+
+/*
+ The batched engine against mono Engines, one per stream. On every instruction set this CPU has, in each mode at the full and fast
+ saturation tiers, it times as many streams as that ISA has lanes (4, or 8 with AVX2 and up) at 48 kHz through their own Engines and
+ then through one BatchEngine, each stream at a different knob setting, and prints the time per stream and the speed-up.
+
+ Then it checks that every stream comes out bit for bit the same as its Engine's (with elision off), with the knobs automated, a stream
+ bypassed and brought back, the mode switched, and 3, 4, 6 and 8 streams, and fails if any sample differs.
+
+ Options:
+    --seconds N     seconds of audio per measurement (default 10)
+    --block N       block size (default 512)
+ */
+
+inline int runBatchBenchmark (const juce::StringArray& args)
+{
+    using theknob::Isa;
+
+    auto seconds = juce::jmax (1, getIntArgument (args, "seconds", 10));
+    auto blockSize = juce::jlimit (16, 8192, getIntArgument (args, "block", 512));
+    const double sampleRate = 48000.0;
+    auto numBlocks = juce::roundToInt (seconds * sampleRate / blockSize);
+    const char* modeNames[] = { "violet", "teal", "crimson" };
+    const char* tierNames[] = { "full", "fast saturation" };
+
+    std::vector<Isa> isas;
+
+    for (int i = 0; i < (int) Isa::numIsas; ++i)
+        if (theknob::isIsaSupported ((Isa) i))
+            isas.push_back ((Isa) i);
+
+    auto active = theknob::getKernels().isa;
+
+    // a block of noise for each stream
+    auto makeNoise = [] (int numStreams, int numSamples, juce::int64 seed)
+    {
+        juce::Random random (seed);
+        std::vector<std::vector<float>> streams ((size_t) numStreams, std::vector<float> ((size_t) numSamples));
+
+        for (auto& stream : streams)
+            for (auto& sample : stream)
+                sample = random.nextFloat() - 0.5f;
+
+        return streams;
+    };
+
+    auto knobFor = [] (int stream) { return 35.0f + 8.0f * (float) stream; };
+
+    //==============================================================================
+    std::cout << "Mono streams at " << sampleRate << " Hz, blocks of " << blockSize << ", " << seconds << " s of audio each" << std::endl;
+
+    for (auto isa : isas)
+    {
+        theknob::setKernelIsa (isa);
+        auto numStreams = theknob::BatchEngine::getPreferredNumStreams();
+        auto noise = makeNoise (numStreams, blockSize, 1);
+        auto audio = noise;
+
+        std::vector<float*> pointers;
+
+        for (auto& stream : audio)
+            pointers.push_back (stream.data());
+
+        std::cout << std::endl << theknob::getIsaName (isa) << ", " << numStreams << " streams" << std::endl;
+
+        for (int tier = theknob::fullQualityTier; tier <= theknob::fastSaturationTier; ++tier)
+        {
+            for (int mode = VIOLET; mode <= CRIMSON; ++mode)
+            {
+                std::vector<std::unique_ptr<theknob::Engine>> engines;
+                theknob::BatchEngine batch;
+                batch.setMode (mode);
+                batch.setQualityTier (tier);
+
+                for (int stream = 0; stream < numStreams; ++stream)
+                {
+                    engines.push_back (std::make_unique<theknob::Engine>());
+                    engines.back()->setElisionThreshold (-INFINITY);
+                    engines.back()->setQualityTier (tier);
+                    engines.back()->setParameters (knobFor (stream), mode);
+                    engines.back()->prepare (sampleRate, blockSize);
+                    batch.setKnob (stream, knobFor (stream));
+                }
+
+                batch.prepare (sampleRate, blockSize, numStreams);
+
+                auto name = juce::String (modeNames[mode]) + ", " + tierNames[tier];
+
+                auto separate = measure (name + ", engines", numBlocks, [&] (int)
+                {
+                    for (int stream = 0; stream < numStreams; ++stream)
+                    {
+                        std::copy (noise[(size_t) stream].begin(), noise[(size_t) stream].end(), audio[(size_t) stream].begin());
+                        float* channels[] = { pointers[(size_t) stream] };
+                        engines[(size_t) stream]->process (channels, 1, blockSize);
+                    }
+                });
+
+                auto batched = measure (name + ", batch", numBlocks, [&] (int)
+                {
+                    for (int stream = 0; stream < numStreams; ++stream)
+                        std::copy (noise[(size_t) stream].begin(), noise[(size_t) stream].end(), audio[(size_t) stream].begin());
+
+                    batch.process (pointers.data(), blockSize);
+                });
+
+                auto perStream = [&] (const BenchmarkResult& result)
+                {
+                    return juce::String (100.0 * result.seconds / (seconds * numStreams), 3).paddedLeft (' ', 8) + "% of a core per stream";
+                };
+
+                std::cout << separate.name.paddedRight (' ', 40) << perStream (separate) << std::endl
+                          << batched.name.paddedRight (' ', 40) << perStream (batched)
+                          << juce::String (separate.seconds / batched.seconds, 2).paddedLeft (' ', 8) << "x" << std::endl;
+            }
+        }
+    }
+
+    //==============================================================================
+    std::cout << std::endl << "Each stream vs its own Engine, with automation, bypass and mode switches" << std::endl;
+
+    int result = 0;
+
+    for (auto isa : isas)
+    {
+        theknob::setKernelIsa (isa);
+
+        for (auto numStreams : { 3, 4, 6, 8 })
+        {
+            for (int tier = theknob::fullQualityTier; tier <= theknob::fastSaturationTier; ++tier)
+            {
+                const int length = (int) sampleRate * 4;
+                auto input = makeNoise (numStreams, length, numStreams);
+                auto expected = input, actual = input;
+
+                std::vector<std::unique_ptr<theknob::Engine>> engines;
+                theknob::BatchEngine batch;
+                batch.setQualityTier (tier);
+
+                for (int stream = 0; stream < numStreams; ++stream)
+                {
+                    engines.push_back (std::make_unique<theknob::Engine>());
+                    engines.back()->setElisionThreshold (-INFINITY);
+                    engines.back()->setQualityTier (tier);
+                    engines.back()->setParameters (knobFor (stream), VIOLET);
+                    engines.back()->prepare (sampleRate, blockSize);
+                    batch.setKnob (stream, knobFor (stream));
+                }
+
+                batch.prepare (sampleRate, blockSize, numStreams);
+                juce::Random random (numStreams);
+                int mode = VIOLET;
+
+                for (int start = 0, call = 0; start < length; ++call)
+                {
+                    // blocks of any length, including longer than blockSize
+                    auto count = juce::jmin (length - start, 1 + random.nextInt (blockSize * 3));
+
+                    if (call % 5 == 2)
+                    {
+                        auto stream = call % numStreams;
+                        auto knob = call % 3 == 0 ? 0.0f : random.nextFloat() * 100.0f;
+                        engines[(size_t) stream]->setParameters (knob, mode);
+                        batch.setKnob (stream, knob);
+                    }
+
+                    if (call % 13 == 7)
+                    {
+                        mode = (mode + 1) % 3;
+                        batch.setMode (mode);
+
+                        for (int stream = 0; stream < numStreams; ++stream)
+                            engines[(size_t) stream]->setParameters (batch.getKnob (stream), mode);
+                    }
+
+                    std::vector<float*> pointers;
+
+                    for (int stream = 0; stream < numStreams; ++stream)
+                    {
+                        float* channels[] = { expected[(size_t) stream].data() + start };
+                        engines[(size_t) stream]->process (channels, 1, count);
+                        pointers.push_back (actual[(size_t) stream].data() + start);
+                    }
+
+                    batch.process (pointers.data(), count);
+                    start += count;
+                }
+
+                int differences = 0;
+
+                for (int stream = 0; stream < numStreams; ++stream)
+                    if (std::memcmp (expected[(size_t) stream].data(), actual[(size_t) stream].data(), (size_t) length * sizeof (float)) != 0)
+                        ++differences;
+
+                auto name = juce::String (theknob::getIsaName (isa)) + ", " + juce::String (numStreams) + " streams, " + tierNames[tier];
+                std::cout << name.paddedRight (' ', 40) << (differences == 0 ? "the same" : juce::String (differences) + " streams DIFFERENT") << std::endl;
+
+                if (differences != 0)
+                    result = 1;
+            }
+        }
+    }
+
+    theknob::setKernelIsa (active);
+    return result;
+}
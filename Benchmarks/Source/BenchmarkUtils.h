@@ -0,0 +1,92 @@
+//
+//  BenchmarkUtils.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include <iostream>
+#include "../../TheKnobDSP/Source/Trace.h"
+
+//==============================================================================
+// Counts every global operator new (defined in Main.cpp), so benchmarks can report heap churn, and the bytes still allocated, which
+// operator delete takes back off, so they can report what something keeps.
+extern std::atomic<juce::int64> numHeapAllocations;
+extern std::atomic<juce::int64> numLiveHeapBytes;
+
+//==============================================================================
+class Stopwatch
+{
+public:
+    Stopwatch() { restart(); }
+
+    void restart() { startTicks = juce::Time::getHighResolutionTicks(); }
+
+    double getElapsedSeconds() const
+    {
+        return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    }
+
+private:
+    juce::int64 startTicks;
+};
+
+//==============================================================================
+struct BenchmarkResult
+{
+    juce::String name;
+    int iterations = 0;
+    double seconds = 0.0;
+    juce::int64 allocations = 0;
+
+    void print() const
+    {
+        std::cout << name.paddedRight (' ', 32)
+                  << juce::String (seconds * 1000.0, 3).paddedLeft (' ', 12) << " ms total"
+                  << juce::String (seconds * 1.0e6 / juce::jmax (1, iterations), 3).paddedLeft (' ', 12) << " us/iter"
+                  << juce::String ((double) allocations / juce::jmax (1, iterations), 2).paddedLeft (' ', 10) << " allocs/iter"
+                  << std::endl;
+    }
+};
+
+// Times `iterations` calls of fn(i), counting the heap allocations made along the way
+template <typename Fn>
+BenchmarkResult measure (const juce::String& name, int iterations, Fn&& fn)
+{
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+
+    // with --trace, the measurement and each iteration are spans on the trace
+    auto* trace = theknob::Trace::getActive();
+    auto* spanName = trace != nullptr ? trace->intern (name.toStdString()) : nullptr;
+    auto spanStart = trace != nullptr ? trace->now() : 0;
+
+    auto allocationsBefore = numHeapAllocations.load();
+    Stopwatch stopwatch;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        theknob::TraceScope span ("Iteration", "benchmark", "iteration", i);
+        fn (i);
+    }
+
+    result.seconds = stopwatch.getElapsedSeconds();
+    result.allocations = numHeapAllocations.load() - allocationsBefore;
+
+    if (trace != nullptr)
+        trace->span (spanName, "benchmark", spanStart, trace->now());
+
+    return result;
+}
+
+//==============================================================================
+// Returns the integer value of "--name value" from the command line, or the default
+inline int getIntArgument (const juce::StringArray& args, const juce::String& name, int defaultValue)
+{
+    auto index = args.indexOf ("--" + name);
+    return index >= 0 && index + 1 < args.size() ? args[index + 1].getIntValue() : defaultValue;
+}
@@ -0,0 +1,153 @@
+//
+//  ConvolutionBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "../../TheKnobDSP/Source/Engine.h"
+
+/*
+ What the linear-phase EQ and the convolution reverb cost. First one channel of uniformly partitioned convolution, for FIRs from 256
+ samples to 64k, as CPU time per second of audio at 48 kHz. Then the whole engine with the EQ and special EQ as IIR filters and as
+ linear-phase FIRs. Last the reverb stage at 96 kHz: the algorithmic one, and the convolution reverb playing a 10 second response, with
+ its long partitions on the worker (audio thread time only) and with everything on the audio thread (the whole cost).
+
+ Options:
+    --seconds N     seconds of audio per measurement (default 10)
+    --partition N   partition size for the convolution table, up to 512 (default 256, the linear-phase EQ's)
+ */
+
+inline int runConvolutionBenchmark (const juce::StringArray& args)
+{
+    auto seconds = getIntArgument (args, "seconds", 10);
+    auto partitionSize = juce::nextPowerOfTwo (juce::jlimit (16, 512, getIntArgument (args, "partition", 256)));
+    const double sampleRate = 48000.0;
+    const int blockSize = 512;
+    auto numBlocks = juce::roundToInt (seconds * sampleRate / blockSize);
+
+    juce::AudioSampleBuffer noise (2, blockSize);
+    juce::Random random (1);
+
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            noise.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+    //==============================================================================
+    std::cout << "One channel, partitions of " << partitionSize << " samples, " << seconds << " s at " << sampleRate << " Hz" << std::endl;
+
+    int order = 0;
+    while ((1 << order) < 2 * partitionSize)
+        ++order;
+
+    theknob::FFT fft (order);
+    std::vector<float> scratch ((size_t) (2 * partitionSize)), kernel, output ((size_t) partitionSize);
+
+    for (int length = 256; length <= 65536; length *= 2)
+    {
+        kernel.resize ((size_t) length);
+
+        for (auto& k : kernel)
+            k = (random.nextFloat() * 2.0f - 1.0f) / (float) length;
+
+        theknob::PartitionedKernel partitioned;
+        partitioned.prepare (partitionSize, length);
+        partitioned.set (fft, kernel.data(), length, scratch.data());
+
+        theknob::UniformConvolver convolver;
+        convolver.prepare (partitionSize, length);
+
+        auto numPartitions = juce::roundToInt (seconds * sampleRate / partitionSize);
+        float total = 0.0f;
+
+        auto result = measure ("FIR " + juce::String (length), numPartitions, [&] (int i)
+        {
+            convolver.pushPartition (noise.getReadPointer (0, (i * partitionSize) % (blockSize - partitionSize + 1)));
+            convolver.convolve (partitioned, output.data());
+            total += output[0];
+        });
+
+        std::cout << ("FIR " + juce::String (length)).paddedRight (' ', 12)
+                  << juce::String (result.seconds * 1.0e6 / numPartitions, 3).paddedLeft (' ', 10) << " us/partition"
+                  << juce::String (100.0 * result.seconds / seconds, 3).paddedLeft (' ', 10) << "% of one core"
+                  << juce::String (result.seconds * 1.0e9 / (numPartitions * (double) partitionSize * length), 4).paddedLeft (' ', 10) << " ns/tap/sample"
+                  << (total == 0.0f ? " " : "") << std::endl;
+    }
+
+    //==============================================================================
+    std::cout << std::endl << "The engine, stereo blocks of " << blockSize << std::endl;
+
+    for (auto linearPhase : { false, true })
+    {
+        theknob::Engine engine;
+        engine.setLinearPhaseEQ (linearPhase);
+        engine.setParameters (60.0f, CRIMSON);
+        engine.prepare (sampleRate, blockSize);
+        juce::AudioSampleBuffer audio (2, blockSize);
+
+        auto result = measure (linearPhase ? "linear-phase EQ" : "IIR EQ", numBlocks, [&] (int)
+        {
+            audio.makeCopyOf (noise, true);
+            engine.process (audio.getArrayOfWritePointers(), 2, blockSize);
+        });
+
+        result.print();
+        std::cout << "    " << juce::String (100.0 * result.seconds / seconds, 3) << "% of one core, "
+                  << engine.getLatencySamples() << " samples of latency" << std::endl;
+    }
+
+    //==============================================================================
+    const double reverbSampleRate = 96000.0;
+    auto reverbBlocks = juce::roundToInt (seconds * reverbSampleRate / blockSize);
+    auto responseLength = (int) (reverbSampleRate * theknob::ConvolutionReverbStage::maxSeconds);
+
+    std::cout << std::endl << "The reverb stage at " << reverbSampleRate << " Hz, stereo blocks of " << blockSize
+              << ", a " << theknob::ConvolutionReverbStage::maxSeconds << " s response" << std::endl;
+
+    // decaying noise, like a long hall
+    juce::AudioSampleBuffer response (2, responseLength);
+
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < responseLength; ++i)
+            response.setSample (ch, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp (-6.9f * (float) i / (float) responseLength));
+
+    juce::AudioSampleBuffer audio (2, blockSize);
+
+    auto printReverb = [&] (const BenchmarkResult& result)
+    {
+        result.print();
+        std::cout << "    " << juce::String (100.0 * result.seconds / seconds, 3) << "% of one core" << std::endl;
+    };
+
+    {
+        theknob::ReverbStage reverb;
+        reverb.prepare (reverbSampleRate);
+        reverb.setParameters (60.0f, CRIMSON);
+
+        printReverb (measure ("algorithmic", reverbBlocks, [&] (int)
+        {
+            audio.makeCopyOf (noise, true);
+            reverb.process (audio.getArrayOfWritePointers(), blockSize);
+        }));
+    }
+
+    for (auto inBackground : { true, false })
+    {
+        theknob::ConvolutionReverbStage reverb;
+        reverb.setDesignInBackground (inBackground);
+        reverb.setUserImpulseResponse (response.getArrayOfReadPointers(), 2, responseLength);
+        reverb.setParameters (60.0f, CRIMSON);
+        reverb.prepare (reverbSampleRate);
+
+        printReverb (measure (inBackground ? "convolution, audio thread" : "convolution, all of it", reverbBlocks, [&] (int)
+        {
+            audio.makeCopyOf (noise, true);
+            reverb.process (audio.getArrayOfWritePointers(), blockSize);
+        }));
+    }
+
+    return 0;
+}
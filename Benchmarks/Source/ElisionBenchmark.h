@@ -0,0 +1,166 @@
+//
+//  ElisionBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "../../TheKnobDSP/Source/Engine.h"
+
+/*
+ What leaving out inaudible stages saves, and what it costs in accuracy. The input is a second of noise, silence, and another second of
+ noise three quarters of the way through, so the tails ring out, get skipped and then have to start again cleanly.
+
+ The engine in each mode at a few knob values, as CPU time per second of audio, with nothing left out vs at the default threshold. Then the
+ reverb and delay stages on their own (the ones whose wet paths are skipped) against the same stages with nothing left out. Each can be off
+ by up to the threshold from the tail it dropped, and as much again from the quiet input it didn't hear, so the benchmark fails if either
+ is more than 6 dB over it.
+
+ The reverb's combs never quite go silent on their own: the rounding that keeps denormals out of them leaves them cycling at up to about
+ -105 dB at the longest room sizes. Skipping the wet path drops that too, so the reverb's error is allowed up to that floor (measured from
+ the second before the second burst) instead, if it's higher.
+
+ The whole engine's output isn't compared: the crimson special EQ's 10 Hz high-pass turns a one-bit change in its input into differences
+ around -70 dB (its own rounding noise), which would hide the stages' own.
+
+ Options:
+    --seconds N     seconds of audio per measurement (default 20)
+    --block N       block size (default 512)
+ */
+
+inline int runElisionBenchmark (const juce::StringArray& args)
+{
+    auto seconds = juce::jmax (4, getIntArgument (args, "seconds", 20));
+    auto blockSize = juce::jlimit (16, 8192, getIntArgument (args, "block", 512));
+    const double sampleRate = 48000.0;
+    auto numSamples = (int) sampleRate * seconds;
+    auto numBlocks = (numSamples + blockSize - 1) / blockSize;
+
+    juce::AudioSampleBuffer input (2, numSamples), audio (2, numSamples);
+    input.clear();
+    juce::Random random (1);
+    auto secondBurst = numSamples * 3 / 4;
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        for (int i = 0; i < (int) sampleRate; ++i)
+        {
+            input.setSample (ch, i, random.nextFloat() - 0.5f);
+            input.setSample (ch, secondBurst + i, random.nextFloat() - 0.5f);
+        }
+    }
+
+    auto processBlock = [&] (auto& processor, int block)
+    {
+        auto start = block * blockSize;
+        float* channels[] = { audio.getWritePointer (0, start), audio.getWritePointer (1, start) };
+        processor.process (channels, juce::jmin (blockSize, numSamples - start));
+    };
+
+    const char* modeNames[] = { "violet", "teal", "crimson" };
+    auto thresholdDb = theknob::Engine::defaultElisionThresholdDb;
+
+    std::cout << "The engine, stereo blocks of " << blockSize << ", " << seconds << " s of audio at " << sampleRate << " Hz, "
+              << "2 s of it noise" << std::endl << std::endl;
+
+    for (int mode = VIOLET; mode <= CRIMSON; ++mode)
+    {
+        for (auto knob : { 1.0f, 60.0f, 100.0f })
+        {
+            for (auto elide : { false, true })
+            {
+                theknob::Engine engine;
+                engine.setElisionThreshold (elide ? thresholdDb : -std::numeric_limits<float>::infinity());
+                engine.setParameters (knob, mode);
+                engine.prepare (sampleRate, blockSize);
+                audio.makeCopyOf (input, true);
+
+                auto name = juce::String (modeNames[mode]) + ", knob " + juce::String (knob, 0) + (elide ? ", elided" : ", everything");
+
+                auto result = measure (name, numBlocks, [&] (int block)
+                {
+                    float* channels[] = { audio.getWritePointer (0, block * blockSize), audio.getWritePointer (1, block * blockSize) };
+                    engine.process (channels, 2, juce::jmin (blockSize, numSamples - block * blockSize));
+                });
+
+                result.print();
+                std::cout << "    " << juce::String (100.0 * result.seconds / seconds, 3) << "% of one core" << std::endl;
+            }
+        }
+    }
+
+    //==============================================================================
+    std::cout << std::endl << "The reverb and delay stages, elided at " << thresholdDb << " dB vs not" << std::endl;
+
+    auto threshold = std::pow (10.0f, thresholdDb * 0.05f);
+    juce::AudioSampleBuffer reference (2, numSamples);
+    int result = 0;
+
+    auto compare = [&] (const juce::String& name, auto makeStage)
+    {
+        auto everything = makeStage (0.0f);
+        auto elided = makeStage (threshold);
+
+        audio.makeCopyOf (input, true);
+
+        for (int block = 0; block < numBlocks; ++block)
+            processBlock (*everything, block);
+
+        reference.makeCopyOf (audio, true);
+        audio.makeCopyOf (input, true);
+
+        for (int block = 0; block < numBlocks; ++block)
+            processBlock (*elided, block);
+
+        float maxError = 0.0f, idleFloor = 0.0f;
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            for (int i = 0; i < numSamples; ++i)
+                maxError = juce::jmax (maxError, std::abs (audio.getSample (ch, i) - reference.getSample (ch, i)));
+
+            idleFloor = juce::jmax (idleFloor, reference.getMagnitude (ch, secondBurst - (int) sampleRate, (int) sampleRate));
+        }
+
+        auto errorDb = juce::Decibels::gainToDecibels (maxError, -200.0f);
+        auto idleFloorDb = juce::Decibels::gainToDecibels (idleFloor, -200.0f);
+        auto pass = errorDb <= juce::jmax (thresholdDb, idleFloorDb) + 6.0f;
+
+        std::cout << name.paddedRight (' ', 32) << juce::String (errorDb, 1).paddedLeft (' ', 8) << " dB max error"
+                  << juce::String (idleFloorDb, 1).paddedLeft (' ', 8) << " dB idle floor" << (pass ? "" : "  FAILED") << std::endl;
+
+        if (! pass)
+            result = 1;
+    };
+
+    for (int mode = VIOLET; mode <= CRIMSON; ++mode)
+    {
+        for (auto knob : { 1.0f, 60.0f, 100.0f })
+        {
+            auto name = juce::String (modeNames[mode]) + ", knob " + juce::String (knob, 0);
+
+            compare ("reverb, " + name, [&] (float stageThreshold)
+            {
+                auto stage = std::make_unique<theknob::ReverbStage>();
+                stage->setElisionThreshold (stageThreshold);
+                stage->prepare (sampleRate);
+                stage->setParameters (knob, mode);
+                return stage;
+            });
+
+            compare ("delay, " + name, [&] (float stageThreshold)
+            {
+                auto stage = std::make_unique<theknob::DelayStage>();
+                stage->setElisionThreshold (stageThreshold);
+                stage->prepare (sampleRate);
+                stage->setParameters (knob, mode);
+                return stage;
+            });
+        }
+    }
+
+    return result;
+}
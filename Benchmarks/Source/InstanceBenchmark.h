@@ -0,0 +1,367 @@
+//
+//  InstanceBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "PluginProcessor.h"
+#include <thread>
+
+#if JUCE_LINUX
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+/*
+ How many instances of the plug-in fit on a machine, which is what actually limits a session. For 1 up to 512 instances (--max N),
+ each in one of the three modes with a different knob value (and the quality pinned to full, so the governor doesn't change the
+ answer), every instance processes a stereo block of noise in turn, like a host's audio callback:
+
+ -on one thread, round-robin
+ -on a pool of one thread per core, the way a host's track-parallel engine does it: each block, the threads take the next instance from a
+  shared counter until none are left, and the block is done when all of them are
+
+ The time a round of blocks takes is the load it would put on a real-time callback. From that it works out how many instances fit in
+ --budget percent of each block (70 by default, what's left being the host's and the other plug-ins'), per core.
+
+ It also reports what an instance costs in memory: the heap it still holds once it's running (not the temporaries it allocated and freed
+ on the way), and on Linux how much the resident set grows. On Linux it
+ reads the CPU's cache counters through perf_event_open too, per instance and block: L1 data misses (what reaches L2), last-level
+ references (what misses L2) and last-level misses. L2 has no generic perf event of its own, so its miss rate is the last-level
+ references over the L1 misses. perf_event_paranoid above 2, or a container without the syscall, leaves them out.
+
+ Options:
+    --max N         most instances (default 512)
+    --blocks N      rounds of blocks per measurement (default 200)
+    --block N       block size (default 256)
+    --budget N      percent of each block the instances can have (default 70)
+    --threads N     pool threads (default one per core)
+ */
+
+//==============================================================================
+// One thread per core, and the thread that calls run() joins in. Idle threads spin (yielding) between blocks, like a host's workers do
+// inside its callback, so handing out a block costs no more than a couple of atomics.
+class InstancePool
+{
+public:
+    InstancePool (int numThreads, std::function<void (int)> jobToRun)
+        : job (std::move (jobToRun))
+    {
+        for (int i = 1; i < numThreads; ++i)
+            threads.emplace_back ([this] { runWorker(); });
+    }
+
+    ~InstancePool()
+    {
+        shouldExit = true;
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    // Runs job (0) to job (numJobs - 1) across the threads, and returns once they've all finished
+    void run (int numJobs)
+    {
+        totalJobs = numJobs;
+        remaining = numJobs;
+        next = 0;
+        ++generation;
+
+        takeJobs();
+
+        while (remaining.load() > 0)
+            std::this_thread::yield();
+    }
+
+private:
+    void takeJobs()
+    {
+        for (auto index = next++; index < totalJobs.load(); index = next++)
+        {
+            job (index);
+            --remaining;
+        }
+    }
+
+    void runWorker()
+    {
+        auto seen = generation.load();
+
+        while (! shouldExit)
+        {
+            if (generation.load() == seen)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            seen = generation.load();
+            takeJobs();
+        }
+    }
+
+    std::function<void (int)> job;
+    std::vector<std::thread> threads;
+    std::atomic<int> totalJobs { 0 }, remaining { 0 }, next { 0 }, generation { 0 };
+    std::atomic<bool> shouldExit { false };
+};
+
+//==============================================================================
+// The CPU's cache counters for this thread and every thread it starts from here on (perf_event_open, Linux only)
+class CacheCounters
+{
+public:
+    enum Counter
+    {
+        l1DataMisses,
+        lastLevelReferences,
+        lastLevelMisses,
+        numCounters
+    };
+
+    CacheCounters()
+    {
+       #if JUCE_LINUX
+        const juce::uint32 types[] = { PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+        const juce::uint64 configs[] = { PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+                                         PERF_COUNT_HW_CACHE_REFERENCES,
+                                         PERF_COUNT_HW_CACHE_MISSES };
+
+        for (int i = 0; i < numCounters; ++i)
+        {
+            perf_event_attr attributes {};
+            attributes.size = sizeof (attributes);
+            attributes.type = types[i];
+            attributes.config = configs[i];
+            attributes.disabled = 1;
+            attributes.inherit = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+
+            descriptors[i] = (int) syscall (__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+        }
+       #endif
+    }
+
+    ~CacheCounters()
+    {
+       #if JUCE_LINUX
+        for (auto descriptor : descriptors)
+            if (descriptor >= 0)
+                close (descriptor);
+       #endif
+    }
+
+    bool isAvailable() const
+    {
+        return std::all_of (std::begin (descriptors), std::end (descriptors), [] (int descriptor) { return descriptor >= 0; });
+    }
+
+    void start()
+    {
+       #if JUCE_LINUX
+        for (auto descriptor : descriptors)
+        {
+            if (descriptor >= 0)
+            {
+                ioctl (descriptor, PERF_EVENT_IOC_RESET, 0);
+                ioctl (descriptor, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+       #endif
+    }
+
+    void stop()
+    {
+       #if JUCE_LINUX
+        for (auto descriptor : descriptors)
+            if (descriptor >= 0)
+                ioctl (descriptor, PERF_EVENT_IOC_DISABLE, 0);
+       #endif
+    }
+
+    // Read once the threads it was counting have finished
+    juce::uint64 read (Counter counter) const
+    {
+        juce::uint64 value = 0;
+
+       #if JUCE_LINUX
+        if (descriptors[counter] < 0 || ::read (descriptors[counter], &value, sizeof (value)) != (ssize_t) sizeof (value))
+            return 0;
+       #else
+        juce::ignoreUnused (counter);
+       #endif
+
+        return value;
+    }
+
+private:
+    int descriptors[numCounters] = { -1, -1, -1 };
+};
+
+// How much of the process is in RAM, or -1 where that isn't known
+inline juce::int64 getResidentBytes()
+{
+   #if JUCE_LINUX
+    auto statm = juce::File ("/proc/self/statm").loadFileAsString();
+    auto pages = juce::StringArray::fromTokens (statm, false)[1].getLargeIntValue();
+    return pages * (juce::int64) sysconf (_SC_PAGESIZE);
+   #else
+    return -1;
+   #endif
+}
+
+//==============================================================================
+inline int runInstanceBenchmark (const juce::StringArray& args)
+{
+    auto maxInstances = juce::jlimit (1, 4096, getIntArgument (args, "max", 512));
+    auto numBlocks = juce::jmax (1, getIntArgument (args, "blocks", 200));
+    auto blockSize = juce::jlimit (16, 8192, getIntArgument (args, "block", 256));
+    auto budget = juce::jlimit (1, 100, getIntArgument (args, "budget", 70)) / 100.0;
+    auto numThreads = juce::jlimit (1, 256, getIntArgument (args, "threads", juce::SystemStats::getNumCpus()));
+
+    const double sampleRate = 48000.0;
+    const double blockSeconds = blockSize / sampleRate;
+
+    juce::AudioSampleBuffer noise (2, blockSize);
+    juce::Random random (1);
+
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            noise.setSample (ch, i, random.nextFloat() - 0.5f);
+
+    std::cout << "Stereo blocks of " << blockSize << " at 48 kHz (" << juce::String (blockSeconds * 1000.0, 2) << " ms), "
+              << juce::roundToInt (budget * 100.0) << "% of each for the instances, " << numThreads << " pool threads" << std::endl;
+
+    // checked once up front, so a machine without them says so once instead of every run
+    auto countersAvailable = CacheCounters().isAvailable();
+
+    if (! countersAvailable)
+        std::cout << "(no cache counters: perf_event_open isn't available here)" << std::endl;
+
+    std::vector<int> counts;
+
+    for (int count = 1; count < maxInstances; count *= 4)
+        counts.push_back (count);
+
+    counts.push_back (maxInstances);
+
+    for (auto count : counts)
+    {
+        std::cout << std::endl << count << (count == 1 ? " instance" : " instances") << std::endl;
+
+        // what they keep hold of once they've been created, prepared and run
+        auto bytesBefore = numLiveHeapBytes.load();
+        auto residentBefore = getResidentBytes();
+
+        std::vector<std::unique_ptr<TheKnobAudioProcessor>> instances;
+        std::vector<juce::AudioSampleBuffer> buffers ((size_t) count);
+        juce::MidiBuffer midi;
+
+        for (int i = 0; i < count; ++i)
+        {
+            BinaryState::Data state;
+            state.mode = i % 3;
+            state.knob = (float) (10 + (i * 37) % 91);
+            state.flags = (juce::uint32) qualityFull << BinaryState::qualityModeShift;
+
+            juce::MemoryBlock block;
+            BinaryState::write (state, block);
+
+            instances.push_back (std::make_unique<TheKnobAudioProcessor>());
+            instances.back()->setStateInformation (block.getData(), (int) block.getSize());
+            instances.back()->setRateAndBufferSizeDetails (sampleRate, blockSize);
+            instances.back()->prepareToPlay (sampleRate, blockSize);
+            buffers[(size_t) i].setSize (2, blockSize);
+        }
+
+        auto processInstance = [&] (int i)
+        {
+            auto& buffer = buffers[(size_t) i];
+            buffer.makeCopyOf (noise, true);
+            instances[(size_t) i]->processBlock (buffer, midi);
+        };
+
+        // the first blocks fault in the delay lines and reverb, which the measurements shouldn't see
+        for (int block = 0; block < 20; ++block)
+            for (int i = 0; i < count; ++i)
+                processInstance (i);
+
+        auto heapPerInstance = (double) (numLiveHeapBytes.load() - bytesBefore) / count;
+        auto residentAfter = getResidentBytes();
+
+        std::cout << "    " << juce::String (heapPerInstance / 1024.0, 1) << " KB of heap held per instance";
+
+        if (residentBefore >= 0 && residentAfter >= 0)
+            std::cout << ", resident set grew " << juce::String ((double) (residentAfter - residentBefore) / count / 1024.0, 1) << " KB per instance";
+
+        std::cout << std::endl;
+
+        // one round of blocks per iteration. The counters are opened before setUp() starts any threads, so they inherit them, and read
+        // after tearDown() has joined them.
+        auto measureRounds = [&] (const juce::String& name, int threadsUsed, std::function<void()> setUp, std::function<void()> round,
+                                  std::function<void()> tearDown)
+        {
+            CacheCounters counters;
+            setUp();
+
+            counters.start();
+            auto result = measure (name, numBlocks, [&] (int) { round(); });
+            counters.stop();
+            tearDown();
+
+            result.print();
+
+            auto load = result.seconds / numBlocks / blockSeconds;
+            auto fit = count * budget / load;
+
+            std::cout << "    " << juce::String (load * 100.0, 1) << "% of a block, so " << juce::String (fit, 0) << " instances fit, "
+                      << juce::String (fit / threadsUsed, 0) << " per core" << std::endl;
+
+            if (counters.isAvailable())
+            {
+                auto perInstanceBlock = [&] (CacheCounters::Counter counter) { return (double) counters.read (counter) / ((double) count * numBlocks); };
+                auto l1Misses = perInstanceBlock (CacheCounters::l1DataMisses);
+                auto lastLevelReferences = perInstanceBlock (CacheCounters::lastLevelReferences);
+                auto lastLevelMisses = perInstanceBlock (CacheCounters::lastLevelMisses);
+
+                std::cout << "    per instance and block: " << juce::String (l1Misses, 0) << " L1d misses, "
+                          << juce::String (lastLevelReferences, 0) << " L2 misses ("
+                          << juce::String (l1Misses > 0.0 ? 100.0 * lastLevelReferences / l1Misses : 0.0, 1) << "%), "
+                          << juce::String (lastLevelMisses, 0) << " LLC misses ("
+                          << juce::String (lastLevelReferences > 0.0 ? 100.0 * lastLevelMisses / lastLevelReferences : 0.0, 1) << "%)" << std::endl;
+            }
+
+            return load;
+        };
+
+        auto singleLoad = measureRounds ("one thread, round-robin", 1, [] {}, [&]
+        {
+            for (int i = 0; i < count; ++i)
+                processInstance (i);
+        }, [] {});
+
+        auto poolThreads = juce::jmin (numThreads, count);
+        std::unique_ptr<InstancePool> pool;
+
+        auto poolLoad = measureRounds (juce::String (poolThreads) + (poolThreads == 1 ? " thread" : " threads") + ", track-parallel", poolThreads, [&]
+        {
+            pool = std::make_unique<InstancePool> (poolThreads, processInstance);
+
+            for (int block = 0; block < 5; ++block)
+                pool->run (count);
+        },
+        [&] { pool->run (count); },
+        [&] { pool.reset(); });
+
+        std::cout << "    " << juce::String (100.0 * singleLoad / poolLoad / poolThreads, 0) << "% parallel efficiency" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,232 @@
+//
+//  JitterBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "PluginProcessor.h"
+#include <numeric>
+#include <thread>
+
+#if JUCE_LINUX
+ #include <pthread.h>
+ #include <sched.h>
+#endif
+
+/*
+ The worst blocks, not the average ones: a dropout is one block that misses its deadline. The plug-in runs on a thread of its own, at
+ SCHED_FIFO priority on Linux (--priority N, 80 by default; it says so and carries on at normal priority if it isn't allowed), woken
+ once per block by a simulated device clock, at 64, 128, 256 and 512 samples at 48 kHz (or just --block N), for --seconds N each.
+
+ What it plays is meant to find the spikes:
+ -a freshly prepared instance, so the first blocks touch its delay lines and reverb for the first time
+ -the knob automated on every block, and the mode switched every half a second, which swaps the chain over
+ -loud noise for a second, then two seconds of silence for the tails to decay into (where denormals would be, if anything let them
+  through), then loud again straight away
+
+ The quality is pinned to full, so the governor doesn't hide anything. Every block's processBlock() time is kept (in memory allocated
+ beforehand, so the thread never allocates), and it prints the distribution up to p99.99 and the max, how late the thread woke up, and
+ the worst blocks with what was happening at the time. It fails if any block takes more than --deadline percent of its period (50 by
+ default).
+
+ Options:
+    --seconds N     seconds per block size (default 5)
+    --block N       only this block size
+    --deadline N    percent of the block period a block may take (default 50)
+    --priority N    SCHED_FIFO priority (default 80)
+ */
+
+inline int runJitterBenchmark (const juce::StringArray& args)
+{
+    auto seconds = juce::jmax (1, getIntArgument (args, "seconds", 5));
+    auto deadline = juce::jlimit (1, 100, getIntArgument (args, "deadline", 50)) / 100.0;
+    auto priority = juce::jlimit (1, 99, getIntArgument (args, "priority", 80));
+    const double sampleRate = 48000.0;
+
+    std::vector<int> blockSizes { 64, 128, 256, 512 };
+
+    if (args.contains ("--block"))
+        blockSizes = { juce::jlimit (16, 8192, getIntArgument (args, "block", 512)) };
+
+    // what was going on in a block
+    enum Event
+    {
+        firstBlock        = 1,
+        modeSwitch        = 2,
+        silenceStarts     = 4,
+        loudAfterSilence  = 8
+    };
+
+    auto describe = [] (int events)
+    {
+        juce::StringArray names;
+
+        if (events & firstBlock)        names.add ("first block");
+        if (events & modeSwitch)        names.add ("mode switch");
+        if (events & silenceStarts)     names.add ("silence starts");
+        if (events & loudAfterSilence)  names.add ("loud after silence");
+
+        return names.isEmpty() ? juce::String ("automation") : names.joinIntoString (", ");
+    };
+
+    auto findParameter = [] (juce::AudioProcessor& processor, const juce::String& id) -> juce::RangedAudioParameter*
+    {
+        for (auto* param : processor.getParameters())
+            if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (param))
+                if (ranged->getParameterID() == id)
+                    return ranged;
+
+        return nullptr;
+    };
+
+    int result = 0;
+
+    for (auto blockSize : blockSizes)
+    {
+        const double period = blockSize / sampleRate;
+        auto numBlocks = (int) (seconds * sampleRate / blockSize);
+        auto blocksPerSecond = sampleRate / blockSize;
+
+        // one period of the input: a second of noise and two of silence, rounded up to whole blocks
+        auto patternLength = blockSize * (int) std::ceil (sampleRate * 3.0 / blockSize);
+        juce::AudioSampleBuffer pattern (2, patternLength);
+        pattern.clear();
+        juce::Random random (1);
+
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < (int) sampleRate; ++i)
+                pattern.setSample (ch, i, random.nextFloat() - 0.5f);
+
+        TheKnobAudioProcessor processor;
+
+        BinaryState::Data state;
+        state.knob = 50.0f;
+        state.flags = (juce::uint32) qualityFull << BinaryState::qualityModeShift;
+
+        juce::MemoryBlock stateData;
+        BinaryState::write (state, stateData);
+        processor.setStateInformation (stateData.getData(), (int) stateData.getSize());
+
+        auto* knob = findParameter (processor, "knob");
+        auto* mode = findParameter (processor, "mode");
+        jassert (knob != nullptr && mode != nullptr);
+
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        juce::AudioSampleBuffer buffer (2, blockSize);
+        juce::MidiBuffer midi;
+        std::vector<double> blockTimes ((size_t) numBlocks), wakeLateness ((size_t) numBlocks);
+        std::vector<int> blockEvents ((size_t) numBlocks);
+        bool realtime = false;
+
+        std::thread audioThread ([&]
+        {
+           #if JUCE_LINUX
+            sched_param parameters {};
+            parameters.sched_priority = priority;
+            realtime = pthread_setschedparam (pthread_self(), SCHED_FIFO, &parameters) == 0;
+           #endif
+
+            theknob::Trace::setThreadName ("Simulated device");
+
+            using Clock = std::chrono::steady_clock;
+            auto periodDuration = std::chrono::duration_cast<Clock::duration> (std::chrono::duration<double> (period));
+            auto wakeTime = Clock::now() + periodDuration;
+            auto lastMode = -1;
+            auto lastLoud = false;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                // the device asks for the next block once the last one has played, whether or not we made it in time
+                std::this_thread::sleep_until (wakeTime);
+                auto start = Clock::now();
+                wakeLateness[(size_t) block] = std::chrono::duration<double> (start - wakeTime).count();
+                wakeTime += periodDuration;
+
+                auto position = (int) (((juce::int64) block * blockSize) % patternLength);
+                auto loud = position < (int) sampleRate;
+                auto newMode = (int) (block / (blocksPerSecond / 2.0)) % 3;
+                auto knobValue = 55.0f + 45.0f * std::sin (juce::MathConstants<float>::twoPi * (float) (block / blocksPerSecond / 4.0));
+
+                auto events = (block == 0 ? firstBlock : 0)
+                            | (newMode != lastMode && block > 0 ? modeSwitch : 0)
+                            | (lastLoud && ! loud ? silenceStarts : 0)
+                            | (loud && ! lastLoud && block > 0 ? loudAfterSilence : 0);
+
+                lastMode = newMode;
+                lastLoud = loud;
+
+                // a host's automation arrives on its audio thread, just before the block
+                knob->setValueNotifyingHost (knob->convertTo0to1 (knobValue));
+                mode->setValueNotifyingHost (mode->convertTo0to1 ((float) newMode));
+
+                for (int ch = 0; ch < 2; ++ch)
+                    buffer.copyFrom (ch, 0, pattern, ch, position, blockSize);
+
+                auto processStart = Clock::now();
+                processor.processBlock (buffer, midi);
+                blockTimes[(size_t) block] = std::chrono::duration<double> (Clock::now() - processStart).count();
+                blockEvents[(size_t) block] = events;
+            }
+        });
+
+        audioThread.join();
+
+        //==============================================================================
+        std::cout << (blockSizes.size() > 1 && blockSize != blockSizes.front() ? "\n" : "")
+                  << blockSize << " samples (" << juce::String (period * 1000.0, 2) << " ms), " << numBlocks << " blocks"
+                  << (realtime ? ", SCHED_FIFO " + juce::String (priority) : juce::String (", normal priority (SCHED_FIFO wasn't allowed)")) << std::endl;
+
+        auto sorted = blockTimes;
+        std::sort (sorted.begin(), sorted.end());
+
+        auto percentile = [] (const std::vector<double>& values, double p)
+        {
+            return values[(size_t) juce::jlimit (0, (int) values.size() - 1, (int) std::ceil (p / 100.0 * (double) values.size()) - 1)];
+        };
+
+        auto microseconds = [] (double value) { return juce::String (value * 1.0e6, 1).paddedLeft (' ', 9) + " us"; };
+
+        for (auto p : { 50.0, 99.0, 99.9, 99.99 })
+            std::cout << ("    p" + juce::String (p)).paddedRight (' ', 12) << microseconds (percentile (sorted, p))
+                      << juce::String (100.0 * percentile (sorted, p) / period, 1).paddedLeft (' ', 8) << "% of the period" << std::endl;
+
+        std::cout << juce::String ("    max").paddedRight (' ', 12) << microseconds (sorted.back())
+                  << juce::String (100.0 * sorted.back() / period, 1).paddedLeft (' ', 8) << "% of the period" << std::endl;
+
+        auto lateness = wakeLateness;
+        std::sort (lateness.begin(), lateness.end());
+        std::cout << "    woke up late by" << microseconds (percentile (lateness, 99.0)) << " at p99, " << microseconds (lateness.back()).trim() << " at worst" << std::endl;
+
+        // the worst five, with what was going on
+        std::vector<int> order ((size_t) numBlocks);
+        std::iota (order.begin(), order.end(), 0);
+        std::partial_sort (order.begin(), order.begin() + juce::jmin (5, numBlocks), order.end(),
+                           [&] (int a, int b) { return blockTimes[(size_t) a] > blockTimes[(size_t) b]; });
+
+        std::cout << "    worst blocks:" << std::endl;
+
+        for (int i = 0; i < juce::jmin (5, numBlocks); ++i)
+        {
+            auto block = order[(size_t) i];
+            std::cout << "        " << microseconds (blockTimes[(size_t) block]) << " at " << juce::String (block / blocksPerSecond, 3) << " s: "
+                      << describe (blockEvents[(size_t) block]) << std::endl;
+        }
+
+        auto over = (int) std::count_if (blockTimes.begin(), blockTimes.end(), [&] (double time) { return time > deadline * period; });
+
+        if (over > 0)
+        {
+            std::cout << "    " << over << (over == 1 ? " block" : " blocks") << " took more than " << juce::roundToInt (deadline * 100.0)
+                      << "% of the period  FAILED" << std::endl;
+            result = 1;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,172 @@
+//
+//  KernelBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "../../TheKnobDSP/Source/Engine.h"
+#include "../../TheKnobDSP/Source/Kernels.h"
+
+/*
+ The inner loops on every instruction set this CPU can run. Each kernel on its own, as ns per sample (per stereo sample for the biquad
+ and combs), then the whole engine in each mode at 48 kHz as CPU time per second of audio. Every ISA's engine output is checked against
+ the scalar one's, and the benchmark fails if any differs by even one bit.
+
+ THEKNOB_ISA only picks what everything else runs with; this always runs all of them.
+
+ Options:
+    --seconds N     seconds of audio per measurement (default 10)
+    --block N       block size (default 512)
+ */
+
+inline int runKernelBenchmark (const juce::StringArray& args)
+{
+    using theknob::Isa;
+
+    auto seconds = getIntArgument (args, "seconds", 10);
+    auto blockSize = juce::jlimit (16, 8192, getIntArgument (args, "block", 512));
+    const double sampleRate = 48000.0;
+    auto numBlocks = juce::roundToInt (seconds * sampleRate / blockSize);
+
+    juce::AudioSampleBuffer noise (2, blockSize), audio (2, blockSize);
+    juce::Random random (1);
+
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            noise.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+    std::vector<Isa> isas;
+
+    for (int i = 0; i < (int) Isa::numIsas; ++i)
+        if (theknob::isIsaSupported ((Isa) i))
+            isas.push_back ((Isa) i);
+
+    auto active = theknob::getKernels().isa;
+    std::cout << "Running with " << theknob::getIsaName (active) << " (the best here is " << theknob::getIsaName (theknob::getBestIsa())
+              << "), blocks of " << blockSize << ", " << seconds << " s of audio" << std::endl;
+
+    auto printPerSample = [&] (const BenchmarkResult& result)
+    {
+        std::cout << result.name.paddedRight (' ', 32)
+                  << juce::String (result.seconds * 1.0e9 / ((double) result.iterations * blockSize), 3).paddedLeft (' ', 10) << " ns/sample"
+                  << std::endl;
+    };
+
+    //==============================================================================
+    auto coefficients = theknob::IIRCoefficients::makePeakFilter (sampleRate, 1000.0f, 0.7f, 2.0f);
+    std::vector<float> ring (48000), delayed ((size_t) blockSize), damping ((size_t) blockSize, 0.3f), feedback ((size_t) blockSize, 0.84f);
+    std::array<int, theknob::CombBank::numCombs> combSizes {};
+    const int juceCombSizes[] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 };
+
+    for (int i = 0; i < 8; ++i)
+    {
+        combSizes[(size_t) i] = juceCombSizes[i];
+        combSizes[(size_t) i + 8] = juceCombSizes[i] + 23;
+    }
+
+    for (auto isa : isas)
+    {
+        theknob::setKernelIsa (isa);
+        const auto& kernels = theknob::getKernels();
+        auto name = juce::String (theknob::getIsaName (isa));
+        std::cout << std::endl << name << std::endl;
+
+        std::array<float, 2> leftState {}, rightState {};
+
+        printPerSample (measure ("biquad", numBlocks, [&] (int)
+        {
+            audio.makeCopyOf (noise, true);
+            kernels.biquadStereo (coefficients.c.data(), coefficients.order, leftState.data(), rightState.data(),
+                                  audio.getWritePointer (0), audio.getWritePointer (1), blockSize);
+        }));
+
+        printPerSample (measure ("waveshaper", numBlocks, [&] (int)
+        {
+            audio.makeCopyOf (noise, true);
+            kernels.waveshape (audio.getWritePointer (0), blockSize, 2.0f, 0.5f, false);
+        }));
+
+        printPerSample (measure ("waveshaper (sine)", numBlocks, [&] (int)
+        {
+            audio.makeCopyOf (noise, true);
+            kernels.waveshape (audio.getWritePointer (0), blockSize, 2.0f, 0.5f, true);
+        }));
+
+        theknob::CombBank bank;
+        bank.setSizes (combSizes);
+
+        printPerSample (measure ("comb bank", numBlocks, [&] (int)
+        {
+            audio.makeCopyOf (noise, true);
+            kernels.combs (bank, noise.getReadPointer (0), damping.data(), feedback.data(),
+                           audio.getWritePointer (0), audio.getWritePointer (1), blockSize);
+        }));
+
+        auto ringSize = (int) ring.size();
+
+        printPerSample (measure ("delay read + write", numBlocks, [&] (int i)
+        {
+            auto start = (i * blockSize) % ringSize;
+            kernels.delayRead (ring.data(), ringSize, start, delayed.data(), blockSize);
+            kernels.delayWrite (ring.data(), ringSize, start, noise.getReadPointer (0), blockSize);
+        }));
+    }
+
+    //==============================================================================
+    const char* modeNames[] = { "violet", "teal", "crimson" };
+    std::cout << std::endl << "The engine, stereo, at " << sampleRate << " Hz" << std::endl;
+    int result = 0;
+
+    for (int mode = VIOLET; mode <= CRIMSON; ++mode)
+    {
+        std::vector<float> scalarOutput;
+
+        for (auto isa : isas)
+        {
+            theknob::setKernelIsa (isa);
+
+            theknob::Engine engine;
+            engine.setParameters (60.0f, mode);
+            engine.prepare (sampleRate, blockSize);
+            std::vector<float> output;
+            output.reserve ((size_t) (2 * ((int) sampleRate + blockSize)));
+
+            auto timing = measure (juce::String (modeNames[mode]) + ", " + theknob::getIsaName (isa), numBlocks, [&] (int i)
+            {
+                audio.makeCopyOf (noise, true);
+                engine.process (audio.getArrayOfWritePointers(), 2, blockSize);
+
+                // the first second is enough to compare
+                if (i * blockSize < (int) sampleRate)
+                    for (int ch = 0; ch < 2; ++ch)
+                        output.insert (output.end(), audio.getReadPointer (ch), audio.getReadPointer (ch) + blockSize);
+            });
+
+            timing.print();
+            std::cout << "    " << juce::String (100.0 * timing.seconds / seconds, 3) << "% of one core";
+
+            if (isa == Isa::scalar)
+            {
+                scalarOutput = output;
+                std::cout << std::endl;
+            }
+            else if (output.size() == scalarOutput.size()
+                      && std::memcmp (output.data(), scalarOutput.data(), output.size() * sizeof (float)) == 0)
+            {
+                std::cout << ", the same as scalar" << std::endl;
+            }
+            else
+            {
+                std::cout << ", DIFFERENT from scalar" << std::endl;
+                result = 1;
+            }
+        }
+    }
+
+    theknob::setKernelIsa (active);
+    return result;
+}
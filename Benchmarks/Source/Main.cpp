@@ -0,0 +1,162 @@
+//
+//  Main.cpp
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#include <JuceHeader.h>
+#include "BenchmarkUtils.h"
+#include "StateBenchmark.h"
+#include "AccuracyTest.h"
+#include "PaintBenchmark.h"
+#include "MeterBenchmark.h"
+#include "AutomationBenchmark.h"
+#include "ConvolutionBenchmark.h"
+#include "MultirateBenchmark.h"
+#include "KernelBenchmark.h"
+#include "ElisionBenchmark.h"
+#include "SnapshotBenchmark.h"
+#include "QualityBenchmark.h"
+#include "InstanceBenchmark.h"
+#include "JitterBenchmark.h"
+#include "BatchBenchmark.h"
+
+//==============================================================================
+std::atomic<juce::int64> numHeapAllocations { 0 };
+std::atomic<juce::int64> numLiveHeapBytes { 0 };
+
+// every block starts with its size, so operator delete knows how much to take off (kept to malloc's alignment)
+static constexpr std::size_t heapHeaderSize = alignof (std::max_align_t);
+
+void* operator new (std::size_t size)
+{
+    if (auto* block = static_cast<char*> (std::malloc (heapHeaderSize + size)))
+    {
+        ++numHeapAllocations;
+        numLiveHeapBytes += (juce::int64) size;
+        std::memcpy (block, &size, sizeof (size));
+        return block + heapHeaderSize;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete (void* ptr) noexcept
+{
+    if (ptr == nullptr)
+        return;
+
+    auto* block = static_cast<char*> (ptr) - heapHeaderSize;
+    std::size_t size;
+    std::memcpy (&size, block, sizeof (size));
+    numLiveHeapBytes -= (juce::int64) size;
+    std::free (block);
+}
+
+void operator delete (void* ptr, std::size_t) noexcept { operator delete (ptr); }
+
+//==============================================================================
+struct Benchmark
+{
+    const char* name;
+    const char* description;
+    int (*run) (const juce::StringArray&);
+};
+
+static const Benchmark benchmarks[] =
+{
+    { "state", "restores plug-in states, binary vs legacy XML", runStateBenchmark },
+    { "accuracy", "compares the DSP with the reference processors, fails outside tolerance", runAccuracyTest },
+    { "paint", "paints the knob without a display, vector paths vs filmstrip", runPaintBenchmark },
+    { "meters", "what the level meters cost the audio thread", runMeterBenchmark },
+    { "automation", "sample-accurate parameter changes, from none to every sample", runAutomationBenchmark },
+    { "convolution", "the linear-phase EQ's convolution, CPU per channel vs FIR length", runConvolutionBenchmark },
+    { "multirate", "the engine at 48-192 kHz, with the reverb and delay at full and reduced rate", runMultirateBenchmark },
+    { "kernels", "the inner loops and the engine on every instruction set the CPU has", runKernelBenchmark },
+    { "elision", "what skipping silent tails saves, and its error", runElisionBenchmark },
+    { "snapshot", "saving and restoring the engine's state, and that a restore carries on bit for bit", runSnapshotBenchmark },
+    { "quality", "each quality tier's CPU and error, switching between them, and the governor", runQualityBenchmark },
+    { "instances", "how many plug-in instances fit per core, on one thread and on a pool", runInstanceBenchmark },
+    { "jitter", "the worst block times on a SCHED_FIFO thread paced like a device, with automation and transients", runJitterBenchmark },
+    { "batch", "4-8 mono streams in one batched engine's SIMD lanes vs an engine each, and that they match bit for bit", runBatchBenchmark },
+};
+
+static void printUsage()
+{
+    std::cout << "usage: TheKnobBenchmarks [benchmark] [options]" << std::endl << std::endl;
+
+    for (auto& benchmark : benchmarks)
+        std::cout << "    " << juce::String (benchmark.name).paddedRight (' ', 12) << benchmark.description << std::endl;
+
+    std::cout << std::endl << "    --trace FILE    also write a Chrome trace of every measurement, iteration and engine stage to FILE" << std::endl;
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add (argv[i]);
+
+    if (args.contains ("--help"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    // with no benchmark named, run all of them
+    auto selected = args.isEmpty() || args[0].startsWith ("--") ? juce::String() : args[0];
+    int result = 0;
+    bool ranAny = false;
+
+    theknob::Trace trace;
+    auto traceIndex = args.indexOf ("--trace");
+    auto traceFile = traceIndex >= 0 ? juce::File::getCurrentWorkingDirectory().getChildFile (args[traceIndex + 1]) : juce::File();
+
+    if (traceFile != juce::File())
+    {
+        if (! trace.start (traceFile.getFullPathName().toStdString()))
+        {
+            std::cerr << "can't write " << traceFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        // this thread's first event sets up its buffer, which shouldn't count towards the first benchmark's allocations
+        theknob::Trace::setThreadName ("Benchmarks");
+        trace.instant ("Start", "benchmark");
+    }
+
+    for (auto& benchmark : benchmarks)
+    {
+        if (selected.isNotEmpty() && selected != benchmark.name)
+            continue;
+
+        std::cout << "==== " << benchmark.name << " ====" << std::endl;
+        theknob::TraceScope span (benchmark.name, "benchmark");
+        result |= benchmark.run (args);
+        ranAny = true;
+    }
+
+    if (trace.isRecording())
+    {
+        auto dropped = trace.stop();
+        std::cout << std::endl << "Trace written to " << traceFile.getFullPathName();
+
+        if (dropped > 0)
+            std::cout << " (" << dropped << " events didn't fit in the buffers and were left out)";
+
+        std::cout << std::endl;
+    }
+
+    if (! ranAny)
+    {
+        printUsage();
+        return 1;
+    }
+
+    return result;
+}
@@ -0,0 +1,98 @@
+//
+//  MeterBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "PluginProcessor.h"
+
+/*
+ What the level meters cost the audio thread: the SIMD block reduction against a plain loop, the meters as processBlock runs them (input
+ and output, with the ballistics and publishing), and the engine processing the same blocks for comparison.
+
+ Options:
+    --count N   number of blocks (default 100000)
+    --block N   samples per block (default 512)
+ */
+
+inline void measureBlockScalar (const float* samples, int numSamples, float& peak, float& sumOfSquares) noexcept
+{
+    peak = 0.0f;
+    sumOfSquares = 0.0f;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        peak = juce::jmax (peak, std::abs (samples[i]));
+        sumOfSquares += samples[i] * samples[i];
+    }
+}
+
+inline int runMeterBenchmark (const juce::StringArray& args)
+{
+    auto count = getIntArgument (args, "count", 100000);
+    auto blockSize = getIntArgument (args, "block", 512);
+    const double sampleRate = 48000.0;
+
+    juce::AudioSampleBuffer noise (2, blockSize);
+    juce::Random random (1);
+
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            noise.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+    std::cout << count << " stereo blocks of " << blockSize << " samples" << std::endl;
+
+    // keeps the results alive, so the reductions can't be optimised away
+    float total = 0.0f;
+
+    auto reduce = [&] (void (*function) (const float*, int, float&, float&))
+    {
+        return [&, function] (int)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                float peak, sumOfSquares;
+                function (noise.getReadPointer (ch), blockSize, peak, sumOfSquares);
+                total += peak + sumOfSquares;
+            }
+        };
+    };
+
+    measure ("reduction, scalar loop", count, reduce (measureBlockScalar)).print();
+    measure ("reduction, SIMD", count, reduce (measureBlock)).print();
+
+    LevelMeters meters;
+    meters.prepare (sampleRate);
+
+    auto metersResult = measure ("meters, input + output", count, [&] (int)
+    {
+        meters.measureInput (noise, 2);
+        meters.measureOutput (noise, 2);
+    });
+    metersResult.print();
+
+    theknob::Engine engine;
+    engine.setParameters (50.0f, VIOLET);
+    engine.prepare (sampleRate, blockSize);
+    juce::AudioSampleBuffer audio (noise);
+
+    auto engineResult = measure ("engine, violet at 50", count, [&] (int)
+    {
+        audio.makeCopyOf (noise, true);
+        engine.process (audio.getArrayOfWritePointers(), 2, blockSize);
+    });
+    engineResult.print();
+
+    auto blockSeconds = blockSize / sampleRate;
+    auto metersPerBlock = metersResult.seconds / count;
+
+    std::cout << "The meters cost " << juce::String (100.0 * metersPerBlock / (engineResult.seconds / count), 2) << "% of the engine, and "
+              << juce::String (100.0 * metersPerBlock / blockSeconds, 4) << "% of a block's real-time budget at " << sampleRate << " Hz"
+              << (total == 0.0f ? " " : "") << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+//
+//  MultirateBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "../../TheKnobDSP/Source/Engine.h"
+
+/*
+ What running the reverb's and delay's wet paths at a reduced rate saves. The engine at 48, 96 and 192 kHz in each mode, with the wet
+ paths at the full rate and at 48 kHz, as CPU time per second of audio, with the latency it reports, then the reduced rate's time over the
+ full rate's. At 48 kHz the two are the same engine, so the difference between them there is the noise floor.
+
+ Options:
+    --seconds N     seconds of audio per measurement (default 10)
+    --block N       block size (default 512)
+ */
+
+inline int runMultirateBenchmark (const juce::StringArray& args)
+{
+    auto seconds = getIntArgument (args, "seconds", 10);
+    auto blockSize = juce::jlimit (16, 8192, getIntArgument (args, "block", 512));
+
+    juce::AudioSampleBuffer noise (2, blockSize), audio (2, blockSize);
+    juce::Random random (1);
+
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            noise.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+    const char* modeNames[] = { "violet", "teal", "crimson" };
+
+    std::cout << "The engine, stereo blocks of " << blockSize << ", " << seconds << " s of audio" << std::endl;
+
+    for (auto sampleRate : { 48000.0, 96000.0, 192000.0 })
+    {
+        std::cout << std::endl << sampleRate << " Hz" << std::endl;
+        auto numBlocks = juce::roundToInt (seconds * sampleRate / blockSize);
+
+        for (int mode = VIOLET; mode <= CRIMSON; ++mode)
+        {
+            double fullRateSeconds = 0;
+
+            for (auto reducedRate : { false, true })
+            {
+                theknob::Engine engine;
+                engine.setReducedRateWetPaths (reducedRate);
+                engine.setParameters (60.0f, mode);
+                engine.prepare (sampleRate, blockSize);
+
+                auto result = measure (juce::String (modeNames[mode]) + (reducedRate ? ", wet at 48 kHz" : ", full rate"), numBlocks, [&] (int)
+                {
+                    audio.makeCopyOf (noise, true);
+                    engine.process (audio.getArrayOfWritePointers(), 2, blockSize);
+                });
+
+                result.print();
+                std::cout << "    " << juce::String (100.0 * result.seconds / seconds, 3) << "% of one core, "
+                          << engine.getLatencySamples() << " samples of latency" << std::endl;
+
+                if (! reducedRate)
+                    fullRateSeconds = result.seconds;
+                else
+                    std::cout << "    reduced / full rate: " << juce::String (result.seconds / fullRateSeconds, 2) << std::endl;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+//
+//  PaintBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "PluginProcessor.h"
+
+/*
+ Paints the editor's knob (with its value box) into an image, with no display, the way a host repaints it while the knob is automated:
+ once for every step of the knob, at 1x and at 2x. The knob drawn with vector paths, as it used to be, is compared with the filmstrip.
+ Then the same for switching modes: swapping LookAndFeels, as the editor used to, against recolouring the one it has, both drawn with
+ vector paths and both with the filmstrip, so each pair only differs in how the mode is switched.
+
+ Options:
+    --count N   number of repaints (default 2000)
+ */
+
+// The knob's LookAndFeel as it was before the filmstrip: vector paths, and a new Font for every paint of the value
+class VectorKnobLookAndFeel  : public MyLookAndFeel
+{
+public:
+    using MyLookAndFeel::MyLookAndFeel;
+
+    void drawRotarySlider (juce::Graphics& g, int x, int y, int width, int height, float sliderPos,
+                           float rotaryStartAngle, float rotaryEndAngle, juce::Slider& slider) override
+    {
+        juce::LookAndFeel_V4::drawRotarySlider (g, x, y, width, height, sliderPos, rotaryStartAngle, rotaryEndAngle, slider);
+    }
+
+    void drawLabel (juce::Graphics& g, juce::Label& label) override
+    {
+        g.fillAll (label.findColour (juce::Label::backgroundColourId));
+
+        const juce::Font font (juce::FontOptions(33));
+
+        g.setColour (findColour (juce::Slider::thumbColourId).withMultipliedAlpha (0.5f));
+        g.setFont (font);
+
+        auto textArea = getLabelBorderSize (label).subtractedFrom (label.getLocalBounds());
+
+        g.drawFittedText (label.getText(), textArea, juce::Justification::centred, 1, 1.0f);
+    }
+};
+
+inline int runPaintBenchmark (const juce::StringArray& args)
+{
+    auto count = getIntArgument (args, "count", 2000);
+
+    std::array<VectorKnobLookAndFeel, 3> vectorLookAndFeels { VectorKnobLookAndFeel (VIOLET), VectorKnobLookAndFeel (TEAL), VectorKnobLookAndFeel (CRIMSON) };
+    std::array<MyLookAndFeel, 3> filmstripLookAndFeels { MyLookAndFeel (VIOLET), MyLookAndFeel (TEAL), MyLookAndFeel (CRIMSON) };
+    VectorKnobLookAndFeel vectorLookAndFeel (VIOLET);
+    MyLookAndFeel filmstripLookAndFeel (VIOLET);
+
+    // the knob as the editor sets it up
+    juce::Slider slider (juce::Slider::Rotary, juce::Slider::TextBoxBelow);
+    slider.setTextBoxStyle (juce::Slider::TextBoxBelow, true, 50, 50);
+    slider.setRange (KNOB_MIN_VALUE, KNOB_MAX_VALUE, 1.0);
+    slider.setBounds (0, 0, PluginEditor::knobAreaWidth, PluginEditor::windowHeight - PluginEditor::analyzerHeight - PluginEditor::footerHeight);
+
+    std::cout << "Painting the " << slider.getWidth() << "x" << slider.getHeight() << " knob " << count << " times" << std::endl;
+
+    for (auto scale : { 1.0f, 2.0f })
+    {
+        juce::Image image (juce::Image::ARGB, juce::roundToInt ((float) slider.getWidth() * scale), juce::roundToInt ((float) slider.getHeight() * scale), true);
+        auto label = juce::String (scale, 0) + "x, ";
+
+        auto paint = [&]
+        {
+            juce::Graphics g (image);
+            g.addTransform (juce::AffineTransform::scale (scale));
+            slider.paintEntireComponent (g, false);
+        };
+
+        auto paintValue = [&] (int i)
+        {
+            slider.setValue (i % 101, juce::dontSendNotification);
+            paint();
+        };
+
+        slider.setLookAndFeel (&vectorLookAndFeels[VIOLET]);
+        measure ("knob " + label + "vector paths", count, paintValue).print();
+
+        slider.setLookAndFeel (&filmstripLookAndFeel);
+        measure ("knob " + label + "filmstrip (first paint)", 1, paintValue).print();
+        measure ("knob " + label + "filmstrip", count, paintValue).print();
+
+        // one LookAndFeel per mode, swapped, against one that's recoloured, on the same drawing path
+        auto measureModeSwitches = [&] (const juce::String& path, auto& perMode, auto& recoloured)
+        {
+            measure ("mode " + label + path + ", swapped", count, [&] (int i)
+            {
+                slider.setLookAndFeel (&perMode[(size_t) (i % 3)]);
+                paint();
+            }).print();
+
+            slider.setLookAndFeel (&recoloured);
+            measure ("mode " + label + path + ", recoloured", count, [&] (int i)
+            {
+                recoloured.setMode (i % 3);
+                paint();
+            }).print();
+        };
+
+        measureModeSwitches ("vector", vectorLookAndFeels, vectorLookAndFeel);
+        measureModeSwitches ("filmstrip", filmstripLookAndFeels, filmstripLookAndFeel);
+    }
+
+    slider.setLookAndFeel (nullptr);
+    return 0;
+}
@@ -0,0 +1,207 @@
+//
+//  QualityBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "../../TheKnobDSP/Source/Engine.h"
+#include "../../TheKnobDSP/Source/QualityGovernor.h"
+
+/*
+ The engine's quality tiers: what each one costs in each mode at 48 and 96 kHz, and how far its output is from the full tier's on the same
+ noise (the largest difference, in dB below full scale).
+
+ Then switching: the tier changes every quarter of a second, and the benchmark fails if the output stops being finite, or jumps by more
+ from one sample to the next than the full tier's own output ever does plus a little.
+
+ Then the governor, fed the loads the tiers would have on a machine where the full tier takes 120% of each block for 3 seconds and then
+ 30% for 15. It fails unless it steps down while overloaded and is back at the full tier by the end.
+
+ Options:
+    --count N       blocks per measurement (default 1000)
+    --block N       block size (default 512)
+ */
+
+inline int runQualityBenchmark (const juce::StringArray& args)
+{
+    auto count = juce::jmax (1, getIntArgument (args, "count", 1000));
+    auto blockSize = juce::jlimit (16, 8192, getIntArgument (args, "block", 512));
+    const char* modeNames[] = { "violet", "teal", "crimson" };
+    const char* tierNames[] = { "full", "fast saturation", "economy" };
+
+    auto fillWithNoise = [] (juce::AudioSampleBuffer& buffer, juce::Random& random)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (ch, i, random.nextFloat() - 0.5f);
+    };
+
+    // the tier can change at the start of any block
+    auto run = [&] (theknob::Engine& engine, juce::AudioSampleBuffer& audio, std::function<int (int)> tierForBlock)
+    {
+        for (int start = 0, block = 0; start < audio.getNumSamples(); start += blockSize, ++block)
+        {
+            engine.setQualityTier (tierForBlock (block));
+
+            float* channels[] = { audio.getWritePointer (0, start), audio.getWritePointer (1, start) };
+            engine.process (channels, 2, juce::jmin (blockSize, audio.getNumSamples() - start));
+        }
+    };
+
+    auto maxDifference = [] (const juce::AudioSampleBuffer& a, const juce::AudioSampleBuffer& b)
+    {
+        float largest = 0.0f;
+
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                largest = juce::jmax (largest, std::abs (a.getSample (ch, i) - b.getSample (ch, i)));
+
+        return largest;
+    };
+
+    auto maxStep = [] (const juce::AudioSampleBuffer& audio)
+    {
+        float largest = 0.0f;
+
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 1; i < audio.getNumSamples(); ++i)
+                largest = juce::jmax (largest, std::abs (audio.getSample (ch, i) - audio.getSample (ch, i - 1)));
+
+        return largest;
+    };
+
+    // each tier's time per block at 48 kHz in crimson, for the governor below
+    double blockCost[theknob::numQualityTiers] = {};
+
+    //==============================================================================
+    std::cout << "Each tier on a stereo block of " << blockSize << ", at knob 60, and its largest difference from the full tier" << std::endl << std::endl;
+
+    for (auto sampleRate : { 48000.0, 96000.0 })
+    {
+        for (int mode = VIOLET; mode <= CRIMSON; ++mode)
+        {
+            juce::Random random (1);
+            juce::AudioSampleBuffer input (2, (int) sampleRate * 2);
+            fillWithNoise (input, random);
+
+            juce::AudioSampleBuffer outputs[theknob::numQualityTiers];
+
+            for (int tier = theknob::fullQualityTier; tier < theknob::numQualityTiers; ++tier)
+            {
+                theknob::Engine engine;
+                engine.prepare (sampleRate, blockSize);
+                engine.setParameters (60.0f, mode);
+
+                outputs[tier].makeCopyOf (input);
+                run (engine, outputs[tier], [tier] (int) { return tier; });
+
+                auto name = juce::String (modeNames[mode]) + ", " + juce::String (sampleRate / 1000.0, 0) + " kHz, " + tierNames[tier];
+                auto result = measure (name, count, [&] (int i)
+                {
+                    auto start = (i * blockSize) % (input.getNumSamples() - blockSize);
+                    float* channels[] = { input.getWritePointer (0, start), input.getWritePointer (1, start) };
+                    engine.process (channels, 2, blockSize);
+                });
+
+                result.print();
+
+                if (sampleRate == 48000.0 && mode == CRIMSON)
+                    blockCost[tier] = result.seconds / result.iterations;
+
+                if (tier != theknob::fullQualityTier)
+                    std::cout << "    " << juce::String (juce::Decibels::gainToDecibels (maxDifference (outputs[tier], outputs[theknob::fullQualityTier]), -200.0f), 1)
+                              << " dB from full" << std::endl;
+            }
+        }
+    }
+
+    //==============================================================================
+    std::cout << std::endl << "Switching tiers every 250 ms: the largest step from one sample to the next, vs the full tier's" << std::endl;
+
+    int result = 0;
+
+    for (int mode = VIOLET; mode <= CRIMSON; ++mode)
+    {
+        const double sampleRate = 48000.0;
+        auto blocksPerSwitch = juce::jmax (1, (int) (sampleRate / 4) / blockSize);
+
+        juce::Random random (2);
+        juce::AudioSampleBuffer input (2, (int) sampleRate * 4), full, switched;
+        fillWithNoise (input, random);
+        full.makeCopyOf (input);
+        switched.makeCopyOf (input);
+
+        theknob::Engine fullEngine, switchedEngine;
+
+        for (auto* e : { &fullEngine, &switchedEngine })
+        {
+            e->prepare (sampleRate, blockSize);
+            e->setParameters (60.0f, mode);
+        }
+
+        // full, fast saturation, economy, fast saturation, full, economy (a jump of two), ...
+        const int sequence[] = { 0, 1, 2, 1, 0, 2 };
+        run (fullEngine, full, [] (int) { return (int) theknob::fullQualityTier; });
+        run (switchedEngine, switched, [&] (int block) { return sequence[(block / blocksPerSwitch) % 6]; });
+
+        auto finite = true;
+
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < switched.getNumSamples(); ++i)
+                finite = finite && std::isfinite (switched.getSample (ch, i));
+
+        auto fullStep = maxStep (full), switchedStep = maxStep (switched);
+        auto pass = finite && switchedStep <= fullStep * 1.1f + 0.01f;
+
+        std::cout << juce::String (modeNames[mode]).paddedRight (' ', 32) << juce::String (switchedStep, 4).paddedLeft (' ', 10)
+                  << juce::String (fullStep, 4).paddedLeft (' ', 10) << (finite ? "" : "  not finite") << (pass ? "" : "  FAILED") << std::endl;
+
+        if (! pass)
+            result = 1;
+    }
+
+    //==============================================================================
+    std::cout << std::endl << "The governor, with the full tier at 120% of each block for 3 s, then 30% for 15 s (crimson's measured cost ratios)" << std::endl;
+
+    const double blockSeconds = blockSize / 48000.0;
+    auto scale = 1.2 / blockCost[theknob::fullQualityTier];
+
+    theknob::QualityGovernor governor;
+    governor.reset();
+
+    int tier = theknob::fullQualityTier;
+    auto steppedDown = false;
+    auto totalBlocks = (int) (18.0 / blockSeconds);
+
+    for (int block = 0; block < totalBlocks; ++block)
+    {
+        auto seconds = block * blockSeconds;
+
+        if (block == (int) (3.0 / blockSeconds))
+            scale = 0.3 / blockCost[theknob::fullQualityTier];
+
+        auto newTier = governor.update ((float) (blockCost[tier] * scale), blockSeconds);
+
+        if (newTier != tier)
+        {
+            std::cout << juce::String (seconds, 2).paddedLeft (' ', 8) << " s: " << tierNames[tier] << " -> " << tierNames[newTier]
+                      << ", load " << juce::String (governor.getLoad(), 2) << std::endl;
+
+            steppedDown = steppedDown || (newTier > tier && seconds < 3.0);
+            tier = newTier;
+        }
+    }
+
+    auto recovered = tier == theknob::fullQualityTier;
+    std::cout << (steppedDown ? "stepped down while overloaded" : "didn't step down while overloaded  FAILED") << ", "
+              << (recovered ? "back at full quality" : "not back at full quality  FAILED") << std::endl;
+
+    if (! steppedDown || ! recovered)
+        result = 1;
+
+    return result;
+}
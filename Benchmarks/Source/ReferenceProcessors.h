@@ -1,128 +1,34 @@
 //
-//  FXProcessors.h
-//  TheKnob - Shared Code
+//  ReferenceProcessors.h
+//  TheKnobBenchmarks
 //
-//  Created by Vou Theophanous on 2025-05-23.
-//  Copyright © 2025 VOU. All rights reserved.
+//  Created by Vou Theophanous on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
 //
 
-#ifndef FXProcessors_h
-#define FXProcessors_h
-
+#pragma once
+#include <JuceHeader.h>
 
 /*
- =================================Mode/FX Descriptions=================================
- 
- There are 3 FX modes: Violet, Teal, and Crimson. They are each a unique combination (with a unique order) of a filter, some EQ, some reverb, some delay, and some distortion. Every mode's chain ends with some more EQ to add some extra unique flavour.
- 
- -The Filter is the same for all modes: HPF that goes from 10 Hz to 150 Hz.
- -The EQ is also the same for all modes:
-    -Boost at 250 Hz. Q goes from 2.0 to 1.0, Gain goes from 1.0 to 2.0 (0 dB to 6 dB).
-    -Boost at 16 kHz. Q goes from 2.0 to 1.0, Gain goes from 1.0 to 2.0 (0 dB to 6 dB).
-    -Reduction at 400 Hz. Q goes from 2.0 to 1.0, Gain goes from 1.0 to 0.5 (0 dB to -6 dB).
- -The Special EQ is custom to each mode.
- -The Reverb chain is: HPF -> LPF -> Delay -> Gain Reduction
-    -HPF goes from 10 Hz to 300 Hz.
-    -LPF goes from 20 kHz to 3500 Hz.
-    -Gain reduction of -6 dB.
- -The Delay chain is: HPF -> LPF -> Delay -> LPF
-    -HPF goes from 10 Hz to 400 Hz.
-    -LPF goes from 20 kHz to 3500 Hz.
-    -The Delay parameters are custom to each mode.
-    -First-order LPF at 1000 Hz.
- -The Distortion parameters are custom to each mode.
- 
- ---------------------------------Violet---------------------------------
- Chain: Filter -> Distortion -> Reverb -> Delay -> EQ -> Special EQ
- 
- -Filter: see above
- -Distortion:
-    -Pre Gain: 0 dB to 10 dB
-    -Post Gain: Pre Gain * -0.75
-    -Waveshaper Transfer Function: tanh(sin(x))
- -Reverb:
-    -Common parameters: see above
-    -Custom parameters:
-        -Room Size: 0 to 0.5
-        -Damping: 1 to 0
-        -Wet Level: 0 to 0.5
-        -Dry Level: 1 - Wet Level
-        -Width: 0 to 0.5
-        -Freeze Mode: 0 to 0.35
- -Delay:
-    -Common parameters: see above
-    -Custom parameters:
-        -Delay time L channel: 0.7
-        -Delay time R channel: 0.7
-        -Wet Level: 0 to 0.6
-        -Feedback: 0 to 0.6
- -EQ: see above
- -Special EQ:
-    -Reduction at 400 Hz, Q = 1, Gain from 0 dB to -3 dB
-    -Boost at 10 kHz, Q = 0.71, Gain from 0 dB to 3 dB
- 
- ---------------------------------Teal---------------------------------
- Chain: Filter -> EQ -> Distortion -> Delay -> Reverb -> Special EQ
- 
- -Filter: see above
- -EQ: see above
- -Distortion:
-    -Pre Gain: 0 dB to 15 dB
-    -Post Gain: Pre Gain * -0.75
-    -Waveshaper Transfer Function: tanh(x)
- -Delay:
-    -Common parameters: see above
-    -Custom parameters:
-        -Delay time L channel: 0.2
-        -Delay time R channel: 0.2
-        -Wet Level: 0 to 0.5
-        -Feedback: 0 to 0.75
- -Reverb:
-    -Common parameters: see above
-    -Custom parameters:
-        -Room Size: 0 to 0.75
-        -Damping: 1 to 0
-        -Wet Level: 0 to 0.8
-        -Dry Level: 1 - Wet Level
-        -Width: 0 to 0.75
-        -Freeze Mode: 0 to 0.1
- -Special EQ:
-    -Boost at 1000 Hz, Q = 2.11, Gain from 0 dB to 3 dB
-    -Boost at 10 kHz, Q = 0.71, Gain from 0 dB to 3 dB
- 
- ---------------------------------Crimson---------------------------------
- Chain: Filter -> EQ -> Delay -> Reverb -> Distortion -> Special EQ
- 
- -Filter: see above
- -EQ: see above
- -Delay:
-    -Common parameters: see above
-    -Custom parameters:
-        -Delay time L channel: 1.0
-        -Delay time R channel: 1.0
-        -Wet Level: 0 to 1.0
-        -Feedback: 0 to 0.25
- -Reverb:
-    -Common parameters: see above
-    -Custom parameters:
-        -Room Size: 0 to 0.9
-        -Damping: 0 to 1
-        -Wet Level: 0 to 1.0
-        -Dry Level: 1 - Wet Level
-        -Width: 0 to 0.9
-        -Freeze Mode: 0 to 0.1
- -Distortion:
-    -Pre Gain: 0 dB to 10 dB
-    -Post Gain: Pre Gain * -0.75
-    -Waveshaper Transfer Function: tanh(x)
- -Special EQ:
-    -HPF from 10 Hz to 111 Hz, Q = 0.71
-    -LPF from 20 kHz to 2500 Hz, Q = 0.66
-    -Boost at 177 Hz, Q = 0.71, Gain from 0 dB to 4 dB
-    -Boost at 1777 Hz, Q = 0.71, Gain from 0 dB to 5 dB
- 
+ =================================Reference Processors=================================
+
+ A frozen copy of TheKnob's original juce::dsp processors (FXProcessors.h at DSP_VERSION 1, before the DSP moved into TheKnobDSP), and
+ the graph that ran them. This is the golden reference the accuracy test holds TheKnobDSP to.
+
+ Don't change anything in here: the whole point is that it doesn't follow the DSP when it changes.
+
  */
 
+namespace reference
+{
+
+enum MODE
+{
+    VIOLET,
+    TEAL,
+    CRIMSON
+};
+
 //==============================================================================
 // KNOB
 const float KNOB_MIN_VALUE = 0.0;
@@ -160,16 +66,17 @@ const std::array<float, 3> DIST_INPUT_GAIN_MIN_VALUE = { 0.0, 0.0, 0.0 }; // one
 const std::array<float, 3> DIST_INPUT_GAIN_MAX_VALUE = { 10.0, 15.0, 10.0 }; // one for each mode
 
 //==============================================================================
-float mapKnobValueToRange(float x, float rangeStart, float rangeEnd)
+inline float mapKnobValueToRange(float x, float rangeStart, float rangeEnd)
 {
     return rangeStart + (x - KNOB_MIN_VALUE) * (rangeEnd - rangeStart) / (KNOB_MAX_VALUE - KNOB_MIN_VALUE);
 }
 
-float normalizeKnobValue(float x)
+inline float normalizeKnobValue(float x)
 {
     return mapKnobValueToRange(x, 0.0, 1.0);
 }
 
+
 //==============================================================================
 class ProcessorBase : public juce::AudioProcessor
 {
@@ -783,4 +690,77 @@ private:
     juce::dsp::ProcessorChain<juce::dsp::Gain<float>, juce::dsp::WaveShaper<float>, juce::dsp::Gain<float>> distortionChain;
 };
 
-#endif /* FXProcessors_h */
+//==============================================================================
+// The plug-in's old AudioProcessorGraph, without the graph: the six processors in each mode's order, bypassed while the knob is below 1
+class Chain
+{
+public:
+    Chain()
+        : filter (&knob, &mode),
+          eq (&knob, &mode),
+          specialEq (&knob, &mode),
+          reverb (&knob, &mode),
+          delay (&knob, &mode),
+          distortion (&knob, &mode)
+    {}
+
+    void setParameters (float newKnob, int newMode)
+    {
+        knob = newKnob;
+        mode = (float) newMode;
+    }
+
+    void prepare (double sampleRate, int samplesPerBlock)
+    {
+        for (auto* processor : std::initializer_list<ProcessorBase*> { &filter, &eq, &specialEq, &reverb, &delay, &distortion })
+        {
+            processor->setRateAndBufferSizeDetails (sampleRate, samplesPerBlock);
+            processor->prepareToPlay (sampleRate, samplesPerBlock);
+        }
+    }
+
+    void process (juce::AudioSampleBuffer& buffer)
+    {
+        if ((int) knob == 0)
+            return;
+
+        std::array<ProcessorBase*, 6> fx;
+
+        switch((int) mode)
+        {
+            case VIOLET:
+                // order: filter -> distortion -> reverb -> delay -> EQ -> Special EQ
+                fx = { &filter, &distortion, &reverb, &delay, &eq, &specialEq };
+                break;
+
+            case TEAL:
+                // order: filter -> EQ -> distortion -> delay -> reverb -> Special EQ
+                fx = { &filter, &eq, &distortion, &delay, &reverb, &specialEq };
+                break;
+
+            case CRIMSON:
+            default:
+                // order: filter -> EQ -> delay -> reverb -> distortion -> Special EQ
+                fx = { &filter, &eq, &delay, &reverb, &distortion, &specialEq };
+                break;
+        }
+
+        for (auto* processor : fx)
+            processor->processBlock (buffer, midi);
+    }
+
+private:
+    std::atomic<float> knob { KNOB_DEFAULT_VALUE };
+    std::atomic<float> mode { VIOLET };
+
+    FilterProcessor filter;
+    EQProcessor eq;
+    SpecialEQProcessor specialEq;
+    ReverbProcessor reverb;
+    DelayProcessor delay;
+    DistortionProcessor distortion;
+
+    juce::MidiBuffer midi;
+};
+
+} // namespace reference
@@ -0,0 +1,160 @@
+//
+//  SnapshotBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "../../TheKnobDSP/Source/Engine.h"
+
+/*
+ The engine's state snapshots: how big they are and how long saving and restoring one takes at 48, 96 and 192 kHz, next to processing a
+ block. Both should be about as fast as copying that many bytes, and never allocate.
+
+ Then whether a restored engine really carries on where the saved one was. In each mode, with the wet paths at the full and reduced rate,
+ an engine runs two seconds of noise, is saved, and runs two more seconds with the knob moving. The same two seconds are run again after
+ restoring into the engine, and into a new one that had been running something else, and the benchmark fails unless all three outputs are
+ bit-identical. It also fails if a state is restored into an engine prepared at a different sample rate.
+
+ Options:
+    --count N       saves and restores per measurement (default 1000)
+    --block N       block size (default 512)
+ */
+
+inline int runSnapshotBenchmark (const juce::StringArray& args)
+{
+    auto count = juce::jmax (1, getIntArgument (args, "count", 1000));
+    auto blockSize = juce::jlimit (16, 8192, getIntArgument (args, "block", 512));
+    const char* modeNames[] = { "violet", "teal", "crimson" };
+
+    auto fillWithNoise = [] (juce::AudioSampleBuffer& buffer, juce::Random& random)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (ch, i, random.nextFloat() - 0.5f);
+    };
+
+    // the knob moves once per block, so the smoothers are mid-ramp whenever the state is saved
+    auto run = [&] (theknob::Engine& engine, juce::AudioSampleBuffer& audio, int mode, float startKnob, float endKnob)
+    {
+        auto numSamples = audio.getNumSamples();
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            auto knob = juce::jmap ((float) start / (float) numSamples, startKnob, endKnob);
+            engine.setParameters (knob, mode);
+
+            float* channels[] = { audio.getWritePointer (0, start), audio.getWritePointer (1, start) };
+            engine.process (channels, 2, juce::jmin (blockSize, numSamples - start));
+        }
+    };
+
+    //==============================================================================
+    std::cout << "Saving and restoring, crimson at knob 60, vs processing a stereo block of " << blockSize << std::endl << std::endl;
+
+    for (auto sampleRate : { 48000.0, 96000.0, 192000.0 })
+    {
+        theknob::Engine engine;
+        engine.prepare (sampleRate, blockSize);
+        engine.setParameters (60.0f, CRIMSON);
+
+        juce::Random random (1);
+        juce::AudioSampleBuffer audio (2, (int) sampleRate);
+        fillWithNoise (audio, random);
+        run (engine, audio, CRIMSON, 60.0f, 60.0f);
+
+        std::vector<unsigned char> state (engine.getStateSize());
+        auto rate = juce::String (sampleRate / 1000.0, 0) + " kHz";
+        std::cout << rate << ": " << juce::String ((double) state.size() / 1024.0, 1) << " KB of state" << std::endl;
+
+        measure ("save, " + rate, count, [&] (int) { engine.saveState (state.data(), state.size()); }).print();
+        measure ("restore, " + rate, count, [&] (int) { engine.restoreState (state.data(), state.size()); }).print();
+
+        measure ("process block, " + rate, count, [&] (int i)
+        {
+            auto start = (i * blockSize) % (audio.getNumSamples() - blockSize);
+            float* channels[] = { audio.getWritePointer (0, start), audio.getWritePointer (1, start) };
+            engine.process (channels, 2, blockSize);
+        }).print();
+    }
+
+    //==============================================================================
+    std::cout << std::endl << "Restoring, then running the same audio again: samples that differ (there shouldn't be any)" << std::endl;
+
+    int result = 0;
+
+    for (auto reducedRate : { false, true })
+    {
+        const double sampleRate = reducedRate ? 96000.0 : 48000.0;
+        auto numSamples = (int) sampleRate * 2;
+
+        for (int mode = VIOLET; mode <= CRIMSON; ++mode)
+        {
+            theknob::Engine engine, other;
+
+            for (auto* e : { &engine, &other })
+            {
+                e->setReducedRateWetPaths (reducedRate);
+                e->prepare (sampleRate, blockSize);
+            }
+
+            juce::Random random (2);
+            juce::AudioSampleBuffer lead (2, numSamples), input (2, numSamples);
+            fillWithNoise (lead, random);
+            fillWithNoise (input, random);
+
+            run (engine, lead, mode, 20.0f, 80.0f);
+            run (other, lead, (mode + 1) % 3, 50.0f, 10.0f);
+
+            std::vector<unsigned char> state (engine.getStateSize());
+            auto saved = engine.saveState (state.data(), state.size());
+
+            juce::AudioSampleBuffer expected, again, elsewhere;
+            expected.makeCopyOf (input);
+            run (engine, expected, mode, 80.0f, 100.0f);
+
+            auto restored = engine.restoreState (state.data(), state.size()) && other.restoreState (state.data(), state.size());
+            again.makeCopyOf (input);
+            elsewhere.makeCopyOf (input);
+            run (engine, again, mode, 80.0f, 100.0f);
+            run (other, elsewhere, mode, 80.0f, 100.0f);
+
+            int differences = 0;
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    differences += expected.getSample (ch, i) != again.getSample (ch, i) ? 1 : 0;
+                    differences += expected.getSample (ch, i) != elsewhere.getSample (ch, i) ? 1 : 0;
+                }
+            }
+
+            auto pass = saved && restored && differences == 0;
+            auto name = juce::String (modeNames[mode]) + (reducedRate ? ", 96 kHz reduced rate" : ", 48 kHz");
+            std::cout << name.paddedRight (' ', 32) << juce::String (differences).paddedLeft (' ', 8) << (pass ? "" : "  FAILED") << std::endl;
+
+            if (! pass)
+                result = 1;
+        }
+    }
+
+    // a state only goes back into an engine prepared the same way
+    theknob::Engine at48k, at44k;
+    at48k.prepare (48000.0, blockSize);
+    at44k.prepare (44100.0, blockSize);
+
+    std::vector<unsigned char> state (at48k.getStateSize());
+    at48k.saveState (state.data(), state.size());
+    auto rejected = ! at44k.restoreState (state.data(), state.size());
+
+    std::cout << "restoring a 48 kHz state at 44.1 kHz" << (rejected ? " is refused" : " wasn't refused  FAILED") << std::endl;
+
+    if (! rejected)
+        result = 1;
+
+    return result;
+}
@@ -0,0 +1,154 @@
+//
+//  StateBenchmark.h
+//  TheKnobBenchmarks
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "BenchmarkUtils.h"
+#include "PluginProcessor.h"
+
+/*
+ Simulates opening a session with many instances: every instance gets its state restored once, first from the binary format and then from the legacy (v1.1) XML format.
+
+ Then it restores states with the knob and mode out of range (from a corrupt or hostile session), binary and XML, and fails unless they come back in range, or if one whose knob isn't a number isn't ignored.
+
+ Options:
+    --count N   number of instances/states (default 1000)
+ */
+
+inline juce::MemoryBlock makeLegacyState (float knob, int mode)
+{
+    // this is what getStateInformation used to write: the APVTS tree, as XML
+    juce::XmlElement xml ("TheKnob");
+
+    auto* knobParam = xml.createNewChildElement ("PARAM");
+    knobParam->setAttribute ("id", "knob");
+    knobParam->setAttribute ("value", knob);
+
+    auto* modeParam = xml.createNewChildElement ("PARAM");
+    modeParam->setAttribute ("id", "mode");
+    modeParam->setAttribute ("value", mode);
+
+    juce::MemoryBlock block;
+    juce::AudioProcessor::copyXmlToBinary (xml, block);
+    return block;
+}
+
+inline int runStateBenchmark (const juce::StringArray& args)
+{
+    auto count = getIntArgument (args, "count", 1000);
+
+    std::vector<std::unique_ptr<TheKnobAudioProcessor>> instances;
+    std::vector<juce::MemoryBlock> binaryStates, legacyStates;
+
+    for (int i = 0; i < count; ++i)
+    {
+        BinaryState::Data state;
+        state.knob = (float) (i % 101);
+        state.mode = i % 3;
+
+        juce::MemoryBlock binaryState;
+        BinaryState::write (state, binaryState);
+        binaryStates.push_back (std::move (binaryState));
+        legacyStates.push_back (makeLegacyState (state.knob, state.mode));
+
+        instances.push_back (std::make_unique<TheKnobAudioProcessor>());
+    }
+
+    std::cout << "Restoring " << count << " states ("
+              << (int) binaryStates.front().getSize() << " bytes binary, "
+              << (int) legacyStates.front().getSize() << " bytes legacy XML)" << std::endl;
+
+    measure ("setStateInformation (binary)", count, [&] (int i)
+    {
+        instances[(size_t) i]->setStateInformation (binaryStates[(size_t) i].getData(), (int) binaryStates[(size_t) i].getSize());
+    }).print();
+
+    measure ("setStateInformation (legacy XML)", count, [&] (int i)
+    {
+        instances[(size_t) i]->setStateInformation (legacyStates[(size_t) i].getData(), (int) legacyStates[(size_t) i].getSize());
+    }).print();
+
+    juce::MemoryBlock savedState;
+    measure ("getStateInformation", count, [&] (int i)
+    {
+        instances[(size_t) i]->getStateInformation (savedState);
+    }).print();
+
+    //==============================================================================
+    std::cout << std::endl << "States out of range" << std::endl;
+
+    struct OutOfRange
+    {
+        float knob;
+        int mode;
+        float expectedKnob;
+        int expectedMode;
+    };
+
+    const OutOfRange tests[] =
+    {
+        { 150.0f, 7, KNOB_MAX_VALUE, CRIMSON },
+        { -20.0f, -3, KNOB_MIN_VALUE, VIOLET },
+        { 1.0e30f, std::numeric_limits<int>::max(), KNOB_MAX_VALUE, CRIMSON },
+        { 50.0f, std::numeric_limits<int>::min(), 50.0f, VIOLET }
+    };
+
+    int result = 0;
+    TheKnobAudioProcessor processor;
+
+    auto check = [&] (const juce::String& name, bool passed)
+    {
+        std::cout << name.paddedRight (' ', 48) << (passed ? "ok" : "FAILED") << std::endl;
+
+        if (! passed)
+            result = 1;
+    };
+
+    // what the processor saves is what its parameters were set to
+    auto savedStateIs = [&] (float knob, int mode)
+    {
+        juce::MemoryBlock saved;
+        processor.getStateInformation (saved);
+
+        BinaryState::Data state;
+        return BinaryState::read (saved.getData(), (int) saved.getSize(), state) && state.knob == knob && state.mode == mode;
+    };
+
+    for (auto& test : tests)
+    {
+        auto name = "knob " + juce::String (test.knob) + ", mode " + juce::String (test.mode);
+
+        BinaryState::Data state;
+        state.knob = test.knob;
+        state.mode = test.mode;
+
+        juce::MemoryBlock block;
+        BinaryState::write (state, block);
+
+        BinaryState::Data read;
+        check (name + ", read", BinaryState::read (block.getData(), (int) block.getSize(), read)
+                                 && read.knob == test.expectedKnob && read.mode == test.expectedMode);
+
+        processor.setStateInformation (block.getData(), (int) block.getSize());
+        check (name + ", restored", savedStateIs (test.expectedKnob, test.expectedMode));
+
+        auto legacyState = makeLegacyState (test.knob, test.mode);
+        processor.setStateInformation (legacyState.getData(), (int) legacyState.getSize());
+        check (name + ", restored from XML", savedStateIs (test.expectedKnob, test.expectedMode));
+    }
+
+    // a knob that isn't a number leaves the last state alone
+    BinaryState::Data notANumber;
+    notANumber.knob = std::numeric_limits<float>::quiet_NaN();
+
+    juce::MemoryBlock block;
+    BinaryState::write (notANumber, block);
+    processor.setStateInformation (block.getData(), (int) block.getSize());
+    check ("knob NaN, ignored", savedStateIs (tests[3].expectedKnob, tests[3].expectedMode));
+
+    return result;
+}
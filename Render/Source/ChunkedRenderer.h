@@ -0,0 +1,250 @@
+//
+//  ChunkedRenderer.h
+//  theknob_render
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "FileRenderer.h"
+#include "WorkStealingPool.h"
+
+/*
+ Renders one long file on every core. The chain only remembers its input for as long as its tail (getTailLengthSeconds()), so the file is cut
+ into chunks, and each chunk is rendered on its own fresh chain after first running that chain over the tail-length of audio before it:
+
+        |<- warm-up ->|<------- chunk n ------->|<- crossfade ->|
+                                 |<- warm-up ->|<------- chunk n + 1 ------->|...
+
+ Chunks are rendered by the pool's workers (on their own FileRenderers) and written in order by the calling thread. Each chunk renders a
+ little past its end so it can be crossfaded into the next one, which hides whatever is left of the warm-up's error. Only a few chunks per
+ worker are ever in memory at once.
+ */
+class ChunkedRenderer
+{
+public:
+    ChunkedRenderer (const RenderSettings& renderSettings, WorkStealingPool& workerPool, std::vector<std::unique_ptr<FileRenderer>>& workerRenderers)
+        : settings (renderSettings), pool (workerPool), renderers (workerRenderers)
+    {
+        formatManager.registerBasicFormats();
+    }
+
+    // Whether the file is long enough to be worth splitting
+    bool shouldChunk (const juce::File& input)
+    {
+        if (settings.chunkSeconds <= 0.0)
+            return false;
+
+        InputReader reader (formatManager, input);
+        return reader.get() != nullptr && (double) reader.get()->lengthInSamples > 2.0 * settings.chunkSeconds * reader.get()->sampleRate;
+    }
+
+    // Call this from a thread that isn't one of the pool's workers, it waits for the chunks
+    RenderResult render (const juce::File& input)
+    {
+        RenderResult result;
+        result.input = input;
+        result.output = renderers.front()->getOutputFile (input);
+
+        juce::int64 startTicks = juce::Time::getHighResolutionTicks();
+
+        InputReader reader (formatManager, input);
+
+        if (reader.get() == nullptr)
+            return withError (result, "can't read file");
+
+        if (reader.get()->numChannels < 1 || reader.get()->numChannels > 2)
+            return withError (result, "only mono and stereo files are supported");
+
+        auto sampleRate = reader.get()->sampleRate;
+        auto totalSamples = renderers.front()->getRenderLength (*reader.get());
+        auto chunkSamples = (juce::int64) std::ceil (settings.chunkSeconds * sampleRate);
+        auto warmUpSamples = (juce::int64) std::ceil (getTailLengthSeconds (settings.mode, settings.knob, settings.warmUpDecayDb) * sampleRate);
+        auto crossfadeSamples = (int) juce::jmin ((juce::int64) std::ceil (crossfadeSeconds * sampleRate), chunkSamples / 2);
+        auto numChunks = (int) ((totalSamples + chunkSamples - 1) / chunkSamples);
+
+        auto writer = FileRenderer::createWriter (*reader.get(), result.output);
+
+        if (writer == nullptr)
+            return withError (result, "can't write " + result.output.getFullPathName());
+
+        //==============================================================================
+        struct Chunk
+        {
+            juce::AudioBuffer<float> audio;
+            juce::WaitableEvent done;
+            std::atomic<bool> succeeded { false };
+        };
+
+        auto maxInFlight = 2 * pool.getNumWorkers();
+        std::vector<std::unique_ptr<Chunk>> inFlight ((size_t) maxInFlight);
+
+        for (auto& chunk : inFlight)
+            chunk = std::make_unique<Chunk>();
+
+        auto getChunkLength = [&] (int index) { return (int) juce::jmin (chunkSamples, totalSamples - index * chunkSamples); };
+        int numSubmitted = 0;
+
+        auto submitNext = [&]
+        {
+            auto index = numSubmitted++;
+            auto* chunk = inFlight[(size_t) (index % maxInFlight)].get();
+            auto numSamples = getChunkLength (index) + (index < numChunks - 1 ? crossfadeSamples : 0);
+
+            pool.submit ([&, chunk, index, numSamples] (int workerIndex)
+            {
+                theknob::TraceScope span ("Render chunk", "render", "chunk", index);
+                chunk->succeeded = renderers[(size_t) workerIndex]->renderSection (input, index * chunkSamples, numSamples, warmUpSamples, chunk->audio);
+                chunk->done.signal();
+            });
+        };
+
+        while (numSubmitted < juce::jmin (maxInFlight, numChunks))
+            submitNext();
+
+        juce::AudioBuffer<float> overlap (2, crossfadeSamples);
+        bool readFailed = false, writeFailed = false;
+
+        // every submitted chunk is waited for, even after a failure, as they all refer to this stack frame
+        for (int index = 0; index < numSubmitted; ++index)
+        {
+            auto& chunk = *inFlight[(size_t) (index % maxInFlight)];
+
+            {
+                theknob::TraceScope span ("Wait for chunk", "wait", "chunk", index);
+                chunk.done.wait();
+            }
+
+            readFailed = readFailed || ! chunk.succeeded;
+
+            if (! readFailed && ! writeFailed)
+            {
+                auto length = getChunkLength (index);
+
+                if (index > 0)
+                    crossfade (overlap, chunk.audio);
+
+                theknob::TraceScope span ("Write", "io", "chunk", index);
+                writeFailed = ! writer->writeFromAudioSampleBuffer (chunk.audio, 0, length);
+
+                if (index < numChunks - 1)
+                    for (int ch = 0; ch < 2; ++ch)
+                        overlap.copyFrom (ch, 0, chunk.audio, ch, length, crossfadeSamples);
+
+                if (numSubmitted < numChunks)
+                    submitNext();
+            }
+        }
+
+        writer.reset();
+
+        if (readFailed)
+            return withError (result, "read error");
+
+        if (writeFailed)
+            return withError (result, "write error");
+
+        result.numChunks = numChunks;
+        result.warmUpSeconds = (double) warmUpSamples / sampleRate;
+        result.audioSeconds = (double) totalSamples / sampleRate;
+        result.wallSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+        return result;
+    }
+
+    /*
+     Renders the input again in one piece and measures the largest difference from the chunked output, in dB relative to full scale. The
+     whole-file render goes to a temporary file and is compared a block at a time, so this doesn't need the file in memory either.
+     */
+    bool verify (RenderResult& result)
+    {
+        auto settingsForWhole = settings;
+        settingsForWhole.outputDirectory = juce::File::getSpecialLocation (juce::File::tempDirectory);
+        settingsForWhole.suffix = "_theknob_whole_" + juce::String::toHexString (juce::Random::getSystemRandom().nextInt());
+
+        FileRenderer wholeRenderer (settingsForWhole);
+        auto whole = wholeRenderer.render (result.input);
+
+        if (! whole.succeeded())
+        {
+            result.error = "verify: " + whole.error;
+            return false;
+        }
+
+        std::unique_ptr<juce::AudioFormatReader> chunkedReader (formatManager.createReaderFor (result.output));
+        std::unique_ptr<juce::AudioFormatReader> wholeReader (formatManager.createReaderFor (whole.output));
+        bool ok = chunkedReader != nullptr && wholeReader != nullptr && chunkedReader->lengthInSamples == wholeReader->lengthInSamples;
+
+        if (ok)
+        {
+            auto numChannels = (int) chunkedReader->numChannels;
+            juce::AudioBuffer<float> chunkedBlock (numChannels, compareBlockSize), wholeBlock (numChannels, compareBlockSize);
+            float maxError = 0.0f;
+
+            for (juce::int64 position = 0; position < chunkedReader->lengthInSamples && ok;)
+            {
+                auto count = (int) juce::jmin ((juce::int64) compareBlockSize, chunkedReader->lengthInSamples - position);
+                ok = chunkedReader->read (&chunkedBlock, 0, count, position, true, true)
+                  && wholeReader->read (&wholeBlock, 0, count, position, true, true);
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                {
+                    auto* a = chunkedBlock.getReadPointer (ch);
+                    auto* b = wholeBlock.getReadPointer (ch);
+
+                    for (int i = 0; i < count; ++i)
+                        maxError = juce::jmax (maxError, std::abs (a[i] - b[i]));
+                }
+
+                position += count;
+            }
+
+            result.errorDb = maxError > 0.0f ? (double) juce::Decibels::gainToDecibels (maxError, -1000.0f)
+                                             : -std::numeric_limits<double>::infinity();
+        }
+
+        wholeReader.reset();
+        whole.output.deleteFile();
+
+        if (! ok)
+            result.error = "verify: can't compare the outputs";
+
+        return ok;
+    }
+
+private:
+    // Fades from the end of the previous chunk (overlap) into the start of this one, in place
+    static void crossfade (const juce::AudioBuffer<float>& overlap, juce::AudioBuffer<float>& audio)
+    {
+        auto numSamples = overlap.getNumSamples();
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            auto* previous = overlap.getReadPointer (ch);
+            auto* next = audio.getWritePointer (ch);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto gain = ((float) i + 0.5f) / (float) numSamples;
+                next[i] = previous[i] + gain * (next[i] - previous[i]);
+            }
+        }
+    }
+
+    static RenderResult withError (RenderResult result, const juce::String& message)
+    {
+        result.error = message;
+        return result;
+    }
+
+    // the chunks are nearly identical over the overlap, so a short linear fade is enough
+    static constexpr double crossfadeSeconds = 0.05;
+    static constexpr int compareBlockSize = 16384;
+
+    RenderSettings settings;
+    WorkStealingPool& pool;
+    std::vector<std::unique_ptr<FileRenderer>>& renderers;
+    juce::AudioFormatManager formatManager;
+
+    JUCE_DECLARE_NON_COPYABLE (ChunkedRenderer)
+};
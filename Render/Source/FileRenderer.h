@@ -0,0 +1,362 @@
+//
+//  FileRenderer.h
+//  theknob_render
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "PluginProcessor.h"
+#include "StreamPipe.h"
+#include "../../TheKnobDSP/Source/Trace.h"
+#include <thread>
+
+//==============================================================================
+struct RenderSettings
+{
+    int mode = VIOLET;
+    float knob = KNOB_DEFAULT_VALUE;
+    int blockSize = 512;
+    double tailSeconds = 0.0;
+    juce::File outputDirectory;         // empty: next to the input
+    juce::String suffix { "_theknob" };
+    double chunkSeconds = 0.0;          // files longer than two chunks are split and their chunks rendered in parallel; 0 renders every file whole
+    float warmUpDecayDb = 80.0f;        // how far the chain's tail has to decay over each chunk's warm-up
+};
+
+struct RenderResult
+{
+    juce::File input, output;
+    double audioSeconds = 0.0;
+    double wallSeconds = 0.0;
+    double decodeSeconds = 0.0, processSeconds = 0.0, encodeSeconds = 0.0; // time each stage was busy
+    bool fromCache = false;
+    int numChunks = 0;                  // chunked renders only
+    double warmUpSeconds = 0.0;
+    double errorDb = -std::numeric_limits<double>::infinity(); // peak difference from a whole-file render, when verified
+    juce::String error;
+
+    bool succeeded() const { return error.isEmpty(); }
+};
+
+//==============================================================================
+// Reads an input file as stereo (mono files come back dual-mono), with silence past either end. PCM WAV files are read through a memory-mapped window that slides along the file; anything else is read with the format's normal reader.
+class InputReader
+{
+public:
+    InputReader (juce::AudioFormatManager& formatManager, const juce::File& input)
+    {
+        juce::WavAudioFormat wav;
+        mappedReader.reset (wav.createMemoryMappedReader (input));
+
+        if (mappedReader == nullptr)
+            streamReader.reset (formatManager.createReaderFor (input));
+    }
+
+    juce::AudioFormatReader* get() const noexcept
+    {
+        return mappedReader != nullptr ? static_cast<juce::AudioFormatReader*> (mappedReader.get()) : streamReader.get();
+    }
+
+    bool read (juce::AudioBuffer<float>& dest, int destStart, int numSamples, juce::int64 position)
+    {
+        auto* reader = get();
+        auto numChannels = (int) reader->numChannels;
+        auto length = reader->lengthInSamples;
+
+        dest.clear (destStart, numSamples);
+
+        // only the part that overlaps the file is read
+        auto first = juce::jlimit ((juce::int64) 0, length, position);
+        auto last = juce::jlimit ((juce::int64) 0, length, position + numSamples);
+
+        if (last <= first)
+            return true;
+
+        auto offset = destStart + (int) (first - position);
+        auto numToRead = (int) (last - first);
+
+        if (mappedReader != nullptr && ! mappedReader->getMappedSection().contains ({ first, last }))
+            mappedReader->mapSectionOfFile ({ first, juce::jmin (length, juce::jmax (last, first + mappedWindowSize)) });
+
+        if (! reader->read (&dest, offset, numToRead, first, true, numChannels > 1))
+            return false;
+
+        if (numChannels == 1)
+            dest.copyFrom (1, offset, dest, 0, offset, numToRead);
+
+        return true;
+    }
+
+private:
+    static constexpr juce::int64 mappedWindowSize = 1 << 20; // samples per mapped section of the input
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+    std::unique_ptr<juce::AudioFormatReader> streamReader;
+};
+
+//==============================================================================
+// Renders files through one TheKnobAudioProcessor. Each render worker owns one of these.
+class FileRenderer
+{
+public:
+    explicit FileRenderer (const RenderSettings& renderSettings)
+        : settings (renderSettings)
+    {
+        formatManager.registerBasicFormats();
+
+        BinaryState::Data state;
+        state.knob = settings.knob;
+        state.mode = settings.mode;
+        BinaryState::write (state, stateData);
+
+        processor.setNonRealtime (true);
+        block.setSize (2, settings.blockSize);
+    }
+
+    juce::File getOutputFile (const juce::File& input) const
+    {
+        auto directory = settings.outputDirectory == juce::File() ? input.getParentDirectory() : settings.outputDirectory;
+        return directory.getChildFile (input.getFileNameWithoutExtension() + settings.suffix + ".wav");
+    }
+
+    /*
+     Streams the file through three overlapped stages, so memory use doesn't depend on the file's length:
+
+        decode thread --(pipe)--> this thread: TheKnob chain --(pipe)--> encode thread
+
+     The input is read through an InputReader.
+     */
+    RenderResult render (const juce::File& input)
+    {
+        RenderResult result;
+        result.input = input;
+        result.output = getOutputFile (input);
+
+        theknob::TraceScope span ("Render file", "render");
+        juce::int64 startTicks = juce::Time::getHighResolutionTicks();
+
+        InputReader reader (formatManager, input);
+
+        if (reader.get() == nullptr)
+            return withError (result, "can't read file");
+
+        if (reader.get()->numChannels < 1 || reader.get()->numChannels > 2)
+            return withError (result, "only mono and stereo files are supported");
+
+        auto sampleRate = reader.get()->sampleRate;
+        auto totalSamples = getRenderLength (*reader.get());
+
+        auto writer = createWriter (*reader.get(), result.output);
+
+        if (writer == nullptr)
+            return withError (result, "can't write " + result.output.getFullPathName());
+
+        //==============================================================================
+        StreamPipe decoded (2, pipeCapacity), processed (2, pipeCapacity);
+        std::atomic<bool> readFailed { false }, writeFailed { false };
+
+        std::thread decodeThread ([&]
+        {
+            theknob::Trace::setThreadName ("Decode");
+
+            // the chain is always stereo; mono files are processed as dual-mono and the left channel is written back
+            juce::AudioBuffer<float> chunk (2, ioChunkSize);
+
+            for (juce::int64 position = 0; position < totalSamples;)
+            {
+                auto chunkTicks = juce::Time::getHighResolutionTicks();
+                auto count = (int) juce::jmin ((juce::int64) ioChunkSize, totalSamples - position);
+
+                {
+                    theknob::TraceScope readSpan ("Read", "io", "samples", count);
+
+                    if (! reader.read (chunk, 0, count, position))
+                    {
+                        readFailed = true;
+                        break;
+                    }
+                }
+
+                result.decodeSeconds += juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - chunkTicks);
+                theknob::TraceScope waitSpan ("Wait for space", "wait");
+
+                if (! decoded.write (chunk, 0, count))
+                    break;
+
+                position += count;
+            }
+
+            decoded.finishWriting();
+        });
+
+        std::thread encodeThread ([&]
+        {
+            theknob::Trace::setThreadName ("Encode");
+            juce::AudioBuffer<float> chunk (2, ioChunkSize);
+
+            while (auto count = readWaiting (processed, chunk, ioChunkSize))
+            {
+                auto chunkTicks = juce::Time::getHighResolutionTicks();
+                theknob::TraceScope writeSpan ("Write", "io", "samples", count);
+
+                if (! writer->writeFromAudioSampleBuffer (chunk, 0, count))
+                {
+                    // unblock the other stages
+                    writeFailed = true;
+                    processed.cancel();
+                    decoded.cancel();
+                    break;
+                }
+
+                result.encodeSeconds += juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - chunkTicks);
+            }
+        });
+
+        result.processSeconds = process (decoded, processed, sampleRate);
+        processed.finishWriting();
+
+        decodeThread.join();
+        encodeThread.join();
+        writer.reset();
+
+        if (readFailed)
+            return withError (result, "read error");
+
+        if (writeFailed)
+            return withError (result, "write error");
+
+        result.audioSeconds = (double) totalSamples / sampleRate;
+        result.wallSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+        return result;
+    }
+
+    //==============================================================================
+    // Samples the rendered output of a file has: the input plus the tail
+    juce::int64 getRenderLength (const juce::AudioFormatReader& reader) const
+    {
+        return reader.lengthInSamples + (juce::int64) std::ceil (settings.tailSeconds * reader.sampleRate);
+    }
+
+    // A WAV writer for the output of this input: same rate and channel count, same resolution (at least 16 bits)
+    static std::unique_ptr<juce::AudioFormatWriter> createWriter (const juce::AudioFormatReader& reader, const juce::File& output)
+    {
+        output.deleteFile();
+        std::unique_ptr<juce::FileOutputStream> stream (output.createOutputStream());
+
+        if (stream == nullptr)
+            return {};
+
+        juce::WavAudioFormat wav;
+        auto bitsPerSample = reader.usesFloatingPointData ? 32 : juce::jlimit (16, 32, (int) reader.bitsPerSample);
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream.get(), reader.sampleRate, reader.numChannels,
+                                                                              bitsPerSample, {}, 0));
+        if (writer != nullptr)
+            stream.release(); // the writer owns it now
+
+        return writer;
+    }
+
+    /*
+     Renders numSamples of the input from startSample into dest, on a fresh chain that has first been run over the warmUpSamples before it
+     (fewer at the start of the file) with the output thrown away. If the warm-up is at least the chain's tail, the result matches a render
+     of the whole file to within the decay that tail was measured to.
+     */
+    bool renderSection (const juce::File& input, juce::int64 startSample, int numSamples, juce::int64 warmUpSamples, juce::AudioBuffer<float>& dest)
+    {
+        InputReader reader (formatManager, input);
+
+        if (reader.get() == nullptr)
+            return false;
+
+        processor.setStateInformation (stateData.getData(), (int) stateData.getSize());
+        processor.prepareToPlay (reader.get()->sampleRate, settings.blockSize);
+
+        auto warmUpStart = juce::jmax ((juce::int64) 0, startSample - warmUpSamples);
+        juce::MidiBuffer midi;
+        bool ok = true;
+
+        theknob::TraceScope warmUpSpan ("Warm-up", "render", "samples", startSample - warmUpStart);
+
+        for (auto position = warmUpStart; position < startSample && ok;)
+        {
+            auto count = (int) juce::jmin ((juce::int64) settings.blockSize, startSample - position);
+            juce::AudioBuffer<float> view (block.getArrayOfWritePointers(), block.getNumChannels(), 0, count);
+            ok = reader.read (view, 0, count, position);
+            processor.processBlock (view, midi);
+            position += count;
+        }
+
+        dest.setSize (2, numSamples, false, false, true);
+
+        for (int offset = 0; offset < numSamples && ok;)
+        {
+            auto count = juce::jmin (settings.blockSize, numSamples - offset);
+            juce::AudioBuffer<float> view (dest.getArrayOfWritePointers(), 2, offset, count);
+            ok = reader.read (view, 0, count, startSample + offset);
+            processor.processBlock (view, midi);
+            offset += count;
+        }
+
+        processor.releaseResources();
+        return ok;
+    }
+
+private:
+    // returns the time spent processing
+    double process (StreamPipe& source, StreamPipe& destination, double sampleRate)
+    {
+        // a fresh prepare gives every file a fresh chain
+        processor.setStateInformation (stateData.getData(), (int) stateData.getSize());
+        processor.prepareToPlay (sampleRate, settings.blockSize);
+
+        juce::MidiBuffer midi;
+        double busySeconds = 0.0;
+        juce::int64 blockIndex = 0;
+
+        while (auto numSamples = readWaiting (source, block, settings.blockSize))
+        {
+            auto blockTicks = juce::Time::getHighResolutionTicks();
+            juce::AudioBuffer<float> view (block.getArrayOfWritePointers(), block.getNumChannels(), 0, numSamples);
+
+            {
+                theknob::TraceScope blockSpan ("Block", "block", "block", blockIndex++);
+                processor.processBlock (view, midi);
+            }
+
+            busySeconds += juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - blockTicks);
+            theknob::TraceScope waitSpan ("Wait for space", "wait");
+
+            if (! destination.write (view, 0, numSamples))
+                break;
+        }
+
+        processor.releaseResources();
+        return busySeconds;
+    }
+
+    // Reads from a pipe, as a wait on the trace
+    static int readWaiting (StreamPipe& pipe, juce::AudioBuffer<float>& dest, int numSamples)
+    {
+        theknob::TraceScope span ("Wait for audio", "wait");
+        return pipe.read (dest, 0, numSamples);
+    }
+
+    static RenderResult withError (RenderResult result, const juce::String& message)
+    {
+        result.error = message;
+        return result;
+    }
+
+    static constexpr int ioChunkSize = 16384;
+    static constexpr int pipeCapacity = ioChunkSize * 4;
+
+    RenderSettings settings;
+    juce::MemoryBlock stateData;
+    juce::AudioBuffer<float> block;
+    juce::AudioFormatManager formatManager;
+    TheKnobAudioProcessor processor;
+
+    JUCE_DECLARE_NON_COPYABLE (FileRenderer)
+};
@@ -0,0 +1,282 @@
+//
+//  Main.cpp
+//  theknob_render
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "ChunkedRenderer.h"
+#include "RenderCache.h"
+#include "WorkStealingPool.h"
+
+//==============================================================================
+static void printUsage()
+{
+    std::cout << "usage: theknob_render --mode violet|teal|crimson --knob 0-100 [options] file..." << std::endl
+              << std::endl
+              << "    --list FILE         also render every file listed in FILE (one path per line)" << std::endl
+              << "    --out-dir DIR       write the results to DIR (default: next to each input)" << std::endl
+              << "    --suffix TEXT       appended to output file names (default: _theknob)" << std::endl
+              << "    --threads N         number of render threads (default: one per core)" << std::endl
+              << "    --block N           processing block size (default: 512)" << std::endl
+              << "    --tail SECONDS      render this much extra audio after the end of each file (default: 0)" << std::endl
+              << "    --chunk SECONDS     split files longer than two chunks and render their chunks in parallel (default: off)" << std::endl
+              << "    --warm-up-db DB     how far the chain's tail must decay over each chunk's warm-up (default: 80)" << std::endl
+              << "    --verify            also render chunked files whole and print the largest difference (counts towards the timings)" << std::endl
+              << "    --cache DIR         reuse renders of the same input and settings from DIR, and keep new ones there" << std::endl
+              << "    --cache-size MB     delete the least recently used renders once the cache is bigger than this (default: 10240)" << std::endl
+              << "    --verbose           print how long each pipeline stage (decode/process/encode) was busy per file" << std::endl
+              << "    --trace FILE        write a Chrome trace (chrome://tracing, ui.perfetto.dev) of every block, stage, read, write and wait" << std::endl;
+}
+
+static int parseMode (const juce::String& name)
+{
+    if (name.equalsIgnoreCase ("violet"))   return VIOLET;
+    if (name.equalsIgnoreCase ("teal"))     return TEAL;
+    if (name.equalsIgnoreCase ("crimson"))  return CRIMSON;
+    return -1;
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RenderSettings settings;
+    juce::Array<juce::File> inputs;
+    int numThreads = juce::SystemStats::getNumCpus();
+    juce::File cacheDirectory, traceFile;
+    juce::int64 cacheSizeMB = 10240;
+    bool gotMode = false, gotKnob = false, verbose = false, verify = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        juce::String arg (argv[i]);
+        auto hasValue = i + 1 < argc;
+        auto value = hasValue ? juce::String (argv[i + 1]) : juce::String();
+        auto cwd = juce::File::getCurrentWorkingDirectory();
+
+        if (arg == "--help")                    { printUsage(); return 0; }
+        else if (arg == "--verbose")            { verbose = true; }
+        else if (arg == "--verify")             { verify = true; }
+        else if (arg == "--mode" && hasValue)   { settings.mode = parseMode (value); gotMode = settings.mode >= 0; ++i; }
+        else if (arg == "--knob" && hasValue)   { settings.knob = juce::jlimit (KNOB_MIN_VALUE, KNOB_MAX_VALUE, value.getFloatValue()); gotKnob = true; ++i; }
+        else if (arg == "--out-dir" && hasValue){ settings.outputDirectory = cwd.getChildFile (value); ++i; }
+        else if (arg == "--suffix" && hasValue) { settings.suffix = value; ++i; }
+        else if (arg == "--cache" && hasValue)  { cacheDirectory = cwd.getChildFile (value); ++i; }
+        else if (arg == "--trace" && hasValue)  { traceFile = cwd.getChildFile (value); ++i; }
+        else if (arg == "--cache-size" && hasValue) { cacheSizeMB = juce::jmax ((juce::int64) 1, value.getLargeIntValue()); ++i; }
+        else if (arg == "--threads" && hasValue){ numThreads = juce::jmax (1, value.getIntValue()); ++i; }
+        else if (arg == "--block" && hasValue)  { settings.blockSize = juce::jlimit (16, 8192, value.getIntValue()); ++i; }
+        else if (arg == "--tail" && hasValue)   { settings.tailSeconds = juce::jmax (0.0, value.getDoubleValue()); ++i; }
+        else if (arg == "--chunk" && hasValue)  { settings.chunkSeconds = juce::jmax (0.0, value.getDoubleValue()); ++i; }
+        else if (arg == "--warm-up-db" && hasValue) { settings.warmUpDecayDb = juce::jlimit (20.0f, 200.0f, value.getFloatValue()); ++i; }
+        else if (arg == "--list" && hasValue)
+        {
+            juce::StringArray lines;
+            lines.addLines (cwd.getChildFile (value).loadFileAsString());
+            lines.trim();
+            lines.removeEmptyStrings();
+
+            for (auto& line : lines)
+                inputs.add (cwd.getChildFile (line));
+
+            ++i;
+        }
+        else if (arg.startsWith ("--"))
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+        else
+        {
+            inputs.add (cwd.getChildFile (arg));
+        }
+    }
+
+    if (! gotMode || ! gotKnob || inputs.isEmpty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (settings.outputDirectory != juce::File())
+        settings.outputDirectory.createDirectory();
+
+    // started before anything runs, so the processors' own threads are on it from the start
+    theknob::Trace trace;
+
+    if (traceFile != juce::File())
+    {
+        if (! trace.start (traceFile.getFullPathName().toStdString()))
+        {
+            std::cerr << "can't write " << traceFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        theknob::Trace::setThreadName ("Main");
+    }
+
+    // a chunked file can keep every thread busy on its own
+    if (settings.chunkSeconds <= 0.0)
+        numThreads = juce::jmin (numThreads, inputs.size());
+
+    //==============================================================================
+    // one renderer (and so one processor) per worker, created up front on the message thread
+    std::vector<std::unique_ptr<FileRenderer>> renderers;
+
+    for (int i = 0; i < numThreads; ++i)
+        renderers.push_back (std::make_unique<FileRenderer> (settings));
+
+    std::vector<RenderResult> results ((size_t) inputs.size());
+    juce::CriticalSection outputLock;
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    std::unique_ptr<RenderCache> cache;
+
+    if (cacheDirectory != juce::File())
+        cache = std::make_unique<RenderCache> (cacheDirectory, cacheSizeMB * 1024 * 1024);
+
+    // a cache hit replaces the render; a miss renders and then keeps a copy
+    auto renderWithCache = [&] (const juce::File& input, const std::function<RenderResult()>& render)
+    {
+        if (cache == nullptr)
+            return render();
+
+        auto key = cache->getKey (input, settings);
+
+        if (key.isNotEmpty())
+        {
+            RenderResult result;
+            result.input = input;
+            result.output = renderers.front()->getOutputFile (input);
+            auto fetchStartTicks = juce::Time::getHighResolutionTicks();
+
+            theknob::TraceScope span ("Cache fetch", "io");
+
+            if (cache->fetch (key, result))
+            {
+                result.wallSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - fetchStartTicks);
+                return result;
+            }
+        }
+
+        auto result = render();
+
+        if (result.succeeded() && key.isNotEmpty())
+        {
+            theknob::TraceScope span ("Cache store", "io");
+            cache->store (key, result.output);
+        }
+
+        return result;
+    };
+
+    auto report = [&] (const RenderResult& result)
+    {
+        const juce::ScopedLock sl (outputLock);
+
+        if (result.succeeded() && result.fromCache)
+        {
+            std::cout << result.output.getFullPathName() << "  (cached)" << std::endl;
+        }
+        else if (result.succeeded())
+        {
+            std::cout << result.output.getFullPathName() << "  (" << juce::String (result.audioSeconds / result.wallSeconds, 1) << "x realtime)" << std::endl;
+
+            if (result.numChunks > 0)
+            {
+                std::cout << "    " << result.numChunks << " chunks, " << juce::String (result.warmUpSeconds, 2) << " s warm-up each";
+
+                if (verify)
+                    std::cout << ", largest difference from a whole-file render " << juce::String (result.errorDb, 1) << " dBFS";
+
+                std::cout << std::endl;
+            }
+            // the slowest stage is the one that limits the throughput
+            else if (verbose)
+            {
+                std::cout << "    decode " << juce::String (result.decodeSeconds, 3) << " s, process " << juce::String (result.processSeconds, 3)
+                          << " s, encode " << juce::String (result.encodeSeconds, 3) << " s, wall " << juce::String (result.wallSeconds, 3) << " s" << std::endl;
+            }
+        }
+        else
+            std::cerr << result.input.getFullPathName() << ": " << result.error << std::endl;
+    };
+
+    {
+        WorkStealingPool pool (numThreads);
+        ChunkedRenderer chunkedRenderer (settings, pool, renderers);
+        juce::Array<int> chunkedInputs;
+
+        for (int i = 0; i < inputs.size(); ++i)
+        {
+            if (chunkedRenderer.shouldChunk (inputs[i]))
+            {
+                chunkedInputs.add (i);
+                continue;
+            }
+
+            pool.submit ([&, i] (int workerIndex)
+            {
+                auto result = renderWithCache (inputs[i], [&] { return renderers[(size_t) workerIndex]->render (inputs[i]); });
+                report (result);
+                results[(size_t) i] = std::move (result);
+            });
+        }
+
+        // long files are split up from this thread, their chunks share the pool with the whole files above
+        for (auto i : chunkedInputs)
+        {
+            auto result = renderWithCache (inputs[i], [&] { return chunkedRenderer.render (inputs[i]); });
+
+            if (verify && result.succeeded() && ! result.fromCache)
+                chunkedRenderer.verify (result);
+
+            report (result);
+            results[(size_t) i] = std::move (result);
+        }
+
+        pool.waitForAll();
+    }
+
+    auto wallSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+
+    //==============================================================================
+    int numFailed = 0, numCached = 0;
+    double audioSeconds = 0.0;
+
+    // cache hits weren't rendered, so they don't count towards the throughput
+    for (auto& result : results)
+    {
+        if (! result.succeeded())
+            ++numFailed;
+        else if (result.fromCache)
+            ++numCached;
+        else
+            audioSeconds += result.audioSeconds;
+    }
+
+    auto throughput = audioSeconds / juce::jmax (1.0e-9, wallSeconds);
+
+    // every renderer is idle by now, so nothing is still recording
+    if (trace.isRecording())
+    {
+        auto dropped = trace.stop();
+        std::cout << "trace written to " << traceFile.getFullPathName()
+                  << (dropped > 0 ? " (" + juce::String (dropped) + " events didn't fit in the buffers and were left out)" : juce::String()) << std::endl;
+    }
+
+    std::cout << std::endl
+              << inputs.size() - numFailed << " of " << inputs.size() << " files rendered on " << numThreads << " threads"
+              << (cache != nullptr ? ", " + juce::String (numCached) + " of them from the cache" : juce::String()) << std::endl
+              << juce::String (audioSeconds, 2) << " s of audio in " << juce::String (wallSeconds, 2) << " s: "
+              << juce::String (throughput, 1) << " audio-seconds per wall-second ("
+              << juce::String (throughput / numThreads, 1) << " per thread)" << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}
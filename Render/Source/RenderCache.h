@@ -0,0 +1,215 @@
+//
+//  RenderCache.h
+//  theknob_render
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "FileRenderer.h"
+
+/*
+ An on-disk cache of rendered files, shared by every theknob_render process that points at the same directory.
+
+ Entries are named after a SHA-256 of the input file's contents and everything that changes what a render sounds like (DSP_VERSION, mode,
+ knob, sample rate, tail, block size, chunking), so a hit is always a render of the same audio with the same settings. Hits are copied out
+ through a memory map. New entries are written to a temporary file and renamed into place, so no process ever sees half an entry; the
+ least recently used entries are deleted once the directory grows past its size limit.
+
+ The directory is guarded by an InterProcessLock (for other processes) and a CriticalSection (for this process's threads, as an
+ InterProcessLock lets every thread of the process that holds it back in). Only renames, deletes and opening maps happen under it.
+ */
+class RenderCache
+{
+public:
+    RenderCache (const juce::File& cacheDirectory, juce::int64 maxSizeInBytes)
+        : directory (cacheDirectory),
+          maxSize (maxSizeInBytes),
+          processLock ("theknob_render_cache_" + juce::String::toHexString (cacheDirectory.getFullPathName().hashCode64()))
+    {
+        directory.createDirectory();
+        formatManager.registerBasicFormats();
+    }
+
+    //==============================================================================
+    // The cache key for rendering this input with these settings, or an empty string if the input can't be read
+    juce::String getKey (const juce::File& input, const RenderSettings& settings)
+    {
+        juce::FileInputStream stream (input);
+
+        if (! stream.openedOk())
+            return {};
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (input));
+
+        if (reader == nullptr)
+            return {};
+
+        auto contentHash = juce::SHA256 (stream).toHexString();
+
+        // the float's bits, so knob values that print the same still get their own entries
+        juce::uint32 knobBits;
+        std::memcpy (&knobBits, &settings.knob, sizeof (knobBits));
+
+        juce::String description;
+        description << contentHash
+                    << ";dsp=" << DSP_VERSION
+                    << ";mode=" << settings.mode
+                    << ";knob=" << juce::String::toHexString ((int) knobBits)
+                    << ";rate=" << reader->sampleRate
+                    << ";tail=" << settings.tailSeconds
+                    << ";block=" << settings.blockSize
+                    << ";chunk=" << settings.chunkSeconds
+                    << ";warmup=" << settings.warmUpDecayDb;
+
+        return juce::SHA256 (description.toUTF8()).toHexString();
+    }
+
+    //==============================================================================
+    // On a hit, copies the cached render to result.output, fills in its length and marks the entry as recently used
+    bool fetch (const juce::String& key, RenderResult& result)
+    {
+        auto& output = result.output;
+        std::unique_ptr<juce::MemoryMappedFile> mapped;
+
+        {
+            const ScopedCacheLock lock (*this);
+            auto entry = getEntryFile (key);
+
+            if (! entry.existsAsFile())
+                return false;
+
+            // once it's mapped, the entry's contents stay readable even if another process evicts it
+            mapped = std::make_unique<juce::MemoryMappedFile> (entry, juce::MemoryMappedFile::readOnly);
+
+            if (mapped->getData() == nullptr)
+                return false;
+
+            entry.setLastModificationTime (juce::Time::getCurrentTime());
+        }
+
+        auto temp = output.getSiblingFile (output.getFileName() + ".partial");
+        bool ok;
+
+        {
+            juce::FileOutputStream stream (temp);
+            ok = stream.openedOk() && stream.setPosition (0) && stream.truncate().wasOk()
+                  && stream.write (mapped->getData(), mapped->getSize());
+        }
+
+        ok = ok && temp.moveFileTo (output);
+
+        if (! ok)
+        {
+            temp.deleteFile();
+            return false;
+        }
+
+        if (std::unique_ptr<juce::AudioFormatReader> reader { formatManager.createReaderFor (output) })
+            result.audioSeconds = (double) reader->lengthInSamples / reader->sampleRate;
+
+        result.fromCache = true;
+        return true;
+    }
+
+    // Adds a finished render to the cache, then evicts old entries if it's now over its limit
+    void store (const juce::String& key, const juce::File& renderedFile)
+    {
+        auto temp = directory.getChildFile (key + "." + juce::String::toHexString (juce::Random::getSystemRandom().nextInt64()) + ".partial");
+
+        if (! renderedFile.copyFileTo (temp))
+        {
+            temp.deleteFile();
+            return;
+        }
+
+        const ScopedCacheLock lock (*this);
+        auto entry = getEntryFile (key);
+
+        // another process may have rendered the same thing meanwhile, and its entry is just as good
+        if (entry.existsAsFile() || ! temp.moveFileTo (entry))
+            temp.deleteFile();
+
+        evict();
+    }
+
+private:
+    //==============================================================================
+    struct ScopedCacheLock
+    {
+        explicit ScopedCacheLock (RenderCache& c) : cache (c)
+        {
+            cache.threadLock.enter();
+            locked = cache.processLock.enter();
+        }
+
+        ~ScopedCacheLock()
+        {
+            if (locked)
+                cache.processLock.exit();
+
+            cache.threadLock.exit();
+        }
+
+        RenderCache& cache;
+        bool locked = false;
+    };
+
+    juce::File getEntryFile (const juce::String& key) const
+    {
+        return directory.getChildFile (key + ".wav");
+    }
+
+    // Call with the lock held. Deletes the least recently used entries until the cache fits, and any temporary files left by processes that died.
+    void evict()
+    {
+        juce::Array<juce::File> entries;
+        juce::int64 totalSize = 0;
+        auto staleTime = juce::Time::getCurrentTime() - juce::RelativeTime::days (1);
+
+        for (const auto& item : juce::RangedDirectoryIterator (directory, false, "*", juce::File::findFiles))
+        {
+            auto file = item.getFile();
+
+            if (file.hasFileExtension ("wav"))
+            {
+                entries.add (file);
+                totalSize += item.getFileSize();
+            }
+            else if (file.hasFileExtension ("partial") && item.getModificationTime() < staleTime)
+            {
+                file.deleteFile();
+            }
+        }
+
+        if (totalSize <= maxSize)
+            return;
+
+        std::sort (entries.begin(), entries.end(), [] (const juce::File& a, const juce::File& b)
+        {
+            return a.getLastModificationTime() < b.getLastModificationTime();
+        });
+
+        for (auto& entry : entries)
+        {
+            if (totalSize <= maxSize)
+                break;
+
+            auto size = entry.getSize();
+
+            // on Windows an entry another process has mapped can't be deleted yet, so it's left for next time
+            if (entry.deleteFile())
+                totalSize -= size;
+        }
+    }
+
+    //==============================================================================
+    juce::File directory;
+    juce::int64 maxSize;
+    juce::InterProcessLock processLock;
+    juce::CriticalSection threadLock;
+    juce::AudioFormatManager formatManager;
+
+    JUCE_DECLARE_NON_COPYABLE (RenderCache)
+};
@@ -0,0 +1,93 @@
+//
+//  StreamPipe.h
+//  theknob_render
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "AudioFifo.h"
+
+//==============================================================================
+// A bounded, blocking audio pipe between two stages of the offline renderer: a writer that stalls when the pipe is full and a reader that stalls when it's empty. Its memory use is fixed when it's created, however much audio goes through it.
+class StreamPipe
+{
+public:
+    StreamPipe (int numChannels, int capacityInSamples)
+    {
+        fifo.setSize (numChannels, capacityInSamples);
+    }
+
+    // Returns false if the pipe was cancelled
+    bool write (const juce::AudioBuffer<float>& source, int startSample, int numSamples)
+    {
+        while (numSamples > 0)
+        {
+            if (cancelled)
+                return false;
+
+            auto count = juce::jmin (numSamples, fifo.getFreeSpace());
+
+            if (count == 0)
+            {
+                spaceAvailable.wait (10);
+                continue;
+            }
+
+            fifo.push (source, startSample, count);
+            dataAvailable.signal();
+            startSample += count;
+            numSamples -= count;
+        }
+
+        return true;
+    }
+
+    void finishWriting()
+    {
+        finished = true;
+        dataAvailable.signal();
+    }
+
+    // Reads up to numSamples, only returning fewer once the writer has finished (or the pipe was cancelled)
+    int read (juce::AudioBuffer<float>& dest, int startSample, int numSamples)
+    {
+        int numRead = 0;
+
+        while (numRead < numSamples && ! cancelled)
+        {
+            auto count = juce::jmin (numSamples - numRead, fifo.getNumReady());
+
+            if (count == 0)
+            {
+                // check the flag before looking at the FIFO again, so nothing written just before finishing is missed
+                if (finished && fifo.getNumReady() == 0)
+                    break;
+
+                dataAvailable.wait (10);
+                continue;
+            }
+
+            fifo.pop (dest, startSample + numRead, count);
+            spaceAvailable.signal();
+            numRead += count;
+        }
+
+        return numRead;
+    }
+
+    void cancel()
+    {
+        cancelled = true;
+        dataAvailable.signal();
+        spaceAvailable.signal();
+    }
+
+    bool wasCancelled() const noexcept { return cancelled; }
+
+private:
+    AudioFifo fifo;
+    juce::WaitableEvent dataAvailable, spaceAvailable;
+    std::atomic<bool> finished { false }, cancelled { false };
+};
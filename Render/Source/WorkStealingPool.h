@@ -0,0 +1,191 @@
+//
+//  WorkStealingPool.h
+//  theknob_render
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include "../../TheKnobDSP/Source/Trace.h"
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+
+/*
+ A fixed set of worker threads, each with its own task deque. A worker takes its newest task from the back of its own deque, and when that's empty it steals the oldest task from the front of somebody else's. Tasks can submit more tasks (they go to the submitting worker's own deque), so big jobs can be split up and the pieces get picked up by whichever cores are idle.
+
+ Tasks are handed the index of the worker running them, so callers can keep per-worker resources (a processor, scratch buffers) without any locking.
+ */
+
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void (int workerIndex)>;
+
+    explicit WorkStealingPool (int numWorkers)
+        : queues ((size_t) juce::jmax (1, numWorkers))
+    {
+        for (int i = 0; i < getNumWorkers(); ++i)
+            workerNames.push_back ("Render worker " + std::to_string (i + 1));
+
+        for (int i = 0; i < getNumWorkers(); ++i)
+            threads.emplace_back ([this, i] { runWorker (i); });
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock (wakeMutex);
+            shouldExit = true;
+        }
+
+        wakeUp.notify_all();
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    int getNumWorkers() const noexcept { return (int) queues.size(); }
+
+    //==============================================================================
+    // From a worker, the task goes onto that worker's own deque; from any other thread they're dealt out round-robin.
+    void submit (Task task)
+    {
+        ++numPending;
+
+        auto index = currentWorkerIndex >= 0 && currentPool == this
+                        ? (size_t) currentWorkerIndex
+                        : (size_t) (nextQueue++ % (unsigned int) queues.size());
+
+        {
+            std::lock_guard<std::mutex> lock (queues[index].mutex);
+            queues[index].tasks.push_back (std::move (task));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock (wakeMutex);
+        }
+
+        wakeUp.notify_one();
+    }
+
+    // Blocks until every submitted task (including the ones they submitted) has finished
+    void waitForAll()
+    {
+        std::unique_lock<std::mutex> lock (wakeMutex);
+        allDone.wait (lock, [this] { return numPending.load() == 0; });
+    }
+
+    int getNumSteals() const noexcept { return numSteals.load(); }
+
+private:
+    //==============================================================================
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool popLocal (int index, Task& task)
+    {
+        auto& queue = queues[(size_t) index];
+        std::lock_guard<std::mutex> lock (queue.mutex);
+
+        if (queue.tasks.empty())
+            return false;
+
+        task = std::move (queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal (int thief, Task& task, std::minstd_rand& random)
+    {
+        auto numQueues = (int) queues.size();
+        auto first = (int) (random() % (unsigned int) numQueues);
+
+        for (int i = 0; i < numQueues; ++i)
+        {
+            auto victim = (first + i) % numQueues;
+
+            if (victim == thief)
+                continue;
+
+            auto& queue = queues[(size_t) victim];
+            std::lock_guard<std::mutex> lock (queue.mutex);
+
+            if (! queue.tasks.empty())
+            {
+                task = std::move (queue.tasks.front());
+                queue.tasks.pop_front();
+                ++numSteals;
+
+                if (auto* trace = theknob::Trace::getActive())
+                    trace->instant ("Steal", "scheduling", "from worker", victim + 1);
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void runWorker (int index)
+    {
+        currentWorkerIndex = index;
+        currentPool = this;
+        theknob::Trace::setThreadName (workerNames[(size_t) index].c_str());
+        std::minstd_rand random ((unsigned int) index + 1);
+
+        for (;;)
+        {
+            Task task;
+
+            if (popLocal (index, task) || steal (index, task, random))
+            {
+                {
+                    theknob::TraceScope span ("Task", "scheduling");
+                    task (index);
+                }
+
+                if (--numPending == 0)
+                {
+                    std::lock_guard<std::mutex> lock (wakeMutex);
+                    allDone.notify_all();
+                }
+
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock (wakeMutex);
+
+            if (shouldExit)
+                return;
+
+            // tasks can be pushed between our last look and taking the lock, so don't sleep for long
+            wakeUp.wait_for (lock, std::chrono::milliseconds (2));
+        }
+    }
+
+    //==============================================================================
+    std::vector<Queue> queues;
+    std::vector<std::string> workerNames;
+    std::vector<std::thread> threads;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeUp, allDone;
+    bool shouldExit = false;
+
+    std::atomic<int> numPending { 0 };
+    std::atomic<int> numSteals { 0 };
+    std::atomic<unsigned int> nextQueue { 0 };
+
+    static inline thread_local int currentWorkerIndex = -1;
+    static inline thread_local WorkStealingPool* currentPool = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE (WorkStealingPool)
+};
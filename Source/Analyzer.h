@@ -0,0 +1,248 @@
+//
+//  Analyzer.h
+//  TheKnob
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include "../TheKnobDSP/Source/Engine.h"
+#include "AudioFifo.h"
+#include "TripleBuffer.h"
+
+/*
+ =================================Analyzer=================================
+
+ The output spectrum, and the combined magnitude response of the filter, EQ and special EQ, for the editor to draw.
+
+ -The audio thread only pushes the output into a FIFO, and only while the analyzer is running.
+ -Everything else happens on a background thread, about 30 times a second: a windowed FFT of the latest output, and the response,
+  which is only worked out again when the version of the knob and mode the engine is running with changes. The response comes from the
+  same stage classes (and coefficient designs) as the engine.
+ -Frames go to the editor through a TripleBuffer.
+ -The editor starts it when it opens and stops it when it closes, and in between nothing runs: the thread is stopped and nothing is pushed.
+
+ */
+
+class Analyzer  : private juce::Thread
+{
+public:
+    static constexpr int numPoints = 128;
+    static constexpr float minFrequency = 20.0f;
+    static constexpr float maxFrequency = 20000.0f;
+
+    struct Frame
+    {
+        std::array<float, numPoints> spectrumDb {};
+        std::array<float, numPoints> responseDb {};
+    };
+
+    explicit Analyzer (const theknob::SharedParameters* sharedParameters)
+        : juce::Thread ("TheKnob Analyzer"),
+          parameters (sharedParameters),
+          fft (fftOrder),
+          window ((size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false)
+    {
+        fifo.setSize (2, fftSize * 4);
+        scratch.setSize (2, fftSize);
+        history.assign ((size_t) fftSize, 0.0f);
+        fftData.assign ((size_t) fftSize * 2, 0.0f);
+
+        for (int i = 0; i < numPoints; ++i)
+            frequencies[(size_t) i] = getFrequencyForPoint (i);
+    }
+
+    ~Analyzer() override
+    {
+        stop();
+    }
+
+    // The frequency each point of a frame is at: log spaced from 20 Hz to 20 kHz
+    static float getFrequencyForPoint (int point)
+    {
+        return minFrequency * std::pow (maxFrequency / minFrequency, (float) point / (float) (numPoints - 1));
+    }
+
+    //==============================================================================
+    void prepare (double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+    }
+
+    // audio thread: drops whatever doesn't fit, it's only for looking at
+    void push (const juce::AudioBuffer<float>& buffer) noexcept
+    {
+        if (! running.load (std::memory_order_relaxed))
+            return;
+
+        auto numSamples = juce::jmin (buffer.getNumSamples(), fifo.getFreeSpace());
+
+        if (numSamples > 0)
+            fifo.push (buffer, 0, numSamples);
+    }
+
+    //==============================================================================
+    // message thread: called by the editor when it opens and closes
+    void start()
+    {
+        if (isThreadRunning())
+            return;
+
+        startThread (juce::Thread::Priority::low);
+        running = true;
+    }
+
+    void stop()
+    {
+        running = false;
+        stopThread (1000);
+    }
+
+    // message thread: returns false if there's no new frame since the last call
+    bool getFrame (Frame& frame) noexcept
+    {
+        return mailbox.read (frame);
+    }
+
+private:
+    //==============================================================================
+    void run() override
+    {
+        // whatever is left from the last time the editor was open is stale
+        fifo.discard (fifo.getNumReady());
+        std::fill (history.begin(), history.end(), 0.0f);
+        frame.spectrumDb.fill (floorDb);
+
+        // and the first frame always has the response in it, even if the knob hasn't moved and the output is silent
+        responseVersion = theknob::ParameterSnapshot::noVersion;
+
+        while (! threadShouldExit())
+        {
+            readOutput();
+
+            // a silent output with a still knob doesn't need drawing again
+            auto spectrumChanged = updateSpectrum();
+            auto responseChanged = updateResponse();
+
+            if (spectrumChanged || responseChanged)
+                mailbox.write (frame);
+
+            wait (1000 / framesPerSecond);
+        }
+    }
+
+    void readOutput()
+    {
+        while (fifo.getNumReady() > 0)
+        {
+            auto numSamples = juce::jmin (fifo.getNumReady(), scratch.getNumSamples());
+            fifo.pop (scratch, 0, numSamples);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                history[(size_t) historyIndex] = 0.5f * (scratch.getSample (0, i) + scratch.getSample (1, i));
+                historyIndex = (historyIndex + 1) % fftSize;
+            }
+        }
+    }
+
+    bool updateSpectrum()
+    {
+        // oldest sample first
+        std::rotate_copy (history.begin(), history.begin() + historyIndex, history.end(), fftData.begin());
+        window.multiplyWithWindowingTable (fftData.data(), (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform (fftData.data(), true);
+
+        // a full scale sine reads 0 dB: half the FFT's gain, and half again for the Hann window
+        const float scale = 4.0f / (float) fftSize;
+        const float fallPerFrame = 60.0f / (float) framesPerSecond;
+        auto rate = (float) sampleRate.load();
+        auto changed = false;
+
+        for (size_t i = 0; i < (size_t) numPoints; ++i)
+        {
+            auto bin = juce::jlimit (0.0f, (float) (fftSize / 2 - 1), frequencies[i] / rate * (float) fftSize);
+            auto index = (int) bin;
+            auto magnitude = juce::jmap (bin - (float) index, fftData[(size_t) index], fftData[(size_t) index + 1]) * scale;
+            auto db = juce::Decibels::gainToDecibels (magnitude, floorDb);
+
+            // jumps up, falls back at 60 dB a second
+            auto newDb = juce::jmax (db, frame.spectrumDb[i] - fallPerFrame);
+            changed = changed || newDb != frame.spectrumDb[i];
+            frame.spectrumDb[i] = newDb;
+        }
+
+        return changed;
+    }
+
+    bool updateResponse()
+    {
+        auto snapshot = parameters->load();
+        auto knob = snapshot.knob;
+        auto currentMode = snapshot.mode;
+        auto currentRate = sampleRate.load();
+
+        auto rateChanged = currentRate != responseRate;
+
+        if (! rateChanged && snapshot.version == responseVersion)
+            return false;
+
+        if (rateChanged)
+        {
+            filter.prepare (currentRate);
+            eq.prepare (currentRate);
+            specialEq.prepare (currentRate);
+        }
+
+        filter.setParameters (knob, currentMode);
+        eq.setParameters (knob, currentMode);
+        specialEq.setParameters (knob, currentMode);
+
+        // the chain is bypassed at 0
+        auto bypassed = (int) knob == 0;
+
+        for (size_t i = 0; i < (size_t) numPoints; ++i)
+        {
+            auto f = (double) frequencies[i];
+            auto magnitude = filter.getMagnitudeForFrequency (f) * eq.getMagnitudeForFrequency (f) * specialEq.getMagnitudeForFrequency (f);
+            frame.responseDb[i] = bypassed ? 0.0f : (float) juce::Decibels::gainToDecibels (magnitude, -120.0);
+        }
+
+        responseRate = currentRate;
+        responseVersion = snapshot.version;
+        return true;
+    }
+
+    //==============================================================================
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int framesPerSecond = 30;
+    static constexpr float floorDb = -100.0f;
+
+    const theknob::SharedParameters* parameters;
+    std::atomic<double> sampleRate { 44100.0 };
+    std::atomic<bool> running { false };
+
+    AudioFifo fifo;
+    TripleBuffer<Frame> mailbox;
+
+    // everything from here on belongs to the analyzer thread
+    juce::dsp::FFT fft;
+    juce::dsp::WindowingFunction<float> window;
+    juce::AudioSampleBuffer scratch;
+    std::vector<float> history, fftData;
+    int historyIndex = 0;
+
+    std::array<float, numPoints> frequencies {};
+    theknob::FilterStage filter;
+    theknob::EQStage eq;
+    theknob::SpecialEQStage specialEq;
+    double responseRate = 0.0;
+    juce::uint32 responseVersion = theknob::ParameterSnapshot::noVersion;
+
+    Frame frame;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Analyzer)
+};
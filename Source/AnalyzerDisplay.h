@@ -0,0 +1,112 @@
+//
+//  AnalyzerDisplay.h
+//  TheKnob
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include "Analyzer.h"
+
+/*
+ The output spectrum (filled, -90 dB to 0 dB) with the EQ curve over it (in the mode's colour, -18 dB to +18 dB), on a log frequency axis.
+
+ It runs the analyzer for as long as it exists, polls it 30 times a second and only repaints when there's a new frame.
+ */
+
+class AnalyzerDisplay  : public juce::Component,
+                         private juce::Timer
+{
+public:
+    explicit AnalyzerDisplay (Analyzer& analyzerToShow)
+        : analyzer (analyzerToShow)
+    {
+        setOpaque (true);
+        frame.spectrumDb.fill (spectrumMinDb);
+        analyzer.start();
+        startTimerHz (30);
+    }
+
+    ~AnalyzerDisplay() override
+    {
+        stopTimer();
+        analyzer.stop();
+    }
+
+    void setCurveColour (juce::Colour newColour)
+    {
+        curveColour = newColour;
+        repaint();
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+
+        auto area = getLocalBounds().reduced (2).toFloat();
+
+        auto getX = [&] (float frequency)
+        {
+            return area.getX() + area.getWidth() * std::log (frequency / Analyzer::minFrequency) / std::log (Analyzer::maxFrequency / Analyzer::minFrequency);
+        };
+
+        auto getPath = [&] (const std::array<float, Analyzer::numPoints>& db, float minDb, float maxDb)
+        {
+            juce::Path path;
+
+            for (int i = 0; i < Analyzer::numPoints; ++i)
+            {
+                auto x = getX (Analyzer::getFrequencyForPoint (i));
+                auto y = juce::jmap (juce::jlimit (minDb, maxDb, db[(size_t) i]), minDb, maxDb, area.getBottom(), area.getY());
+
+                if (i == 0)
+                    path.startNewSubPath (x, y);
+                else
+                    path.lineTo (x, y);
+            }
+
+            return path;
+        };
+
+        // 100 Hz, 1 kHz and 10 kHz, and 0 dB for the curve
+        g.setColour (juce::Colours::grey.withAlpha (0.2f));
+
+        for (auto frequency : { 100.0f, 1000.0f, 10000.0f })
+            g.drawVerticalLine (juce::roundToInt (getX (frequency)), area.getY(), area.getBottom());
+
+        g.drawHorizontalLine (juce::roundToInt (area.getCentreY()), area.getX(), area.getRight());
+
+        auto spectrum = getPath (frame.spectrumDb, spectrumMinDb, spectrumMaxDb);
+        auto filled = spectrum;
+        filled.lineTo (area.getBottomRight());
+        filled.lineTo (area.getBottomLeft());
+        filled.closeSubPath();
+
+        g.setColour (juce::Colours::grey.withAlpha (0.3f));
+        g.fillPath (filled);
+        g.setColour (juce::Colours::grey.withAlpha (0.6f));
+        g.strokePath (spectrum, juce::PathStrokeType (1.0f));
+
+        g.setColour (curveColour);
+        g.strokePath (getPath (frame.responseDb, -curveRangeDb, curveRangeDb), juce::PathStrokeType (2.0f));
+    }
+
+private:
+    void timerCallback() override
+    {
+        if (analyzer.getFrame (frame))
+            repaint();
+    }
+
+    static constexpr float spectrumMinDb = -90.0f;
+    static constexpr float spectrumMaxDb = 0.0f;
+    static constexpr float curveRangeDb = 18.0f;
+
+    Analyzer& analyzer;
+    Analyzer::Frame frame;
+    juce::Colour curveColour { juce::Colours::violet };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalyzerDisplay)
+};
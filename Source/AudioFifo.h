@@ -0,0 +1,102 @@
+//
+//  AudioFifo.h
+//  TheKnob
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// A lock-free single-producer, single-consumer FIFO of multichannel audio. Nothing allocates after setSize().
+class AudioFifo
+{
+public:
+    void setSize (int numChannels, int capacityInSamples)
+    {
+        // an AbstractFifo of size N holds N - 1 items
+        buffer.setSize (numChannels, capacityInSamples + 1);
+        fifo.setTotalSize (capacityInSamples + 1);
+        fifo.reset();
+    }
+
+    void reset() noexcept
+    {
+        fifo.reset();
+    }
+
+    int getNumReady() const noexcept      { return fifo.getNumReady(); }
+    int getFreeSpace() const noexcept     { return fifo.getFreeSpace(); }
+    int getNumChannels() const noexcept   { return buffer.getNumChannels(); }
+
+    //==============================================================================
+    // producer: the caller checks getFreeSpace() first
+    void push (const juce::AudioBuffer<float>& source, int startSample, int numSamples) noexcept
+    {
+        jassert (numSamples <= getFreeSpace());
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto sourceChannel = juce::jmin (ch, source.getNumChannels() - 1);
+
+            if (size1 > 0)
+                buffer.copyFrom (ch, start1, source, sourceChannel, startSample, size1);
+            if (size2 > 0)
+                buffer.copyFrom (ch, start2, source, sourceChannel, startSample + size1, size2);
+        }
+
+        fifo.finishedWrite (size1 + size2);
+    }
+
+    void pushSilence (int numSamples) noexcept
+    {
+        jassert (numSamples <= getFreeSpace());
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            if (size1 > 0)
+                buffer.clear (ch, start1, size1);
+            if (size2 > 0)
+                buffer.clear (ch, start2, size2);
+        }
+
+        fifo.finishedWrite (size1 + size2);
+    }
+
+    //==============================================================================
+    // consumer: the caller checks getNumReady() first
+    void pop (juce::AudioBuffer<float>& dest, int startSample, int numSamples) noexcept
+    {
+        jassert (numSamples <= getNumReady());
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (numSamples, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < dest.getNumChannels(); ++ch)
+        {
+            auto fifoChannel = juce::jmin (ch, buffer.getNumChannels() - 1);
+
+            if (size1 > 0)
+                dest.copyFrom (ch, startSample, buffer, fifoChannel, start1, size1);
+            if (size2 > 0)
+                dest.copyFrom (ch, startSample + size1, buffer, fifoChannel, start2, size2);
+        }
+
+        fifo.finishedRead (size1 + size2);
+    }
+
+    void discard (int numSamples) noexcept
+    {
+        jassert (numSamples <= getNumReady());
+        fifo.finishedRead (numSamples);
+    }
+
+private:
+    juce::AudioBuffer<float> buffer;
+    juce::AbstractFifo fifo { 1 };
+};
@@ -0,0 +1,167 @@
+//
+//  BinaryState.h
+//  TheKnob
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include "../TheKnobDSP/Source/Parameters.h"
+
+/*
+ =================================Binary State Format=================================
+
+ The plug-in state is a fixed-layout, little-endian blob, so that it can be loaded without any XML parsing or heap allocation:
+
+    offset  size  field
+    0       4     magic   ('TKNB')
+    4       4     version (uint32)
+    8       4     knob    (float32)
+    12      4     mode    (int32)
+    16      4     flags   (uint32, see below)
+
+ Version 2 appends:
+
+    20      4     length of the impulse response path in bytes (uint32)
+    24      n     the convolution reverb's impulse response file, as a UTF-8 path (empty for the captured responses)
+
+ Newer versions may append fields, but must never move the ones above. Fields past the end of a shorter blob read as empty. Anything that doesn't start with the magic number is treated as a legacy XML state (copyXmlToBinary).
+
+ Flags (engine options, see EngineOptions.h):
+    bits 0-1    PipelineMode
+    bit 2       linear-phase EQ
+    bit 3       convolution reverb
+    bit 4       reduced-rate reverb and delay
+    bits 5-6    QualityMode (0 is automatic)
+    bits 7-31   reserved, must be 0
+
+ */
+
+namespace BinaryState
+{
+    const juce::uint32 magic = 0x424e4b54; // "TKNB" when read as little-endian bytes
+    const juce::uint32 currentVersion = 2;
+    const int sizeInBytes = 20;
+
+    const juce::uint32 pipelineModeMask = 0x3;
+    const juce::uint32 linearPhaseEQFlag = 0x4;
+    const juce::uint32 convolutionReverbFlag = 0x8;
+    const juce::uint32 reducedRateFlag = 0x10;
+    const juce::uint32 qualityModeMask = 0x60;
+    const int qualityModeShift = 5;
+
+    struct Data
+    {
+        float knob = 0.0f;
+        int mode = 0;
+        juce::uint32 flags = 0;
+    };
+
+    //==============================================================================
+    inline void writeUInt32 (char* dest, juce::uint32 value)
+    {
+        value = juce::ByteOrder::swapIfBigEndian (value);
+        std::memcpy (dest, &value, sizeof (value));
+    }
+
+    inline juce::uint32 readUInt32 (const char* src)
+    {
+        return juce::ByteOrder::littleEndianInt (src);
+    }
+
+    inline juce::uint32 floatToBits (float value)
+    {
+        juce::uint32 bits;
+        std::memcpy (&bits, &value, sizeof (bits));
+        return bits;
+    }
+
+    inline float bitsToFloat (juce::uint32 bits)
+    {
+        float value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return value;
+    }
+
+    //==============================================================================
+    // A state can come from anywhere (a corrupt session, a hand-edited preset), so the knob and mode are pulled back into range before
+    // they get anywhere near the engine or the parameters. Returns false if the knob isn't a number at all.
+    inline bool makeLegal (Data& state)
+    {
+        if (! std::isfinite (state.knob))
+            return false;
+
+        state.knob = juce::jlimit (KNOB_MIN_VALUE, KNOB_MAX_VALUE, state.knob);
+        state.mode = juce::jlimit ((int) VIOLET, (int) CRIMSON, state.mode);
+        return true;
+    }
+
+    inline bool isBinaryState (const void* data, int size)
+    {
+        return data != nullptr && size >= 8 && readUInt32 (static_cast<const char*> (data)) == magic;
+    }
+
+    inline void write (const Data& state, juce::MemoryBlock& destData)
+    {
+        destData.setSize ((size_t) sizeInBytes);
+        auto* dest = static_cast<char*> (destData.getData());
+
+        writeUInt32 (dest, magic);
+        writeUInt32 (dest + 4, currentVersion);
+        writeUInt32 (dest + 8, floatToBits (state.knob));
+        writeUInt32 (dest + 12, (juce::uint32) state.mode);
+        writeUInt32 (dest + 16, state.flags);
+    }
+
+    // returns false if the blob isn't a binary state, or is one we can't read. The knob and mode come back in range (see makeLegal()).
+    inline bool read (const void* data, int size, Data& state)
+    {
+        if (! isBinaryState (data, size) || size < sizeInBytes)
+            return false;
+
+        auto* src = static_cast<const char*> (data);
+        auto version = readUInt32 (src + 4);
+
+        // newer versions only ever append fields, so the ones we know about are still valid
+        if (version == 0)
+            return false;
+
+        state.knob = bitsToFloat (readUInt32 (src + 8));
+        state.mode = (int) readUInt32 (src + 12);
+        state.flags = readUInt32 (src + 16);
+
+        return makeLegal (state);
+    }
+
+    //==============================================================================
+    // The impulse response path goes after the fixed fields, so only the message thread ever deals with it: Data stays a plain value
+    // that can go through the audio thread's mailbox.
+    inline void writeImpulseResponsePath (const juce::String& path, juce::MemoryBlock& destData)
+    {
+        jassert (destData.getSize() == (size_t) sizeInBytes);
+
+        auto utf8 = path.toRawUTF8();
+        auto length = (juce::uint32) std::strlen (utf8);
+        char lengthBytes[4];
+        writeUInt32 (lengthBytes, length);
+
+        destData.append (lengthBytes, sizeof (lengthBytes));
+        destData.append (utf8, length);
+    }
+
+    inline juce::String readImpulseResponsePath (const void* data, int size)
+    {
+        if (! isBinaryState (data, size) || size < sizeInBytes + 4)
+            return {};
+
+        auto* src = static_cast<const char*> (data);
+        auto length = readUInt32 (src + sizeInBytes);
+
+        if (length > (juce::uint32) (size - sizeInBytes - 4))
+            return {};
+
+        return juce::String::fromUTF8 (src + sizeInBytes + 4, (int) length);
+    }
+}
@@ -0,0 +1,58 @@
+//
+//  EngineOptions.h
+//  TheKnob
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <JuceHeader.h>
+
+// Where the reverb (and delay) run. Anything but pipelineOff adds one block of latency.
+enum PipelineMode
+{
+    pipelineOff,
+    pipelineReverb,
+    pipelineReverbAndDelay
+};
+
+// Which theknob::QualityTier the engine runs at. qualityAutomatic lets a theknob::QualityGovernor pick from how long the blocks take.
+enum QualityMode
+{
+    qualityAutomatic,
+    qualityFull,
+    qualityFastSaturation,
+    qualityEconomy
+};
+
+//==============================================================================
+// Non-automatable engine settings: they're saved with the state and set from the editor's context menu.
+class EngineOptions
+{
+public:
+    virtual ~EngineOptions() = default;
+
+    virtual PipelineMode getPipelineMode() const = 0;
+    virtual void setPipelineMode (PipelineMode newMode) = 0;
+
+    // Runs the EQ and special EQ as linear-phase FIRs, which adds about 100 ms of latency
+    virtual bool getLinearPhaseEQ() const = 0;
+    virtual void setLinearPhaseEQ (bool shouldBeLinearPhase) = 0;
+
+    // Plays the reverb from impulse responses: captured from the algorithmic reverb, or loaded from a file (an empty File for the captured ones)
+    virtual bool getConvolutionReverb() const = 0;
+    virtual void setConvolutionReverb (bool shouldBeConvolution) = 0;
+    virtual juce::File getImpulseResponseFile() const = 0;
+    virtual void setImpulseResponseFile (const juce::File& file) = 0;
+
+    // Runs the reverb's and delay's wet paths at 44.1 or 48 kHz at high sample rates: about a third less CPU for those two stages at
+    // 192 kHz, 10-20% less for the whole engine, and a little latency on the reverb
+    virtual bool getReducedRateWetPaths() const = 0;
+    virtual void setReducedRateWetPaths (bool shouldReduceRate) = 0;
+
+    // Trades some of the sound for CPU, from the next block on (with a crossfade, and no change in latency). Bounces always run at full quality
+    // when it's automatic.
+    virtual QualityMode getQualityMode() const = 0;
+    virtual void setQualityMode (QualityMode newMode) = 0;
+};
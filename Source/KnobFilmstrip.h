@@ -0,0 +1,167 @@
+//
+//  KnobFilmstrip.h
+//  TheKnob
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ =================================Knob Filmstrip=================================
+
+ The rotary knob, drawn once for every position it can be in, so repainting it is an image copy instead of stroking paths.
+
+ -The frames are alpha masks, and the colours are applied when they're drawn, so one filmstrip works for all three modes.
+ -A filmstrip is rendered for each size and display scale the knob is drawn at, the first time it's needed. Every editor shares them
+  through a KnobFilmstrip::Cache, which keeps the few most recently used.
+ -The geometry is LookAndFeel_V4's rotary slider, so the knob looks the same as it did when it was drawn with paths.
+
+ */
+
+class KnobFilmstrip
+{
+public:
+    // one frame for each value of the knob parameter (0 to 100)
+    static constexpr int numFrames = 101;
+
+    KnobFilmstrip (juce::Rectangle<int> sliderBounds, float scaleFactor, float startAngle, float endAngle)
+        : bounds (sliderBounds),
+          scale (scaleFactor),
+          rotaryStartAngle (startAngle),
+          rotaryEndAngle (endAngle)
+    {
+        auto knobBounds = bounds.toFloat().reduced (10);
+        auto radius = juce::jmin (knobBounds.getWidth(), knobBounds.getHeight()) / 2.0f;
+
+        centre = knobBounds.getCentre();
+        lineWidth = juce::jmin (8.0f, radius * 0.5f);
+        arcRadius = radius - lineWidth * 0.5f;
+        area = juce::Rectangle<float> (radius * 2.0f, radius * 2.0f).withCentre (centre).getSmallestIntegerContainer().expanded (1);
+
+        render();
+    }
+
+    bool matches (juce::Rectangle<int> sliderBounds, float scaleFactor, float startAngle, float endAngle) const
+    {
+        return bounds == sliderBounds && scale == scaleFactor && rotaryStartAngle == startAngle && rotaryEndAngle == endAngle;
+    }
+
+    // sliderPos is the slider's proportional position (0 to 1)
+    void draw (juce::Graphics& g, float sliderPos, juce::Colour outline, juce::Colour fill, juce::Colour thumb, bool isEnabled) const
+    {
+        auto frame = juce::jlimit (0, numFrames - 1, juce::roundToInt (sliderPos * (float) (numFrames - 1)));
+        auto toPhysical = juce::AffineTransform::scale (1.0f / scale).translated ((float) area.getX(), (float) area.getY());
+
+        g.setImageResamplingQuality (juce::Graphics::lowResamplingQuality);
+
+        g.setColour (outline);
+        g.drawImageTransformed (backgroundFrame, toPhysical, true);
+
+        if (isEnabled)
+        {
+            g.setColour (fill);
+            g.drawImageTransformed (valueFrames[(size_t) frame], toPhysical, true);
+        }
+
+        // the thumb is a single small ellipse, which is as cheap to fill as it would be to copy
+        auto toAngle = getAngle (frame);
+        auto thumbWidth = lineWidth * 2.0f;
+        juce::Point<float> thumbPoint (centre.x + arcRadius * std::cos (toAngle - juce::MathConstants<float>::halfPi),
+                                       centre.y + arcRadius * std::sin (toAngle - juce::MathConstants<float>::halfPi));
+
+        g.setColour (thumb);
+        g.fillEllipse (juce::Rectangle<float> (thumbWidth, thumbWidth).withCentre (thumbPoint));
+    }
+
+    //==============================================================================
+    class Cache
+    {
+    public:
+        const KnobFilmstrip& get (juce::Rectangle<int> sliderBounds, float scaleFactor, float startAngle, float endAngle)
+        {
+            JUCE_ASSERT_MESSAGE_THREAD
+
+            for (size_t i = 0; i < filmstrips.size(); ++i)
+            {
+                if (filmstrips[i]->matches (sliderBounds, scaleFactor, startAngle, endAngle))
+                {
+                    // most recently used at the back
+                    std::rotate (filmstrips.begin() + (long) i, filmstrips.begin() + (long) i + 1, filmstrips.end());
+                    return *filmstrips.back();
+                }
+            }
+
+            if (filmstrips.size() >= maxFilmstrips)
+                filmstrips.erase (filmstrips.begin());
+
+            filmstrips.push_back (std::make_unique<KnobFilmstrip> (sliderBounds, scaleFactor, startAngle, endAngle));
+            return *filmstrips.back();
+        }
+
+    private:
+        // a couple of displays with different scales, and a resize or two
+        static constexpr size_t maxFilmstrips = 4;
+        std::vector<std::unique_ptr<KnobFilmstrip>> filmstrips;
+    };
+
+private:
+    //==============================================================================
+    float getAngle (int frame) const
+    {
+        return rotaryStartAngle + (float) frame / (float) (numFrames - 1) * (rotaryEndAngle - rotaryStartAngle);
+    }
+
+    void render()
+    {
+        auto frameWidth = juce::roundToInt ((float) area.getWidth() * scale);
+        auto frameHeight = juce::roundToInt ((float) area.getHeight() * scale);
+
+        // the strip holds the background arc, then a value arc for every frame
+        strip = juce::Image (juce::Image::SingleChannel, frameWidth, frameHeight * (numFrames + 1), true);
+        juce::Graphics g (strip);
+        g.setColour (juce::Colours::white);
+
+        const juce::PathStrokeType stroke (lineWidth, juce::PathStrokeType::curved, juce::PathStrokeType::rounded);
+
+        auto drawArc = [&] (int index, float toAngle)
+        {
+            juce::Path arc;
+            arc.addCentredArc (centre.x, centre.y, arcRadius, arcRadius, 0.0f, rotaryStartAngle, toAngle, true);
+
+            juce::Graphics::ScopedSaveState saveState (g);
+            g.reduceClipRegion (0, index * frameHeight, frameWidth, frameHeight);
+            g.addTransform (juce::AffineTransform::translation ((float) -area.getX(), (float) -area.getY())
+                                                  .scaled (scale)
+                                                  .translated (0.0f, (float) (index * frameHeight)));
+            g.strokePath (arc, stroke);
+
+            return strip.getClippedImage ({ 0, index * frameHeight, frameWidth, frameHeight });
+        };
+
+        backgroundFrame = drawArc (0, rotaryEndAngle);
+
+        valueFrames.clear();
+        valueFrames.reserve ((size_t) numFrames);
+
+        for (int frame = 0; frame < numFrames; ++frame)
+            valueFrames.push_back (drawArc (frame + 1, getAngle (frame)));
+    }
+
+    //==============================================================================
+    const juce::Rectangle<int> bounds;
+    const float scale;
+    const float rotaryStartAngle, rotaryEndAngle;
+
+    juce::Point<float> centre;
+    float lineWidth = 0.0f, arcRadius = 0.0f;
+
+    // the part of the slider the frames cover, in the slider's coordinates
+    juce::Rectangle<int> area;
+
+    juce::Image strip;
+    juce::Image backgroundFrame;
+    std::vector<juce::Image> valueFrames;
+};
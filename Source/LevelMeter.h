@@ -0,0 +1,193 @@
+//
+//  LevelMeter.h
+//  TheKnob
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+
+/*
+ =================================Level Meters=================================
+
+ Peak and RMS levels of TheKnob's input and output, measured on the audio thread and shown by the editor.
+
+ -Each block is reduced to a peak and a sum of squares per channel with SIMD, then the ballistics are applied once per block: the peak
+  falls back at 20 dB a second, and the RMS is averaged over about 300 ms.
+ -About 60 times a second the audio thread publishes the levels through a TripleBuffer. It never waits, and the editor only ever sees
+  a complete set. Because the levels carry their own decay, the editor can poll at whatever rate it likes without missing a peak.
+
+ */
+
+struct MeterLevels
+{
+    struct Channel
+    {
+        float peak = 0.0f;
+        float rms = 0.0f;
+    };
+
+    std::array<Channel, 2> input, output;
+    int numChannels = 2;
+};
+
+//==============================================================================
+// The largest absolute value and the sum of squares of a block of samples. The aligned middle of the block is done with SIMD.
+inline void measureBlock (const float* samples, int numSamples, float& peak, float& sumOfSquares) noexcept
+{
+    float scalarPeak = 0.0f, scalarSum = 0.0f;
+
+    auto addScalar = [&] (const float* from, const float* to)
+    {
+        for (auto* s = from; s < to; ++s)
+        {
+            scalarPeak = juce::jmax (scalarPeak, std::abs (*s));
+            scalarSum += *s * *s;
+        }
+    };
+
+   #if JUCE_USE_SIMD
+    using Vector = juce::dsp::SIMDRegister<float>;
+
+    auto* end = samples + numSamples;
+    auto* alignedStart = juce::jmin<const float*> (Vector::getNextSIMDAlignedPtr (const_cast<float*> (samples)), end);
+    auto numVectors = (int) (end - alignedStart) / (int) Vector::SIMDNumElements;
+    auto* alignedEnd = alignedStart + numVectors * (int) Vector::SIMDNumElements;
+
+    addScalar (samples, alignedStart);
+
+    auto vectorPeak = Vector::expand (0.0f);
+    auto vectorSum = Vector::expand (0.0f);
+
+    for (auto* s = alignedStart; s < alignedEnd; s += Vector::SIMDNumElements)
+    {
+        auto v = Vector::fromRawArray (s);
+        vectorPeak = Vector::max (vectorPeak, Vector::abs (v));
+        vectorSum += v * v;
+    }
+
+    addScalar (alignedEnd, end);
+
+    for (size_t i = 0; i < Vector::SIMDNumElements; ++i)
+        scalarPeak = juce::jmax (scalarPeak, vectorPeak.get (i));
+
+    scalarSum += vectorSum.sum();
+   #else
+    addScalar (samples, samples + numSamples);
+   #endif
+
+    peak = scalarPeak;
+    sumOfSquares = scalarSum;
+}
+
+//==============================================================================
+class LevelMeter
+{
+public:
+    void prepare (double sampleRate) noexcept
+    {
+        const double peakReleaseDbPerSecond = 20.0;
+        const double rmsWindowSeconds = 0.3;
+
+        peakReleasePerSample = -peakReleaseDbPerSecond / 20.0 * std::log (10.0) / sampleRate;
+        rmsTimeConstantSamples = rmsWindowSeconds * sampleRate;
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        peak.fill (0.0f);
+        meanSquare.fill (0.0f);
+    }
+
+    // audio thread
+    void measure (const juce::AudioBuffer<float>& buffer, int numChannels) noexcept
+    {
+        auto numSamples = buffer.getNumSamples();
+
+        if (numSamples == 0)
+            return;
+
+        // the ballistics only depend on the block's length, so work them out once for all the channels
+        auto peakDecay = (float) std::exp (peakReleasePerSample * numSamples);
+        auto rmsCoefficient = (float) (1.0 - std::exp (-numSamples / rmsTimeConstantSamples));
+
+        for (int ch = 0; ch < juce::jmin (numChannels, 2); ++ch)
+        {
+            float blockPeak, sumOfSquares;
+            measureBlock (buffer.getReadPointer (ch), numSamples, blockPeak, sumOfSquares);
+
+            auto c = (size_t) ch;
+            peak[c] = juce::jmax (blockPeak, peak[c] * peakDecay);
+            meanSquare[c] += (sumOfSquares / (float) numSamples - meanSquare[c]) * rmsCoefficient;
+        }
+    }
+
+    MeterLevels::Channel getLevels (int channel) const noexcept
+    {
+        auto c = (size_t) channel;
+        return { peak[c], std::sqrt (meanSquare[c]) };
+    }
+
+private:
+    double peakReleasePerSample = 0.0;
+    double rmsTimeConstantSamples = 1.0;
+
+    std::array<float, 2> peak {}, meanSquare {};
+};
+
+//==============================================================================
+class LevelMeters
+{
+public:
+    void prepare (double sampleRate) noexcept
+    {
+        input.prepare (sampleRate);
+        output.prepare (sampleRate);
+        publishIntervalSamples = juce::roundToInt (sampleRate / publishRateHz);
+        samplesSincePublish = 0;
+    }
+
+    // audio thread: the input at the start of processBlock, the output at the end
+    void measureInput (const juce::AudioBuffer<float>& buffer, int numChannels) noexcept     { input.measure (buffer, numChannels); }
+
+    void measureOutput (const juce::AudioBuffer<float>& buffer, int numChannels) noexcept
+    {
+        output.measure (buffer, numChannels);
+        samplesSincePublish += buffer.getNumSamples();
+
+        if (samplesSincePublish < publishIntervalSamples)
+            return;
+
+        samplesSincePublish = 0;
+
+        MeterLevels levels;
+        levels.numChannels = juce::jlimit (1, 2, numChannels);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            levels.input[(size_t) ch] = input.getLevels (ch);
+            levels.output[(size_t) ch] = output.getLevels (ch);
+        }
+
+        mailbox.write (levels);
+    }
+
+    // message thread: returns false if nothing new has been published since the last call
+    bool getLevels (MeterLevels& levels) noexcept
+    {
+        return mailbox.read (levels);
+    }
+
+private:
+    static constexpr double publishRateHz = 60.0;
+
+    LevelMeter input, output;
+    int publishIntervalSamples = 800;
+    int samplesSincePublish = 0;
+
+    TripleBuffer<MeterLevels> mailbox;
+};
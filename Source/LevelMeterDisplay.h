@@ -0,0 +1,106 @@
+//
+//  LevelMeterDisplay.h
+//  TheKnob
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include "LevelMeter.h"
+
+/*
+ The input and output meters: a bar for each channel's RMS level and a line at its peak, from -60 dB to +6 dB.
+
+ It polls the processor's LevelMeters 30 times a second, and only repaints when a bar or a line has moved by at least a pixel.
+ */
+
+class LevelMeterDisplay  : public juce::Component,
+                           private juce::Timer
+{
+public:
+    explicit LevelMeterDisplay (LevelMeters& metersToShow)
+        : meters (metersToShow)
+    {
+        setOpaque (true);
+        startTimerHz (30);
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+
+        auto area = getLocalBounds().reduced (2);
+        auto numBars = levels.numChannels * 2;
+        auto barWidth = (area.getWidth() - (numBars - 1) * barGap) / numBars;
+
+        auto drawBar = [&] (const MeterLevels::Channel& channel)
+        {
+            auto bar = area.removeFromLeft (barWidth);
+            area.removeFromLeft (barGap);
+
+            g.setColour (juce::Colours::grey.withAlpha (0.2f));
+            g.fillRect (bar);
+
+            g.setColour (juce::Colours::grey);
+            g.fillRect (bar.withTop (bar.getBottom() - getHeightFor (channel.rms, bar.getHeight())));
+
+            auto peakHeight = getHeightFor (channel.peak, bar.getHeight());
+            g.setColour (channel.peak >= 1.0f ? juce::Colours::red : juce::Colours::lightgrey);
+            g.fillRect (bar.getX(), bar.getBottom() - peakHeight, bar.getWidth(), 1);
+        };
+
+        for (int ch = 0; ch < levels.numChannels; ++ch)
+            drawBar (levels.input[(size_t) ch]);
+
+        for (int ch = 0; ch < levels.numChannels; ++ch)
+            drawBar (levels.output[(size_t) ch]);
+    }
+
+private:
+    static int getHeightFor (float level, int height)
+    {
+        auto db = juce::Decibels::gainToDecibels (level, minDb);
+        return juce::jlimit (0, height, juce::roundToInt (juce::jmap (db, minDb, maxDb, 0.0f, (float) height)));
+    }
+
+    void timerCallback() override
+    {
+        MeterLevels newLevels;
+
+        if (! meters.getLevels (newLevels))
+            return;
+
+        // compare what would be drawn, not the levels, which change on every update
+        auto height = getLocalBounds().reduced (2).getHeight();
+        auto moved = newLevels.numChannels != levels.numChannels;
+
+        for (size_t ch = 0; ch < 2 && ! moved; ++ch)
+        {
+            for (auto bus : { std::make_pair (&levels.input[ch], &newLevels.input[ch]), std::make_pair (&levels.output[ch], &newLevels.output[ch]) })
+            {
+                moved = moved
+                     || getHeightFor (bus.first->rms, height) != getHeightFor (bus.second->rms, height)
+                     || getHeightFor (bus.first->peak, height) != getHeightFor (bus.second->peak, height)
+                     || (bus.first->peak >= 1.0f) != (bus.second->peak >= 1.0f);
+            }
+        }
+
+        // keep the levels that were last drawn, so slow movements still add up to a repaint
+        if (moved)
+        {
+            levels = newLevels;
+            repaint();
+        }
+    }
+
+    static constexpr float minDb = -60.0f;
+    static constexpr float maxDb = 6.0f;
+    static constexpr int barGap = 1;
+
+    LevelMeters& meters;
+    MeterLevels levels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeterDisplay)
+};
@@ -0,0 +1,238 @@
+//
+//  PipelinedProcessor.h
+//  TheKnob
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <JuceHeader.h>
+#include "../TheKnobDSP/Source/Engine.h"
+#include "AudioFifo.h"
+
+/*
+ =================================Pipelined Reverb=================================
+
+ Runs the reverb (and optionally the delay, which sits right next to it in every mode's chain) on a dedicated real-time worker thread, so the host's audio thread only has to copy audio in and out. The worker has its own theknob::Engine and runs its detached stages; the processor's engine runs the rest of the chain around this.
+
+ -Audio goes to the worker through a lock-free FIFO and comes back through another one, in chunks of one host block, so the output is exactly one block late. TheKnobAudioProcessor reports that with setLatencySamples().
+ -A dry copy of the input is kept, delayed by the same amount. If the worker hasn't finished a chunk in time, the dry signal is played instead of waiting, and the late samples are thrown away when they arrive. Nothing on the audio thread ever blocks.
+ -When the knob is at 0 the worker passes audio through untouched, so the latency stays the same.
+ -The worker runs at whatever quality tier the audio thread last set, and reports how long its chunks take, so the processor's governor sees the worker getting overloaded as well as the audio thread.
+
+ */
+
+class PipelinedProcessor  : private juce::Thread
+{
+public:
+    PipelinedProcessor(const theknob::SharedParameters* sharedParameters, bool includeDelay)
+        : juce::Thread ("TheKnob Reverb Worker"),
+          parameters (sharedParameters)
+    {
+        engine.setDetachedStages (true, includeDelay);
+    }
+
+    ~PipelinedProcessor() override
+    {
+        stopThread (1000);
+    }
+
+    void prepare (double sampleRate, int samplesPerBlock)
+    {
+        stopThread (1000);
+
+        chunkSize = juce::jmax (1, samplesPerBlock);
+        chunkSampleRate = sampleRate;
+        workerLoad = 0.0f;
+
+        engine.setParameters (parameters->load());
+        engine.prepare (sampleRate, chunkSize);
+        chunkData.setSize (2, chunkSize);
+
+        inputFifo.setSize (2, chunkSize * fifoBlocks);
+        outputFifo.setSize (2, chunkSize * fifoBlocks);
+        dryFifo.setSize (2, chunkSize * (fifoBlocks + 1));
+
+        // one block of latency: the first block out is the primed silence
+        dryFifo.pushSilence (chunkSize);
+        segments.clear();
+        segments.push (chunkSize, false);
+        samplesToDiscard = 0;
+
+        startRealtimeThread (juce::Thread::RealtimeOptions().withApproximateAudioProcessingTime (chunkSize, sampleRate));
+    }
+
+    // the worker's engine, for the options that change how its stages run. Set them before prepare().
+    theknob::Engine& getEngine() noexcept                { return engine; }
+
+    // Takes effect from the worker's next chunk
+    void setQualityTier (int tier) noexcept              { qualityTier = tier; }
+
+    // How long the worker's last chunk took, over the time it plays for
+    float getWorkerLoad() const noexcept                 { return workerLoad; }
+
+    void release()
+    {
+        stopThread (1000);
+    }
+
+    // Called on the audio thread with a stereo buffer, in place of the detached stages
+    void process (juce::AudioSampleBuffer& buffer)
+    {
+        auto numSamples = buffer.getNumSamples();
+        jassert (numSamples <= chunkSize);
+
+        // input: always to the dry line, and to the worker if it has room
+        bool sent = inputFifo.getFreeSpace() >= numSamples && segments.hasRoomForSentSegment();
+
+        dryFifo.push (buffer, 0, numSamples);
+
+        if (sent)
+        {
+            inputFifo.push (buffer, 0, numSamples);
+            workAvailable.signal();
+        }
+
+        // output: whatever was sent one block ago, in the order it was sent
+        int position = 0;
+
+        while (position < numSamples && ! segments.isEmpty())
+        {
+            auto& segment = segments.front();
+            auto count = juce::jmin (numSamples - position, segment.numSamples);
+
+            if (segment.sentToWorker)
+                readWorkerOutput (buffer, position, count);
+            else
+                dryFifo.pop (buffer, position, count);
+
+            position += count;
+            segment.numSamples -= count;
+
+            if (segment.numSamples == 0)
+                segments.pop();
+        }
+
+        jassert (position == numSamples);
+        segments.push (numSamples, sent);
+    }
+
+private:
+    //==============================================================================
+    void readWorkerOutput (juce::AudioSampleBuffer& buffer, int startSample, int numSamples)
+    {
+        // samples we already played dry in place of are stale
+        auto stale = juce::jmin (samplesToDiscard, outputFifo.getNumReady());
+        outputFifo.discard (stale);
+        samplesToDiscard -= stale;
+
+        auto ready = samplesToDiscard == 0 ? juce::jmin (numSamples, outputFifo.getNumReady()) : 0;
+
+        if (ready > 0)
+        {
+            outputFifo.pop (buffer, startSample, ready);
+            dryFifo.discard (ready);
+        }
+
+        // overrun: play the delayed dry signal rather than wait for the worker
+        if (ready < numSamples)
+        {
+            if (auto* trace = theknob::Trace::getActive())
+                trace->instant ("Overrun", "scheduling", "samples", numSamples - ready);
+
+            dryFifo.pop (buffer, startSample + ready, numSamples - ready);
+            samplesToDiscard += numSamples - ready;
+        }
+    }
+
+    void run() override
+    {
+        juce::ScopedNoDenormals noDenormals;
+        theknob::Trace::setThreadName ("Pipeline worker");
+
+        while (! threadShouldExit())
+        {
+            auto numSamples = juce::jmin (chunkSize, inputFifo.getNumReady(), outputFifo.getFreeSpace());
+
+            if (numSamples == 0)
+            {
+                workAvailable.wait (50);
+                continue;
+            }
+
+            // host blocks can be shorter than the prepared size, so process whatever has arrived
+            juce::AudioSampleBuffer chunk (chunkData.getArrayOfWritePointers(), chunkData.getNumChannels(), numSamples);
+            inputFifo.pop (chunk, 0, numSamples);
+
+            // one consistent snapshot for the whole chunk, which costs one compare if it hasn't changed; when the knob is at 0 the engine
+            // leaves the audio alone
+            theknob::TraceScope span ("Chunk", "block", "samples", numSamples);
+            auto start = juce::Time::getHighResolutionTicks();
+            engine.setParameters (parameters->load());
+            engine.setQualityTier (qualityTier);
+            engine.processDetached (chunk.getArrayOfWritePointers(), numSamples);
+            workerLoad = (float) (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * chunkSampleRate / numSamples);
+
+            outputFifo.push (chunk, 0, numSamples);
+        }
+    }
+
+    //==============================================================================
+    // The order in which output samples have to be taken from the worker or from the dry line. Only touched by the audio thread.
+    struct Segment
+    {
+        int numSamples = 0;
+        bool sentToWorker = false;
+    };
+
+    class SegmentQueue
+    {
+    public:
+        void clear() noexcept                { head = tail = 0; }
+        bool isEmpty() const noexcept        { return head == tail; }
+        int getNumFree() const noexcept      { return maxSegments - 1 - (tail - head + maxSegments) % maxSegments; }
+        Segment& front() noexcept            { return items[(size_t) head]; }
+        void pop() noexcept                  { head = (head + 1) % maxSegments; }
+
+        // a sent segment always leaves room for the unsent one that may follow it
+        bool hasRoomForSentSegment() const noexcept { return getNumFree() >= 2; }
+        void push (int numSamples, bool sentToWorker) noexcept
+        {
+            auto& last = items[(size_t) ((tail + maxSegments - 1) % maxSegments)];
+
+            if (! isEmpty() && last.sentToWorker == sentToWorker)
+            {
+                last.numSamples += numSamples;
+                return;
+            }
+
+            jassert (getNumFree() > 0);
+            items[(size_t) tail] = { numSamples, sentToWorker };
+            tail = (tail + 1) % maxSegments;
+        }
+
+    private:
+        static constexpr int maxSegments = 64;
+        std::array<Segment, maxSegments> items;
+        int head = 0, tail = 0;
+    };
+
+    //==============================================================================
+    static constexpr int fifoBlocks = 4;
+
+    const theknob::SharedParameters* parameters;
+
+    theknob::Engine engine;
+
+    int chunkSize = 512;
+    double chunkSampleRate = 44100.0;
+    std::atomic<int> qualityTier { theknob::fullQualityTier };
+    std::atomic<float> workerLoad { 0.0f };
+    juce::AudioSampleBuffer chunkData;
+    AudioFifo inputFifo, outputFifo, dryFifo;
+    juce::WaitableEvent workAvailable;
+
+    SegmentQueue segments;
+    int samplesToDiscard = 0;
+};
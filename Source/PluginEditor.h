@@ -9,14 +9,11 @@
 //==============================================================================
 
 #include "RadioButtonAttachment.h"
-
-
-enum MODE
-{
-    VIOLET,
-    TEAL,
-    CRIMSON
-};
+#include "EngineOptions.h"
+#include "KnobFilmstrip.h"
+#include "LevelMeterDisplay.h"
+#include "AnalyzerDisplay.h"
+#include "../TheKnobDSP/Source/Parameters.h"
 
 const std::array<juce::Colour, 3> COLOURS =
 {
@@ -25,15 +22,37 @@ const std::array<juce::Colour, 3> COLOURS =
     juce::Colours::crimson
 };
 
+// The knob's look: one instance per editor, recoloured when the mode changes (swapping LookAndFeels makes JUCE lay the slider out again)
 class MyLookAndFeel : public juce::LookAndFeel_V4
 {
 public:
     MyLookAndFeel(int mode)
+    {
+        setMode (mode);
+    }
+    
+    void setMode (int mode)
     {
         colour = COLOURS[mode];
         setColour (juce::Slider::thumbColourId, colour);
     }
     
+    void drawRotarySlider (juce::Graphics& g, int x, int y, int width, int height, float sliderPos,
+                           float rotaryStartAngle, float rotaryEndAngle, juce::Slider& slider) override
+    {
+        // the slider is opaque, so its repaints stop here instead of going through the editor behind it
+        g.fillAll (findColour (juce::ResizableWindow::backgroundColourId));
+        
+        auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        auto& filmstrip = filmstrips->get ({ x, y, width, height }, scale, rotaryStartAngle, rotaryEndAngle);
+        
+        filmstrip.draw (g, sliderPos,
+                        slider.findColour (juce::Slider::rotarySliderOutlineColourId),
+                        slider.findColour (juce::Slider::rotarySliderFillColourId),
+                        slider.findColour (juce::Slider::thumbColourId),
+                        slider.isEnabled());
+    }
+    
     juce::Slider::SliderLayout getSliderLayout (juce::Slider& slider) override
     {
         juce::Slider::SliderLayout layout;
@@ -46,23 +65,31 @@ public:
     {
         g.fillAll (label.findColour (juce::Label::backgroundColourId));
 
-        const juce::Font font (juce::FontOptions(33));
-
-        g.setColour (colour.withMultipliedAlpha (0.5f));
-        g.setFont (font);
-
         auto textArea = getLabelBorderSize (label).subtractedFrom (label.getLocalBounds());
 
-        g.drawFittedText (label.getText(), textArea, juce::Justification::centred, 1, 1.0f);
-
-        g.setColour (label.findColour (juce::Label::outlineColourId).withMultipliedAlpha (0.0f));
+        // laying the glyphs out costs more than drawing them, and the text only changes with the knob's value
+        if (label.getText() != layoutText || textArea != layoutArea)
+        {
+            layoutText = label.getText();
+            layoutArea = textArea;
+            layout.clear();
+            layout.addFittedText (valueFont, layoutText, (float) textArea.getX(), (float) textArea.getY(),
+                                  (float) textArea.getWidth(), (float) textArea.getHeight(), juce::Justification::centred, 1, 1.0f);
+        }
 
-        g.drawRect (label.getLocalBounds());
+        g.setColour (colour.withMultipliedAlpha (0.5f));
+        layout.draw (g);
     }
     
 private:
     juce::Colour colour;
-
+    
+    const juce::Font valueFont { juce::FontOptions(33) };
+    juce::String layoutText;
+    juce::Rectangle<int> layoutArea;
+    juce::GlyphArrangement layout;
+    
+    juce::SharedResourcePointer<KnobFilmstrip::Cache> filmstrips;
 };
 
 class PluginEditor : public juce::AudioProcessorEditor
@@ -70,10 +97,12 @@ class PluginEditor : public juce::AudioProcessorEditor
 public:
     enum
     {
-        windowWidth = 300,
-        windowHeight = 200,
+        windowWidth = 330,
+        windowHeight = 280,
+        analyzerHeight = 80,
         footerHeight = 30,
-        knobAreaWidth = 200
+        knobAreaWidth = 200,
+        meterAreaWidth = 30
     };
     
     enum RadioButtonIds {
@@ -83,10 +112,14 @@ public:
     typedef juce::AudioProcessorValueTreeState::SliderAttachment SliderAttachment;
     typedef juce::AudioProcessorValueTreeState::ComboBoxAttachment ComboBoxAttachment;
 
-    PluginEditor (juce::AudioProcessor& parent, juce::AudioProcessorValueTreeState& vts)
+    PluginEditor (juce::AudioProcessor& parent, juce::AudioProcessorValueTreeState& vts, EngineOptions& options, LevelMeters& meters, Analyzer& analyzer)
         : AudioProcessorEditor (parent),
-          valueTreeState (vts)
+          valueTreeState (vts),
+          engineOptions (options),
+          meterDisplay (meters),
+          analyzerDisplay (analyzer)
     {
+        setOpaque (true);
         setSize (windowWidth, windowHeight);
         
         // the knob label
@@ -100,6 +133,8 @@ public:
         knobSlider.setSliderStyle (juce::Slider::Rotary);
         knobSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, true, 50, 50);
         knobSlider.setPopupDisplayEnabled (false, false, this);
+        knobSlider.setLookAndFeel (&knobLookAndFeel);
+        knobSlider.setOpaque (true);
         
         // the mode label
         addAndMakeVisible (modeLabel);
@@ -121,15 +156,28 @@ public:
         modeButtons.add(&button2);
         modeButtons.add(&button3);
         
+        // input and output level meters
+        addAndMakeVisible (meterDisplay);
+        
+        // the EQ curve and the output spectrum
+        addAndMakeVisible (analyzerDisplay);
+        
         knobAttachment.reset (new SliderAttachment (valueTreeState, "knob", knobSlider));
         modeAttachment = std::make_unique<RadioButtonAttachment>(*valueTreeState.getParameter("mode"), modeButtons, "mode", ModeButtons);
     }
+    
+    ~PluginEditor() override
+    {
+        knobSlider.setLookAndFeel (nullptr);
+    }
 
     void resized() override
     {
         auto area = getLocalBounds();
         
+        auto analyzerArea = area.removeFromTop(analyzerHeight);
         auto footerArea = area.removeFromBottom(footerHeight);
+        auto meterArea = area.removeFromRight(meterAreaWidth);
         auto knobLabelArea = footerArea.removeFromLeft(knobAreaWidth);
         auto modeLabelArea = footerArea;
         
@@ -147,6 +195,8 @@ public:
         button1.setBounds (button1Area);
         button2.setBounds (button2Area);
         button3.setBounds (button3Area);
+        meterDisplay.setBounds (meterArea);
+        analyzerDisplay.setBounds (analyzerArea);
     }
 
     void paint (juce::Graphics& g) override
@@ -154,14 +204,85 @@ public:
         g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
     }
     
+    // right-click anywhere outside the controls for the engine options
+    void mouseDown (const juce::MouseEvent& e) override
+    {
+        if (! e.mods.isPopupMenu())
+            return;
+        
+        auto pipelineMode = engineOptions.getPipelineMode();
+        
+        juce::PopupMenu menu;
+        menu.addSectionHeader ("Reverb");
+        menu.addItem ("Run on the host's audio thread", true, pipelineMode == pipelineOff,
+                      [this] { engineOptions.setPipelineMode (pipelineOff); });
+        menu.addItem ("Run on a worker thread (+1 block latency)", true, pipelineMode == pipelineReverb,
+                      [this] { engineOptions.setPipelineMode (pipelineReverb); });
+        menu.addItem ("Run with the delay on a worker thread (+1 block latency)", true, pipelineMode == pipelineReverbAndDelay,
+                      [this] { engineOptions.setPipelineMode (pipelineReverbAndDelay); });
+        
+        auto convolution = engineOptions.getConvolutionReverb();
+        auto impulseResponseFile = engineOptions.getImpulseResponseFile();
+        
+        menu.addSeparator();
+        menu.addItem ("Play from impulse responses", true, convolution,
+                      [this] { engineOptions.setConvolutionReverb (! engineOptions.getConvolutionReverb()); });
+        menu.addItem ("Captured from the algorithmic reverb", convolution, impulseResponseFile == juce::File(),
+                      [this] { engineOptions.setImpulseResponseFile ({}); });
+        menu.addItem (impulseResponseFile == juce::File() ? juce::String ("Load an impulse response...") : impulseResponseFile.getFileName(),
+                      convolution, impulseResponseFile != juce::File(),
+                      [this] { chooseImpulseResponse(); });
+        
+        menu.addSeparator();
+        menu.addItem ("Run the reverb and delay at 48 kHz at high sample rates", true, engineOptions.getReducedRateWetPaths(),
+                      [this] { engineOptions.setReducedRateWetPaths (! engineOptions.getReducedRateWetPaths()); });
+        
+        menu.addSectionHeader ("EQ");
+        menu.addItem ("Linear phase (+100 ms latency)", true, engineOptions.getLinearPhaseEQ(),
+                      [this] { engineOptions.setLinearPhaseEQ (! engineOptions.getLinearPhaseEQ()); });
+        
+        auto qualityMode = engineOptions.getQualityMode();
+        
+        menu.addSectionHeader ("Quality");
+        menu.addItem ("Automatic (steps down when the CPU can't keep up)", true, qualityMode == qualityAutomatic,
+                      [this] { engineOptions.setQualityMode (qualityAutomatic); });
+        menu.addItem ("Full", true, qualityMode == qualityFull,
+                      [this] { engineOptions.setQualityMode (qualityFull); });
+        menu.addItem ("Fast saturation", true, qualityMode == qualityFastSaturation,
+                      [this] { engineOptions.setQualityMode (qualityFastSaturation); });
+        menu.addItem ("Economy", true, qualityMode == qualityEconomy,
+                      [this] { engineOptions.setQualityMode (qualityEconomy); });
+        
+        menu.showMenuAsync (juce::PopupMenu::Options().withTargetComponent (this).withMousePosition());
+    }
+    
     void updateButtons (MODE mode)
     {
         knobLabel.setColour (juce::Label::textColourId, COLOURS[mode]);
-        knobSlider.setLookAndFeel(&buttonLookAndFeel[mode]);
+        knobLookAndFeel.setMode (mode);
+        knobSlider.repaint();
+        analyzerDisplay.setCurveColour (COLOURS[mode]);
     }
 
 private:
+    void chooseImpulseResponse()
+    {
+        fileChooser = std::make_unique<juce::FileChooser> ("Load an impulse response", engineOptions.getImpulseResponseFile(), "*.wav;*.aif;*.aiff;*.flac");
+        fileChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                  [this] (const juce::FileChooser& chooser)
+                                  {
+                                      auto file = chooser.getResult();
+                                      
+                                      if (file.existsAsFile())
+                                          engineOptions.setImpulseResponseFile (file);
+                                  });
+    }
+    
     juce::AudioProcessorValueTreeState& valueTreeState;
+    EngineOptions& engineOptions;
+
+    // declared before the slider, so it outlives it
+    MyLookAndFeel knobLookAndFeel { VIOLET };
 
     juce::Label knobLabel;
     juce::Slider knobSlider;
@@ -174,5 +295,9 @@ private:
     juce::ToggleButton button3 { "Crimson" };
     std::unique_ptr<RadioButtonAttachment> modeAttachment;
     
-    std::array<MyLookAndFeel, 3> buttonLookAndFeel = {MyLookAndFeel(VIOLET), MyLookAndFeel(TEAL), MyLookAndFeel(CRIMSON)};
+    LevelMeterDisplay meterDisplay;
+    AnalyzerDisplay analyzerDisplay;
+    
+    // kept while the impulse response chooser is open
+    std::unique_ptr<juce::FileChooser> fileChooser;
 };
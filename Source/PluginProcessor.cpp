@@ -13,8 +13,6 @@
 TheKnobAudioProcessor::TheKnobAudioProcessor()
     :   AudioProcessor (BusesProperties().withInput ("Input", juce::AudioChannelSet::stereo(), true).withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
 
-        mainProcessor (new juce::AudioProcessorGraph()),
-
         parameters (*this, nullptr, juce::Identifier ("TheKnob"), {
             std::make_unique<juce::AudioParameterInt> ("knob",
                                                        "Amount",
@@ -30,151 +28,510 @@ TheKnobAudioProcessor::TheKnobAudioProcessor()
 {
     knobParameter = parameters.getRawParameterValue("knob");
     modeParameter = parameters.getRawParameterValue("mode");
-    
-    initialiseGraph();
 }
 
-TheKnobAudioProcessor::~TheKnobAudioProcessor(){}
+TheKnobAudioProcessor::~TheKnobAudioProcessor()
+{
+    // the pipeline's worker reads engineParameters, so it has to stop first
+    discardPendingSetups();
+    setup.reset();
+}
 
 //==============================================================================
 void TheKnobAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    mainProcessor->setPlayConfigDetails (getMainBusNumInputChannels(),
-                                         getMainBusNumOutputChannels(),
-                                         sampleRate, samplesPerBlock);
-    mainProcessor->prepareToPlay (sampleRate, samplesPerBlock);
-    initialiseGraph();
+    // anything recalled while we weren't playing can be applied straight away
+    BinaryState::Data recalledState;
+    stateMailbox.read (recalledState);
+    hasPendingState = false;
+    fadeState = notFading;
+    fadeLengthSamples = juce::roundToInt (sampleRate * 0.005); // 5 ms
+    
+    engineParameters.publish (knobParameter->load(), (int) modeParameter->load());
+    
+    // the audio thread isn't running, so a setup that was waiting for it is built for the old rate, and this one goes straight in
+    discardPendingSetups();
+    setup = createSetup (getSetupOptions(), sampleRate, samplesPerBlock);
+    setupLatencySamples = setup->latencySamples;
+    setupRequested = false;
+    prepared = true;
+    
+    meters.prepare (sampleRate);
+    analyzer.prepare (sampleRate);
+    governor.reset();
+    
+    setLatencySamples (setup->latencySamples);
+}
+
+void TheKnobAudioProcessor::releaseResources()
+{
+    prepared = false;
+    discardPendingSetups();
+    
+    if (setup != nullptr && setup->pipeline != nullptr)
+        setup->pipeline->release();
 }
 
-void TheKnobAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void TheKnobAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 {
     juce::ScopedNoDenormals noDenormals;
     
     for (int i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
             buffer.clear (i, 0, buffer.getNumSamples());
     
-    int currentKnobValue = (int)*knobParameter;
-    int currentMode = (int)*modeParameter;
+    if (setup == nullptr)
+        return;
+    
+    auto numSamples = buffer.getNumSamples();
+    auto numChannels = juce::jmin (buffer.getNumChannels(), 2);
+    
+    meters.measureInput (buffer, numChannels);
     
-    if (prevKnobValue != currentKnobValue && (prevKnobValue == 0 || currentKnobValue == 0))
+    auto realtime = ! isNonRealtime();
+    auto start = juce::Time::getHighResolutionTicks();
+    
+    updateQualityTier (realtime);
+    updateEngineParameters();
+    
+    auto& engine = setup->engine;
+    auto* pipeline = setup->pipeline.get();
+    engine.setParameters (engineParameters.load());
+    
+    if (pipeline == nullptr)
     {
-        connectGraph();
-        prevKnobValue = currentKnobValue;
+        engine.process (buffer.getArrayOfWritePointers(), numChannels, numSamples);
     }
-    else if (prevMode != currentMode)
+    else
     {
-        connectGraph();
-        prevMode = currentMode;
+        // the pipeline (and the mono stereo buffer) only take up to the prepared block size at a time, so a longer host block goes
+        // through in pieces
+        auto maxPieceSize = setup->stereoBuffer.getNumSamples();
+        
+        for (int offset = 0; offset < numSamples; offset += maxPieceSize)
+        {
+            auto pieceSize = juce::jmin (maxPieceSize, numSamples - offset);
+            
+            // the worker always gets a stereo block, even when bypassed, so the latency doesn't change
+            float* channels[2];
+            
+            if (numChannels < 2)
+            {
+                channels[0] = setup->stereoBuffer.getWritePointer (0);
+                channels[1] = setup->stereoBuffer.getWritePointer (1);
+                juce::FloatVectorOperations::copy (channels[0], buffer.getReadPointer (0, offset), pieceSize);
+                juce::FloatVectorOperations::clear (channels[1], pieceSize);
+            }
+            else
+            {
+                channels[0] = buffer.getWritePointer (0, offset);
+                channels[1] = buffer.getWritePointer (1, offset);
+            }
+            
+            juce::AudioSampleBuffer stereo (channels, 2, pieceSize);
+            
+            engine.processHead (stereo.getArrayOfWritePointers(), pieceSize);
+            pipeline->process (stereo);
+            engine.processTail (stereo.getArrayOfWritePointers(), pieceSize);
+            
+            if (numChannels < 2)
+                buffer.copyFrom (0, offset, stereo, 0, 0, pieceSize);
+        }
+    }
+    
+    // the governor judges the next block's tier by whichever of this thread and the worker is closer to running out of time
+    if (qualityMode == qualityAutomatic && realtime && getSampleRate() > 0)
+    {
+        auto blockSeconds = numSamples / getSampleRate();
+        auto load = (float) (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) / blockSeconds);
+        
+        if (pipeline != nullptr)
+            load = juce::jmax (load, pipeline->getWorkerLoad());
+        
+        governor.update (load, blockSeconds);
     }
     
-    mainProcessor->processBlock (buffer, midiMessages);
+    auto fadeLength = juce::jmin (fadeLengthSamples, numSamples);
+    
+    if (fadeState == fadingOut)
+    {
+        // fade the old settings (or setup) out at the end of this block, then switch to the new ones for the next
+        buffer.applyGainRamp (numSamples - fadeLength, fadeLength, 1.0f, 0.0f);
+        
+        if (hasPendingState)
+        {
+            engineParameters.publish (pendingState.knob, pendingState.mode);
+            hasPendingState = false;
+        }
+        
+        if (nextSetup.load() != nullptr && retiredSetup.load() == nullptr)
+            swapSetup();
+        
+        fadeState = fadingIn;
+    }
+    else if (fadeState == fadingIn)
+    {
+        buffer.applyGainRamp (0, fadeLength, 0.0f, 1.0f);
+        fadeState = notFading;
+    }
+    
+    meters.measureOutput (buffer, numChannels);
+    analyzer.push (buffer);
+}
+
+void TheKnobAudioProcessor::updateQualityTier (bool realtime)
+{
+    auto mode = qualityMode.load();
+    
+    // switching to automatic starts from the top again, with nothing measured
+    if (mode != lastQualityMode && mode == qualityAutomatic)
+        governor.reset();
+    
+    lastQualityMode = mode;
+    
+    // bounces aren't in a hurry, so the governor leaves them at full quality
+    auto tier = mode != qualityAutomatic ? (int) mode - 1
+                                         : realtime ? governor.getTier() : (int) theknob::fullQualityTier;
+    
+    setup->engine.setQualityTier (tier);
+    
+    if (setup->pipeline != nullptr)
+        setup->pipeline->setQualityTier (tier);
+}
+
+void TheKnobAudioProcessor::updateEngineParameters()
+{
+    BinaryState::Data recalledState;
+    
+    if (stateMailbox.read (recalledState))
+    {
+        pendingState = recalledState;
+        hasPendingState = true;
+    }
+    
+    // the parameters belong to the recalled state until it's faded in
+    if (fadeState != notFading)
+        return;
+    
+    if (hasPendingState)
+    {
+        auto current = engineParameters.load();
+        
+        if (pendingState.knob != current.knob || pendingState.mode != current.mode)
+        {
+            fadeState = fadingOut;
+            return;
+        }
+        
+        hasPendingState = false;
+    }
+    
+    engineParameters.publish (knobParameter->load(), (int) modeParameter->load());
+    
+    // a new setup waits until the message thread has deleted the last one it replaced
+    if (nextSetup.load() != nullptr && retiredSetup.load() == nullptr)
+        fadeState = fadingOut;
 }
 
 //==============================================================================
 void TheKnobAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    auto state = parameters.copyState();
-    std::unique_ptr<juce::XmlElement> xml (state.createXml());
-    copyXmlToBinary (*xml, destData);
+    BinaryState::Data state;
+    state.knob = knobParameter->load();
+    state.mode = (int) modeParameter->load();
+    state.flags = (juce::uint32) pipelineMode
+                    | (linearPhaseEQ ? BinaryState::linearPhaseEQFlag : 0)
+                    | (convolutionReverb ? BinaryState::convolutionReverbFlag : 0)
+                    | (reducedRateWetPaths ? BinaryState::reducedRateFlag : 0)
+                    | ((juce::uint32) qualityMode.load() << BinaryState::qualityModeShift);
+    BinaryState::write (state, destData);
+    BinaryState::writeImpulseResponsePath (impulseResponseFile.getFullPathName(), destData);
 }
 
 void TheKnobAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    BinaryState::Data state;
+
+    if (BinaryState::read (data, sizeInBytes, state))
+    {
+        auto path = BinaryState::readImpulseResponsePath (data, sizeInBytes);
+        setImpulseResponseFile (juce::File::isAbsolutePath (path) ? juce::File (path) : juce::File());
+        applyState (state);
+        return;
+    }
+
+    // legacy (v1.1 and earlier) XML state
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
 
     if (xmlState.get() != nullptr)
     {
         if (xmlState->hasTagName (parameters.state.getType()))
         {
-            parameters.replaceState (juce::ValueTree::fromXml (*xmlState));
+            state.knob = knobParameter->load();
+            state.mode = (int) modeParameter->load();
+            
+            for (auto* param : xmlState->getChildWithTagNameIterator ("PARAM"))
+            {
+                if (param->getStringAttribute ("id") == "knob")
+                    state.knob = (float) param->getDoubleAttribute ("value", state.knob);
+                else if (param->getStringAttribute ("id") == "mode")
+                    state.mode = param->getIntAttribute ("value", state.mode);
+            }
+            
+            if (BinaryState::makeLegal (state))
+                applyState (state);
         }
     }
 }
 
+void TheKnobAudioProcessor::applyState (const BinaryState::Data& state)
+{
+    // the audio thread takes the new values from the mailbox (never mid-block), the parameters are only updated for the host and the editor
+    stateMailbox.write (state);
+    
+    auto setParameter = [] (juce::RangedAudioParameter* param, float value)
+    {
+        param->setValueNotifyingHost (param->convertTo0to1 (param->getNormalisableRange().snapToLegalValue (value)));
+    };
+
+    setParameter (parameters.getParameter ("knob"), state.knob);
+    setParameter (parameters.getParameter ("mode"), (float) state.mode);
+    
+    auto newPipelineMode = (int) (state.flags & BinaryState::pipelineModeMask);
+    setPipelineMode (newPipelineMode <= pipelineReverbAndDelay ? (PipelineMode) newPipelineMode : pipelineOff);
+    setLinearPhaseEQ ((state.flags & BinaryState::linearPhaseEQFlag) != 0);
+    setConvolutionReverb ((state.flags & BinaryState::convolutionReverbFlag) != 0);
+    setReducedRateWetPaths ((state.flags & BinaryState::reducedRateFlag) != 0);
+    setQualityMode ((QualityMode) ((state.flags & BinaryState::qualityModeMask) >> BinaryState::qualityModeShift));
+}
+
 //==============================================================================
-void TheKnobAudioProcessor::initialiseGraph()
+void TheKnobAudioProcessor::setPipelineMode (PipelineMode newMode)
 {
-    mainProcessor->clear();
+    if (newMode == pipelineMode)
+        return;
     
-    // I/O nodes & processors
-    audioInputNode = mainProcessor->addNode (std::make_unique<AudioGraphIOProcessor> (AudioGraphIOProcessor::audioInputNode));
-    audioOutputNode = mainProcessor->addNode (std::make_unique<AudioGraphIOProcessor> (AudioGraphIOProcessor::audioOutputNode));
+    pipelineMode = newMode;
+    requestNewSetup();
+}
+
+void TheKnobAudioProcessor::setLinearPhaseEQ (bool shouldBeLinearPhase)
+{
+    if (shouldBeLinearPhase == linearPhaseEQ)
+        return;
     
-    // FX nodes & processors
-    filterNode = mainProcessor->addNode (std::make_unique<FilterProcessor>(knobParameter, modeParameter));
-    eqNode = mainProcessor->addNode (std::make_unique<EQProcessor>(knobParameter, modeParameter));
-    specialEqNode = mainProcessor->addNode (std::make_unique<SpecialEQProcessor>(knobParameter, modeParameter));
-    reverbNode = mainProcessor->addNode (std::make_unique<ReverbProcessor>(knobParameter, modeParameter));
-    delayNode = mainProcessor->addNode (std::make_unique<DelayProcessor>(knobParameter, modeParameter));
-    distortionNode = mainProcessor->addNode (std::make_unique<DistortionProcessor>(knobParameter, modeParameter));
+    linearPhaseEQ = shouldBeLinearPhase;
+    requestNewSetup();
+}
+
+void TheKnobAudioProcessor::setConvolutionReverb (bool shouldBeConvolution)
+{
+    if (shouldBeConvolution == convolutionReverb)
+        return;
+    
+    convolutionReverb = shouldBeConvolution;
+    requestNewSetup();
+}
+
+void TheKnobAudioProcessor::setReducedRateWetPaths (bool shouldReduceRate)
+{
+    if (shouldReduceRate == reducedRateWetPaths)
+        return;
+    
+    reducedRateWetPaths = shouldReduceRate;
+    requestNewSetup();
+}
+
+void TheKnobAudioProcessor::setImpulseResponseFile (const juce::File& file)
+{
+    if (file == impulseResponseFile)
+        return;
+    
+    // a file that can't be read leaves the captured responses
+    impulseResponseFile = loadImpulseResponse (file) ? file : juce::File();
+    
+    if (convolutionReverb)
+        requestNewSetup();
+}
+
+bool TheKnobAudioProcessor::loadImpulseResponse (const juce::File& file)
+{
+    impulseResponse.reset();
+    
+    if (file == juce::File())
+        return false;
+    
+    // WAV files are read straight out of a memory-mapped view of the whole file, anything else through the format's own reader
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader (wav.createMemoryMappedReader (file));
+    
+    if (mappedReader != nullptr && mappedReader->mapEntireFile())
+    {
+        reader = std::move (mappedReader);
+    }
+    else
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        reader.reset (formatManager.createReaderFor (file));
+    }
+    
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0)
+        return false;
+    
+    auto length = (int) juce::jmin (reader->lengthInSamples, (juce::int64) (reader->sampleRate * theknob::ConvolutionReverbStage::maxSeconds));
+    auto numChannels = (int) juce::jmin (2u, reader->numChannels);
+    
+    auto loaded = std::make_shared<LoadedImpulseResponse>();
+    loaded->samples.setSize (numChannels, length);
+    loaded->sampleRate = reader->sampleRate;
+    
+    if (! reader->read (&loaded->samples, 0, length, 0, true, numChannels > 1))
+        return false;
+    
+    impulseResponse = std::move (loaded);
+    return true;
+}
+
+void TheKnobAudioProcessor::configureWetStages (theknob::Engine& target, const SetupOptions& options, double sampleRate) const
+{
+    target.setReducedRateWetPaths (options.reducedRateWetPaths);
+    
+    // offline, the responses are captured as the knob moves and all of the convolution runs on the audio thread, so bounces don't depend on timing
+    target.setConvolutionReverb (options.convolutionReverb, ! isNonRealtime());
+    
+    if (! options.convolutionReverb || options.impulseResponse == nullptr)
+    {
+        target.setImpulseResponse (nullptr, 0, 0);
+        return;
+    }
     
-    connectGraph();
+    auto& samples = options.impulseResponse->samples;
+    auto numChannels = samples.getNumChannels();
+    auto length = samples.getNumSamples();
+    
+    if (options.impulseResponse->sampleRate == sampleRate)
+    {
+        target.setImpulseResponse (samples.getArrayOfReadPointers(), numChannels, length);
+        return;
+    }
+    
+    // the file's rate isn't the session's
+    auto ratio = options.impulseResponse->sampleRate / sampleRate;
+    auto resampledLength = (int) std::ceil (length / ratio);
+    juce::AudioSampleBuffer resampled (numChannels, resampledLength);
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        juce::LagrangeInterpolator interpolator;
+        interpolator.process (ratio, samples.getReadPointer (ch), resampled.getWritePointer (ch), resampledLength, length, 0);
+    }
+    
+    target.setImpulseResponse (resampled.getArrayOfReadPointers(), numChannels, resampledLength);
 }
 
-void TheKnobAudioProcessor::connectGraph()
+//==============================================================================
+TheKnobAudioProcessor::SetupOptions TheKnobAudioProcessor::getSetupOptions() const
 {
-    for (auto& conn : mainProcessor->getConnections())
+    SetupOptions options;
+    options.pipelineMode = pipelineMode;
+    options.linearPhaseEQ = linearPhaseEQ;
+    options.convolutionReverb = convolutionReverb;
+    options.reducedRateWetPaths = reducedRateWetPaths;
+    options.impulseResponse = impulseResponse;
+    return options;
+}
+
+std::unique_ptr<TheKnobAudioProcessor::EngineSetup> TheKnobAudioProcessor::createSetup (const SetupOptions& options, double sampleRate, int samplesPerBlock) const
+{
+    auto newSetup = std::make_unique<EngineSetup>();
+    auto& engine = newSetup->engine;
+    auto pipelined = options.pipelineMode != pipelineOff;
+    auto withDelay = options.pipelineMode == pipelineReverbAndDelay;
+    
+    engine.setDetachedStages (pipelined, withDelay);
+    
+    // offline, the linear-phase EQ is designed as the knob moves instead of in the background, so bounces don't depend on timing
+    engine.setLinearPhaseEQ (options.linearPhaseEQ, ! isNonRealtime());
+    configureWetStages (engine, options, sampleRate);
+    engine.setParameters (engineParameters.load());
+    engine.prepare (sampleRate, samplesPerBlock);
+    
+    if (pipelined)
     {
-        mainProcessor->removeConnection (conn);
+        newSetup->pipeline = std::make_unique<PipelinedProcessor> (&engineParameters, withDelay);
+        
+        // the reverb runs in the worker's engine
+        configureWetStages (newSetup->pipeline->getEngine(), options, sampleRate);
+        newSetup->pipeline->prepare (sampleRate, samplesPerBlock);
+        newSetup->stereoBuffer.setSize (2, juce::jmax (1, samplesPerBlock));
     }
     
-    if ((int)*knobParameter == 0)
+    // the pipelined reverb hands its output back one block later
+    newSetup->latencySamples = engine.getLatencySamples() + (pipelined ? samplesPerBlock : 0);
+    return newSetup;
+}
+
+void TheKnobAudioProcessor::requestNewSetup()
+{
+    setupRequested = true;
+    
+    // not playing: the next prepareToPlay() builds it
+    if (prepared)
+        startTimer (20);
+}
+
+void TheKnobAudioProcessor::swapSetup() noexcept
+{
+    // the old setup is retired before the new one is taken, so the message thread can't see both slots empty in between and stop
+    // looking for it
+    retiredSetup = setup.release();
+    setup.reset (nextSetup.exchange (nullptr));
+    setupLatencySamples = setup->latencySamples;
+}
+
+void TheKnobAudioProcessor::discardPendingSetups()
+{
+    stopTimer();
+    
+    // a build can't be interrupted, but it's never more than a prepare
+    setupBuilder.removeAllJobs (false, -1);
+    delete nextSetup.exchange (nullptr);
+    delete retiredSetup.exchange (nullptr);
+}
+
+void TheKnobAudioProcessor::timerCallback()
+{
+    // the setup the audio thread swapped out is deleted here, with its threads, and the host is told about the new one's latency
+    if (auto* retired = retiredSetup.exchange (nullptr))
     {
-        for (int channel = 0; channel < 2; ++channel)
+        delete retired;
+        
+        if (setupLatencySamples != getLatencySamples())
         {
-            mainProcessor->addConnection ({ { audioInputNode->nodeID, channel }, { audioOutputNode->nodeID, channel } });
+            setLatencySamples (setupLatencySamples);
+            updateHostDisplay (juce::AudioProcessorListener::ChangeDetails().withLatencyChanged (true));
         }
     }
-    else
+    
+    // one build at a time, with the options as they are when it starts: anything changed while it runs gets the next one
+    if (setupRequested && prepared && setupBuilder.getNumJobs() == 0)
     {
-        switch((int)*modeParameter)
+        setupRequested = false;
+        
+        setupBuilder.addJob ([this, options = getSetupOptions(), sampleRate = getSampleRate(), blockSize = getBlockSize()]
         {
-            case VIOLET:
-                for (int channel = 0; channel < 2; ++channel)
-                {
-                    // order: filter -> distortion -> reverb -> delay -> EQ -> Special EQ
-                    mainProcessor->addConnection ({ { audioInputNode->nodeID, channel }, { filterNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { filterNode->nodeID, channel }, { distortionNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { distortionNode->nodeID, channel }, { reverbNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { reverbNode->nodeID, channel }, { delayNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { delayNode->nodeID, channel }, { eqNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { eqNode->nodeID, channel }, { specialEqNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { specialEqNode->nodeID, channel }, { audioOutputNode->nodeID, channel } });
-                }
-                break;
-                
-            case TEAL:
-                for (int channel = 0; channel < 2; ++channel)
-                {
-                    // order: filter -> EQ -> distortion -> delay -> reverb -> Special EQ
-                    mainProcessor->addConnection ({ { audioInputNode->nodeID, channel }, { filterNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { filterNode->nodeID, channel }, { eqNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { eqNode->nodeID, channel }, { distortionNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { distortionNode->nodeID, channel }, { delayNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { delayNode->nodeID, channel }, { reverbNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { reverbNode->nodeID, channel }, { specialEqNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { specialEqNode->nodeID, channel }, { audioOutputNode->nodeID, channel } });
-                }
-                break;
-                
-            case CRIMSON:
-                for (int channel = 0; channel < 2; ++channel)
-                {
-                    // order: filter -> EQ -> delay -> reverb -> distortion -> Special EQ
-                    mainProcessor->addConnection ({ { audioInputNode->nodeID, channel }, { filterNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { filterNode->nodeID, channel }, { eqNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { eqNode->nodeID, channel }, { delayNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { delayNode->nodeID, channel }, { reverbNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { reverbNode->nodeID, channel }, { distortionNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { distortionNode->nodeID, channel }, { specialEqNode->nodeID, channel } });
-                    mainProcessor->addConnection ({ { specialEqNode->nodeID, channel }, { audioOutputNode->nodeID, channel } });
-                }
-                break;
-        }
+            auto newSetup = createSetup (options, sampleRate, blockSize);
+            
+            // if the audio thread hasn't taken the last one yet, this one replaces it
+            delete nextSetup.exchange (newSetup.release());
+        });
     }
+    
+    if (! setupRequested && setupBuilder.getNumJobs() == 0 && nextSetup.load() == nullptr && retiredSetup.load() == nullptr)
+        stopTimer();
 }
 
-
 //==============================================================================
 // This creates new instances of the plugin..
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -10,30 +10,45 @@
 
 #include <JuceHeader.h>
 #include "PluginEditor.h"
-#include "FXProcessors.h"
+#include "../TheKnobDSP/Source/Engine.h"
+#include "BinaryState.h"
+#include "TripleBuffer.h"
+#include "PipelinedProcessor.h"
+#include "EngineOptions.h"
+#include "LevelMeter.h"
+#include "Analyzer.h"
+#include "../TheKnobDSP/Source/QualityGovernor.h"
 
 
 //==============================================================================
 /**
 */
-class TheKnobAudioProcessor  : public juce::AudioProcessor
+class TheKnobAudioProcessor  : public juce::AudioProcessor,
+                               public EngineOptions,
+                               private juce::Timer
 {
 public:
-    //==============================================================================
-    using AudioGraphIOProcessor = juce::AudioProcessorGraph::AudioGraphIOProcessor;
-    using Node = juce::AudioProcessorGraph::Node;
-    
     //==============================================================================
     TheKnobAudioProcessor();
     ~TheKnobAudioProcessor() override;
 
     //==============================================================================
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
     
-    void releaseResources() override
-    {
-        mainProcessor->releaseResources();
-    }
+    //==============================================================================
+    PipelineMode getPipelineMode() const override                { return pipelineMode; }
+    void setPipelineMode (PipelineMode newMode) override;
+    bool getLinearPhaseEQ() const override                       { return linearPhaseEQ; }
+    void setLinearPhaseEQ (bool shouldBeLinearPhase) override;
+    bool getConvolutionReverb() const override                   { return convolutionReverb; }
+    void setConvolutionReverb (bool shouldBeConvolution) override;
+    juce::File getImpulseResponseFile() const override           { return impulseResponseFile; }
+    void setImpulseResponseFile (const juce::File& file) override;
+    bool getReducedRateWetPaths() const override                 { return reducedRateWetPaths; }
+    void setReducedRateWetPaths (bool shouldReduceRate) override;
+    QualityMode getQualityMode() const override                  { return qualityMode; }
+    void setQualityMode (QualityMode newMode) override           { qualityMode = newMode; }
 
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override
     {
@@ -49,7 +64,7 @@ public:
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     //==============================================================================
-    juce::AudioProcessorEditor* createEditor() override          { return new PluginEditor (*this, parameters); }
+    juce::AudioProcessorEditor* createEditor() override          { return new PluginEditor (*this, parameters, *this, meters, analyzer); }
     bool hasEditor() const override                              { return true; }
 
     //==============================================================================
@@ -72,22 +87,89 @@ public:
 
 private:
     //==============================================================================
-    void initialiseGraph();
-    void connectGraph();
+    // Everything an engine option changes. When one does, a new setup is built and prepared while the old one keeps playing, and the
+    // audio thread swaps it in at a block boundary, with the same fade as a state recall.
+    struct EngineSetup
+    {
+        // all of the DSP lives in the engine (TheKnobDSP), the processor only feeds it the parameters and the host's audio
+        theknob::Engine engine;
+        
+        // runs the engine's detached reverb (and delay) on a worker thread when the pipeline is on
+        std::unique_ptr<PipelinedProcessor> pipeline;
+        
+        // the pipelined chain is always stereo, mono audio goes through this with a silent right channel. It's the prepared block size,
+        // the most the pipeline takes at once.
+        juce::AudioSampleBuffer stereoBuffer;
+        
+        int latencySamples = 0;
+    };
+    
+    // the convolution reverb's own response, as read from the file. A setup being built keeps hold of the one it was given.
+    struct LoadedImpulseResponse
+    {
+        juce::AudioSampleBuffer samples;
+        double sampleRate = 0.0;
+    };
+    
+    // the options a setup is built with, copied on the message thread for the thread that builds it
+    struct SetupOptions
+    {
+        PipelineMode pipelineMode = pipelineOff;
+        bool linearPhaseEQ = false;
+        bool convolutionReverb = false;
+        bool reducedRateWetPaths = false;
+        std::shared_ptr<const LoadedImpulseResponse> impulseResponse;
+    };
     
     //==============================================================================
-
-    std::unique_ptr<juce::AudioProcessorGraph> mainProcessor;
-
-    Node::Ptr audioInputNode;
-    Node::Ptr audioOutputNode;
-
-    Node::Ptr filterNode;
-    Node::Ptr eqNode;
-    Node::Ptr specialEqNode;
-    Node::Ptr reverbNode;
-    Node::Ptr delayNode;
-    Node::Ptr distortionNode;
+    void applyState (const BinaryState::Data& state);
+    void updateEngineParameters();
+    SetupOptions getSetupOptions() const;
+    std::unique_ptr<EngineSetup> createSetup (const SetupOptions& options, double sampleRate, int samplesPerBlock) const;
+    void requestNewSetup();
+    void swapSetup() noexcept;
+    void discardPendingSetups();
+    void timerCallback() override;
+    void configureWetStages (theknob::Engine& target, const SetupOptions& options, double sampleRate) const;
+    void updateQualityTier (bool realtime);
+    bool loadImpulseResponse (const juce::File& file);
+    
+    //==============================================================================
+    // the setup the audio thread plays through. Only replaced by prepareToPlay(), or by the audio thread itself.
+    std::unique_ptr<EngineSetup> setup;
+    
+    // a new setup waiting for the audio thread (only the latest), and the one it replaced, waiting to be deleted on the message thread
+    std::atomic<EngineSetup*> nextSetup { nullptr };
+    std::atomic<EngineSetup*> retiredSetup { nullptr };
+    std::atomic<int> setupLatencySamples { 0 };
+    
+    // between prepareToPlay() and releaseResources(). Options changed outside of that are picked up by the next prepareToPlay().
+    bool prepared = false;
+    
+    // Set when an option changes. The timer builds one setup for however many options changed since it last looked (a state recall
+    // sets them all at once), on setupBuilder, so neither the message thread nor the audio thread waits for the prepare (or for the
+    // convolution reverb's first response to be captured).
+    bool setupRequested = false;
+    juce::ThreadPool setupBuilder { 1 };
+    
+    // input and output levels for the editor's meters
+    LevelMeters meters;
+    
+    PipelineMode pipelineMode = pipelineOff;
+    bool linearPhaseEQ = false;
+    bool convolutionReverb = false;
+    bool reducedRateWetPaths = false;
+    
+    // set from the message thread, read by the audio thread at the start of each block
+    std::atomic<QualityMode> qualityMode { qualityAutomatic };
+    
+    // picks the tier from how long the blocks take, when the quality mode is automatic. Only touched by the audio thread.
+    theknob::QualityGovernor governor;
+    QualityMode lastQualityMode = qualityAutomatic;
+    
+    // the convolution reverb's own response (none for the captured ones)
+    juce::File impulseResponseFile;
+    std::shared_ptr<const LoadedImpulseResponse> impulseResponse;
     
     //==============================================================================
     
@@ -96,8 +178,26 @@ private:
     std::atomic<float>* knobParameter  = nullptr;
     std::atomic<float>* modeParameter  = nullptr;
     
-    float prevMode;
-    float prevKnobValue;
+    // The values the engine actually runs with. They're only published by the audio thread at the start of a block, as one snapshot, so the whole block (and the pipeline's worker) sees the same knob and mode, and nothing downstream recalculates unless its version changes.
+    theknob::SharedParameters engineParameters;
+    
+    // the output spectrum and the EQ curve for the editor, worked out on its own thread while the editor is open
+    Analyzer analyzer { &engineParameters };
+    
+    //==============================================================================
+    // State recalls are handed to the audio thread through this mailbox, and applied with a short fade out/in at the next block boundary.
+    enum FadeState
+    {
+        notFading,
+        fadingOut,
+        fadingIn
+    };
+    
+    TripleBuffer<BinaryState::Data> stateMailbox;
+    BinaryState::Data pendingState;
+    bool hasPendingState = false;
+    FadeState fadeState = notFading;
+    int fadeLengthSamples = 0;
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TheKnobAudioProcessor)
@@ -45,7 +45,8 @@ void RadioButtonAttachment::setBounds(int x, int y, int width, int height, int m
     }
 }
 
-// FIXME: automation no worky
+// Only a click is a gesture. buttonStateChanged() also fires on every hover and mouse-down, and answering those sent the host extra
+// gestures (on a mouse-down, for the button that was still selected) that could be written over its automation.
 void RadioButtonAttachment::buttonClicked (juce::Button* b)
 {
     if (ignoreCallbacks)
@@ -58,22 +59,11 @@ void RadioButtonAttachment::buttonClicked (juce::Button* b)
     }
 }
 
-void RadioButtonAttachment::buttonStateChanged(juce::Button* b)
-{
-    if (ignoreCallbacks) {
-        return;
-    }
-    
-    for (int i=0; i<buttons.size(); i++) {
-        if (b == buttons.getUnchecked(i) && b->getToggleState()) {
-            attachment.setValueAsCompleteGesture(i);
-        }
-    }
-}
-
 void RadioButtonAttachment::setValue (float newValue)
 {
     value = newValue;
     const juce::ScopedValueSetter<bool> svs (ignoreCallbacks, true);
-    buttons[value]->setToggleState(true, juce::sendNotification);
+    
+    if (auto* button = buttons[juce::roundToInt (value)].getComponent())
+        button->setToggleState(true, juce::sendNotification);
 }
@@ -31,7 +31,6 @@ private:
     float value;
 
     void buttonClicked (juce::Button* b) override;
-    void buttonStateChanged(juce::Button* b) override;
 
     juce::RangedAudioParameter& storedParameter;
     juce::ParameterAttachment attachment;
@@ -0,0 +1,49 @@
+//
+//  TripleBuffer.h
+//  TheKnob
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <atomic>
+
+/*
+ A wait-free single-producer, single-consumer mailbox: the writer always has a slot of its own to fill, the reader always has a slot of its own to read, and the third slot is swapped between them with a single atomic exchange. Neither side ever blocks or sees a half-written value; if the writer publishes several times before the reader looks, the reader just gets the latest one.
+ */
+
+template <typename Type>
+class TripleBuffer
+{
+public:
+    // producer: the message thread for state recalls, the audio thread for the meters
+    void write (const Type& value) noexcept
+    {
+        slots[writeIndex] = value;
+        writeIndex = middle.exchange (writeIndex | newDataFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // consumer: returns false (and leaves value untouched) if nothing new has been written
+    bool read (Type& value) noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & newDataFlag) == 0)
+            return false;
+
+        readIndex = middle.exchange (readIndex, std::memory_order_acq_rel) & indexMask;
+        value = slots[readIndex];
+        return true;
+    }
+
+private:
+    enum
+    {
+        indexMask = 3,
+        newDataFlag = 4
+    };
+
+    Type slots[3] {};
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle { 2 };
+};
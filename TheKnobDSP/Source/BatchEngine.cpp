@@ -0,0 +1,520 @@
+//
+//  BatchEngine.cpp
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#include "BatchEngine.h"
+
+namespace theknob
+{
+
+BatchEngine::BatchEngine()
+    : chain (Engine::getChain (mode))
+{
+    knobs.fill (KNOB_DEFAULT_VALUE);
+    updateRightChannel();
+}
+
+int BatchEngine::getPreferredNumStreams() noexcept
+{
+    auto isa = getKernels().isa;
+    return isa == Isa::avx2 || isa == Isa::avx512 ? 8 : 4;
+}
+
+//==============================================================================
+void BatchEngine::prepare (double newSampleRate, int maxBlockSize, int newNumStreams)
+{
+    sampleRate = newSampleRate;
+    blockSize = std::max (1, maxBlockSize);
+    numStreams = std::clamp (newNumStreams, 1, (int) maxStreams);
+    numLanes = numStreams <= 4 ? 4 : 8;
+
+    auto lanes = (size_t) numLanes;
+    for (auto& channel : audio)
+        channel.assign ((size_t) blockSize * lanes, 0.0f);
+
+    for (auto* scratch : { &combInput, &combDamping, &combFeedback, &combLeft, &combRight, &dry, &wet1, &wet2, &delayed, &feedbackInput })
+        scratch->assign ((size_t) chunkSize * lanes, 0.0f);
+
+    // every lane's reverb and delay are the same length, as they would be in an Engine at this rate
+    combs.setSizes (Reverb::getCombSizes (sampleRate), numLanes);
+    auto allPassSizes = Reverb::getAllPassSizes (sampleRate);
+
+    for (size_t ch = 0; ch < allPasses.size(); ++ch)
+        for (size_t j = 0; j < allPasses[ch].size(); ++j)
+            allPasses[ch][j].setSize (allPassSizes[ch][j], numLanes);
+
+    delayLineSize = (int) FeedbackDelay::getLineSize ((float) sampleRate);
+
+    for (auto& line : delayLines)
+        line.assign ((size_t) delayLineSize * lanes, 0.0f);
+
+    updateDelayTimes();
+    repeatFilter = IIRCoefficients::makeFirstOrderLowPass ((float) sampleRate, FeedbackDelay::repeatCutoff);
+
+    // the padding lanes get the default knob's coefficients, so there's nothing odd in them
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        for (auto* smoothed : { &damping, &feedback, &dryGain, &wetGain1, &wetGain2 })
+            (*smoothed)[(size_t) lane].reset (sampleRate, Reverb::smoothTime);
+
+        updateLane (lane);
+
+        // an Engine prepared with this knob starts with its reverb already there
+        for (auto* smoothed : { &damping, &feedback, &dryGain, &wetGain1, &wetGain2 })
+            (*smoothed)[(size_t) lane].setCurrentAndTargetValue ((*smoothed)[(size_t) lane].getTargetValue());
+
+        outOfDate[(size_t) lane] = false;
+    }
+
+    reset();
+}
+
+void BatchEngine::reset() noexcept
+{
+    for (auto* filters : { &highPass, &eq[0], &eq[1], &eq[2], &specialEq[0], &specialEq[1], &specialEq[2], &specialEq[3],
+                           &reverbHpf, &reverbLpf, &delayHpf, &delayLpf })
+        filters->reset();
+
+    combs.clear();
+
+    for (auto& channel : allPasses)
+        for (auto& allPass : channel)
+            allPass.clear();
+
+    for (auto& line : delayLines)
+        std::fill (line.begin(), line.end(), 0.0f);
+
+    repeatStates = {};
+    rightLive = {};
+}
+
+void BatchEngine::setKnob (int stream, float newKnob) noexcept
+{
+    if (stream < 0 || stream >= maxStreams)
+        return;
+
+    auto lane = (size_t) stream;
+    newKnob = std::clamp (newKnob, KNOB_MIN_VALUE, KNOB_MAX_VALUE);
+
+    if (newKnob == knobs[lane])
+        return;
+
+    auto wasBypassed = isBypassed (stream);
+    knobs[lane] = newKnob;
+
+    if (isBypassed (stream))
+    {
+        outOfDate[lane] = true;
+        return;
+    }
+
+    // as in an Engine, a stream comes back from bypass without the tails it had when it stopped
+    if (wasBypassed)
+        resetLane (stream);
+
+    updateLane (stream);
+    outOfDate[lane] = false;
+}
+
+void BatchEngine::setMode (int newMode) noexcept
+{
+    newMode = std::clamp (newMode, (int) VIOLET, (int) CRIMSON);
+
+    if (newMode == mode)
+        return;
+
+    mode = newMode;
+    chain = Engine::getChain (mode);
+    updateRightChannel();
+    updateDelayTimes();
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        if (lane < numStreams && isBypassed (lane))
+            outOfDate[(size_t) lane] = true;
+        else
+            updateLane (lane);
+    }
+}
+
+void BatchEngine::setQualityTier (int tier) noexcept
+{
+    qualityTier = std::clamp (tier, (int) fullQualityTier, (int) fastSaturationTier);
+}
+
+//==============================================================================
+void BatchEngine::updateLane (int lane) noexcept
+{
+    auto l = (size_t) lane;
+    auto knob = knobs[l];
+
+    auto filterDesign = FilterStage::design (sampleRate, knob, mode);
+    highPass.setCoefficients (lane, filterDesign.highPass, numLanes);
+
+    auto eqDesign = EQStage::design (sampleRate, knob, mode);
+
+    for (size_t i = 0; i < eq.size(); ++i)
+        eq[i].setCoefficients (lane, eqDesign.filters[i], numLanes);
+
+    // crimson's high- and low-pass keep their last coefficients (and state) in the other modes, as in the SpecialEQStage
+    auto specialDesign = SpecialEQStage::design (sampleRate, knob, mode);
+    specialEq[0].setCoefficients (lane, specialDesign.peaks[0], numLanes);
+    specialEq[1].setCoefficients (lane, specialDesign.peaks[1], numLanes);
+
+    if (mode == CRIMSON)
+    {
+        specialEq[2].setCoefficients (lane, specialDesign.highPass, numLanes);
+        specialEq[3].setCoefficients (lane, specialDesign.lowPass, numLanes);
+    }
+
+    auto reverbDesign = ReverbStage::design (sampleRate, knob, mode);
+    auto targets = Reverb::getTargets (reverbDesign.reverb);
+    reverbGain[l] = targets.gain;
+    damping[l].setTargetValue (targets.damping);
+    feedback[l].setTargetValue (targets.feedback);
+    dryGain[l].setTargetValue (targets.dryGain);
+    wetGain1[l].setTargetValue (targets.wetGain1);
+    wetGain2[l].setTargetValue (targets.wetGain2);
+    reverbHpf.setCoefficients (lane, reverbDesign.hpf, numLanes);
+    reverbLpf.setCoefficients (lane, reverbDesign.lpf, numLanes);
+
+    auto delayDesign = DelayStage::design (sampleRate, knob, mode);
+    delayWetLevel[l] = delayDesign.wetLevel;
+    delayFeedback[l] = delayDesign.feedback;
+    delayHpf.setCoefficients (lane, delayDesign.hpf, numLanes);
+    delayLpf.setCoefficients (lane, delayDesign.lpf, numLanes);
+
+    auto distortionDesign = DistortionStage::design (sampleRate, knob, mode);
+    preGain[l] = distortionDesign.preGain;
+    postGain[l] = distortionDesign.postGain;
+}
+
+void BatchEngine::resetLane (int lane) noexcept
+{
+    for (auto* filters : { &highPass, &eq[0], &eq[1], &eq[2], &specialEq[0], &specialEq[1], &specialEq[2], &specialEq[3],
+                           &reverbHpf, &reverbLpf, &delayHpf, &delayLpf })
+        filters->resetLane (lane, numLanes);
+
+    combs.clearLane (lane);
+
+    for (auto& channel : allPasses)
+        for (auto& allPass : channel)
+            allPass.clearLane (lane);
+
+    for (auto& line : delayLines)
+        for (size_t i = (size_t) lane; i < line.size(); i += (size_t) numLanes)
+            line[i] = 0.0f;
+
+    for (auto& state : repeatStates)
+        state[(size_t) lane] = 0.0f;
+}
+
+void BatchEngine::updateDelayTimes() noexcept
+{
+    const std::array<float, 2> times { DELAY_TIME_L[(size_t) mode], DELAY_TIME_R[(size_t) mode] };
+
+    for (size_t ch = 0; ch < times.size() && delayLineSize > 0; ++ch)
+        delaySamples[ch] = std::min ((int) FeedbackDelay::getDelaySamples (times[ch], (float) sampleRate), delayLineSize - 1);
+}
+
+void BatchEngine::updateRightChannel() noexcept
+{
+    auto heard = false;
+
+    for (auto position = (int) chain.size(); --position >= 0;)
+    {
+        auto stage = chain[(size_t) position];
+        rightHeardLater[(size_t) position] = heard;
+        usesRight[(size_t) position] = stage == Engine::distortionStage ? heard : stage != Engine::specialEqStage;
+        heard = heard || usesRight[(size_t) position];
+    }
+}
+
+//==============================================================================
+void BatchEngine::process (float* const* streams, int numSamples) noexcept
+{
+    if (numStreams == 0 || numSamples <= 0)
+        return;
+
+    auto anyRunning = false;
+
+    for (int stream = 0; stream < numStreams; ++stream)
+        anyRunning = anyRunning || isRunning (stream);
+
+    if (! anyRunning)
+        return;
+
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        auto count = std::min (blockSize, numSamples - start);
+
+        // the bypassed streams and padding lanes run on silence, and keep it
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const float* source = isRunning (lane) ? streams[lane] + start : nullptr;
+
+            for (int i = 0; i < count; ++i)
+                audio[0][(size_t) (i * numLanes + lane)] = source != nullptr ? source[i] : 0.0f;
+        }
+
+        auto rightSilent = true;
+
+        for (int position = 0; position < (int) chain.size(); ++position)
+            processStage (position, count, rightSilent);
+
+        for (int stream = 0; stream < numStreams; ++stream)
+        {
+            if (! isRunning (stream))
+                continue;
+
+            auto* dest = streams[stream] + start;
+
+            for (int i = 0; i < count; ++i)
+                dest[i] = audio[0][(size_t) (i * numLanes + stream)];
+        }
+    }
+}
+
+void BatchEngine::processStage (int position, int numSamples, bool& rightSilent) noexcept
+{
+    auto stage = chain[(size_t) position];
+    TraceScope span (Engine::getStageName (stage), "stage", "samples", numSamples);
+
+    // a stage whose right channel is silent on the way in, with nothing left in its state, would only make silence
+    auto runRight = usesRight[(size_t) position] && (! rightSilent || rightLive[(size_t) stage]);
+    auto* left = audio[0].data();
+    auto* right = audio[1].data();
+
+    if (runRight && rightSilent)
+        std::fill (audio[1].begin(), audio[1].begin() + numSamples * numLanes, 0.0f);
+
+    if (runRight && stage != Engine::distortionStage)
+        rightLive[(size_t) stage] = true;
+
+    auto processFilter = [&] (LaneFilter& filter)
+    {
+        filter.process (left, numSamples, numLanes);
+
+        if (runRight)
+            filter.process (right, numSamples, numLanes, 1);
+    };
+
+    switch (stage)
+    {
+        case Engine::filterStage:
+            processFilter (highPass);
+            break;
+
+        case Engine::eqStage:
+            for (auto& filter : eq)
+                processFilter (filter);
+            break;
+
+        case Engine::specialEqStage:
+            // always the last stage, so nothing hears its right channel
+            specialEq[0].process (left, numSamples, numLanes);
+            specialEq[1].process (left, numSamples, numLanes);
+
+            if (mode == CRIMSON)
+            {
+                specialEq[2].process (left, numSamples, numLanes);
+                specialEq[3].process (left, numSamples, numLanes);
+            }
+            break;
+
+        case Engine::reverbStage:       processReverb (numSamples, runRight, rightHeardLater[(size_t) position]); break;
+        case Engine::delayStage:        processDelay (numSamples, runRight); break;
+        case Engine::distortionStage:   processDistortion (numSamples, runRight); break;
+        case Engine::numStages:
+        default:                        break;
+    }
+
+    if (runRight || stage == Engine::reverbStage)
+        rightSilent = false;
+}
+
+void BatchEngine::processReverb (int numSamples, bool runRight, bool makeRight) noexcept
+{
+    auto& kernels = getKernels();
+    auto lanes = (size_t) numLanes;
+
+    for (auto* filter : { &reverbHpf, &reverbLpf })
+    {
+        filter->process (audio[0].data(), numSamples, numLanes);
+
+        if (runRight)
+            filter->process (audio[1].data(), numSamples, numLanes, 1);
+    }
+
+    // a silent right channel is l + 0 into the combs, just as it is in the Engine
+    if (! runRight)
+        std::fill (audio[1].begin(), audio[1].begin() + numSamples * numLanes, 0.0f);
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        auto count = std::min (chunkSize, numSamples - start);
+        auto total = (size_t) count * lanes;
+        auto* l = audio[0].data() + (size_t) start * lanes;
+        auto* r = audio[1].data() + (size_t) start * lanes;
+
+        for (size_t i = 0; i < total; i += lanes)
+            for (size_t lane = 0; lane < lanes; ++lane)
+                combInput[i + lane] = (l[i + lane] + r[i + lane]) * reverbGain[lane];
+
+        fillSmoothed (damping, combDamping.data(), count);
+        fillSmoothed (feedback, combFeedback.data(), count);
+        kernels.combLanes (combs, combInput.data(), combDamping.data(), combFeedback.data(), combLeft.data(), combRight.data(), count);
+
+        for (auto& allPass : allPasses[0])
+            kernels.allPassLanes (allPass, combLeft.data(), count);
+
+        for (auto& allPass : allPasses[1])
+            kernels.allPassLanes (allPass, combRight.data(), count);
+
+        fillSmoothed (dryGain, dry.data(), count);
+        fillSmoothed (wetGain1, wet1.data(), count);
+        fillSmoothed (wetGain2, wet2.data(), count);
+
+        auto mix = [&] (float* samples, const float* out, const float* otherOut)
+        {
+            for (size_t i = 0; i < total; ++i)
+            {
+                samples[i] = out[i] * wet1[i] + otherOut[i] * wet2[i] + samples[i] * dry[i];
+                samples[i] *= ReverbStage::outputGain;
+            }
+        };
+
+        mix (l, combLeft.data(), combRight.data());
+
+        if (makeRight)
+            mix (r, combRight.data(), combLeft.data());
+    }
+}
+
+void BatchEngine::processDelay (int numSamples, bool runRight) noexcept
+{
+    for (auto* filter : { &delayHpf, &delayLpf })
+    {
+        filter->process (audio[0].data(), numSamples, numLanes);
+
+        if (runRight)
+            filter->process (audio[1].data(), numSamples, numLanes, 1);
+    }
+
+    processDelayChannel (0, numSamples);
+
+    if (runRight)
+        processDelayChannel (1, numSamples);
+
+    delayPosition = (delayPosition + numSamples) % delayLineSize;
+}
+
+void BatchEngine::processDelayChannel (int channel, int numSamples) noexcept
+{
+    auto& kernels = getKernels();
+    auto waveshape = qualityTier >= fastSaturationTier ? kernels.waveshapeApproximate : kernels.waveshape;
+    auto lanes = (size_t) numLanes;
+    auto* line = delayLines[(size_t) channel].data();
+    auto& repeatState = repeatStates[(size_t) channel];
+    auto length = delaySamples[(size_t) channel];
+    const auto& c = repeatFilter.c;
+
+    // nothing a chunk reads was written in the same chunk, as in the FeedbackDelay
+    auto maxChunkSize = std::min (chunkSize, length + 1);
+    auto position = delayPosition;
+
+    for (int start = 0; start < numSamples; start += maxChunkSize)
+    {
+        auto count = std::min (maxChunkSize, numSamples - start);
+        auto* samples = audio[(size_t) channel].data() + (size_t) start * lanes;
+
+        // the line is a ring of frames, a sample for each lane, with the oldest at position
+        auto readPosition = (position + delayLineSize - length - 1) % delayLineSize;
+        auto first = std::min (count, delayLineSize - readPosition);
+        std::copy_n (line + (size_t) readPosition * lanes, (size_t) first * lanes, delayed.data());
+        std::copy_n (line, (size_t) (count - first) * lanes, delayed.data() + (size_t) first * lanes);
+
+        // the repeats' LPF, a sample at a time as the FeedbackDelay's processSample() runs it
+        for (int i = 0; i < count; ++i)
+        {
+            for (size_t lane = 0; lane < lanes; ++lane)
+            {
+                auto index = (size_t) i * lanes + lane;
+                auto& state = repeatState[lane];
+                auto input = delayed[index];
+                auto output = c[0] * input + state;
+                state = c[1] * input - c[2] * output;
+
+                delayed[index] = output;
+                feedbackInput[index] = samples[index] + delayFeedback[lane] * output;
+            }
+        }
+
+        waveshape (feedbackInput.data(), count * numLanes, 1.0f, 1.0f, false);
+
+        first = std::min (count, delayLineSize - position);
+        std::copy_n (feedbackInput.data(), (size_t) first * lanes, line + (size_t) position * lanes);
+        std::copy_n (feedbackInput.data() + (size_t) first * lanes, (size_t) (count - first) * lanes, line);
+        position = (position + count) % delayLineSize;
+
+        for (int i = 0; i < count; ++i)
+            for (size_t lane = 0; lane < lanes; ++lane)
+                samples[(size_t) i * lanes + lane] = 1.0f * samples[(size_t) i * lanes + lane] + delayWetLevel[lane] * delayed[(size_t) i * lanes + lane];
+    }
+}
+
+void BatchEngine::processDistortion (int numSamples, bool runRight) noexcept
+{
+    auto& kernels = getKernels();
+    auto waveshape = qualityTier >= fastSaturationTier ? kernels.waveshapeApproximate : kernels.waveshape;
+
+    // the gains are each stream's own, so they go either side of the waveshaper rather than through it
+    for (int ch = 0; ch < (runRight ? 2 : 1); ++ch)
+    {
+        auto* samples = audio[(size_t) ch].data();
+        applyGains (samples, numSamples, preGain);
+        waveshape (samples, numSamples * numLanes, 1.0f, 1.0f, mode == VIOLET);
+        applyGains (samples, numSamples, postGain);
+    }
+}
+
+void BatchEngine::applyGains (float* samples, int numSamples, const LaneValues& gains) const noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+        for (int lane = 0; lane < numLanes; ++lane)
+            samples[i * numLanes + lane] *= gains[(size_t) lane];
+}
+
+void BatchEngine::fillSmoothed (LaneSmoothedValues& values, float* dest, int numSamples) noexcept
+{
+    auto lanes = (size_t) numLanes;
+    LaneValues targets {};
+    std::array<bool, maxStreams> smoothing {};
+    auto anySmoothing = false;
+
+    for (size_t lane = 0; lane < lanes; ++lane)
+    {
+        targets[lane] = values[lane].getTargetValue();
+        smoothing[lane] = isRunning ((int) lane) && values[lane].isSmoothing();
+        anySmoothing = anySmoothing || smoothing[lane];
+    }
+
+    // most of the time nothing's moving, and it's the same frame over and over
+    if (! anySmoothing)
+    {
+        for (size_t i = 0; i < (size_t) numSamples * lanes; i += lanes)
+            std::copy_n (targets.data(), lanes, dest + i);
+
+        return;
+    }
+
+    for (size_t i = 0; i < (size_t) numSamples * lanes; i += lanes)
+        for (size_t lane = 0; lane < lanes; ++lane)
+            dest[i + lane] = smoothing[lane] ? values[lane].getNextValue() : targets[lane];
+}
+
+} // namespace theknob
@@ -0,0 +1,179 @@
+//
+//  BatchEngine.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "Engine.h"
+
+namespace theknob
+{
+
+/*
+ =================================BatchEngine=================================
+
+ TheKnob's chain on up to eight independent mono streams at once (a mixer's tracks, say), one in each lane of the vector registers: 4
+ lanes with SSE2 and NEON, 8 with AVX2 and AVX-512 (getPreferredNumStreams()). Every stream has its own knob and its own state, and they
+ all share the mode and sample rate. That makes every stream's delay line and reverb combs and allpasses the same length, so they're
+ stored a lane after another and each step of the chain is a whole register of streams, with no gathers (the lane kernels in Kernels.h).
+
+ -Each stream comes out bit for bit the same as an Engine would make of it on its own as mono (with setElisionThreshold (-infinity)):
+  the same filters, reverb and delay, with the knob-to-parameter mappings shared through the stages' design(). Only the left channel
+  comes out, and a mono stream's right channel is silent until the reverb, so most of the time that's all that runs. The right channel
+  only runs through a stage once the reverb's right channel has reached it (after violet's reverb), for when a mode switch puts that
+  stage before the reverb, until reset().
+ -prepare() is the only call that allocates. The rest are real-time safe, and have to be called from the same thread (or never at the
+  same time).
+ -A stream with its knob below 1 is bypassed and left untouched, and comes back from a clear state, like an Engine.
+ -The full tier's saturation is std::tanh a sample at a time, as in the Engine, so the distortion and the delay's repeats don't gain
+  anything from the lanes: most of the speed-up comes at fastSaturationTier, where they're vectorised as well. There's no economy tier
+  (it runs as fastSaturationTier), and nothing is elided, run at a reduced rate, linear phase or by convolution.
+ */
+class BatchEngine
+{
+public:
+    static constexpr int maxStreams = LaneCombBank::maxLanes;
+
+    BatchEngine();
+
+    // How many streams fill the registers of the ISA the kernels are running with
+    static int getPreferredNumStreams() noexcept;
+
+    //==============================================================================
+    // Allocates for numStreams streams (1 to maxStreams) at this rate, and clears everything. process() runs the chain maxBlockSize
+    // samples at a time, like an Engine's mono processing.
+    void prepare (double sampleRate, int maxBlockSize, int numStreams);
+
+    // Clears every stream's delay and reverb tails and filter states
+    void reset() noexcept;
+
+    int getNumStreams() const noexcept                   { return numStreams; }
+
+    void setKnob (int stream, float knob) noexcept;
+    float getKnob (int stream) const noexcept            { return knobs[(size_t) stream]; }
+    bool isBypassed (int stream) const noexcept          { return (int) knobs[(size_t) stream] == 0; }
+
+    // For every stream
+    void setMode (int mode) noexcept;
+    int getMode() const noexcept                         { return mode; }
+
+    // fullQualityTier or fastSaturationTier (economyTier runs as fastSaturationTier). It switches straight away.
+    void setQualityTier (int tier) noexcept;
+    int getQualityTier() const noexcept                  { return qualityTier; }
+
+    // streams holds getNumStreams() pointers to numSamples floats each, which are processed in place
+    void process (float* const* streams, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    // One filter in every lane, each with its own coefficients, and state for each channel
+    struct LaneFilter
+    {
+        void setCoefficients (int lane, const IIRCoefficients& newCoefficients, int numLanes) noexcept
+        {
+            // as with IIRFilter, a lane whose order changes starts again from silence
+            if (newCoefficients.order != orders[(size_t) lane])
+                resetLane (lane, numLanes);
+
+            orders[(size_t) lane] = order = newCoefficients.order;
+
+            for (size_t c = 0; c < newCoefficients.c.size(); ++c)
+                coefficients[c * (size_t) numLanes + (size_t) lane] = newCoefficients.c[c];
+        }
+
+        void reset() noexcept                            { states = {}; }
+
+        void resetLane (int lane, int numLanes) noexcept
+        {
+            for (auto& state : states)
+                state[(size_t) lane] = state[(size_t) (numLanes + lane)] = 0.0f;
+        }
+
+        void process (float* samples, int numSamples, int numLanes, int channel = 0) noexcept
+        {
+            getKernels().biquadLanes (coefficients.data(), order, states[(size_t) channel].data(), samples, numSamples, numLanes);
+        }
+
+        std::array<float, 5 * maxStreams> coefficients {};
+        std::array<std::array<float, 2 * maxStreams>, 2> states {};
+        std::array<int, maxStreams> orders {};
+        int order = 0;
+    };
+
+    using LaneValues = std::array<float, maxStreams>;
+    using LaneSmoothedValues = std::array<LinearSmoothedValue, maxStreams>;
+
+    // the reverb and delay work through their blocks a chunk at a time, as they do in the Engine
+    static constexpr int chunkSize = 256;
+
+    bool isRunning (int lane) const noexcept            { return lane < numStreams && ! isBypassed (lane); }
+    void updateLane (int lane) noexcept;
+    void resetLane (int lane) noexcept;
+    void updateDelayTimes() noexcept;
+
+    // Which of the chain's stages need their right channel: the ones with state (but the special EQ, which always comes last), and the
+    // distortion when one of those comes after it
+    void updateRightChannel() noexcept;
+
+    // rightSilent says whether the right channel is silent on the way in, and is updated for the way out
+    void processStage (int position, int numSamples, bool& rightSilent) noexcept;
+    void processReverb (int numSamples, bool runRight, bool makeRight) noexcept;
+    void processDelay (int numSamples, bool runRight) noexcept;
+    void processDelayChannel (int channel, int numSamples) noexcept;
+    void processDistortion (int numSamples, bool runRight) noexcept;
+
+    // samples[i * numLanes + lane] *= gains[lane]
+    void applyGains (float* samples, int numSamples, const LaneValues& gains) const noexcept;
+
+    // Each running lane's next numSamples values, and the rest's targets (a bypassed stream's smoothing waits for it, as in the Engine)
+    void fillSmoothed (LaneSmoothedValues& values, float* dest, int numSamples) noexcept;
+
+    //==============================================================================
+    double sampleRate = 44100.0;
+    int blockSize = 0, numStreams = 0, numLanes = 4;
+
+    LaneValues knobs;
+    std::array<bool, maxStreams> outOfDate {};
+    int mode = VIOLET;
+    Engine::Chain chain;
+    int qualityTier = fullQualityTier;
+
+    // the block being processed, each channel interleaved
+    std::array<std::vector<float>, 2> audio;
+
+    // by position in the chain: whether a stage uses its right channel, and whether one after it does
+    std::array<bool, Engine::numStages> usesRight {}, rightHeardLater {};
+
+    // by stage: whether its right channel's state has had anything in it since reset()
+    std::array<bool, Engine::numStages> rightLive {};
+
+    LaneFilter highPass;
+    std::array<LaneFilter, 3> eq;
+    std::array<LaneFilter, 4> specialEq;   // the two peaks, then crimson's high- and low-pass
+
+    // reverb
+    LaneFilter reverbHpf, reverbLpf;
+    LaneValues reverbGain {};
+    LaneSmoothedValues damping, feedback, dryGain, wetGain1, wetGain2;
+    LaneCombBank combs;
+    std::array<std::array<LaneAllPass, Reverb::numAllPasses>, Reverb::numChannels> allPasses;
+    std::vector<float> combInput, combDamping, combFeedback, combLeft, combRight, dry, wet1, wet2;
+
+    // delay
+    LaneFilter delayHpf, delayLpf;
+    LaneValues delayWetLevel {}, delayFeedback {};
+    std::array<LaneValues, 2> repeatStates {};
+    IIRCoefficients repeatFilter;
+    std::array<std::vector<float>, 2> delayLines;
+    std::vector<float> delayed, feedbackInput;
+    int delayLineSize = 0, delayPosition = 0;
+    std::array<int, 2> delaySamples {};
+
+    // distortion
+    LaneValues preGain {}, postGain {};
+};
+
+} // namespace theknob
@@ -0,0 +1,290 @@
+//
+//  ConvolutionReverb.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "Stages.h"
+#include "NonUniformConvolver.h"
+
+namespace theknob
+{
+
+/*
+ =================================Convolution Reverb=================================
+
+ The reverb stage played from impulse responses on a NonUniformConvolver, instead of run as a feedback network. It sounds like
+ ReverbStage (it plays what ReverbStage does to an impulse), or like any response the caller gives it.
+
+ -ReverbStage sums its input to mono before the combs, so its wet output is just two responses to L + R, one per output. Those are
+  what's captured: a ReverbStage is run on an impulse in one channel, and the other channel's output is the wet response. The dry path
+  (the stage's filters and its dry level) is still run as it is.
+ -Responses are captured at a grid of knob settings, every 10, for each mode, until the tail has decayed by 90 dB (10 s at most). They
+  are captured per unit of wet level, so between grid points the wet level still follows the knob.
+ -Capturing and partitioning a response takes tens of milliseconds, so setParameters() only posts the knob and mode, and
+  updateImpulseResponse() does the work on whichever thread calls it (the Engine's design thread), like the linear-phase EQ. Responses
+  are handed over through four slots: the audio thread keeps the one it plays and the one it's fading out of until the convolver
+  is done with it, the designer keeps one to fill, and the fourth is swapped between them.
+ -setUserImpulseResponse() plays the caller's response instead, whatever the knob. It's normalised so the louder channel has the same
+  energy as the input.
+ -For offline rendering, setDesignInBackground (false) captures as the parameters change, and runs the whole convolution on the audio
+  thread, so renders don't depend on timing.
+ */
+class ConvolutionReverbStage
+{
+public:
+    static constexpr double maxSeconds = 10.0;
+    static constexpr float gridStep = 10.0f;
+    static constexpr float captureDecayDb = 90.0f;
+
+    // Call before prepare()
+    void setDesignInBackground (bool shouldDesignInBackground) noexcept    { designInBackground = shouldDesignInBackground; }
+
+    // Call before prepare(). Copies the response, any number of channels (only the first two are used). No channels goes back to the
+    // captured responses.
+    void setUserImpulseResponse (const float* const* channels, int numChannels, int length)
+    {
+        numChannels = std::min (numChannels, 2);
+
+        for (auto& channel : userResponse)
+            channel.clear();
+
+        if (channels == nullptr || numChannels <= 0 || length <= 0)
+            return;
+
+        double maxEnergy = 0.0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            userResponse[(size_t) ch].assign (channels[ch], channels[ch] + length);
+
+            double energy = 0.0;
+
+            for (auto sample : userResponse[(size_t) ch])
+                energy += (double) sample * sample;
+
+            maxEnergy = std::max (maxEnergy, energy);
+        }
+
+        // the wet path's input is L + R
+        auto gain = maxEnergy > 0.0 ? (float) (0.5 / std::sqrt (maxEnergy)) : 0.0f;
+
+        for (auto& channel : userResponse)
+            for (auto& sample : channel)
+                sample *= gain;
+    }
+
+    bool hasUserImpulseResponse() const noexcept         { return ! userResponse[0].empty(); }
+
+    // Allocates everything for this sample rate, and loads the first response for the last parameters set
+    void prepare (double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        maxLength = (int) std::ceil (sampleRate * maxSeconds);
+
+        if (hasUserImpulseResponse())
+            maxLength = std::min (maxLength, (int) userResponse[0].size());
+
+        captureStage.prepare (sampleRate);
+
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            captureBuffer[ch].assign ((size_t) maxLength, 0.0f);
+            captureResponse[ch].assign ((size_t) maxLength, 0.0f);
+        }
+
+        for (auto& slot : slots)
+            slot.prepare (maxLength);
+
+        convolver.prepare (maxLength, designInBackground);
+
+        updateFilters();
+        dryGain.reset (sampleRate, gainSmoothingSeconds);
+        wetGain.reset (sampleRate, gainSmoothingSeconds);
+
+        // the first response goes straight in, with nothing to fade from
+        loadedSerial = requestSerial.load();
+        loadedKnob = -1.0f;
+        loadResponse (slots[0]);
+        front = 0;
+        middle = 1;
+        back = 2;
+        spare = 3;
+        convolver.switchTo (&slots[(size_t) front]);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        hpf.reset();
+        lpf.reset();
+        convolver.reset();
+    }
+
+    // audio thread
+    void setParameters (float newKnob, int newMode) noexcept
+    {
+        knob = newKnob;
+        mode = newMode;
+        updateFilters();
+
+        requestedKnob.store (knob, std::memory_order_relaxed);
+        requestedMode.store (mode, std::memory_order_relaxed);
+        requestSerial.fetch_add (1, std::memory_order_release);
+
+        if (! designInBackground)
+            updateImpulseResponse();
+    }
+
+    // Captures the response for the last parameters set, if it isn't the one already loaded. Returns false if there was nothing to do.
+    bool updateImpulseResponse() noexcept
+    {
+        auto serial = requestSerial.load (std::memory_order_acquire);
+
+        if (serial == loadedSerial || maxLength == 0)
+            return false;
+
+        loadedSerial = serial;
+
+        if (hasUserImpulseResponse()
+             || (getGridKnob (requestedKnob.load (std::memory_order_relaxed)) == loadedKnob && requestedMode.load (std::memory_order_relaxed) == loadedMode))
+            return false;
+
+        loadResponse (slots[(size_t) back]);
+        back = middle.exchange (back | newResponseBit, std::memory_order_acq_rel) & slotMask;
+        return true;
+    }
+
+    void process (float* const* channels, int numSamples) noexcept
+    {
+        // a new response, once the convolver has finished fading out of the one before
+        if ((middle.load (std::memory_order_relaxed) & newResponseBit) != 0 && convolver.canSwitch())
+        {
+            auto next = middle.exchange (spare, std::memory_order_acq_rel) & slotMask;
+            spare = front;
+            front = next;
+            convolver.switchTo (&slots[(size_t) front]);
+        }
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            auto count = std::min (chunkSize, numSamples - start);
+            float* chunk[] = { channels[0] + start, channels[1] + start };
+
+            for (int i = 0; i < count; ++i)
+                wetInput[(size_t) i] = (chunk[0][i] + chunk[1][i]) * wetGain.getNextValue();
+
+            hpf.process (chunk, count);
+            lpf.process (chunk, count);
+
+            for (int i = 0; i < count; ++i)
+            {
+                auto gain = dryGain.getNextValue();
+                chunk[0][i] *= gain;
+                chunk[1][i] *= gain;
+            }
+
+            convolver.process (wetInput.data(), chunk, count);
+        }
+    }
+
+    // the knob setting the response for this one is captured at
+    static float getGridKnob (float knob) noexcept
+    {
+        return std::clamp (std::round (knob / gridStep) * gridStep, gridStep, KNOB_MAX_VALUE);
+    }
+
+private:
+    //==============================================================================
+    // the same filters and dry level as ReverbStage, the wet level is the response's
+    void updateFilters() noexcept
+    {
+        auto wetLevel = mapKnobValueToRange (knob, 0, REVERB_WET_LEVEL_MAX_VALUE[mode]);
+        wetGain.setTargetValue (wetLevel);
+        dryGain.setTargetValue ((1.0f - wetLevel) * 2.0f * outputGain);
+
+        hpf.setCoefficients (IIRCoefficients::makeFirstOrderHighPass (sampleRate, mapKnobValueToRange (knob, 10, 300)));
+        lpf.setCoefficients (IIRCoefficients::makeFirstOrderLowPass (sampleRate, mapKnobValueToRange (knob, 20000, 3500)));
+    }
+
+    void loadResponse (ImpulseResponse& slot) noexcept
+    {
+        if (hasUserImpulseResponse())
+        {
+            const float* channels[] = { userResponse[0].data(), userResponse[1].empty() ? userResponse[0].data() : userResponse[1].data() };
+            slot.set (channels, 2, maxLength);
+            return;
+        }
+
+        loadedKnob = getGridKnob (requestedKnob.load (std::memory_order_relaxed));
+        loadedMode = requestedMode.load (std::memory_order_relaxed);
+
+        auto length = std::min (maxLength, (int) std::ceil (getReverbTailLengthSeconds (loadedMode, loadedKnob, captureDecayDb) * sampleRate));
+        auto wetLevel = mapKnobValueToRange (loadedKnob, 0, REVERB_WET_LEVEL_MAX_VALUE[loadedMode]);
+
+        for (int side = 0; side < 2; ++side)
+        {
+            // preparing again clears the reverb and takes its smoothed values straight to the new parameters
+            captureStage.setParameters (loadedKnob, loadedMode);
+            captureStage.prepare (sampleRate);
+
+            for (auto& channel : captureBuffer)
+                std::fill (channel.begin(), channel.begin() + length, 0.0f);
+
+            // an impulse in the other channel, so this one's output is all wet
+            captureBuffer[(size_t) (1 - side)][0] = 1.0f;
+
+            float* capture[] = { captureBuffer[0].data(), captureBuffer[1].data() };
+            captureStage.process (capture, length);
+
+            for (int i = 0; i < length; ++i)
+                captureResponse[(size_t) side][(size_t) i] = captureBuffer[(size_t) side][(size_t) i] / wetLevel;
+        }
+
+        const float* channels[] = { captureResponse[0].data(), captureResponse[1].data() };
+        slot.set (channels, 2, length);
+    }
+
+    //==============================================================================
+    static constexpr int chunkSize = 256;
+    static constexpr int newResponseBit = 4;
+    static constexpr int slotMask = 3;
+    static constexpr double gainSmoothingSeconds = 0.01;
+
+    double sampleRate = 44100.0;
+    int maxLength = 0;
+    bool designInBackground = true;
+    float knob = KNOB_DEFAULT_VALUE;
+    int mode = VIOLET;
+
+    // posted by the audio thread
+    std::atomic<float> requestedKnob { KNOB_DEFAULT_VALUE };
+    std::atomic<int> requestedMode { VIOLET };
+    std::atomic<unsigned int> requestSerial { 0 };
+
+    // the designer's
+    unsigned int loadedSerial = 0;
+    float loadedKnob = -1.0f;
+    int loadedMode = VIOLET;
+    ReverbStage captureStage;
+    std::array<std::vector<float>, 2> captureBuffer, captureResponse, userResponse;
+    int back = 2;
+
+    // the responses: the audio thread's (front, and spare while it's faded out of), the designer's (back), and the one being handed over
+    std::array<ImpulseResponse, 4> slots;
+    std::atomic<int> middle { 1 };
+    int front = 0, spare = 3;
+
+    // the audio thread's
+    StereoIIRFilter hpf, lpf;
+    LinearSmoothedValue dryGain, wetGain;
+    std::array<float, chunkSize> wetInput {};
+    NonUniformConvolver convolver;
+    const float outputGain = std::pow (10.0f, -6.0f * 0.05f);
+};
+
+} // namespace theknob
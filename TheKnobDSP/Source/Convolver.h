@@ -0,0 +1,146 @@
+//
+//  Convolver.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "FFT.h"
+#include <memory>
+
+namespace theknob
+{
+
+/*
+ =================================Uniformly Partitioned Convolution=================================
+
+ Long FIR filters, run in the frequency domain with uniformly partitioned overlap-save:
+
+ -The kernel is cut into partitions of B samples, and each is kept as the spectrum of a 2B point FFT (PartitionedKernel).
+ -Every B input samples, the last 2B inputs are transformed once and put at the front of a frequency-domain delay line. The output is
+  the sum over the partitions of each one's spectrum times the input spectrum from that many partitions ago, transformed back, and
+  its second half is the next B output samples. So the output is one partition late, and the cost per sample grows with the kernel's
+  length only through one complex multiply-add per bin and partition.
+ -The delay line only holds input, so the same one can be run through two kernels at once to crossfade between them.
+
+ */
+
+class PartitionedKernel
+{
+public:
+    using Complex = FFT::Complex;
+
+    // allocates room for kernels of up to maxLength samples
+    void prepare (int newPartitionSize, int maxLength)
+    {
+        partitionSize = newPartitionSize;
+        numBins = partitionSize + 1;
+        maxPartitions = (maxLength + partitionSize - 1) / partitionSize;
+        spectra.assign ((size_t) (maxPartitions * numBins), {});
+        numPartitions = 0;
+    }
+
+    // fft has to be 2 * the partition size, and scratch has to hold 2 * the partition size
+    void set (FFT& fft, const float* kernel, int length, float* scratch) noexcept
+    {
+        numPartitions = std::min (maxPartitions, (length + partitionSize - 1) / partitionSize);
+
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            auto count = std::min (partitionSize, length - p * partitionSize);
+            std::fill (scratch, scratch + 2 * partitionSize, 0.0f);
+            std::copy (kernel + p * partitionSize, kernel + p * partitionSize + count, scratch);
+            fft.forward (scratch, getPartition (p));
+        }
+    }
+
+    int getNumPartitions() const noexcept                { return numPartitions; }
+    const Complex* getPartition (int p) const noexcept   { return spectra.data() + p * numBins; }
+
+private:
+    Complex* getPartition (int p) noexcept               { return spectra.data() + p * numBins; }
+
+    int partitionSize = 0, numBins = 0, maxPartitions = 0, numPartitions = 0;
+    std::vector<Complex> spectra;
+};
+
+//==============================================================================
+// One channel of convolution. The caller collects B input samples at a time and plays out B output samples at a time.
+class UniformConvolver
+{
+public:
+    using Complex = FFT::Complex;
+
+    void prepare (int newPartitionSize, int maxKernelLength)
+    {
+        partitionSize = newPartitionSize;
+        numBins = partitionSize + 1;
+        numPartitions = (maxKernelLength + partitionSize - 1) / partitionSize;
+
+        int order = 0;
+        while ((1 << order) < 2 * partitionSize)
+            ++order;
+
+        fft = std::make_unique<FFT> (order);
+        delayLine.assign ((size_t) (numPartitions * numBins), {});
+        accumulator.assign ((size_t) numBins, {});
+        frame.assign ((size_t) (2 * partitionSize), 0.0f);
+        outputFrame.assign ((size_t) (2 * partitionSize), 0.0f);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        std::fill (delayLine.begin(), delayLine.end(), Complex());
+        std::fill (frame.begin(), frame.end(), 0.0f);
+        newest = 0;
+    }
+
+    int getPartitionSize() const noexcept                { return partitionSize; }
+
+    // Takes the next B input samples into the delay line
+    void pushPartition (const float* input) noexcept
+    {
+        std::copy (frame.begin() + partitionSize, frame.end(), frame.begin());
+        std::copy (input, input + partitionSize, frame.begin() + partitionSize);
+
+        newest = (newest + numPartitions - 1) % numPartitions;
+        fft->forward (frame.data(), getSpectrum (newest));
+    }
+
+    // Writes the B output samples for the last pushed partition, through this kernel
+    void convolve (const PartitionedKernel& kernel, float* output) noexcept
+    {
+        std::fill (accumulator.begin(), accumulator.end(), Complex());
+
+        auto count = std::min (numPartitions, kernel.getNumPartitions());
+
+        for (int p = 0; p < count; ++p)
+        {
+            const auto* x = getSpectrum ((newest + p) % numPartitions);
+            const auto* h = kernel.getPartition (p);
+            auto* sum = accumulator.data();
+
+            for (int k = 0; k < numBins; ++k)
+                sum[k] += FFT::multiply (x[k], h[k]);
+        }
+
+        // overlap-save: the first half wraps around, the second half is the linear convolution
+        fft->inverse (accumulator.data(), outputFrame.data());
+        std::copy (outputFrame.begin() + partitionSize, outputFrame.end(), output);
+    }
+
+private:
+    Complex* getSpectrum (int index) noexcept            { return delayLine.data() + index * numBins; }
+
+    int partitionSize = 0, numBins = 0, numPartitions = 1;
+    int newest = 0;
+
+    std::unique_ptr<FFT> fft;
+    std::vector<Complex> delayLine, accumulator;
+    std::vector<float> frame, outputFrame;
+};
+
+} // namespace theknob
@@ -0,0 +1,180 @@
+//
+//  Delay.h
+//  TheKnobDSP
+//
+//  Created by Vou Theophanous on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "Filters.h"
+
+namespace theknob
+{
+
+//==============================================================================
+template <typename Type>
+class DelayLine
+{
+public:
+    void clear() noexcept
+    {
+        std::fill (rawData.begin(), rawData.end(), Type (0));
+    }
+
+    size_t size() const noexcept
+    {
+        return rawData.size();
+    }
+
+    void visitState (StateArchive& archive) noexcept    { archive (rawData, leastRecentIndex); }
+
+    void resize (size_t newValue)
+    {
+        rawData.resize (newValue);
+        leastRecentIndex = 0;
+    }
+
+    Type back() const noexcept
+    {
+        return rawData[leastRecentIndex];
+    }
+
+    Type get (size_t delayInSamples) const noexcept
+    {
+        return rawData[(leastRecentIndex + 1 + delayInSamples) % size()];
+    }
+
+    /** Set the specified sample in the delay line */
+    void set (size_t delayInSamples, Type newValue) noexcept
+    {
+        rawData[(leastRecentIndex + 1 + delayInSamples) % size()] = newValue;
+    }
+
+    /** Adds a new value to the delay line, overwriting the least recently added sample */
+    void push (Type valueToAdd) noexcept
+    {
+        rawData[leastRecentIndex] = valueToAdd;
+        leastRecentIndex = leastRecentIndex == 0 ? size() - 1 : leastRecentIndex - 1;
+    }
+
+    /** What get (delayInSamples) returns over the next numSamples pushes, for up to delayInSamples + 1 of them (so none of those
+        pushes can be read back) */
+    void read (size_t delayInSamples, Type* dest, int numSamples) const noexcept
+    {
+        getKernels().delayRead (rawData.data(), (int) size(), (int) ((leastRecentIndex + 1 + delayInSamples) % size()), dest, numSamples);
+    }
+
+    /** Pushes numSamples values, up to size() of them */
+    void write (const Type* source, int numSamples) noexcept
+    {
+        getKernels().delayWrite (rawData.data(), (int) size(), (int) leastRecentIndex, source, numSamples);
+        leastRecentIndex = (leastRecentIndex + size() - (size_t) numSamples) % size();
+    }
+
+private:
+    std::vector<Type> rawData;
+    size_t leastRecentIndex = 0;
+};
+
+//==============================================================================
+// A stereo feedback delay, with a tanh in the loop and a first-order LPF at 1 kHz on the repeats. Nothing a block reads back was written
+// in the same block, as long as it's no longer than the delay, so each channel runs in chunks of up to that length: the reads, writes and
+// tanh go through the kernels a chunk at a time, and only the LPF runs sample by sample.
+class FeedbackDelay
+{
+public:
+    static constexpr float maxDelayTime = 2.0f;
+    static constexpr float repeatCutoff = 1000.0f;
+
+    // How long the lines are, and how many samples a delay time is, at this rate
+    static size_t getLineSize (float sampleRate) noexcept                    { return (size_t) std::ceil (maxDelayTime * sampleRate); }
+    static size_t getDelaySamples (float seconds, float sampleRate) noexcept { return (size_t) std::lround (seconds * sampleRate); }
+
+    // Allocates: the lines are sized for the longest delay time
+    void prepare (double newSampleRate)
+    {
+        sampleRate = (float) newSampleRate;
+
+        for (auto& dline : delayLines)
+            dline.resize (getLineSize (sampleRate));
+
+        for (auto& f : filters)
+            f.setCoefficients (IIRCoefficients::makeFirstOrderLowPass (sampleRate, repeatCutoff));
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& f : filters)
+            f.reset();
+
+        for (auto& dline : delayLines)
+            dline.clear();
+    }
+
+    void visitState (StateArchive& archive) noexcept
+    {
+        archive (delayLines, delayTimesSample, filters, feedback, wetLevel, dryLevel, approximateTanh);
+    }
+
+    void setFeedback (float newValue) noexcept      { feedback = newValue; }
+    void setWetLevel (float newValue) noexcept      { wetLevel = newValue; }
+    void setDryLevel (float newValue) noexcept      { dryLevel = newValue; }
+
+    // Saturates the repeats with the kernels' approximate tanh, for the cheaper QualityTiers
+    void setApproximateTanh (bool shouldApproximate) noexcept { approximateTanh = shouldApproximate; }
+
+    void setDelayTime (size_t channel, float newValue) noexcept
+    {
+        delayTimesSample[channel] = getDelaySamples (newValue, sampleRate);
+    }
+
+    void process (float* const* channels, int numSamples) noexcept
+    {
+        auto& kernels = getKernels();
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            auto maxChunkSize = (int) std::min ((size_t) chunkSize, delayTimesSample[ch] + 1);
+
+            for (int start = 0; start < numSamples; start += maxChunkSize)
+            {
+                auto count = std::min (maxChunkSize, numSamples - start);
+                auto* samples = channels[ch] + start;
+
+                delayLines[ch].read (delayTimesSample[ch], delayed.data(), count);
+
+                for (int i = 0; i < count; ++i)
+                {
+                    delayed[(size_t) i] = filters[ch].processSample (delayed[(size_t) i]);
+                    feedbackInput[(size_t) i] = samples[i] + feedback * delayed[(size_t) i];
+                }
+
+                (approximateTanh ? kernels.waveshapeApproximate : kernels.waveshape) (feedbackInput.data(), count, 1.0f, 1.0f, false);
+                delayLines[ch].write (feedbackInput.data(), count);
+
+                for (int i = 0; i < count; ++i)
+                    samples[i] = dryLevel * samples[i] + wetLevel * delayed[(size_t) i];
+            }
+        }
+    }
+
+private:
+    static constexpr size_t numChannels = 2;
+    static constexpr int chunkSize = 256;
+
+    std::array<DelayLine<float>, numChannels> delayLines;
+    std::array<size_t, numChannels> delayTimesSample {};
+    std::array<IIRFilter, numChannels> filters;
+    std::array<float, chunkSize> delayed {}, feedbackInput {};
+
+    float feedback = 0.0f;
+    float wetLevel = 0.0f;
+    float dryLevel = 1.0f;
+    bool approximateTanh = false;
+    float sampleRate = 44.1e3f;
+};
+
+} // namespace theknob
@@ -0,0 +1,511 @@
+//
+//  Engine.cpp
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#include "Engine.h"
+
+namespace theknob
+{
+
+Engine::Engine()
+    : chain (getChain (mode))
+{
+    filter.setParameters (knob, mode);
+    eq.setParameters (knob, mode);
+    specialEq.setParameters (knob, mode);
+    reverb.setParameters (knob, mode);
+    delay.setParameters (knob, mode);
+    distortion.setParameters (knob, mode);
+}
+
+Engine::~Engine()
+{
+    stopDesignThread();
+}
+
+//==============================================================================
+void Engine::prepare (double sampleRate, int maxBlockSize)
+{
+    stopDesignThread();
+
+    auto elisionThreshold = std::pow (10.0f, elisionThresholdDb * 0.05f);
+    reverb.setElisionThreshold (elisionThreshold);
+    delay.setElisionThreshold (elisionThreshold);
+
+    filter.prepare (sampleRate);
+    eq.prepare (sampleRate);
+    specialEq.prepare (sampleRate);
+    reverb.prepare (sampleRate);
+    delay.prepare (sampleRate);
+    distortion.prepare (sampleRate);
+
+    monoScratch.assign ((size_t) std::max (1, maxBlockSize), 0.0f);
+
+    // the coefficients depend on the sample rate
+    filter.setParameters (knob, mode);
+    eq.setParameters (knob, mode);
+    specialEq.setParameters (knob, mode);
+    reverb.setParameters (knob, mode);
+    delay.setParameters (knob, mode);
+    distortion.setParameters (knob, mode);
+    stagesOutOfDate = false;
+
+    if (linearPhase)
+    {
+        // the first kernels are designed here, for these parameters
+        linearPhaseEq.setParameters (knob, mode);
+        linearPhaseSpecialEq.setParameters (knob, mode);
+        linearPhaseEq.prepare (sampleRate);
+        linearPhaseSpecialEq.prepare (sampleRate);
+    }
+
+    if (convolution)
+    {
+        // the first response is captured here, for these parameters
+        convolutionReverb.setParameters (knob, mode);
+        convolutionReverb.prepare (sampleRate);
+    }
+
+    for (auto& line : bypassDelayLine)
+        line.assign ((size_t) getLatencySamples(), 0.0f);
+
+    bypassDelayPosition = 0;
+
+    // the linear-phase EQ's and convolution reverb's FFT state belongs to their background threads as much as to this one
+    stateSize = 0;
+
+    if (! linearPhase && ! convolution)
+    {
+        auto archive = StateArchive::forMeasuring();
+        visitState (archive);
+        stateSize = sizeof (StateHeader) + archive.getPosition();
+    }
+
+    stateHeader = {};
+    stateHeader.sampleRate = sampleRate;
+    stateHeader.reducedRate = reducedRate ? 1 : 0;
+    stateHeader.elisionThresholdDb = elisionThresholdDb;
+    stateHeader.size = stateSize;
+
+    if (needsDesignThread())
+        startDesignThread();
+}
+
+void Engine::reset() noexcept
+{
+    filter.reset();
+    eq.reset();
+    specialEq.reset();
+    reverb.reset();
+    delay.reset();
+    distortion.reset();
+
+    if (linearPhase)
+    {
+        linearPhaseEq.reset();
+        linearPhaseSpecialEq.reset();
+    }
+
+    for (auto& line : bypassDelayLine)
+        std::fill (line.begin(), line.end(), 0.0f);
+
+    if (convolution)
+        convolutionReverb.reset();
+}
+
+void Engine::setParameters (float newKnob, int newMode) noexcept
+{
+    appliedVersion = ParameterSnapshot::noVersion;
+    newKnob = clampKnob (newKnob);
+    newMode = clampMode (newMode);
+
+    if (newKnob == knob && newMode == mode)
+        return;
+
+    auto wasBypassed = isBypassed();
+    auto knobChanged = newKnob != knob;
+    knob = newKnob;
+    mode = newMode;
+
+    if (isBypassed())
+    {
+        stagesOutOfDate = true;
+        return;
+    }
+
+    // nothing runs while the chain is bypassed, so don't let it come back with the tails it had when it stopped
+    if (wasBypassed)
+        reset();
+
+    updateStages (knobChanged || stagesOutOfDate);
+    stagesOutOfDate = false;
+}
+
+void Engine::setParameters (const ParameterSnapshot& snapshot) noexcept
+{
+    if (snapshot.version == appliedVersion)
+        return;
+
+    setParameters (snapshot.knob, snapshot.mode);
+    appliedVersion = snapshot.version;
+}
+
+void Engine::updateStages (bool knobChanged) noexcept
+{
+    chain = getChain (mode);
+
+    // the filter and EQ don't depend on the mode
+    if (knobChanged)
+    {
+        filter.setParameters (knob, mode);
+        eq.setParameters (knob, mode);
+
+        if (linearPhase)
+            linearPhaseEq.setParameters (knob, mode);
+    }
+
+    specialEq.setParameters (knob, mode);
+
+    if (linearPhase)
+        linearPhaseSpecialEq.setParameters (knob, mode);
+
+    reverb.setParameters (knob, mode);
+
+    if (convolution)
+        convolutionReverb.setParameters (knob, mode);
+
+    delay.setParameters (knob, mode);
+    distortion.setParameters (knob, mode);
+
+    // the linear-phase EQ and the convolution reverb have just posted new parameters for the design thread
+    if (designThread.joinable())
+        designWork.post();
+}
+
+//==============================================================================
+void Engine::setDetachedStages (bool reverbDetached, bool delayDetached) noexcept
+{
+    detached = {};
+    detached[reverbStage] = reverbDetached;
+    detached[delayStage] = delayDetached;
+}
+
+void Engine::setLinearPhaseEQ (bool enabled, bool shouldDesignInBackground) noexcept
+{
+    linearPhase = enabled;
+    designInBackground = shouldDesignInBackground;
+    linearPhaseEq.setDesignInBackground (designInBackground);
+    linearPhaseSpecialEq.setDesignInBackground (designInBackground);
+}
+
+void Engine::setConvolutionReverb (bool enabled, bool shouldDesignInBackground) noexcept
+{
+    convolution = enabled;
+    convolutionInBackground = shouldDesignInBackground;
+    convolutionReverb.setDesignInBackground (convolutionInBackground);
+}
+
+void Engine::setImpulseResponse (const float* const* channels, int numChannels, int length)
+{
+    convolutionReverb.setUserImpulseResponse (channels, numChannels, length);
+}
+
+void Engine::setReducedRateWetPaths (bool enabled) noexcept
+{
+    reducedRate = enabled;
+    reverb.setReducedRate (reducedRate);
+    delay.setReducedRate (reducedRate);
+}
+
+void Engine::setElisionThreshold (float decibels) noexcept
+{
+    elisionThresholdDb = decibels;
+}
+
+void Engine::setQualityTier (int tier) noexcept
+{
+    qualityTier = std::clamp (tier, (int) fullQualityTier, numQualityTiers - 1);
+    filter.setQualityTier (qualityTier);
+    specialEq.setQualityTier (qualityTier);
+    reverb.setQualityTier (qualityTier);
+    delay.setQualityTier (qualityTier);
+    distortion.setQualityTier (qualityTier);
+}
+
+int Engine::getLatencySamples() const noexcept
+{
+    auto latency = convolution ? 0 : reverb.getLatencySamples();
+
+    if (linearPhase)
+        latency += linearPhaseEq.getLatencySamples() + linearPhaseSpecialEq.getLatencySamples();
+
+    return latency;
+}
+
+void Engine::process (float* const* channels, int numChannels, int numSamples) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    if (isBypassed())
+    {
+        delayBypassed (channels, std::min (numChannels, 2), numSamples);
+        return;
+    }
+
+    if (numChannels >= 2)
+    {
+        processStereo (channels, numSamples);
+        return;
+    }
+
+    // mono: the chain is always stereo, so it gets a silent right channel, the same as a stereo chain on a mono track
+    auto scratchSize = (int) monoScratch.size();
+
+    for (int start = 0; scratchSize > 0 && start < numSamples; start += scratchSize)
+    {
+        auto count = std::min (scratchSize, numSamples - start);
+        std::fill (monoScratch.begin(), monoScratch.begin() + count, 0.0f);
+
+        float* stereo[] = { channels[0] + start, monoScratch.data() };
+        processStereo (stereo, count);
+    }
+}
+
+void Engine::process (float* const* channels, int numChannels, int numSamples, const ParameterChange* changes, int numChanges) noexcept
+{
+    auto processRange = [&] (int start, int count)
+    {
+        if (count <= 0)
+            return;
+
+        float* range[] = { channels[0] + start, numChannels >= 2 ? channels[1] + start : nullptr };
+        process (range, numChannels, count);
+    };
+
+    int position = 0;
+
+    for (int i = 0; i < numChanges; ++i)
+    {
+        auto offset = std::clamp (changes[i].sampleOffset, position, std::max (position, numSamples));
+
+        // only the last of the changes at one offset counts, and one that changes nothing doesn't split the block
+        if (i + 1 < numChanges && changes[i + 1].sampleOffset <= offset)
+            continue;
+
+        if (clampKnob (changes[i].knob) == knob && clampMode (changes[i].mode) == mode)
+            continue;
+
+        processRange (position, offset - position);
+        position = offset;
+        setParameters (changes[i].knob, changes[i].mode);
+    }
+
+    processRange (position, numSamples - position);
+}
+
+void Engine::processHead (float* const* channels, int numSamples) noexcept
+{
+    if (isBypassed())
+    {
+        delayBypassed (channels, 2, numSamples);
+        return;
+    }
+
+    for (auto stage : chain)
+    {
+        if (isDetached (stage))
+            break;
+
+        processStage (stage, channels, numSamples);
+    }
+}
+
+void Engine::processDetached (float* const* channels, int numSamples) noexcept
+{
+    if (isBypassed())
+        return;
+
+    for (auto stage : chain)
+        if (isDetached (stage))
+            processStage (stage, channels, numSamples);
+}
+
+void Engine::processTail (float* const* channels, int numSamples) noexcept
+{
+    if (isBypassed())
+        return;
+
+    auto afterDetached = chain.end();
+
+    for (auto it = chain.begin(); it != chain.end(); ++it)
+        if (isDetached (*it))
+            afterDetached = it + 1;
+
+    for (auto it = afterDetached; it != chain.end(); ++it)
+        processStage (*it, channels, numSamples);
+}
+
+//==============================================================================
+bool Engine::saveState (void* destination, size_t size) const noexcept
+{
+    if (stateSize == 0 || destination == nullptr || size < stateSize)
+        return false;
+
+    std::memcpy (destination, &stateHeader, sizeof (StateHeader));
+
+    // visitState() only reads when it's saving
+    auto archive = StateArchive::forSaving (static_cast<unsigned char*> (destination) + sizeof (StateHeader), stateSize - sizeof (StateHeader));
+    const_cast<Engine*> (this)->visitState (archive);
+    return ! archive.hasOverflowed();
+}
+
+bool Engine::restoreState (const void* source, size_t size) noexcept
+{
+    if (stateSize == 0 || source == nullptr || size != stateSize)
+        return false;
+
+    StateHeader header;
+    std::memcpy (&header, source, sizeof (header));
+
+    if (! header.matches (stateHeader))
+        return false;
+
+    auto archive = StateArchive::forRestoring (static_cast<const unsigned char*> (source) + sizeof (StateHeader), stateSize - sizeof (StateHeader));
+    visitState (archive);
+
+    // the next snapshot is applied whatever its version, since this knob and mode didn't come from it
+    appliedVersion = ParameterSnapshot::noVersion;
+    return true;
+}
+
+void Engine::visitState (StateArchive& archive) noexcept
+{
+    archive (knob, mode, qualityTier, chain, stagesOutOfDate, bypassDelayLine, bypassDelayPosition);
+    archive (filter, eq, specialEq, reverb, delay, distortion);
+}
+
+//==============================================================================
+Engine::Chain Engine::getChain (int mode) noexcept
+{
+    switch (mode)
+    {
+        case VIOLET:
+            // order: filter -> distortion -> reverb -> delay -> EQ -> Special EQ
+            return { filterStage, distortionStage, reverbStage, delayStage, eqStage, specialEqStage };
+
+        case TEAL:
+            // order: filter -> EQ -> distortion -> delay -> reverb -> Special EQ
+            return { filterStage, eqStage, distortionStage, delayStage, reverbStage, specialEqStage };
+
+        case CRIMSON:
+        default:
+            // order: filter -> EQ -> delay -> reverb -> distortion -> Special EQ
+            return { filterStage, eqStage, delayStage, reverbStage, distortionStage, specialEqStage };
+    }
+}
+
+const char* Engine::getStageName (Stage stage) noexcept
+{
+    switch (stage)
+    {
+        case filterStage:       return "Filter";
+        case eqStage:           return "EQ";
+        case specialEqStage:    return "Special EQ";
+        case reverbStage:       return "Reverb";
+        case delayStage:        return "Delay";
+        case distortionStage:   return "Distortion";
+        case numStages:
+        default:                return "";
+    }
+}
+
+void Engine::processStage (Stage stage, float* const* channels, int numSamples) noexcept
+{
+    TraceScope span (getStageName (stage), "stage", "samples", numSamples);
+
+    switch (stage)
+    {
+        case filterStage:       filter.process (channels, numSamples); break;
+        case eqStage:           linearPhase ? linearPhaseEq.process (channels, numSamples) : eq.process (channels, numSamples); break;
+        case specialEqStage:    linearPhase ? linearPhaseSpecialEq.process (channels, numSamples) : specialEq.process (channels, numSamples); break;
+        case reverbStage:       convolution ? convolutionReverb.process (channels, numSamples) : reverb.process (channels, numSamples); break;
+        case delayStage:        delay.process (channels, numSamples); break;
+        case distortionStage:   distortion.process (channels, numSamples); break;
+        case numStages:
+        default:                break;
+    }
+}
+
+void Engine::processStereo (float* const* channels, int numSamples) noexcept
+{
+    for (auto stage : chain)
+        processStage (stage, channels, numSamples);
+}
+
+void Engine::delayBypassed (float* const* channels, int numChannels, int numSamples) noexcept
+{
+    auto length = (int) bypassDelayLine[0].size();
+
+    if (length == 0)
+        return;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            std::swap (channels[ch][i], bypassDelayLine[(size_t) ch][(size_t) bypassDelayPosition]);
+
+        bypassDelayPosition = (bypassDelayPosition + 1) % length;
+    }
+}
+
+//==============================================================================
+bool Engine::needsDesignThread() const noexcept
+{
+    return (linearPhase && designInBackground) || (convolution && convolutionInBackground);
+}
+
+void Engine::startDesignThread()
+{
+    designThreadShouldExit = false;
+
+    designThread = std::thread ([this]
+    {
+        Trace::setThreadName ("Engine design");
+
+        for (;;)
+        {
+            designWork.wait();
+
+            if (designThreadShouldExit.load())
+                break;
+
+            auto* trace = Trace::getActive();
+            auto start = trace != nullptr ? trace->now() : 0;
+
+            // everything can have changed at once, so always check everything
+            auto designedEq = linearPhase && linearPhaseEq.updateKernel();
+            auto designedSpecialEq = linearPhase && linearPhaseSpecialEq.updateKernel();
+            auto capturedReverb = convolution && convolutionReverb.updateImpulseResponse();
+
+            if ((designedEq || designedSpecialEq || capturedReverb) && trace != nullptr)
+                trace->span ("Design", "background", start, trace->now());
+        }
+    });
+}
+
+void Engine::stopDesignThread()
+{
+    if (! designThread.joinable())
+        return;
+
+    designThreadShouldExit = true;
+    designWork.post();
+    designThread.join();
+}
+
+} // namespace theknob
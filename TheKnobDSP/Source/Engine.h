@@ -0,0 +1,316 @@
+//
+//  Engine.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "Stages.h"
+#include "LinearPhase.h"
+#include "ConvolutionReverb.h"
+#include "Semaphore.h"
+#include "Trace.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+namespace theknob
+{
+
+// A new knob and mode, from sampleOffset samples into the block on
+struct ParameterChange
+{
+    int sampleOffset = 0;
+    float knob = KNOB_DEFAULT_VALUE;
+    int mode = VIOLET;
+};
+
+// The knob and mode one block (or chunk) runs with. version changes whenever either of them does.
+struct ParameterSnapshot
+{
+    static constexpr uint32_t noVersion = 0xffffffff;
+
+    float knob = KNOB_DEFAULT_VALUE;
+    int mode = VIOLET;
+    uint32_t version = 0;
+};
+
+//==============================================================================
+// The knob and mode the audio thread runs with, for other threads (a pipeline worker, an analyzer) to run with too. The knob, mode and
+// version are packed into one 64-bit atomic, so a reader can never see one block's knob with another block's mode, and can tell whether
+// anything changed since it last looked by comparing versions.
+class SharedParameters
+{
+public:
+    // From one thread only. Values that are already there don't change the version.
+    void publish (float knob, int mode) noexcept
+    {
+        auto current = load();
+        mode = std::clamp (mode, 0, 255);
+
+        if (knob == current.knob && mode == current.mode)
+            return;
+
+        packed.store (pack ({ knob, mode, (current.version + 1) & versionMask }), std::memory_order_release);
+    }
+
+    ParameterSnapshot load() const noexcept
+    {
+        auto bits = packed.load (std::memory_order_acquire);
+        ParameterSnapshot snapshot;
+
+        auto knobBits = (uint32_t) (bits >> 32);
+        std::memcpy (&snapshot.knob, &knobBits, sizeof (float));
+        snapshot.mode = (int) ((bits >> 24) & 0xff);
+        snapshot.version = (uint32_t) bits & versionMask;
+        return snapshot;
+    }
+
+private:
+    // the version wraps after 16 million changes, which never comes near noVersion
+    static constexpr uint32_t versionMask = 0xffffff;
+
+    static uint64_t pack (const ParameterSnapshot& snapshot) noexcept
+    {
+        uint32_t knobBits;
+        std::memcpy (&knobBits, &snapshot.knob, sizeof (float));
+        return ((uint64_t) knobBits << 32) | ((uint64_t) snapshot.mode << 24) | (snapshot.version & versionMask);
+    }
+
+    std::atomic<uint64_t> packed { pack ({}) };
+};
+
+/*
+ =================================Engine=================================
+
+ The whole of TheKnob's sound: the six stages, run in the order the current mode puts them in. It has no dependencies beyond the standard
+ library, and it processes the caller's buffers in place.
+
+ -prepare() is the only call that allocates.
+ -setParameters() and the process calls are real-time safe, and have to be called from the same thread (or never at the same time).
+ -When the knob is at 0 (below 1) the chain is bypassed, and the audio is left untouched.
+ -Stages (or parts of them) that make no audible difference at the current settings are skipped, down to setElisionThreshold(): the
+  reverb and delay once their tails have rung out, so a chain that's fed silence costs next to nothing.
+ -A whole block takes its knob and mode from one ParameterSnapshot, which other threads running parts of the chain can share through
+  SharedParameters. Nothing is recalculated unless its version has changed.
+ -While a Trace is recording, every stage it runs is a span on it, named after the stage (getStageName()), with the number of samples.
+ -Parameter changes can land anywhere inside a block: process() takes them with their sample offsets, and only splits the block where
+  one actually changes the knob or the mode. A run of automation that keeps sending the same values costs nothing.
+
+ In linear-phase mode (setLinearPhaseEQ()) the EQ and special EQ run as linear-phase FIRs instead, designed on a background thread the
+ engine owns. It sleeps until the knob or the mode changes, and the audio thread wakes it without locking. That delays the whole output by getLatencySamples(), and a bypassed chain is delayed by the same amount so the latency
+ never changes.
+
+ The reverb and delay can also run their wet paths at a reduced rate (setReducedRateWetPaths()). Their filters and dry paths stay at the
+ full rate, since the dry output is the filtered input, so at 192 kHz the two stages cost about a third less (the whole engine 10-20%
+ less) and still about four times what they do at 48 kHz. At 96 kHz they save 10-15%. That's with the compiler vectorising the half-band
+ filters (-O3): without it they cost as much as they save. The reverb's round trip is added to the latency in the same way.
+
+ In convolution reverb mode (setConvolutionReverb()) the reverb is played from impulse responses instead: ones captured from the
+ algorithmic reverb at a grid of knob settings, or the caller's own (setImpulseResponse()). It adds no latency. The responses are
+ captured on the same background thread, and the longest partitions of the convolution run on a worker thread of the stage's own.
+
+ When there isn't the CPU to run the full chain, setQualityTier() swaps some stages for cheaper versions (see QualityTier in Stages.h)
+ without a click. It's real-time safe, so it can change from block to block (QualityGovernor picks a tier from how long the blocks take).
+ The linear-phase EQ and the convolution reverb don't have cheaper versions, and stay as they are.
+
+ The whole running state of the chain (the knob and mode, the delay lines, the reverb's combs and allpasses, every filter, smoother and
+ elision counter) can be copied out with saveState() and put back with restoreState(), at about the speed of a memcpy of the delay lines,
+ and without allocating. A restored engine carries on bit for bit as the saved one did, for A/B comparisons, regression tests and
+ starting renders from a known point. The linear-phase EQ and the convolution reverb keep state on their background threads, so an
+ engine running either can't be saved.
+
+ The reverb and delay are next to each other in every mode's chain, so they can be split off and run somewhere else (TheKnob's pipelined
+ reverb runs them on a worker thread). Mark them with setDetachedStages(), then call processHead(), run processDetached() wherever they
+ belong and call processTail() on the result. process() does all three in one go.
+ */
+class Engine
+{
+public:
+    enum Stage
+    {
+        filterStage,
+        eqStage,
+        specialEqStage,
+        reverbStage,
+        delayStage,
+        distortionStage,
+        numStages
+    };
+
+    Engine();
+    ~Engine();
+
+    // "Filter", "EQ", "Special EQ", "Reverb", "Delay" or "Distortion"
+    static const char* getStageName (Stage stage) noexcept;
+
+    // The order a mode runs the stages in
+    using Chain = std::array<Stage, numStages>;
+    static Chain getChain (int mode) noexcept;
+
+    //==============================================================================
+    // Allocates the delay lines and reverb for this sample rate, and clears everything. maxBlockSize only limits mono processing.
+    void prepare (double sampleRate, int maxBlockSize);
+
+    // Clears the delay and reverb tails and the filter states
+    void reset() noexcept;
+
+    void setParameters (float knob, int mode) noexcept;
+
+    // The same, but it's a single compare (and nothing else) when the snapshot's version is the one it last applied
+    void setParameters (const ParameterSnapshot& snapshot) noexcept;
+
+    float getKnob() const noexcept                       { return knob; }
+    int getMode() const noexcept                         { return mode; }
+    bool isBypassed() const noexcept                     { return (int) knob == 0; }
+
+    //==============================================================================
+    // Takes the reverb (and the delay) out of process() and processHead()/processTail(). Call it before prepare().
+    void setDetachedStages (bool reverb, bool delay) noexcept;
+
+    // Runs the EQ and special EQ as linear-phase FIRs. Call it before prepare(). Offline renders should design the FIRs as the parameters
+    // change instead of on the background thread, so the output doesn't depend on timing.
+    void setLinearPhaseEQ (bool enabled, bool designInBackground = true) noexcept;
+    bool isLinearPhaseEQ() const noexcept                { return linearPhase; }
+
+    // Plays the reverb from impulse responses. Call it before prepare(). Offline renders should capture the responses as the
+    // parameters change and run all of the convolution on the calling thread instead, so the output doesn't depend on timing.
+    void setConvolutionReverb (bool enabled, bool designInBackground = true) noexcept;
+    bool isConvolutionReverb() const noexcept            { return convolution; }
+
+    // The response the convolution reverb plays instead of the captured ones, any number of channels at the rate the engine will be
+    // prepared at (only the first two channels and 10 seconds are used). It's copied. Call it before prepare(), with no channels to go
+    // back to the captured responses.
+    void setImpulseResponse (const float* const* channels, int numChannels, int length);
+
+    // Runs the reverb's and delay's wet paths at 44.1 or 48 kHz inside, at sample rates 2, 4 or 8 times that. The reverb's round trip
+    // through the lower rate adds to getLatencySamples() (the delay makes up for its own). Call it before prepare().
+    void setReducedRateWetPaths (bool enabled) noexcept;
+    bool isReducedRateWetPaths() const noexcept          { return reducedRate; }
+
+    // Leaves out the reverb's and delay's wet paths once their tails have rung out, when they make less difference to the output than
+    // this (see Stages.h). -infinity never leaves anything out. Call it before prepare().
+    void setElisionThreshold (float decibels) noexcept;
+    float getElisionThreshold() const noexcept           { return elisionThresholdDb; }
+
+    static constexpr float defaultElisionThresholdDb = -120.0f;
+
+    // Trades some of the chain's quality for CPU, from fullQualityTier to economyTier. Real-time safe, and it can be called between any
+    // two blocks: the stages it changes crossfade where they need to.
+    void setQualityTier (int tier) noexcept;
+    int getQualityTier() const noexcept                  { return qualityTier; }
+
+    // How late the output is, in samples
+    int getLatencySamples() const noexcept;
+
+    // Runs the whole chain on one (mono) or two channels
+    void process (float* const* channels, int numChannels, int numSamples) noexcept;
+
+    // The same, applying each change at its offset. The changes have to be in order, and the last of several at the same offset wins.
+    void process (float* const* channels, int numChannels, int numSamples, const ParameterChange* changes, int numChanges) noexcept;
+
+    // Parts of the chain, on two channels: before the detached stages, the detached stages, and after them
+    void processHead (float* const* channels, int numSamples) noexcept;
+    void processDetached (float* const* channels, int numSamples) noexcept;
+    void processTail (float* const* channels, int numSamples) noexcept;
+
+    //==============================================================================
+    // How many bytes saveState() writes, once prepared. 0 with the linear-phase EQ or the convolution reverb.
+    size_t getStateSize() const noexcept                 { return stateSize; }
+
+    // Copies the chain's running state into destination, which has to hold getStateSize() bytes. It doesn't allocate or lock, but it
+    // has to be called from the thread that processes, with no detached stages running at the time. Returns false if the state doesn't
+    // fit or can't be saved.
+    bool saveState (void* destination, size_t size) const noexcept;
+
+    // Puts back a state from saveState(), so the chain carries on exactly as it did from there. It has to come from an engine prepared at
+    // the same sample rate, with the same settings and DSP_VERSION: if it doesn't, or size isn't getStateSize(), it returns false and
+    // nothing changes. Real-time safe, with the same rules as saveState().
+    bool restoreState (const void* source, size_t size) noexcept;
+
+private:
+    //==============================================================================
+    static float clampKnob (float value) noexcept        { return std::clamp (value, KNOB_MIN_VALUE, KNOB_MAX_VALUE); }
+    static int clampMode (int value) noexcept            { return std::clamp (value, (int) VIOLET, (int) CRIMSON); }
+    void updateStages (bool knobChanged) noexcept;
+    bool isDetached (Stage stage) const noexcept         { return detached[(size_t) stage]; }
+    void processStage (Stage stage, float* const* channels, int numSamples) noexcept;
+    void processStereo (float* const* channels, int numSamples) noexcept;
+    void delayBypassed (float* const* channels, int numChannels, int numSamples) noexcept;
+    bool needsDesignThread() const noexcept;
+    void visitState (StateArchive& archive) noexcept;
+    void startDesignThread();
+    void stopDesignThread();
+
+    //==============================================================================
+    FilterStage filter;
+    EQStage eq;
+    SpecialEQStage specialEq;
+    ReverbStage reverb;
+    DelayStage delay;
+    DistortionStage distortion;
+
+    LinearPhaseStage<EQStage> linearPhaseEq;
+    LinearPhaseStage<SpecialEQStage> linearPhaseSpecialEq;
+    bool linearPhase = false;
+    bool designInBackground = true;
+    std::thread designThread;
+    std::atomic<bool> designThreadShouldExit { false };
+    Semaphore designWork;
+
+    ConvolutionReverbStage convolutionReverb;
+    bool convolution = false;
+    bool convolutionInBackground = true;
+
+    bool reducedRate = false;
+
+    // the same delay as the chain's, for when it's bypassed
+    std::array<std::vector<float>, 2> bypassDelayLine;
+    int bypassDelayPosition = 0;
+
+    std::array<bool, numStages> detached {};
+    Chain chain;
+
+    float knob = KNOB_DEFAULT_VALUE;
+    int mode = VIOLET;
+    float elisionThresholdDb = defaultElisionThresholdDb;
+    int qualityTier = fullQualityTier;
+
+    // the version of the last snapshot applied, if the knob and mode came from one
+    uint32_t appliedVersion = ParameterSnapshot::noVersion;
+
+    // the stages aren't updated while the chain is bypassed, only when it comes back
+    bool stagesOutOfDate = false;
+
+    // the silent right channel for mono processing
+    std::vector<float> monoScratch;
+
+    //==============================================================================
+    // what a saved state starts with, so it's only restored into an engine prepared the same way
+    struct StateHeader
+    {
+        static constexpr uint32_t expectedMagic = 0x54534b54; // "TKST"
+
+        uint32_t magic = expectedMagic;
+        uint32_t dspVersion = (uint32_t) DSP_VERSION;
+        double sampleRate = 0.0;
+        uint32_t reducedRate = 0;
+        float elisionThresholdDb = 0.0f;
+        uint64_t size = 0;
+
+        bool matches (const StateHeader& other) const noexcept
+        {
+            return magic == other.magic && dspVersion == other.dspVersion && sampleRate == other.sampleRate
+                && reducedRate == other.reducedRate && elisionThresholdDb == other.elisionThresholdDb && size == other.size;
+        }
+    };
+
+    // set up by prepare()
+    StateHeader stateHeader;
+    size_t stateSize = 0;
+};
+
+} // namespace theknob
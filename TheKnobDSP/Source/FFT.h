@@ -0,0 +1,141 @@
+//
+//  FFT.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace theknob
+{
+
+/*
+ A power-of-two FFT of real signals, for the convolution in the linear-phase EQ. A real transform of size N is done as a complex one of
+ size N/2, with the two halves untangled afterwards.
+
+ -The constructor is the only thing that allocates.
+ -An instance keeps its working space inside, so one thread at a time.
+ */
+class FFT
+{
+public:
+    using Complex = std::complex<float>;
+
+    explicit FFT (int order)
+        : size (1 << order),
+          half (size / 2)
+    {
+        const double pi = 3.14159265358979323846;
+
+        twiddles.resize ((size_t) std::max (1, half / 2));
+        for (size_t k = 0; k < twiddles.size(); ++k)
+            twiddles[k] = std::polar (1.0f, (float) (-2.0 * pi * (double) k / half));
+
+        realTwiddles.resize ((size_t) half + 1);
+        for (size_t k = 0; k < realTwiddles.size(); ++k)
+            realTwiddles[k] = std::polar (1.0f, (float) (-2.0 * pi * (double) k / size));
+
+        bitReversed.resize ((size_t) half);
+        for (int i = 0, bits = order - 1; i < half; ++i)
+        {
+            int reversed = 0;
+
+            for (int b = 0; b < bits; ++b)
+                reversed |= ((i >> b) & 1) << (bits - 1 - b);
+
+            bitReversed[(size_t) i] = reversed;
+        }
+
+        work.resize ((size_t) half);
+    }
+
+    int getSize() const noexcept                         { return size; }
+    int getNumBins() const noexcept                      { return half + 1; }
+
+    // size real samples in, size/2 + 1 bins out, not scaled
+    void forward (const float* input, Complex* output) noexcept
+    {
+        for (int i = 0; i < half; ++i)
+            work[(size_t) bitReversed[(size_t) i]] = { input[2 * i], input[2 * i + 1] };
+
+        transform (work.data());
+
+        output[0] = { work[0].real() + work[0].imag(), 0.0f };
+        output[half] = { work[0].real() - work[0].imag(), 0.0f };
+
+        for (int k = 1; k < half; ++k)
+        {
+            auto z = work[(size_t) k];
+            auto zc = std::conj (work[(size_t) (half - k)]);
+            auto even = (z + zc) * 0.5f;
+            auto odd = multiply ((z - zc) * 0.5f, Complex (0.0f, -1.0f));
+            output[k] = even + multiply (realTwiddles[(size_t) k], odd);
+        }
+    }
+
+    // size/2 + 1 bins in, size real samples out, scaled by 1/size so that forward() then inverse() gives back the input
+    void inverse (const Complex* input, float* output) noexcept
+    {
+        for (int k = 0; k < half; ++k)
+        {
+            auto x = input[k];
+            auto xc = std::conj (input[half - k]);
+            auto even = (x + xc) * 0.5f;
+            auto odd = multiply ((x - xc) * 0.5f, std::conj (realTwiddles[(size_t) k]));
+
+            // the inverse is a forward transform of the conjugate
+            work[(size_t) bitReversed[(size_t) k]] = std::conj (even + multiply (odd, Complex (0.0f, 1.0f)));
+        }
+
+        transform (work.data());
+
+        const float scale = 1.0f / (float) half;
+
+        for (int i = 0; i < half; ++i)
+        {
+            output[2 * i] = work[(size_t) i].real() * scale;
+            output[2 * i + 1] = -work[(size_t) i].imag() * scale;
+        }
+    }
+
+    // written out, because std::complex's operator* checks for infinities and NaNs and won't be vectorised
+    static Complex multiply (Complex a, Complex b) noexcept
+    {
+        return { a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real() };
+    }
+
+private:
+    // in-place radix-2 complex FFT of half points, on data that's already in bit-reversed order
+    void transform (Complex* data) noexcept
+    {
+        for (int length = 2; length <= half; length *= 2)
+        {
+            auto stride = half / length;
+
+            for (int start = 0; start < half; start += length)
+            {
+                for (int k = 0; k < length / 2; ++k)
+                {
+                    auto twiddle = twiddles[(size_t) (k * stride)];
+                    auto& a = data[start + k];
+                    auto& b = data[start + k + length / 2];
+                    auto t = multiply (b, twiddle);
+                    b = a - t;
+                    a += t;
+                }
+            }
+        }
+    }
+
+    int size, half;
+    std::vector<Complex> twiddles, realTwiddles, work;
+    std::vector<int> bitReversed;
+};
+
+} // namespace theknob
@@ -0,0 +1,219 @@
+//
+//  Filters.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "Kernels.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace theknob
+{
+
+//==============================================================================
+// First and second order IIR coefficients, normalised so a0 = 1. The designs are the same as juce::dsp::IIR::Coefficients, computed in float
+// like the ones TheKnob used to get from it, so the filters sound exactly the same.
+struct IIRCoefficients
+{
+    std::array<float, 5> c {}; // b0, b1, b2, a1, a2 (first order: b0, b1, a1)
+    int order = 0;
+
+    static IIRCoefficients makeFirstOrderLowPass (double sampleRate, float frequency)
+    {
+        auto n = std::tan (pi * frequency / (float) sampleRate);
+        return firstOrder (n, n, n + 1, n - 1);
+    }
+
+    static IIRCoefficients makeFirstOrderHighPass (double sampleRate, float frequency)
+    {
+        auto n = std::tan (pi * frequency / (float) sampleRate);
+        return firstOrder (1, -1, n + 1, n - 1);
+    }
+
+    static IIRCoefficients makeLowPass (double sampleRate, float frequency, float Q)
+    {
+        auto n = 1 / std::tan (pi * frequency / (float) sampleRate);
+        auto nSquared = n * n;
+        auto invQ = 1 / Q;
+        auto c1 = 1 / (1 + invQ * n + nSquared);
+        return secondOrder (c1, c1 * 2, c1, 1, c1 * 2 * (1 - nSquared), c1 * (1 - invQ * n + nSquared));
+    }
+
+    static IIRCoefficients makeHighPass (double sampleRate, float frequency, float Q = (float) (1.0 / 1.4142135623730951))
+    {
+        auto n = std::tan (pi * frequency / (float) sampleRate);
+        auto nSquared = n * n;
+        auto invQ = 1 / Q;
+        auto c1 = 1 / (1 + invQ * n + nSquared);
+        return secondOrder (c1, c1 * -2, c1, 1, c1 * 2 * (nSquared - 1), c1 * (1 - invQ * n + nSquared));
+    }
+
+    static IIRCoefficients makePeakFilter (double sampleRate, float frequency, float Q, float gainFactor)
+    {
+        auto A = std::sqrt (std::max (gainFactor, 0.0f));
+        auto omega = (2 * pi * std::max (frequency, 2.0f)) / (float) sampleRate;
+        auto alpha = std::sin (omega) / (Q * 2);
+        auto c2 = -2 * std::cos (omega);
+        auto alphaTimesA = alpha * A;
+        auto alphaOverA = alpha / A;
+        return secondOrder (1 + alphaTimesA, c2, 1 - alphaTimesA, 1 + alphaOverA, c2, 1 - alphaOverA);
+    }
+
+    // |H(e^jw)| at the given frequency. Not real-time code: it's for drawing the response.
+    double getMagnitudeForFrequency (double frequency, double sampleRate) const noexcept
+    {
+        if (order == 0)
+            return 1.0;
+
+        auto z = std::polar (1.0, -2.0 * 3.141592653589793 * frequency / sampleRate); // z^-1
+        auto b = order == 1 ? std::array<double, 3> { c[0], c[1], 0 } : std::array<double, 3> { c[0], c[1], c[2] };
+        auto a = order == 1 ? std::array<double, 3> { 1, c[2], 0 } : std::array<double, 3> { 1, c[3], c[4] };
+
+        auto numerator = b[0] + z * (b[1] + z * b[2]);
+        auto denominator = a[0] + z * (a[1] + z * a[2]);
+        return std::abs (numerator / denominator);
+    }
+
+private:
+    static constexpr float pi = 3.14159265358979323846f;
+
+    static IIRCoefficients firstOrder (float b0, float b1, float a0, float a1)
+    {
+        auto a0inv = a0 != 0 ? 1 / a0 : 0.0f;
+        return { { b0 * a0inv, b1 * a0inv, a1 * a0inv, 0, 0 }, 1 };
+    }
+
+    static IIRCoefficients secondOrder (float b0, float b1, float b2, float a0, float a1, float a2)
+    {
+        auto a0inv = a0 != 0 ? 1 / a0 : 0.0f;
+        return { { b0 * a0inv, b1 * a0inv, b2 * a0inv, a1 * a0inv, a2 * a0inv }, 2 };
+    }
+};
+
+//==============================================================================
+// A first or second order IIR filter in transposed direct form II
+class IIRFilter
+{
+public:
+    void setCoefficients (const IIRCoefficients& newCoefficients) noexcept
+    {
+        if (newCoefficients.order != coefficients.order)
+            reset();
+
+        coefficients = newCoefficients;
+    }
+
+    const IIRCoefficients& getCoefficients() const noexcept   { return coefficients; }
+
+    void reset() noexcept
+    {
+        state = {};
+    }
+
+    void visitState (StateArchive& archive) noexcept    { archive (coefficients, state); }
+
+    float processSample (float input) noexcept
+    {
+        auto& c = coefficients.c;
+
+        if (coefficients.order == 1)
+        {
+            auto output = c[0] * input + state[0];
+            state[0] = c[1] * input - c[2] * output;
+            return output;
+        }
+
+        auto output = c[0] * input + state[0];
+        state[0] = c[1] * input - c[3] * output + state[1];
+        state[1] = c[2] * input - c[4] * output;
+        return output;
+    }
+
+    void process (float* samples, int numSamples) noexcept
+    {
+        auto& c = coefficients.c;
+        auto lv1 = state[0], lv2 = state[1];
+
+        if (coefficients.order == 1)
+        {
+            auto b0 = c[0], b1 = c[1], a1 = c[2];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto input = samples[i];
+                auto output = input * b0 + lv1;
+                samples[i] = output;
+                lv1 = input * b1 - output * a1;
+            }
+        }
+        else if (coefficients.order == 2)
+        {
+            auto b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto input = samples[i];
+                auto output = input * b0 + lv1;
+                samples[i] = output;
+                lv1 = input * b1 - output * a1 + lv2;
+                lv2 = input * b2 - output * a2;
+            }
+        }
+
+        // don't let the state decay into denormals between blocks
+        state[0] = snapToZero (lv1);
+        state[1] = snapToZero (lv2);
+    }
+
+private:
+    static float snapToZero (float value) noexcept
+    {
+        return (value < -1.0e-8f || value > 1.0e-8f) ? value : 0.0f;
+    }
+
+    friend class StereoIIRFilter;
+
+    IIRCoefficients coefficients;
+    std::array<float, 2> state {};
+};
+
+//==============================================================================
+// The same filter on both channels, run together by the biquad kernel
+class StereoIIRFilter
+{
+public:
+    void setCoefficients (const IIRCoefficients& newCoefficients) noexcept
+    {
+        for (auto& f : filters)
+            f.setCoefficients (newCoefficients);
+    }
+
+    const IIRCoefficients& getCoefficients() const noexcept   { return filters[0].getCoefficients(); }
+
+    void reset() noexcept
+    {
+        for (auto& f : filters)
+            f.reset();
+    }
+
+    void visitState (StateArchive& archive) noexcept    { archive (filters); }
+
+    void process (float* const* channels, int numSamples) noexcept
+    {
+        const auto& coefficients = filters[0].coefficients;
+        getKernels().biquadStereo (coefficients.c.data(), coefficients.order, filters[0].state.data(), filters[1].state.data(),
+                                   channels[0], channels[1], numSamples);
+    }
+
+private:
+    std::array<IIRFilter, 2> filters;
+};
+
+} // namespace theknob
@@ -0,0 +1,1434 @@
+//
+//  Kernels.cpp
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#include "Kernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+#if defined (__x86_64__) || defined (_M_X64) || ((defined (__i386__) || defined (_M_IX86)) && defined (__SSE2__))
+ #define THEKNOB_X86 1
+ #include <immintrin.h>
+ #if defined (_MSC_VER) && ! defined (__clang__)
+  #include <intrin.h>
+  #define THEKNOB_TARGET(isa)
+ #else
+  #define THEKNOB_TARGET(isa) __attribute__ ((target (isa)))
+ #endif
+#elif defined (__aarch64__) || defined (_M_ARM64)
+ #define THEKNOB_NEON 1
+ #include <arm_neon.h>
+#endif
+
+#if defined (_MSC_VER) && ! defined (__clang__)
+ #define THEKNOB_ALWAYS_INLINE __forceinline
+#else
+ #define THEKNOB_ALWAYS_INLINE inline __attribute__ ((always_inline))
+#endif
+
+// GCC fuses a multiply and an add into an FMA wherever the target has them (AVX-512 does), which rounds once instead of twice and
+// would make that ISA's results differ from the others'
+#if defined (__GNUC__) && ! defined (__clang__)
+ #pragma GCC optimize ("fp-contract=off")
+#endif
+
+namespace theknob
+{
+
+//==============================================================================
+void CombBank::setSizes (const std::array<int, numCombs>& newSizes)
+{
+    int total = 0;
+
+    for (int i = 0; i < numCombs; ++i)
+    {
+        if (newSizes[(size_t) i] != sizes[(size_t) i])
+            positions[(size_t) i] = 0;
+
+        offsets[(size_t) i] = total;
+        total += newSizes[(size_t) i];
+    }
+
+    sizes = newSizes;
+    storage.assign ((size_t) total, 0.0f);
+    clear();
+}
+
+void CombBank::clear() noexcept
+{
+    std::fill (storage.begin(), storage.end(), 0.0f);
+    last = {};
+}
+
+void LaneCombBank::setSizes (const std::array<int, CombBank::numCombs>& newSizes, int newNumLanes)
+{
+    int total = 0;
+
+    for (int i = 0; i < CombBank::numCombs; ++i)
+    {
+        if (newSizes[(size_t) i] != sizes[(size_t) i])
+            positions[(size_t) i] = 0;
+
+        offsets[(size_t) i] = total;
+        total += newSizes[(size_t) i] * newNumLanes;
+    }
+
+    sizes = newSizes;
+    numLanes = newNumLanes;
+    storage.assign ((size_t) total, 0.0f);
+    clear();
+}
+
+void LaneCombBank::clear() noexcept
+{
+    std::fill (storage.begin(), storage.end(), 0.0f);
+    last = {};
+}
+
+void LaneCombBank::clearLane (int lane) noexcept
+{
+    for (int j = 0; j < CombBank::numCombs; ++j)
+    {
+        auto* buffer = storage.data() + offsets[(size_t) j];
+
+        for (int i = 0; i < sizes[(size_t) j]; ++i)
+            buffer[i * numLanes + lane] = 0.0f;
+
+        last[(size_t) (j * numLanes + lane)] = 0.0f;
+    }
+}
+
+void LaneAllPass::setSize (int newSize, int newNumLanes)
+{
+    if (newSize != size)
+        position = 0;
+
+    size = newSize;
+    numLanes = newNumLanes;
+    buffer.assign ((size_t) (size * numLanes), 0.0f);
+}
+
+void LaneAllPass::clear() noexcept
+{
+    std::fill (buffer.begin(), buffer.end(), 0.0f);
+}
+
+void LaneAllPass::clearLane (int lane) noexcept
+{
+    for (int i = 0; i < size; ++i)
+        buffer[(size_t) (i * numLanes + lane)] = 0.0f;
+}
+
+namespace
+{
+
+//==============================================================================
+// The scalar versions, and the parts every version shares. The vector versions do exactly these operations, lane by lane.
+
+inline float undenormalise (float x) noexcept
+{
+    x += 0.1f;
+    x -= 0.1f;
+    return x;
+}
+
+inline float snapToZero (float value) noexcept
+{
+    return (value < -1.0e-8f || value > 1.0e-8f) ? value : 0.0f;
+}
+
+//==============================================================================
+// stride is how far apart the samples are: 1, or the number of lanes
+void biquadChannelScalar (const float* c, int order, float* state, float* samples, int numSamples, int stride = 1) noexcept
+{
+    auto lv1 = state[0], lv2 = state[1];
+
+    if (order == 1)
+    {
+        auto b0 = c[0], b1 = c[1], a1 = c[2];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto input = samples[i * stride];
+            auto output = input * b0 + lv1;
+            samples[i * stride] = output;
+            lv1 = input * b1 - output * a1;
+        }
+    }
+    else if (order == 2)
+    {
+        auto b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto input = samples[i * stride];
+            auto output = input * b0 + lv1;
+            samples[i * stride] = output;
+            lv1 = input * b1 - output * a1 + lv2;
+            lv2 = input * b2 - output * a2;
+        }
+    }
+
+    state[0] = snapToZero (lv1);
+    state[1] = snapToZero (lv2);
+}
+
+void biquadStereoScalar (const float* c, int order, float* leftState, float* rightState, float* left, float* right, int numSamples)
+{
+    biquadChannelScalar (c, order, leftState, left, numSamples);
+    biquadChannelScalar (c, order, rightState, right, numSamples);
+}
+
+// std::tanh and std::sin, not approximations of them: the distortion has to match its JUCE reference to -100 dB
+void waveshapeScalar (float* samples, int numSamples, float preGain, float postGain, bool sine)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto x = samples[i] * preGain;
+        samples[i] = std::tanh (sine ? std::sin (x) : x) * postGain;
+    }
+}
+
+// A rational approximation of tanh, within 4e-7 of it: x * p (x^2) / q (x^2), clamped to where it reaches +-1. Near 0, x is closer to
+// tanh (x) than the ratio is.
+const float tanhClamp = 7.90531110763549805f;
+const float tanhSmall = 0.0004f;
+const float tanhNumerator[] = { -2.76076847742355e-16f, 2.00018790482477e-13f, -8.60467152213735e-11f, 5.12229709037114e-08f,
+                                1.48572235717979e-05f, 6.37261928875436e-04f, 4.89352455891786e-03f };
+const float tanhDenominator[] = { 1.19825839466702e-06f, 1.18534705686654e-04f, 2.26843463243900e-03f, 4.89352518554385e-03f };
+
+inline float approximateTanh (float x) noexcept
+{
+    const auto clamped = std::min (std::max (x, -tanhClamp), tanhClamp);
+    const auto x2 = clamped * clamped;
+
+    auto p = tanhNumerator[0];
+
+    for (size_t i = 1; i < std::size (tanhNumerator); ++i)
+        p = p * x2 + tanhNumerator[i];
+
+    auto q = tanhDenominator[0];
+
+    for (size_t i = 1; i < std::size (tanhDenominator); ++i)
+        q = q * x2 + tanhDenominator[i];
+
+    return std::abs (x) < tanhSmall ? x : clamped * p / q;
+}
+
+// The sine isn't approximated: the vector versions run this first, then their tanh on the result
+inline void applySine (float* samples, int numSamples, float preGain) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+        samples[i] = std::sin (samples[i] * preGain);
+}
+
+// The vector versions' leftover samples
+inline void waveshapeApproximateTail (float* samples, int start, int numSamples, float preGain, float postGain) noexcept
+{
+    for (int i = start; i < numSamples; ++i)
+        samples[i] = approximateTanh (samples[i] * preGain) * postGain;
+}
+
+void waveshapeApproximateScalar (float* samples, int numSamples, float preGain, float postGain, bool sine)
+{
+    if (sine)
+    {
+        applySine (samples, numSamples, preGain);
+        preGain = 1.0f;
+    }
+
+    waveshapeApproximateTail (samples, 0, numSamples, preGain, postGain);
+}
+
+// One comb: the same as juce::Reverb's
+inline float processComb (CombBank& bank, int comb, float input, float damp, float feedback) noexcept
+{
+    auto& position = bank.positions[(size_t) comb];
+    auto* buffer = bank.storage.data() + bank.offsets[(size_t) comb];
+
+    auto output = buffer[position];
+    auto& last = bank.last[(size_t) comb];
+    last = undenormalise ((output * (1.0f - damp)) + (last * damp));
+    buffer[position] = undenormalise (input + (last * feedback));
+
+    if (++position == bank.sizes[(size_t) comb])
+        position = 0;
+
+    return output;
+}
+
+// Each channel's outputs are added up in comb order, starting from 0, whatever the ISA
+inline void sumCombs (const float* outputs, float& left, float& right) noexcept
+{
+    float sumLeft = 0, sumRight = 0;
+
+    for (int j = 0; j < 8; ++j)
+    {
+        sumLeft += outputs[j];
+        sumRight += outputs[j + 8];
+    }
+
+    left = sumLeft;
+    right = sumRight;
+}
+
+void combsScalar (CombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples)
+{
+    float outputs[CombBank::numCombs];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int j = 0; j < CombBank::numCombs; ++j)
+            outputs[j] = processComb (bank, j, input[i], damping[i], feedback[i]);
+
+        sumCombs (outputs, left[i], right[i]);
+    }
+}
+
+// The ring is written backwards, so reading forwards in time walks down it
+THEKNOB_ALWAYS_INLINE void delayReadLoop (const float* ring, int size, int start, float* dest, int numSamples) noexcept
+{
+    while (numSamples > 0)
+    {
+        auto count = std::min (numSamples, start + 1);
+        const auto* source = ring + start;
+
+        for (int i = 0; i < count; ++i)
+            dest[i] = source[-i];
+
+        dest += count;
+        numSamples -= count;
+        start = size - 1;
+    }
+}
+
+THEKNOB_ALWAYS_INLINE void delayWriteLoop (float* ring, int size, int start, const float* source, int numSamples) noexcept
+{
+    while (numSamples > 0)
+    {
+        auto count = std::min (numSamples, start + 1);
+        auto* dest = ring + start;
+
+        for (int i = 0; i < count; ++i)
+            dest[-i] = source[i];
+
+        source += count;
+        numSamples -= count;
+        start = size - 1;
+    }
+}
+
+void delayReadScalar (const float* ring, int size, int start, float* dest, int numSamples)        { delayReadLoop (ring, size, start, dest, numSamples); }
+void delayWriteScalar (float* ring, int size, int start, const float* source, int numSamples)     { delayWriteLoop (ring, size, start, source, numSamples); }
+
+//==============================================================================
+// The lane kernels' scalar versions, a lane at a time
+void biquadLanesScalar (const float* c, int order, float* state, float* samples, int numSamples, int numLanes)
+{
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        float laneCoefficients[5], laneState[2] = { state[lane], state[numLanes + lane] };
+
+        for (int j = 0; j < 5; ++j)
+            laneCoefficients[j] = c[j * numLanes + lane];
+
+        biquadChannelScalar (laneCoefficients, order, laneState, samples + lane, numSamples, numLanes);
+
+        state[lane] = laneState[0];
+        state[numLanes + lane] = laneState[1];
+    }
+}
+
+inline void advanceCombs (LaneCombBank& bank) noexcept
+{
+    for (int j = 0; j < CombBank::numCombs; ++j)
+    {
+        auto& position = bank.positions[(size_t) j];
+
+        if (++position == bank.sizes[(size_t) j])
+            position = 0;
+    }
+}
+
+void combLanesScalar (LaneCombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples)
+{
+    auto numLanes = bank.numLanes;
+    float outputs[CombBank::numCombs];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            auto n = i * numLanes + lane;
+
+            for (int j = 0; j < CombBank::numCombs; ++j)
+            {
+                auto& sample = bank.storage[(size_t) (bank.offsets[(size_t) j] + bank.positions[(size_t) j] * numLanes + lane)];
+                auto& last = bank.last[(size_t) (j * numLanes + lane)];
+
+                outputs[j] = sample;
+                last = undenormalise ((sample * (1.0f - damping[n])) + (last * damping[n]));
+                sample = undenormalise (input[n] + (last * feedback[n]));
+            }
+
+            sumCombs (outputs, left[n], right[n]);
+        }
+
+        advanceCombs (bank);
+    }
+}
+
+// The same as Reverb's allpasses
+void allPassLanesScalar (LaneAllPass& allPass, float* samples, int numSamples)
+{
+    auto numLanes = allPass.numLanes;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto* buffered = allPass.buffer.data() + allPass.position * numLanes;
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            auto input = samples[i * numLanes + lane];
+            auto bufferedValue = buffered[lane];
+            buffered[lane] = undenormalise (input + (bufferedValue * 0.5f));
+            samples[i * numLanes + lane] = bufferedValue - input;
+        }
+
+        if (++allPass.position == allPass.size)
+            allPass.position = 0;
+    }
+}
+
+// The vector versions' states are snapped the same way, once they're stored
+inline void snapStates (float* state, int numLanes) noexcept
+{
+    for (int i = 0; i < 2 * numLanes; ++i)
+        state[i] = snapToZero (state[i]);
+}
+
+const Kernels scalarKernels { Isa::scalar, biquadStereoScalar, waveshapeScalar, waveshapeApproximateScalar, combsScalar, delayReadScalar, delayWriteScalar,
+                              biquadLanesScalar, combLanesScalar, allPassLanesScalar };
+
+#if THEKNOB_X86
+//==============================================================================
+// SSE2, which every x86-64 CPU has
+void biquadStereoSse2 (const float* c, int order, float* leftState, float* rightState, float* left, float* right, int numSamples)
+{
+    // left in lane 0, right in lane 1
+    auto lv1 = _mm_setr_ps (leftState[0], rightState[0], 0.0f, 0.0f);
+    auto lv2 = _mm_setr_ps (leftState[1], rightState[1], 0.0f, 0.0f);
+
+    auto load = [&] (int i) { return _mm_unpacklo_ps (_mm_load_ss (left + i), _mm_load_ss (right + i)); };
+    auto store = [&] (int i, __m128 output)
+    {
+        _mm_store_ss (left + i, output);
+        _mm_store_ss (right + i, _mm_shuffle_ps (output, output, _MM_SHUFFLE (1, 1, 1, 1)));
+    };
+
+    if (order == 1)
+    {
+        auto b0 = _mm_set1_ps (c[0]), b1 = _mm_set1_ps (c[1]), a1 = _mm_set1_ps (c[2]);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto input = load (i);
+            auto output = _mm_add_ps (_mm_mul_ps (input, b0), lv1);
+            store (i, output);
+            lv1 = _mm_sub_ps (_mm_mul_ps (input, b1), _mm_mul_ps (output, a1));
+        }
+    }
+    else if (order == 2)
+    {
+        auto b0 = _mm_set1_ps (c[0]), b1 = _mm_set1_ps (c[1]), b2 = _mm_set1_ps (c[2]), a1 = _mm_set1_ps (c[3]), a2 = _mm_set1_ps (c[4]);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto input = load (i);
+            auto output = _mm_add_ps (_mm_mul_ps (input, b0), lv1);
+            store (i, output);
+            lv1 = _mm_add_ps (_mm_sub_ps (_mm_mul_ps (input, b1), _mm_mul_ps (output, a1)), lv2);
+            lv2 = _mm_sub_ps (_mm_mul_ps (input, b2), _mm_mul_ps (output, a2));
+        }
+    }
+
+    float states[2][4];
+    _mm_storeu_ps (states[0], lv1);
+    _mm_storeu_ps (states[1], lv2);
+
+    leftState[0] = snapToZero (states[0][0]);
+    leftState[1] = snapToZero (states[1][0]);
+    rightState[0] = snapToZero (states[0][1]);
+    rightState[1] = snapToZero (states[1][1]);
+}
+
+// four combs at a time, loaded and stored one by one
+void combsSse2 (CombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples)
+{
+    __m128 last[4];
+
+    for (int g = 0; g < 4; ++g)
+        last[g] = _mm_loadu_ps (bank.last.data() + 4 * g);
+
+    float* buffers[CombBank::numCombs];
+
+    for (int j = 0; j < CombBank::numCombs; ++j)
+        buffers[j] = bank.storage.data() + bank.offsets[(size_t) j];
+
+    auto& positions = bank.positions;
+    alignas (16) float outputs[CombBank::numCombs], inputs[CombBank::numCombs];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto damp = _mm_set1_ps (damping[i]);
+        auto oneMinusDamp = _mm_set1_ps (1.0f - damping[i]);
+        auto in = _mm_set1_ps (input[i]);
+        auto fb = _mm_set1_ps (feedback[i]);
+        auto offset = _mm_set1_ps (0.1f);
+
+        for (int j = 0; j < CombBank::numCombs; ++j)
+            outputs[j] = buffers[j][positions[(size_t) j]];
+
+        for (int g = 0; g < 4; ++g)
+        {
+            auto output = _mm_load_ps (outputs + 4 * g);
+            last[g] = _mm_sub_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (output, oneMinusDamp), _mm_mul_ps (last[g], damp)), offset), offset);
+            _mm_store_ps (inputs + 4 * g, _mm_sub_ps (_mm_add_ps (_mm_add_ps (in, _mm_mul_ps (last[g], fb)), offset), offset));
+        }
+
+        for (int j = 0; j < CombBank::numCombs; ++j)
+        {
+            auto& position = positions[(size_t) j];
+            buffers[j][position] = inputs[j];
+
+            if (++position == bank.sizes[(size_t) j])
+                position = 0;
+        }
+
+        sumCombs (outputs, left[i], right[i]);
+    }
+
+    for (int g = 0; g < 4; ++g)
+        _mm_storeu_ps (bank.last.data() + 4 * g, last[g]);
+}
+
+// four samples at a time, the max and min in the same order as std::max and std::min so that even a NaN comes out the same
+inline __m128 approximateTanhSse2 (__m128 x) noexcept
+{
+    auto clamped = _mm_min_ps (_mm_set1_ps (tanhClamp), _mm_max_ps (_mm_set1_ps (-tanhClamp), x));
+    auto x2 = _mm_mul_ps (clamped, clamped);
+
+    auto p = _mm_set1_ps (tanhNumerator[0]);
+
+    for (size_t i = 1; i < std::size (tanhNumerator); ++i)
+        p = _mm_add_ps (_mm_mul_ps (p, x2), _mm_set1_ps (tanhNumerator[i]));
+
+    auto q = _mm_set1_ps (tanhDenominator[0]);
+
+    for (size_t i = 1; i < std::size (tanhDenominator); ++i)
+        q = _mm_add_ps (_mm_mul_ps (q, x2), _mm_set1_ps (tanhDenominator[i]));
+
+    auto ratio = _mm_div_ps (_mm_mul_ps (clamped, p), q);
+    auto small = _mm_cmplt_ps (_mm_andnot_ps (_mm_set1_ps (-0.0f), x), _mm_set1_ps (tanhSmall));
+    return _mm_or_ps (_mm_and_ps (small, x), _mm_andnot_ps (small, ratio));
+}
+
+void waveshapeApproximateSse2 (float* samples, int numSamples, float preGain, float postGain, bool sine)
+{
+    if (sine)
+    {
+        applySine (samples, numSamples, preGain);
+        preGain = 1.0f;
+    }
+
+    auto pre = _mm_set1_ps (preGain), post = _mm_set1_ps (postGain);
+    int i = 0;
+
+    for (; i + 4 <= numSamples; i += 4)
+        _mm_storeu_ps (samples + i, _mm_mul_ps (approximateTanhSse2 (_mm_mul_ps (_mm_loadu_ps (samples + i), pre)), post));
+
+    waveshapeApproximateTail (samples, i, numSamples, preGain, postGain);
+}
+
+// The lane kernels, four lanes to a register. Eight lanes are two registers, run side by side so the biquad's two recursions overlap.
+template <int numGroups>
+THEKNOB_ALWAYS_INLINE void biquadLanesSse2Groups (const float* c, int order, float* state, float* samples, int numSamples) noexcept
+{
+    constexpr int numLanes = 4 * numGroups;
+    __m128 lv1[numGroups], lv2[numGroups], b0[numGroups], b1[numGroups], b2[numGroups], a1[numGroups], a2[numGroups];
+
+    for (int g = 0; g < numGroups; ++g)
+    {
+        lv1[g] = _mm_loadu_ps (state + 4 * g);
+        lv2[g] = _mm_loadu_ps (state + numLanes + 4 * g);
+        b0[g] = _mm_loadu_ps (c + 4 * g);
+        b1[g] = _mm_loadu_ps (c + numLanes + 4 * g);
+        b2[g] = _mm_loadu_ps (c + 2 * numLanes + 4 * g);
+        a1[g] = _mm_loadu_ps (c + 3 * numLanes + 4 * g);
+        a2[g] = _mm_loadu_ps (c + 4 * numLanes + 4 * g);
+    }
+
+    if (order == 1)
+    {
+        // b0, b1, a1
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int g = 0; g < numGroups; ++g)
+            {
+                auto* sample = samples + i * numLanes + 4 * g;
+                auto input = _mm_loadu_ps (sample);
+                auto output = _mm_add_ps (_mm_mul_ps (input, b0[g]), lv1[g]);
+                _mm_storeu_ps (sample, output);
+                lv1[g] = _mm_sub_ps (_mm_mul_ps (input, b1[g]), _mm_mul_ps (output, b2[g]));
+            }
+        }
+    }
+    else if (order == 2)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int g = 0; g < numGroups; ++g)
+            {
+                auto* sample = samples + i * numLanes + 4 * g;
+                auto input = _mm_loadu_ps (sample);
+                auto output = _mm_add_ps (_mm_mul_ps (input, b0[g]), lv1[g]);
+                _mm_storeu_ps (sample, output);
+                lv1[g] = _mm_add_ps (_mm_sub_ps (_mm_mul_ps (input, b1[g]), _mm_mul_ps (output, a1[g])), lv2[g]);
+                lv2[g] = _mm_sub_ps (_mm_mul_ps (input, b2[g]), _mm_mul_ps (output, a2[g]));
+            }
+        }
+    }
+
+    for (int g = 0; g < numGroups; ++g)
+    {
+        _mm_storeu_ps (state + 4 * g, lv1[g]);
+        _mm_storeu_ps (state + numLanes + 4 * g, lv2[g]);
+    }
+
+    snapStates (state, numLanes);
+}
+
+void biquadLanesSse2 (const float* c, int order, float* state, float* samples, int numSamples, int numLanes)
+{
+    if (numLanes == 8)
+        biquadLanesSse2Groups<2> (c, order, state, samples, numSamples);
+    else
+        biquadLanesSse2Groups<1> (c, order, state, samples, numSamples);
+}
+
+template <int numGroups>
+THEKNOB_ALWAYS_INLINE void combLanesSse2Groups (LaneCombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples) noexcept
+{
+    constexpr int numLanes = 4 * numGroups;
+    float* buffers[CombBank::numCombs];
+
+    for (int j = 0; j < CombBank::numCombs; ++j)
+        buffers[j] = bank.storage.data() + bank.offsets[(size_t) j];
+
+    auto* last = bank.last.data();
+    auto offset = _mm_set1_ps (0.1f);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int g = 0; g < numGroups; ++g)
+        {
+            auto n = i * numLanes + 4 * g;
+            auto damp = _mm_loadu_ps (damping + n);
+            auto oneMinusDamp = _mm_sub_ps (_mm_set1_ps (1.0f), damp);
+            auto in = _mm_loadu_ps (input + n);
+            auto fb = _mm_loadu_ps (feedback + n);
+            auto sumLeft = _mm_setzero_ps(), sumRight = _mm_setzero_ps();
+
+            for (int j = 0; j < CombBank::numCombs; ++j)
+            {
+                auto* sample = buffers[j] + bank.positions[(size_t) j] * numLanes + 4 * g;
+                auto* combLast = last + j * numLanes + 4 * g;
+
+                auto output = _mm_loadu_ps (sample);
+                auto newLast = _mm_sub_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (output, oneMinusDamp), _mm_mul_ps (_mm_loadu_ps (combLast), damp)), offset), offset);
+                _mm_storeu_ps (combLast, newLast);
+                _mm_storeu_ps (sample, _mm_sub_ps (_mm_add_ps (_mm_add_ps (in, _mm_mul_ps (newLast, fb)), offset), offset));
+
+                if (j < 8)
+                    sumLeft = _mm_add_ps (sumLeft, output);
+                else
+                    sumRight = _mm_add_ps (sumRight, output);
+            }
+
+            _mm_storeu_ps (left + n, sumLeft);
+            _mm_storeu_ps (right + n, sumRight);
+        }
+
+        advanceCombs (bank);
+    }
+}
+
+void combLanesSse2 (LaneCombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples)
+{
+    if (bank.numLanes == 8)
+        combLanesSse2Groups<2> (bank, input, damping, feedback, left, right, numSamples);
+    else
+        combLanesSse2Groups<1> (bank, input, damping, feedback, left, right, numSamples);
+}
+
+void allPassLanesSse2 (LaneAllPass& allPass, float* samples, int numSamples)
+{
+    auto numLanes = allPass.numLanes;
+    auto offset = _mm_set1_ps (0.1f), half = _mm_set1_ps (0.5f);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto* buffered = allPass.buffer.data() + allPass.position * numLanes;
+
+        for (int g = 0; g < numLanes; g += 4)
+        {
+            auto* sample = samples + i * numLanes + g;
+            auto input = _mm_loadu_ps (sample);
+            auto bufferedValue = _mm_loadu_ps (buffered + g);
+            _mm_storeu_ps (buffered + g, _mm_sub_ps (_mm_add_ps (_mm_add_ps (input, _mm_mul_ps (bufferedValue, half)), offset), offset));
+            _mm_storeu_ps (sample, _mm_sub_ps (bufferedValue, input));
+        }
+
+        if (++allPass.position == allPass.size)
+            allPass.position = 0;
+    }
+}
+
+const Kernels sse2Kernels { Isa::sse2, biquadStereoSse2, waveshapeScalar, waveshapeApproximateSse2, combsSse2, delayReadScalar, delayWriteScalar,
+                            biquadLanesSse2, combLanesSse2, allPassLanesSse2 };
+
+//==============================================================================
+// AVX2
+// a channel's eight combs at a time, gathered from the one block of memory and stored one by one
+THEKNOB_TARGET ("avx2") void combsAvx2 (CombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples)
+{
+    __m256 last[2];
+    __m256i offsets[2], sizes[2], positions[2];
+
+    for (int g = 0; g < 2; ++g)
+    {
+        last[g] = _mm256_loadu_ps (bank.last.data() + 8 * g);
+        offsets[g] = _mm256_loadu_si256 ((const __m256i*) (bank.offsets.data() + 8 * g));
+        sizes[g] = _mm256_loadu_si256 ((const __m256i*) (bank.sizes.data() + 8 * g));
+        positions[g] = _mm256_loadu_si256 ((const __m256i*) (bank.positions.data() + 8 * g));
+    }
+
+    auto* storage = bank.storage.data();
+    auto one = _mm256_set1_epi32 (1);
+    alignas (32) float outputs[CombBank::numCombs], inputs[CombBank::numCombs];
+    alignas (32) int indices[CombBank::numCombs];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto damp = _mm256_set1_ps (damping[i]);
+        auto oneMinusDamp = _mm256_set1_ps (1.0f - damping[i]);
+        auto in = _mm256_set1_ps (input[i]);
+        auto fb = _mm256_set1_ps (feedback[i]);
+        auto offset = _mm256_set1_ps (0.1f);
+
+        for (int g = 0; g < 2; ++g)
+        {
+            auto index = _mm256_add_epi32 (offsets[g], positions[g]);
+            auto output = _mm256_i32gather_ps (storage, index, 4);
+            _mm256_store_ps (outputs + 8 * g, output);
+            _mm256_store_si256 ((__m256i*) (indices + 8 * g), index);
+
+            last[g] = _mm256_sub_ps (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (output, oneMinusDamp), _mm256_mul_ps (last[g], damp)), offset), offset);
+            _mm256_store_ps (inputs + 8 * g, _mm256_sub_ps (_mm256_add_ps (_mm256_add_ps (in, _mm256_mul_ps (last[g], fb)), offset), offset));
+
+            auto next = _mm256_add_epi32 (positions[g], one);
+            positions[g] = _mm256_andnot_si256 (_mm256_cmpeq_epi32 (next, sizes[g]), next);
+        }
+
+        for (int j = 0; j < CombBank::numCombs; ++j)
+            storage[indices[j]] = inputs[j];
+
+        sumCombs (outputs, left[i], right[i]);
+    }
+
+    for (int g = 0; g < 2; ++g)
+    {
+        _mm256_storeu_ps (bank.last.data() + 8 * g, last[g]);
+        _mm256_storeu_si256 ((__m256i*) (bank.positions.data() + 8 * g), positions[g]);
+    }
+}
+
+THEKNOB_TARGET ("avx2") void delayReadAvx2 (const float* ring, int size, int start, float* dest, int numSamples)     { delayReadLoop (ring, size, start, dest, numSamples); }
+THEKNOB_TARGET ("avx2") void delayWriteAvx2 (float* ring, int size, int start, const float* source, int numSamples)  { delayWriteLoop (ring, size, start, source, numSamples); }
+
+THEKNOB_TARGET ("avx2") inline __m256 approximateTanhAvx2 (__m256 x) noexcept
+{
+    auto clamped = _mm256_min_ps (_mm256_set1_ps (tanhClamp), _mm256_max_ps (_mm256_set1_ps (-tanhClamp), x));
+    auto x2 = _mm256_mul_ps (clamped, clamped);
+
+    auto p = _mm256_set1_ps (tanhNumerator[0]);
+
+    for (size_t i = 1; i < std::size (tanhNumerator); ++i)
+        p = _mm256_add_ps (_mm256_mul_ps (p, x2), _mm256_set1_ps (tanhNumerator[i]));
+
+    auto q = _mm256_set1_ps (tanhDenominator[0]);
+
+    for (size_t i = 1; i < std::size (tanhDenominator); ++i)
+        q = _mm256_add_ps (_mm256_mul_ps (q, x2), _mm256_set1_ps (tanhDenominator[i]));
+
+    auto ratio = _mm256_div_ps (_mm256_mul_ps (clamped, p), q);
+    auto small = _mm256_cmp_ps (_mm256_andnot_ps (_mm256_set1_ps (-0.0f), x), _mm256_set1_ps (tanhSmall), _CMP_LT_OQ);
+    return _mm256_blendv_ps (ratio, x, small);
+}
+
+THEKNOB_TARGET ("avx2") void waveshapeApproximateAvx2 (float* samples, int numSamples, float preGain, float postGain, bool sine)
+{
+    if (sine)
+    {
+        applySine (samples, numSamples, preGain);
+        preGain = 1.0f;
+    }
+
+    auto pre = _mm256_set1_ps (preGain), post = _mm256_set1_ps (postGain);
+    int i = 0;
+
+    for (; i + 8 <= numSamples; i += 8)
+        _mm256_storeu_ps (samples + i, _mm256_mul_ps (approximateTanhAvx2 (_mm256_mul_ps (_mm256_loadu_ps (samples + i), pre)), post));
+
+    waveshapeApproximateTail (samples, i, numSamples, preGain, postGain);
+}
+
+// The lane kernels, eight lanes to a register (four go to the SSE2 versions)
+THEKNOB_TARGET ("avx2") void biquadLanesAvx2 (const float* c, int order, float* state, float* samples, int numSamples, int numLanes)
+{
+    if (numLanes != 8)
+    {
+        biquadLanesSse2 (c, order, state, samples, numSamples, numLanes);
+        return;
+    }
+
+    auto lv1 = _mm256_loadu_ps (state), lv2 = _mm256_loadu_ps (state + 8);
+    auto b0 = _mm256_loadu_ps (c), b1 = _mm256_loadu_ps (c + 8), b2 = _mm256_loadu_ps (c + 16), a1 = _mm256_loadu_ps (c + 24), a2 = _mm256_loadu_ps (c + 32);
+
+    if (order == 1)
+    {
+        // b0, b1, a1
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto input = _mm256_loadu_ps (samples + 8 * i);
+            auto output = _mm256_add_ps (_mm256_mul_ps (input, b0), lv1);
+            _mm256_storeu_ps (samples + 8 * i, output);
+            lv1 = _mm256_sub_ps (_mm256_mul_ps (input, b1), _mm256_mul_ps (output, b2));
+        }
+    }
+    else if (order == 2)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto input = _mm256_loadu_ps (samples + 8 * i);
+            auto output = _mm256_add_ps (_mm256_mul_ps (input, b0), lv1);
+            _mm256_storeu_ps (samples + 8 * i, output);
+            lv1 = _mm256_add_ps (_mm256_sub_ps (_mm256_mul_ps (input, b1), _mm256_mul_ps (output, a1)), lv2);
+            lv2 = _mm256_sub_ps (_mm256_mul_ps (input, b2), _mm256_mul_ps (output, a2));
+        }
+    }
+
+    _mm256_storeu_ps (state, lv1);
+    _mm256_storeu_ps (state + 8, lv2);
+    snapStates (state, 8);
+}
+
+THEKNOB_TARGET ("avx2") void combLanesAvx2 (LaneCombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples)
+{
+    if (bank.numLanes != 8)
+    {
+        combLanesSse2 (bank, input, damping, feedback, left, right, numSamples);
+        return;
+    }
+
+    float* buffers[CombBank::numCombs];
+
+    for (int j = 0; j < CombBank::numCombs; ++j)
+        buffers[j] = bank.storage.data() + bank.offsets[(size_t) j];
+
+    auto* last = bank.last.data();
+    auto offset = _mm256_set1_ps (0.1f);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto damp = _mm256_loadu_ps (damping + 8 * i);
+        auto oneMinusDamp = _mm256_sub_ps (_mm256_set1_ps (1.0f), damp);
+        auto in = _mm256_loadu_ps (input + 8 * i);
+        auto fb = _mm256_loadu_ps (feedback + 8 * i);
+        auto sumLeft = _mm256_setzero_ps(), sumRight = _mm256_setzero_ps();
+
+        for (int j = 0; j < CombBank::numCombs; ++j)
+        {
+            auto* sample = buffers[j] + bank.positions[(size_t) j] * 8;
+            auto* combLast = last + j * 8;
+
+            auto output = _mm256_loadu_ps (sample);
+            auto newLast = _mm256_sub_ps (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (output, oneMinusDamp), _mm256_mul_ps (_mm256_loadu_ps (combLast), damp)), offset), offset);
+            _mm256_storeu_ps (combLast, newLast);
+            _mm256_storeu_ps (sample, _mm256_sub_ps (_mm256_add_ps (_mm256_add_ps (in, _mm256_mul_ps (newLast, fb)), offset), offset));
+
+            if (j < 8)
+                sumLeft = _mm256_add_ps (sumLeft, output);
+            else
+                sumRight = _mm256_add_ps (sumRight, output);
+        }
+
+        _mm256_storeu_ps (left + 8 * i, sumLeft);
+        _mm256_storeu_ps (right + 8 * i, sumRight);
+        advanceCombs (bank);
+    }
+}
+
+THEKNOB_TARGET ("avx2") void allPassLanesAvx2 (LaneAllPass& allPass, float* samples, int numSamples)
+{
+    if (allPass.numLanes != 8)
+    {
+        allPassLanesSse2 (allPass, samples, numSamples);
+        return;
+    }
+
+    auto offset = _mm256_set1_ps (0.1f), half = _mm256_set1_ps (0.5f);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto* buffered = allPass.buffer.data() + allPass.position * 8;
+        auto input = _mm256_loadu_ps (samples + 8 * i);
+        auto bufferedValue = _mm256_loadu_ps (buffered);
+        _mm256_storeu_ps (buffered, _mm256_sub_ps (_mm256_add_ps (_mm256_add_ps (input, _mm256_mul_ps (bufferedValue, half)), offset), offset));
+        _mm256_storeu_ps (samples + 8 * i, _mm256_sub_ps (bufferedValue, input));
+
+        if (++allPass.position == allPass.size)
+            allPass.position = 0;
+    }
+}
+
+const Kernels avx2Kernels { Isa::avx2, biquadStereoSse2, waveshapeScalar, waveshapeApproximateAvx2, combsAvx2, delayReadAvx2, delayWriteAvx2,
+                            biquadLanesAvx2, combLanesAvx2, allPassLanesAvx2 };
+
+//==============================================================================
+// AVX-512
+// all sixteen combs at once, gathered and scattered
+THEKNOB_TARGET ("avx512f") void combsAvx512 (CombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples)
+{
+    auto last = _mm512_loadu_ps (bank.last.data());
+    auto offsets = _mm512_loadu_si512 (bank.offsets.data());
+    auto sizes = _mm512_loadu_si512 (bank.sizes.data());
+    auto positions = _mm512_loadu_si512 (bank.positions.data());
+
+    auto* storage = bank.storage.data();
+    auto one = _mm512_set1_epi32 (1);
+    auto zero = _mm512_setzero_si512();
+    alignas (64) float outputs[CombBank::numCombs];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto damp = _mm512_set1_ps (damping[i]);
+        auto oneMinusDamp = _mm512_set1_ps (1.0f - damping[i]);
+        auto in = _mm512_set1_ps (input[i]);
+        auto fb = _mm512_set1_ps (feedback[i]);
+        auto offset = _mm512_set1_ps (0.1f);
+
+        auto index = _mm512_add_epi32 (offsets, positions);
+        auto output = _mm512_mask_i32gather_ps (_mm512_setzero_ps(), 0xffff, index, storage, 4);
+        _mm512_store_ps (outputs, output);
+
+        last = _mm512_sub_ps (_mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (output, oneMinusDamp), _mm512_mul_ps (last, damp)), offset), offset);
+        _mm512_i32scatter_ps (storage, index, _mm512_sub_ps (_mm512_add_ps (_mm512_add_ps (in, _mm512_mul_ps (last, fb)), offset), offset), 4);
+
+        auto next = _mm512_add_epi32 (positions, one);
+        positions = _mm512_mask_blend_epi32 (_mm512_cmpeq_epi32_mask (next, sizes), next, zero);
+
+        sumCombs (outputs, left[i], right[i]);
+    }
+
+    _mm512_storeu_ps (bank.last.data(), last);
+    _mm512_storeu_si512 (bank.positions.data(), positions);
+}
+
+THEKNOB_TARGET ("avx512f") void delayReadAvx512 (const float* ring, int size, int start, float* dest, int numSamples)     { delayReadLoop (ring, size, start, dest, numSamples); }
+THEKNOB_TARGET ("avx512f") void delayWriteAvx512 (float* ring, int size, int start, const float* source, int numSamples)  { delayWriteLoop (ring, size, start, source, numSamples); }
+
+THEKNOB_TARGET ("avx512f") inline __m512 approximateTanhAvx512 (__m512 x) noexcept
+{
+    auto clamped = _mm512_min_ps (_mm512_set1_ps (tanhClamp), _mm512_max_ps (_mm512_set1_ps (-tanhClamp), x));
+    auto x2 = _mm512_mul_ps (clamped, clamped);
+
+    auto p = _mm512_set1_ps (tanhNumerator[0]);
+
+    for (size_t i = 1; i < std::size (tanhNumerator); ++i)
+        p = _mm512_add_ps (_mm512_mul_ps (p, x2), _mm512_set1_ps (tanhNumerator[i]));
+
+    auto q = _mm512_set1_ps (tanhDenominator[0]);
+
+    for (size_t i = 1; i < std::size (tanhDenominator); ++i)
+        q = _mm512_add_ps (_mm512_mul_ps (q, x2), _mm512_set1_ps (tanhDenominator[i]));
+
+    auto ratio = _mm512_div_ps (_mm512_mul_ps (clamped, p), q);
+    auto small = _mm512_cmp_ps_mask (_mm512_abs_ps (x), _mm512_set1_ps (tanhSmall), _CMP_LT_OQ);
+    return _mm512_mask_blend_ps (small, ratio, x);
+}
+
+THEKNOB_TARGET ("avx512f") void waveshapeApproximateAvx512 (float* samples, int numSamples, float preGain, float postGain, bool sine)
+{
+    if (sine)
+    {
+        applySine (samples, numSamples, preGain);
+        preGain = 1.0f;
+    }
+
+    auto pre = _mm512_set1_ps (preGain), post = _mm512_set1_ps (postGain);
+    int i = 0;
+
+    for (; i + 16 <= numSamples; i += 16)
+        _mm512_storeu_ps (samples + i, _mm512_mul_ps (approximateTanhAvx512 (_mm512_mul_ps (_mm512_loadu_ps (samples + i), pre)), post));
+
+    waveshapeApproximateTail (samples, i, numSamples, preGain, postGain);
+}
+
+const Kernels avx512Kernels { Isa::avx512, biquadStereoSse2, waveshapeScalar, waveshapeApproximateAvx512, combsAvx512, delayReadAvx512, delayWriteAvx512,
+                              biquadLanesAvx2, combLanesAvx2, allPassLanesAvx2 };
+#endif
+
+#if THEKNOB_NEON
+//==============================================================================
+// NEON, which every 64-bit ARM CPU has
+void biquadStereoNeon (const float* c, int order, float* leftState, float* rightState, float* left, float* right, int numSamples)
+{
+    // left in lane 0, right in lane 1
+    float32x2_t lv1 = { leftState[0], rightState[0] };
+    float32x2_t lv2 = { leftState[1], rightState[1] };
+
+    auto load = [&] (int i) { return vset_lane_f32 (right[i], vdup_n_f32 (left[i]), 1); };
+    auto store = [&] (int i, float32x2_t output)
+    {
+        left[i] = vget_lane_f32 (output, 0);
+        right[i] = vget_lane_f32 (output, 1);
+    };
+
+    if (order == 1)
+    {
+        auto b0 = vdup_n_f32 (c[0]), b1 = vdup_n_f32 (c[1]), a1 = vdup_n_f32 (c[2]);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto input = load (i);
+            auto output = vadd_f32 (vmul_f32 (input, b0), lv1);
+            store (i, output);
+            lv1 = vsub_f32 (vmul_f32 (input, b1), vmul_f32 (output, a1));
+        }
+    }
+    else if (order == 2)
+    {
+        auto b0 = vdup_n_f32 (c[0]), b1 = vdup_n_f32 (c[1]), b2 = vdup_n_f32 (c[2]), a1 = vdup_n_f32 (c[3]), a2 = vdup_n_f32 (c[4]);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto input = load (i);
+            auto output = vadd_f32 (vmul_f32 (input, b0), lv1);
+            store (i, output);
+            lv1 = vadd_f32 (vsub_f32 (vmul_f32 (input, b1), vmul_f32 (output, a1)), lv2);
+            lv2 = vsub_f32 (vmul_f32 (input, b2), vmul_f32 (output, a2));
+        }
+    }
+
+    leftState[0] = snapToZero (vget_lane_f32 (lv1, 0));
+    leftState[1] = snapToZero (vget_lane_f32 (lv2, 0));
+    rightState[0] = snapToZero (vget_lane_f32 (lv1, 1));
+    rightState[1] = snapToZero (vget_lane_f32 (lv2, 1));
+}
+
+void combsNeon (CombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples)
+{
+    float32x4_t last[4];
+
+    for (int g = 0; g < 4; ++g)
+        last[g] = vld1q_f32 (bank.last.data() + 4 * g);
+
+    float* buffers[CombBank::numCombs];
+
+    for (int j = 0; j < CombBank::numCombs; ++j)
+        buffers[j] = bank.storage.data() + bank.offsets[(size_t) j];
+
+    auto& positions = bank.positions;
+    float outputs[CombBank::numCombs], inputs[CombBank::numCombs];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto damp = vdupq_n_f32 (damping[i]);
+        auto oneMinusDamp = vdupq_n_f32 (1.0f - damping[i]);
+        auto in = vdupq_n_f32 (input[i]);
+        auto fb = vdupq_n_f32 (feedback[i]);
+        auto offset = vdupq_n_f32 (0.1f);
+
+        for (int j = 0; j < CombBank::numCombs; ++j)
+            outputs[j] = buffers[j][positions[(size_t) j]];
+
+        for (int g = 0; g < 4; ++g)
+        {
+            auto output = vld1q_f32 (outputs + 4 * g);
+            last[g] = vsubq_f32 (vaddq_f32 (vaddq_f32 (vmulq_f32 (output, oneMinusDamp), vmulq_f32 (last[g], damp)), offset), offset);
+            vst1q_f32 (inputs + 4 * g, vsubq_f32 (vaddq_f32 (vaddq_f32 (in, vmulq_f32 (last[g], fb)), offset), offset));
+        }
+
+        for (int j = 0; j < CombBank::numCombs; ++j)
+        {
+            auto& position = positions[(size_t) j];
+            buffers[j][position] = inputs[j];
+
+            if (++position == bank.sizes[(size_t) j])
+                position = 0;
+        }
+
+        sumCombs (outputs, left[i], right[i]);
+    }
+
+    for (int g = 0; g < 4; ++g)
+        vst1q_f32 (bank.last.data() + 4 * g, last[g]);
+}
+
+inline float32x4_t approximateTanhNeon (float32x4_t x) noexcept
+{
+    // vmaxq and vminq would pass a NaN on where std::max and std::min don't, so the clamp compares and selects instead
+    auto low = vdupq_n_f32 (-tanhClamp), high = vdupq_n_f32 (tanhClamp);
+    auto clamped = vbslq_f32 (vcltq_f32 (x, low), low, x);
+    clamped = vbslq_f32 (vcltq_f32 (high, clamped), high, clamped);
+    auto x2 = vmulq_f32 (clamped, clamped);
+
+    auto p = vdupq_n_f32 (tanhNumerator[0]);
+
+    for (size_t i = 1; i < std::size (tanhNumerator); ++i)
+        p = vaddq_f32 (vmulq_f32 (p, x2), vdupq_n_f32 (tanhNumerator[i]));
+
+    auto q = vdupq_n_f32 (tanhDenominator[0]);
+
+    for (size_t i = 1; i < std::size (tanhDenominator); ++i)
+        q = vaddq_f32 (vmulq_f32 (q, x2), vdupq_n_f32 (tanhDenominator[i]));
+
+    auto ratio = vdivq_f32 (vmulq_f32 (clamped, p), q);
+    return vbslq_f32 (vcltq_f32 (vabsq_f32 (x), vdupq_n_f32 (tanhSmall)), x, ratio);
+}
+
+void waveshapeApproximateNeon (float* samples, int numSamples, float preGain, float postGain, bool sine)
+{
+    if (sine)
+    {
+        applySine (samples, numSamples, preGain);
+        preGain = 1.0f;
+    }
+
+    auto pre = vdupq_n_f32 (preGain), post = vdupq_n_f32 (postGain);
+    int i = 0;
+
+    for (; i + 4 <= numSamples; i += 4)
+        vst1q_f32 (samples + i, vmulq_f32 (approximateTanhNeon (vmulq_f32 (vld1q_f32 (samples + i), pre)), post));
+
+    waveshapeApproximateTail (samples, i, numSamples, preGain, postGain);
+}
+
+// The lane kernels, four lanes to a register, and eight as two side by side
+template <int numGroups>
+inline void biquadLanesNeonGroups (const float* c, int order, float* state, float* samples, int numSamples) noexcept
+{
+    constexpr int numLanes = 4 * numGroups;
+    float32x4_t lv1[numGroups], lv2[numGroups], b0[numGroups], b1[numGroups], b2[numGroups], a1[numGroups], a2[numGroups];
+
+    for (int g = 0; g < numGroups; ++g)
+    {
+        lv1[g] = vld1q_f32 (state + 4 * g);
+        lv2[g] = vld1q_f32 (state + numLanes + 4 * g);
+        b0[g] = vld1q_f32 (c + 4 * g);
+        b1[g] = vld1q_f32 (c + numLanes + 4 * g);
+        b2[g] = vld1q_f32 (c + 2 * numLanes + 4 * g);
+        a1[g] = vld1q_f32 (c + 3 * numLanes + 4 * g);
+        a2[g] = vld1q_f32 (c + 4 * numLanes + 4 * g);
+    }
+
+    if (order == 1)
+    {
+        // b0, b1, a1
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int g = 0; g < numGroups; ++g)
+            {
+                auto* sample = samples + i * numLanes + 4 * g;
+                auto input = vld1q_f32 (sample);
+                auto output = vaddq_f32 (vmulq_f32 (input, b0[g]), lv1[g]);
+                vst1q_f32 (sample, output);
+                lv1[g] = vsubq_f32 (vmulq_f32 (input, b1[g]), vmulq_f32 (output, b2[g]));
+            }
+        }
+    }
+    else if (order == 2)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int g = 0; g < numGroups; ++g)
+            {
+                auto* sample = samples + i * numLanes + 4 * g;
+                auto input = vld1q_f32 (sample);
+                auto output = vaddq_f32 (vmulq_f32 (input, b0[g]), lv1[g]);
+                vst1q_f32 (sample, output);
+                lv1[g] = vaddq_f32 (vsubq_f32 (vmulq_f32 (input, b1[g]), vmulq_f32 (output, a1[g])), lv2[g]);
+                lv2[g] = vsubq_f32 (vmulq_f32 (input, b2[g]), vmulq_f32 (output, a2[g]));
+            }
+        }
+    }
+
+    for (int g = 0; g < numGroups; ++g)
+    {
+        vst1q_f32 (state + 4 * g, lv1[g]);
+        vst1q_f32 (state + numLanes + 4 * g, lv2[g]);
+    }
+
+    snapStates (state, numLanes);
+}
+
+void biquadLanesNeon (const float* c, int order, float* state, float* samples, int numSamples, int numLanes)
+{
+    if (numLanes == 8)
+        biquadLanesNeonGroups<2> (c, order, state, samples, numSamples);
+    else
+        biquadLanesNeonGroups<1> (c, order, state, samples, numSamples);
+}
+
+void combLanesNeon (LaneCombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples)
+{
+    auto numLanes = bank.numLanes;
+    float* buffers[CombBank::numCombs];
+
+    for (int j = 0; j < CombBank::numCombs; ++j)
+        buffers[j] = bank.storage.data() + bank.offsets[(size_t) j];
+
+    auto* last = bank.last.data();
+    auto offset = vdupq_n_f32 (0.1f);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int g = 0; g < numLanes; g += 4)
+        {
+            auto n = i * numLanes + g;
+            auto damp = vld1q_f32 (damping + n);
+            auto oneMinusDamp = vsubq_f32 (vdupq_n_f32 (1.0f), damp);
+            auto in = vld1q_f32 (input + n);
+            auto fb = vld1q_f32 (feedback + n);
+            auto sumLeft = vdupq_n_f32 (0.0f), sumRight = vdupq_n_f32 (0.0f);
+
+            for (int j = 0; j < CombBank::numCombs; ++j)
+            {
+                auto* sample = buffers[j] + bank.positions[(size_t) j] * numLanes + g;
+                auto* combLast = last + j * numLanes + g;
+
+                auto output = vld1q_f32 (sample);
+                auto newLast = vsubq_f32 (vaddq_f32 (vaddq_f32 (vmulq_f32 (output, oneMinusDamp), vmulq_f32 (vld1q_f32 (combLast), damp)), offset), offset);
+                vst1q_f32 (combLast, newLast);
+                vst1q_f32 (sample, vsubq_f32 (vaddq_f32 (vaddq_f32 (in, vmulq_f32 (newLast, fb)), offset), offset));
+
+                if (j < 8)
+                    sumLeft = vaddq_f32 (sumLeft, output);
+                else
+                    sumRight = vaddq_f32 (sumRight, output);
+            }
+
+            vst1q_f32 (left + n, sumLeft);
+            vst1q_f32 (right + n, sumRight);
+        }
+
+        advanceCombs (bank);
+    }
+}
+
+void allPassLanesNeon (LaneAllPass& allPass, float* samples, int numSamples)
+{
+    auto numLanes = allPass.numLanes;
+    auto offset = vdupq_n_f32 (0.1f), half = vdupq_n_f32 (0.5f);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto* buffered = allPass.buffer.data() + allPass.position * numLanes;
+
+        for (int g = 0; g < numLanes; g += 4)
+        {
+            auto* sample = samples + i * numLanes + g;
+            auto input = vld1q_f32 (sample);
+            auto bufferedValue = vld1q_f32 (buffered + g);
+            vst1q_f32 (buffered + g, vsubq_f32 (vaddq_f32 (vaddq_f32 (input, vmulq_f32 (bufferedValue, half)), offset), offset));
+            vst1q_f32 (sample, vsubq_f32 (bufferedValue, input));
+        }
+
+        if (++allPass.position == allPass.size)
+            allPass.position = 0;
+    }
+}
+
+const Kernels neonKernels { Isa::neon, biquadStereoNeon, waveshapeScalar, waveshapeApproximateNeon, combsNeon, delayReadScalar, delayWriteScalar,
+                            biquadLanesNeon, combLanesNeon, allPassLanesNeon };
+#endif
+
+//==============================================================================
+const Kernels* getKernelsFor (Isa isa) noexcept
+{
+    switch (isa)
+    {
+       #if THEKNOB_X86
+        case Isa::sse2:     return &sse2Kernels;
+        case Isa::avx2:     return &avx2Kernels;
+        case Isa::avx512:   return &avx512Kernels;
+       #endif
+       #if THEKNOB_NEON
+        case Isa::neon:     return &neonKernels;
+       #endif
+        case Isa::scalar:
+        default:            return &scalarKernels;
+    }
+}
+
+#if THEKNOB_X86 && defined (_MSC_VER) && ! defined (__clang__)
+// AVX needs the OS to save the wider registers as well as the CPU to have them
+bool hasCpuFeature (Isa isa) noexcept
+{
+    int info[4] = {};
+    __cpuid (info, 0);
+
+    if (info[0] < 7)
+        return false;
+
+    __cpuid (info, 1);
+
+    if ((info[2] & (1 << 27)) == 0) // OSXSAVE
+        return false;
+
+    auto enabledState = _xgetbv (0);
+    __cpuidex (info, 7, 0);
+
+    if (isa == Isa::avx2)
+        return (enabledState & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+
+    return (enabledState & 0xe6) == 0xe6 && (info[1] & (1 << 16)) != 0;
+}
+#elif THEKNOB_X86
+bool hasCpuFeature (Isa isa) noexcept
+{
+    __builtin_cpu_init();
+    return isa == Isa::avx2 ? __builtin_cpu_supports ("avx2") != 0 : __builtin_cpu_supports ("avx512f") != 0;
+}
+#endif
+
+const Kernels* chooseKernels() noexcept
+{
+    auto isa = getBestIsa();
+
+    Isa forced;
+
+    if (findIsa (std::getenv ("THEKNOB_ISA"), forced) && isIsaSupported (forced))
+        isa = forced;
+
+    return getKernelsFor (isa);
+}
+
+std::atomic<const Kernels*> activeKernels { nullptr };
+
+} // namespace
+
+//==============================================================================
+const char* getIsaName (Isa isa) noexcept
+{
+    switch (isa)
+    {
+        case Isa::scalar:   return "scalar";
+        case Isa::sse2:     return "sse2";
+        case Isa::avx2:     return "avx2";
+        case Isa::avx512:   return "avx512";
+        case Isa::neon:     return "neon";
+        case Isa::numIsas:
+        default:            return "";
+    }
+}
+
+bool findIsa (const char* name, Isa& isa) noexcept
+{
+    if (name == nullptr)
+        return false;
+
+    std::string lowerCase (name);
+    std::transform (lowerCase.begin(), lowerCase.end(), lowerCase.begin(), [] (char c) { return (char) std::tolower ((unsigned char) c); });
+
+    for (int i = 0; i < (int) Isa::numIsas; ++i)
+    {
+        if (lowerCase == getIsaName ((Isa) i))
+        {
+            isa = (Isa) i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool isIsaSupported (Isa isa) noexcept
+{
+    switch (isa)
+    {
+        case Isa::scalar:   return true;
+       #if THEKNOB_X86
+        case Isa::sse2:     return true;
+        case Isa::avx2:     return hasCpuFeature (Isa::avx2);
+        case Isa::avx512:   return hasCpuFeature (Isa::avx512);
+       #endif
+       #if THEKNOB_NEON
+        case Isa::neon:     return true;
+       #endif
+        case Isa::numIsas:
+        default:            return false;
+    }
+}
+
+Isa getBestIsa() noexcept
+{
+    static const Isa best = []
+    {
+        for (auto isa : { Isa::avx512, Isa::avx2, Isa::sse2, Isa::neon })
+            if (isIsaSupported (isa))
+                return isa;
+
+        return Isa::scalar;
+    }();
+
+    return best;
+}
+
+const Kernels& getKernels() noexcept
+{
+    auto* kernels = activeKernels.load (std::memory_order_acquire);
+
+    if (kernels == nullptr)
+    {
+        static const Kernels* const chosen = chooseKernels();
+        const Kernels* expected = nullptr;
+        activeKernels.compare_exchange_strong (expected, chosen, std::memory_order_acq_rel);
+        kernels = activeKernels.load (std::memory_order_acquire);
+    }
+
+    return *kernels;
+}
+
+bool setKernelIsa (Isa isa) noexcept
+{
+    if (! isIsaSupported (isa))
+        return false;
+
+    activeKernels.store (getKernelsFor (isa), std::memory_order_release);
+    return true;
+}
+
+} // namespace theknob
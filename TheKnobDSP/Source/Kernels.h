@@ -0,0 +1,151 @@
+//
+//  Kernels.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "StateArchive.h"
+#include <array>
+#include <vector>
+
+namespace theknob
+{
+
+/*
+ =================================Kernels=================================
+
+ The inner loops the stages spend their time in, compiled once for each instruction set and bound at runtime to the best one this CPU
+ has, so one binary runs well on older Xeons, AVX-512 servers and ARM machines alike.
+
+ -getKernels() checks the CPU the first time it's called (CPUID on x86, NEON is always there on 64-bit ARM). The THEKNOB_ISA environment
+  variable (scalar, sse2, avx2, avx512 or neon) forces a particular one for testing. setKernelIsa() does the same from code, for the
+  benchmarks and theknob_set_isa(). An ISA the CPU can't run falls back to the best one it can.
+ -Every variant gives bit-identical results: the vector ones do the same float operations in the same order as the scalar ones, with no
+  fused multiply-adds. Renders don't depend on the machine they were made on.
+ -The waveshaper is std::tanh (and std::sin) on every ISA. A polynomial tanh vectorises, but changes the engine's output by as much as
+  -65 dB, well outside what the accuracy test allows against the JUCE reference. The cheaper QualityTiers use a rational one anyway
+  (waveshapeApproximate), 4, 8 or 16 samples at a time, and as bit-identical on every ISA as the rest.
+ -The stereo biquad runs left and right in two lanes of a 128-bit register. It's a recursive filter, so wider registers have nothing to
+  add and AVX2 and AVX-512 use the SSE2 version.
+ -The reverb's comb bank runs its combs in the lanes: 4 at a time with SSE2 and NEON, a channel's 8 with AVX2 (with gathers), and both
+  channels' 16 with AVX-512 (with gathers and scatters).
+ -The delay's reads and writes are plain loops, compiled for each ISA.
+ -The lane kernels are the BatchEngine's: 4 or 8 independent streams, interleaved sample by sample, each in its own lane. Their biquads,
+  combs and allpasses are the same as the ones above, a whole register of streams at a time, so they're as fast per sample as the
+  scalar versions and as bit-identical. 4 lanes are one SSE2 or NEON register, 8 are one AVX2 register (AVX-512 uses the AVX2 versions,
+  since the BatchEngine never runs more than 8) or two SSE2 or NEON ones, run together so their recursions overlap.
+ */
+
+enum class Isa
+{
+    scalar,
+    sse2,
+    avx2,
+    avx512,
+    neon,
+    numIsas
+};
+
+const char* getIsaName (Isa isa) noexcept;
+
+// The ISA getIsaName() calls name, in any case. Returns false if there isn't one.
+bool findIsa (const char* name, Isa& isa) noexcept;
+
+// Whether this build has the ISA's kernels and this CPU (and OS) can run them
+bool isIsaSupported (Isa isa) noexcept;
+
+// The fastest one isIsaSupported()
+Isa getBestIsa() noexcept;
+
+//==============================================================================
+// The reverb's sixteen damped combs (the left channel's eight, then the right's), all in one block of memory so the wide versions can
+// gather from them
+struct CombBank
+{
+    static constexpr int numCombs = 16;
+
+    // Allocates
+    void setSizes (const std::array<int, numCombs>& newSizes);
+    void clear() noexcept;
+
+    // the sizes and offsets are set up by setSizes()
+    void visitState (StateArchive& archive) noexcept    { archive (storage, positions, last); }
+
+    std::vector<float> storage;
+    std::array<int, numCombs> offsets {}, sizes {}, positions {};
+    std::array<float, numCombs> last {};
+};
+
+//==============================================================================
+// The same sixteen combs in each of 4 or 8 lanes, for the lane kernels. Every lane's combs are the same lengths, so each comb's samples
+// are stored a lane after another (lane 0's first sample, lane 1's, ...), and its position is the same in all of them.
+struct LaneCombBank
+{
+    static constexpr int maxLanes = 8;
+
+    // Allocates
+    void setSizes (const std::array<int, CombBank::numCombs>& newSizes, int newNumLanes);
+    void clear() noexcept;
+    void clearLane (int lane) noexcept;
+
+    std::vector<float> storage;
+    std::array<int, CombBank::numCombs> offsets {}, sizes {}, positions {};
+    std::array<float, CombBank::numCombs * maxLanes> last {};   // comb by comb, numLanes each
+    int numLanes = 4;
+};
+
+// One of the reverb's allpasses in each of 4 or 8 lanes, stored the same way
+struct LaneAllPass
+{
+    // Allocates
+    void setSize (int newSize, int newNumLanes);
+    void clear() noexcept;
+    void clearLane (int lane) noexcept;
+
+    std::vector<float> buffer;
+    int size = 0, position = 0, numLanes = 4;
+};
+
+//==============================================================================
+struct Kernels
+{
+    Isa isa;
+
+    // One first or second order section (IIRCoefficients::c and order) on both channels, in transposed direct form II
+    void (*biquadStereo) (const float* coefficients, int order, float* leftState, float* rightState, float* left, float* right, int numSamples);
+
+    // samples[i] = tanh (x) * postGain, or tanh (sin (x)) * postGain, where x = samples[i] * preGain
+    void (*waveshape) (float* samples, int numSamples, float preGain, float postGain, bool sine);
+
+    // The same with a rational approximation of tanh, within 4e-7 of it
+    void (*waveshapeApproximate) (float* samples, int numSamples, float preGain, float postGain, bool sine);
+
+    // Runs the combs on a mono input, with a damping and feedback per sample, and writes each channel's sum of its combs
+    void (*combs) (CombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples);
+
+    // dest[i] = ring[start - i], and ring[start - i] = source[i], wrapping around a ring buffer that's written backwards
+    void (*delayRead) (const float* ring, int size, int start, float* dest, int numSamples);
+    void (*delayWrite) (float* ring, int size, int start, const float* source, int numSamples);
+
+    // The lane kernels: samples[i * numLanes + lane], for numLanes 4 or 8
+    // One first or second order section in each lane, each with its own coefficients (coefficients[c * numLanes + lane], c as in
+    // IIRCoefficients::c) and state (state[s * numLanes + lane]), in transposed direct form II
+    void (*biquadLanes) (const float* coefficients, int order, float* state, float* samples, int numSamples, int numLanes);
+
+    // The combs in every lane, on each lane's mono input with its damping and feedback, writing each lane's left and right sums
+    void (*combLanes) (LaneCombBank& bank, const float* input, const float* damping, const float* feedback, float* left, float* right, int numSamples);
+
+    // One allpass in every lane, in place
+    void (*allPassLanes) (LaneAllPass& allPass, float* samples, int numSamples);
+};
+
+// The kernels everything runs with
+const Kernels& getKernels() noexcept;
+
+// Binds every kernel to this ISA's, from the next process call on. Returns false (and changes nothing) if it isn't supported.
+bool setKernelIsa (Isa isa) noexcept;
+
+} // namespace theknob
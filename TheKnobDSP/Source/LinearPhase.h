@@ -0,0 +1,246 @@
+//
+//  LinearPhase.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "Stages.h"
+#include "Convolver.h"
+#include <atomic>
+
+namespace theknob
+{
+
+/*
+ =================================Linear-Phase EQ=================================
+
+ A linear stage (the EQ or the special EQ) run as a linear-phase FIR: the same magnitude response, with no phase shift, for a fixed delay.
+
+ -The kernel is designed by frequency sampling. The IIR stage's magnitude response is sampled on a grid twice the kernel's length, transformed
+  back to a zero-phase impulse, and a Blackman window of the kernel's length is centred on it. The kernel is about 85 ms long (a power of two),
+  which resolves the lowest of the EQ's bands, and the delay is half of it.
+ -It runs on a UniformConvolver, which adds one partition of delay. getLatencySamples() is the total.
+ -setParameters() never designs on the audio thread. It only posts the new knob and mode, and updateKernel() designs the kernel on
+  whichever thread calls it (the Engine's design thread). Finished kernels are passed back through three slots, like a TripleBuffer.
+  The audio thread takes the newest at the start of a partition, and crossfades to it over that partition.
+ -For offline rendering, setDesignInBackground (false) makes setParameters() design the kernel itself, so renders don't depend on timing.
+
+ */
+
+template <typename IIRStage>
+class LinearPhaseStage
+{
+public:
+    static constexpr int partitionSize = 256;
+    static constexpr double kernelSeconds = 0.085;
+
+    // Call before prepare()
+    void setDesignInBackground (bool shouldDesignInBackground) noexcept    { designInBackground = shouldDesignInBackground; }
+
+    // Allocates everything for this sample rate, and designs the first kernel for the last parameters set
+    void prepare (double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        kernelLength = 512;
+
+        while (kernelLength < (int) (sampleRate * kernelSeconds))
+            kernelLength *= 2;
+
+        design.prepare (sampleRate);
+        designFft = std::make_unique<FFT> (getOrder (2 * kernelLength));
+        designSpectrum.assign ((size_t) kernelLength + 1, {});
+        designImpulse.assign ((size_t) (2 * kernelLength), 0.0f);
+        kernel.assign ((size_t) kernelLength, 0.0f);
+
+        const double pi = 3.14159265358979323846;
+        window.resize ((size_t) kernelLength);
+
+        for (int n = 0; n < kernelLength; ++n)
+        {
+            auto phase = 2.0 * pi * n / kernelLength;
+            window[(size_t) n] = (float) (0.42 - 0.5 * std::cos (phase) + 0.08 * std::cos (2.0 * phase));
+        }
+
+        partitionFft = std::make_unique<FFT> (getOrder (2 * partitionSize));
+        partitionScratch.assign ((size_t) (2 * partitionSize), 0.0f);
+
+        for (auto& slot : slots)
+            slot.prepare (partitionSize, kernelLength);
+
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            convolvers[ch].prepare (partitionSize, kernelLength);
+            input[ch].assign ((size_t) partitionSize, 0.0f);
+            output[ch].assign ((size_t) partitionSize, 0.0f);
+            faded[ch].assign ((size_t) partitionSize, 0.0f);
+        }
+
+        // the first kernel goes straight in, with nothing to fade from
+        designSerial = requestSerial.load();
+        designKernel (slots[0]);
+        front = 0;
+        middle = 1;
+        back = 2;
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            convolvers[ch].reset();
+            std::fill (input[ch].begin(), input[ch].end(), 0.0f);
+            std::fill (output[ch].begin(), output[ch].end(), 0.0f);
+        }
+
+        position = 0;
+    }
+
+    int getLatencySamples() const noexcept               { return partitionSize + kernelLength / 2; }
+
+    // audio thread
+    void setParameters (float knob, int mode) noexcept
+    {
+        requestedKnob.store (knob, std::memory_order_relaxed);
+        requestedMode.store (mode, std::memory_order_relaxed);
+        requestSerial.fetch_add (1, std::memory_order_release);
+
+        if (! designInBackground)
+            updateKernel();
+    }
+
+    // Designs a kernel for the last parameters set, if it hasn't already. Returns false if there was nothing to do.
+    bool updateKernel() noexcept
+    {
+        auto serial = requestSerial.load (std::memory_order_acquire);
+
+        if (serial == designSerial || designFft == nullptr)
+            return false;
+
+        designSerial = serial;
+        designKernel (slots[(size_t) back]);
+
+        back = middle.exchange (back | newKernelBit, std::memory_order_acq_rel) & slotMask;
+        return true;
+    }
+
+    void process (float* const* channels, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples;)
+        {
+            auto count = std::min (numSamples - i, partitionSize - position);
+
+            for (size_t ch = 0; ch < 2; ++ch)
+            {
+                std::copy (channels[ch] + i, channels[ch] + i + count, input[ch].begin() + position);
+                std::copy (output[ch].begin() + position, output[ch].begin() + position + count, channels[ch] + i);
+            }
+
+            i += count;
+            position += count;
+
+            if (position == partitionSize)
+            {
+                processPartition();
+                position = 0;
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    void processPartition() noexcept
+    {
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            convolvers[ch].pushPartition (input[ch].data());
+            convolvers[ch].convolve (slots[(size_t) front], output[ch].data());
+        }
+
+        if ((middle.load (std::memory_order_relaxed) & newKernelBit) == 0)
+            return;
+
+        // the old kernel's output is done, so its slot can go back to the designer
+        front = middle.exchange (front, std::memory_order_acq_rel) & slotMask;
+
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            convolvers[ch].convolve (slots[(size_t) front], faded[ch].data());
+
+            for (int i = 0; i < partitionSize; ++i)
+            {
+                auto gain = (float) (i + 1) / (float) partitionSize;
+                output[ch][(size_t) i] += (faded[ch][(size_t) i] - output[ch][(size_t) i]) * gain;
+            }
+        }
+    }
+
+    void designKernel (PartitionedKernel& slot) noexcept
+    {
+        design.setParameters (requestedKnob.load (std::memory_order_relaxed), requestedMode.load (std::memory_order_relaxed));
+
+        // zero phase: a real, symmetric impulse around 0
+        auto designSize = 2 * kernelLength;
+
+        for (int k = 0; k <= kernelLength; ++k)
+            designSpectrum[(size_t) k] = { (float) design.getMagnitudeForFrequency (k * sampleRate / designSize), 0.0f };
+
+        designFft->inverse (designSpectrum.data(), designImpulse.data());
+
+        // centred on the middle of the kernel, windowed
+        for (int n = 0; n < kernelLength; ++n)
+        {
+            auto m = n - kernelLength / 2;
+            kernel[(size_t) n] = designImpulse[(size_t) ((m + designSize) % designSize)] * window[(size_t) n];
+        }
+
+        slot.set (*partitionFft, kernel.data(), kernelLength, partitionScratch.data());
+    }
+
+    static int getOrder (int size) noexcept
+    {
+        int order = 0;
+
+        while ((1 << order) < size)
+            ++order;
+
+        return order;
+    }
+
+    //==============================================================================
+    static constexpr int newKernelBit = 4;
+    static constexpr int slotMask = 3;
+
+    double sampleRate = 44100.0;
+    int kernelLength = 512;
+    bool designInBackground = true;
+
+    // posted by the audio thread
+    std::atomic<float> requestedKnob { KNOB_DEFAULT_VALUE };
+    std::atomic<int> requestedMode { VIOLET };
+    std::atomic<unsigned int> requestSerial { 0 };
+
+    // the designer's
+    unsigned int designSerial = 0;
+    IIRStage design;
+    std::unique_ptr<FFT> designFft, partitionFft;
+    std::vector<FFT::Complex> designSpectrum;
+    std::vector<float> designImpulse, kernel, window, partitionScratch;
+    int back = 2;
+
+    // the kernels: the audio thread's (front), the designer's (back), and the one being handed over (middle, flagged when it's new)
+    std::array<PartitionedKernel, 3> slots;
+    std::atomic<int> middle { 1 };
+    int front = 0;
+
+    // the audio thread's
+    std::array<UniformConvolver, 2> convolvers;
+    std::array<std::vector<float>, 2> input, output, faded;
+    int position = 0;
+};
+
+} // namespace theknob
@@ -0,0 +1,366 @@
+//
+//  Multirate.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "StateArchive.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace theknob
+{
+
+/*
+ =================================Multirate=================================
+
+ Taking a signal down to around 48 kHz and back up again, for the reverb and delay's wet paths at high sample rates. Both low-pass
+ their input hard, so running them at 88.2 kHz and up only costs more CPU and memory.
+
+ -The rate is halved (or doubled) by a cascade of half-band FIRs, as many as it takes to get to 44.1 or 48 kHz. Every other tap of a
+  half-band filter is zero, so each one is run polyphase: only the odd taps are multiplied, folded around the centre, once per
+  low-rate sample.
+ -The last stage (next to the low rate) is long enough to keep the whole audio band and reject what would alias into it by 80 dB. The
+  ones before only have to clear the band above the next stage's.
+ -The round trip delays the signal by a fixed number of full-rate samples (getRoundTripLatency()), which the stages compensate.
+ */
+
+// How many times the rate is halved to get down to 44.1 or 48 kHz: 1 (not at all), 2, 4 or 8
+inline int getRateReductionFactor (double sampleRate) noexcept
+{
+    int factor = 1;
+
+    while (factor < 8 && sampleRate / (2 * factor) >= 44100.0 - 1.0)
+        factor *= 2;
+
+    return factor;
+}
+
+//==============================================================================
+// The odd taps of one side of a Kaiser-windowed half-band lowpass, 4 * numTaps - 1 long. The centre tap is always 0.5.
+class HalfBandFilter
+{
+public:
+    explicit HalfBandFilter (int numTaps = 1)
+        : taps ((size_t) numTaps)
+    {
+        std::vector<double> design ((size_t) numTaps);
+        const double pi = 3.14159265358979323846;
+        const double beta = 8.0; // about 80 dB
+        auto halfLength = 2.0 * numTaps; // the window is 0 at +-(2 * numTaps)
+        double sum = 0.0;
+
+        for (int i = 0; i < numTaps; ++i)
+        {
+            auto offset = 2.0 * i + 1.0;
+            auto ratio = offset / halfLength;
+            auto window = besselI0 (beta * std::sqrt (1.0 - ratio * ratio)) / besselI0 (beta);
+            auto sinc = std::sin (pi * offset / 2.0) / (pi * offset / 2.0);
+            design[(size_t) i] = 0.5 * sinc * window;
+            sum += 2.0 * design[(size_t) i];
+        }
+
+        // unity at DC: the odd taps add up to 0.5, the same as the centre
+        for (size_t i = 0; i < taps.size(); ++i)
+            taps[i] = (float) (design[i] * 0.5 / sum);
+    }
+
+    int getNumTaps() const noexcept                      { return (int) taps.size(); }
+    int getLength() const noexcept                       { return 4 * getNumTaps() - 1; }
+    const float* getTaps() const noexcept                { return taps.data(); }
+
+private:
+    static double besselI0 (double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 50 && term > 1.0e-12 * sum; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    std::vector<float> taps;
+};
+
+//==============================================================================
+// One channel, full rate in, low rate out
+class Decimator
+{
+public:
+    // Allocates for up to maxSamples in one call. factor is 1, 2, 4 or 8.
+    void prepare (int newFactor, int maxSamples)
+    {
+        factor = newFactor;
+        stages.clear();
+
+        for (int rate = factor; rate > 1; rate /= 2)
+            stages.emplace_back (rate == 2 ? lastStageTaps : earlyStageTaps, (maxSamples + factor) * rate / factor);
+
+        pending.assign ((size_t) (maxSamples + factor), 0.0f);
+        scratch.assign ((size_t) (maxSamples + factor), 0.0f);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& stage : stages)
+            stage.reset();
+
+        numPending = 0;
+    }
+
+    void visitState (StateArchive& archive) noexcept    { archive (stages, pending, numPending); }
+
+    // Returns the number of low-rate samples written to output, which can be up to numSamples / factor + 1
+    int process (const float* input, int numSamples, float* output) noexcept
+    {
+        if (factor == 1)
+        {
+            std::copy (input, input + numSamples, output);
+            return numSamples;
+        }
+
+        // only whole groups of factor samples go down, the rest waits for the next call. With nothing waiting, the input is used as it is.
+        const auto* source = input;
+
+        if (numPending > 0)
+        {
+            std::copy (input, input + numSamples, pending.data() + numPending);
+            source = pending.data();
+        }
+
+        auto count = numPending + numSamples;
+        auto numGroups = count / factor;
+
+        if (numGroups > 0)
+        {
+            const auto* in = source;
+            auto n = numGroups * factor;
+
+            for (size_t i = 0; i < stages.size(); ++i)
+            {
+                auto* out = i + 1 == stages.size() ? output : scratch.data();
+                stages[i].process (in, n, out);
+                in = out;
+                n /= 2;
+            }
+        }
+
+        numPending = count - numGroups * factor;
+        std::copy (source + numGroups * factor, source + count, pending.data());
+
+        return numGroups;
+    }
+
+    static constexpr int lastStageTaps = 16;
+    static constexpr int earlyStageTaps = 5;
+
+private:
+    // every other input makes an output. The inputs are split into even and odd ones, so each tap runs over contiguous samples.
+    struct Stage
+    {
+        Stage (int numTaps, int maxSamples)
+            : filter (numTaps),
+              historyLength (2 * numTaps - 1)
+        {
+            for (auto& phase : phases)
+                phase.assign ((size_t) (historyLength + maxSamples / 2), 0.0f);
+        }
+
+        void reset() noexcept
+        {
+            for (auto& phase : phases)
+                std::fill (phase.begin(), phase.end(), 0.0f);
+        }
+
+        void visitState (StateArchive& archive) noexcept { archive (phases); }
+
+        // numSamples is even, output gets numSamples / 2. It can be the same as input.
+        void process (const float* input, int numSamples, float* output) noexcept
+        {
+            auto numOutput = numSamples / 2;
+            auto* even = phases[0].data();
+            auto* odd = phases[1].data();
+
+            for (int j = 0; j < numOutput; ++j)
+            {
+                even[historyLength + j] = input[2 * j];
+                odd[historyLength + j] = input[2 * j + 1];
+            }
+
+            // the centre tap is an even sample, and all the others are odd ones
+            auto numTaps = filter.getNumTaps();
+            const auto* taps = filter.getTaps();
+
+            for (int j = 0; j < numOutput; ++j)
+                output[j] = 0.5f * even[j + numTaps];
+
+            for (int i = 0; i < numTaps; ++i)
+            {
+                const auto* before = odd + numTaps - 1 - i;
+                const auto* after = odd + numTaps + i;
+
+                for (int j = 0; j < numOutput; ++j)
+                    output[j] += taps[i] * (before[j] + after[j]);
+            }
+
+            for (auto& phase : phases)
+                std::copy (phase.begin() + numOutput, phase.begin() + numOutput + historyLength, phase.begin());
+        }
+
+        HalfBandFilter filter;
+        int historyLength;
+        std::array<std::vector<float>, 2> phases;
+    };
+
+    int factor = 1;
+    std::vector<Stage> stages;
+    std::vector<float> pending, scratch;
+    int numPending = 0;
+};
+
+//==============================================================================
+// One channel, low rate in, full rate out. There's always exactly one output sample for every full-rate sample that went into the
+// matching Decimator, at a fixed delay.
+class Interpolator
+{
+public:
+    // Allocates for up to maxLowRateSamples in one call
+    void prepare (int newFactor, int maxLowRateSamples)
+    {
+        factor = newFactor;
+        stages.clear();
+
+        // from the low rate up
+        for (int rate = 2; rate <= factor; rate *= 2)
+            stages.emplace_back (rate == 2 ? Decimator::lastStageTaps : Decimator::earlyStageTaps, maxLowRateSamples * rate / 2);
+
+        for (auto& buffer : scratch)
+            buffer.assign ((size_t) (maxLowRateSamples * factor), 0.0f);
+
+        pending.assign ((size_t) ((maxLowRateSamples + 2) * factor), 0.0f);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& stage : stages)
+            stage.reset();
+
+        // the low-rate sample for a group of inputs only arrives with the last of them, so the ones before it play this
+        std::fill (pending.begin(), pending.end(), 0.0f);
+        numPending = factor - 1;
+    }
+
+    void visitState (StateArchive& archive) noexcept    { archive (stages, pending, numPending); }
+
+    // Takes numLowRate samples, and writes the next numSamples full-rate ones
+    void process (const float* input, int numLowRate, float* output, int numSamples) noexcept
+    {
+        if (factor == 1)
+        {
+            std::copy (input, input + numSamples, output);
+            return;
+        }
+
+        // the last stage writes straight after the samples still waiting to go out
+        const auto* in = input;
+        auto n = numLowRate;
+
+        for (size_t i = 0; i < stages.size(); ++i)
+        {
+            auto* out = i + 1 == stages.size() ? pending.data() + numPending : scratch[i % 2].data();
+            stages[i].process (in, n, out);
+            in = out;
+            n *= 2;
+        }
+
+        auto count = numPending + n;
+        std::copy (pending.data(), pending.data() + numSamples, output);
+        std::copy (pending.data() + numSamples, pending.data() + count, pending.data());
+        numPending = count - numSamples;
+    }
+
+    // the full-rate delay from the Decimator's input to this one's output
+    static int getRoundTripLatency (int factor) noexcept
+    {
+        int latency = 0;
+
+        // each stage delays by its length - 1 samples of the higher of its two rates, half of it on the way down and half on the way up
+        // (the samples waiting in pending are part of that)
+        for (int rate = factor; rate > 1; rate /= 2)
+            latency += (factor / rate) * (HalfBandFilter (rate == 2 ? Decimator::lastStageTaps : Decimator::earlyStageTaps).getLength() - 1);
+
+        return latency;
+    }
+
+private:
+    // every input makes two outputs: the filtered point halfway between it and the one before, then a delayed copy of an input
+    struct Stage
+    {
+        Stage (int numTaps, int maxSamples)
+            : filter (numTaps),
+              historyLength (2 * numTaps - 1),
+              history ((size_t) (historyLength + maxSamples), 0.0f),
+              between ((size_t) maxSamples, 0.0f)
+        {
+        }
+
+        void reset() noexcept
+        {
+            std::fill (history.begin(), history.end(), 0.0f);
+        }
+
+        // between is only scratch
+        void visitState (StateArchive& archive) noexcept { archive (history); }
+
+        // output gets 2 * numSamples
+        void process (const float* input, int numSamples, float* output) noexcept
+        {
+            std::copy (input, input + numSamples, history.begin() + historyLength);
+
+            auto numTaps = filter.getNumTaps();
+            const auto* taps = filter.getTaps();
+            const auto* u = history.data();
+            std::fill (between.begin(), between.begin() + numSamples, 0.0f);
+
+            for (int i = 0; i < numTaps; ++i)
+            {
+                const auto* before = u + numTaps - 1 - i;
+                const auto* after = u + numTaps + i;
+
+                for (int j = 0; j < numSamples; ++j)
+                    between[(size_t) j] += 2.0f * taps[i] * (before[j] + after[j]);
+            }
+
+            for (int j = 0; j < numSamples; ++j)
+            {
+                output[2 * j] = between[(size_t) j];
+                output[2 * j + 1] = u[j + numTaps];
+            }
+
+            std::copy (history.begin() + numSamples, history.begin() + numSamples + historyLength, history.begin());
+        }
+
+        HalfBandFilter filter;
+        int historyLength;
+        std::vector<float> history, between;
+    };
+
+    int factor = 1;
+    std::vector<Stage> stages;
+    std::array<std::vector<float>, 2> scratch;
+    std::vector<float> pending;
+    int numPending = 0;
+};
+
+} // namespace theknob
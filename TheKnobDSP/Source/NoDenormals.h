@@ -0,0 +1,56 @@
+//
+//  NoDenormals.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <cstdint>
+
+#if defined (__SSE__) || defined (_M_X64) || defined (_M_IX86)
+ #include <xmmintrin.h>
+ #define THEKNOB_USE_SSE_CSR 1
+#endif
+
+namespace theknob
+{
+
+//==============================================================================
+// Turns on flush-to-zero (and denormals-are-zero) for its lifetime, like juce::ScopedNoDenormals does for the plug-in
+class ScopedNoDenormals
+{
+public:
+    ScopedNoDenormals() noexcept
+    {
+       #if THEKNOB_USE_SSE_CSR
+        previous = _mm_getcsr();
+        _mm_setcsr (previous | 0x8040); // FTZ | DAZ
+       #elif defined (__aarch64__)
+        asm volatile ("mrs %0, fpcr" : "=r" (previous));
+        asm volatile ("msr fpcr, %0" : : "r" (previous | (1ull << 24))); // FZ
+       #endif
+    }
+
+    ~ScopedNoDenormals() noexcept
+    {
+       #if THEKNOB_USE_SSE_CSR
+        _mm_setcsr ((unsigned int) previous);
+       #elif defined (__aarch64__)
+        asm volatile ("msr fpcr, %0" : : "r" (previous));
+       #endif
+    }
+
+private:
+   #if defined (__aarch64__) && ! THEKNOB_USE_SSE_CSR
+    std::uint64_t previous = 0;
+   #else
+    unsigned int previous = 0;
+   #endif
+
+    ScopedNoDenormals (const ScopedNoDenormals&) = delete;
+    ScopedNoDenormals& operator= (const ScopedNoDenormals&) = delete;
+};
+
+} // namespace theknob
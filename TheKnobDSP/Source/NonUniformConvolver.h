@@ -0,0 +1,605 @@
+//
+//  NonUniformConvolver.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "Convolver.h"
+#include "Semaphore.h"
+#include "Trace.h"
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace theknob
+{
+
+/*
+ =================================Non-Uniformly Partitioned Convolution=================================
+
+ Convolution with impulse responses seconds long (the convolution reverb's), with no latency and a bounded cost per sample:
+
+ -The first 128 samples of the response are a direct-form FIR, so the output starts on the same sample as the input.
+ -The rest is cut into segments of uniformly partitioned convolution (see Convolver.h), each with partitions 4x as long as the one
+  before: 64, 256, 1024, 4096 and 16384 samples. A segment with partitions of B samples starts 2B into the response and covers 6
+  partitions, up to where the next one starts, and the last one covers everything from 32768 samples on. Starting 2B in gives every
+  segment a whole partition of slack between having its input and owing its output, so the short partitions keep the latency at zero
+  and the long ones keep the cost of the tail low.
+ -The segments with partitions of 4096 and up are run on a worker thread the convolver owns. Every B samples the audio thread hands
+  it a partition of input, wakes it through a Semaphore, and takes back the output of the one before. The worker sleeps until then.
+ -If the worker is late, that partition of the tail is left out of the output rather than waited for. If it's so far behind that
+  its queue is full, the audio thread holds on to the partition and hands it over later, for the worker's delay line only, so the
+  rest of the tail still lines up and only that one output is lost. Only a worker a whole queue behind on that as well loses its
+  delay line, and starts again from silence.
+ -The response can be switched while it plays. The head and each segment crossfade from the old response to the new one over their
+  next partition, and since the delay lines only hold input, the new response applies to the whole history straight away.
+ */
+
+struct NonUniformLayout
+{
+    static constexpr int headLength = 128;
+    static constexpr int firstPartitionSize = 64;
+    static constexpr int maxSegments = 5;
+    static constexpr int firstBackgroundSegment = 3; // partitions of 4096
+
+    static int getPartitionSize (int segment) noexcept   { return firstPartitionSize << (2 * segment); }
+    static int getStart (int segment) noexcept           { return 2 * getPartitionSize (segment); }
+
+    // how much of a response this long the segment covers
+    static int getLength (int segment, int responseLength) noexcept
+    {
+        auto end = segment == maxSegments - 1 ? responseLength : std::min (responseLength, getStart (segment + 1));
+        return std::max (0, end - getStart (segment));
+    }
+
+    static int getNumSegments (int responseLength) noexcept
+    {
+        int numSegments = 0;
+
+        while (numSegments < maxSegments && getStart (numSegments) < responseLength)
+            ++numSegments;
+
+        return numSegments;
+    }
+
+    static int getOrder (int size) noexcept
+    {
+        int order = 0;
+
+        while ((1 << order) < size)
+            ++order;
+
+        return order;
+    }
+};
+
+//==============================================================================
+// A stereo impulse response cut up for a NonUniformConvolver: the head's taps, and each segment's partition spectra for both channels
+class ImpulseResponse
+{
+public:
+    static constexpr int numOutputs = 2;
+
+    // allocates room for responses of up to maxLength samples
+    void prepare (int newMaxLength)
+    {
+        maxLength = newMaxLength;
+        length = 0;
+
+        for (auto& taps : head)
+            taps.assign ((size_t) NonUniformLayout::headLength, 0.0f);
+
+        segments.clear();
+        segments.resize ((size_t) NonUniformLayout::getNumSegments (maxLength));
+
+        for (int s = 0; s < (int) segments.size(); ++s)
+        {
+            auto& segment = segments[(size_t) s];
+            auto partitionSize = NonUniformLayout::getPartitionSize (s);
+
+            segment.fft = std::make_unique<FFT> (NonUniformLayout::getOrder (2 * partitionSize));
+            segment.scratch.assign ((size_t) (2 * partitionSize), 0.0f);
+
+            for (auto& kernel : segment.kernels)
+                kernel.prepare (partitionSize, NonUniformLayout::getLength (s, maxLength));
+        }
+    }
+
+    // Doesn't allocate, but transforms the whole response, so not on the audio thread. A single channel goes to both outputs.
+    void set (const float* const* channels, int numChannels, int newLength) noexcept
+    {
+        length = std::clamp (newLength, 0, maxLength);
+
+        for (int ch = 0; ch < numOutputs; ++ch)
+        {
+            const auto* response = channels[std::min (ch, numChannels - 1)];
+            auto& taps = head[(size_t) ch];
+
+            for (int i = 0; i < NonUniformLayout::headLength; ++i)
+                taps[(size_t) i] = i < length ? response[i] : 0.0f;
+
+            for (int s = 0; s < (int) segments.size(); ++s)
+            {
+                auto& segment = segments[(size_t) s];
+                auto start = NonUniformLayout::getStart (s);
+                segment.kernels[(size_t) ch].set (*segment.fft, response + std::min (start, length),
+                                                  NonUniformLayout::getLength (s, length), segment.scratch.data());
+            }
+        }
+    }
+
+    int getLength() const noexcept                                          { return length; }
+    const float* getHead (int ch) const noexcept                            { return head[(size_t) ch].data(); }
+    const PartitionedKernel& getKernel (int segment, int ch) const noexcept { return segments[(size_t) segment].kernels[(size_t) ch]; }
+
+private:
+    struct Segment
+    {
+        std::unique_ptr<FFT> fft;
+        std::vector<float> scratch;
+        std::array<PartitionedKernel, numOutputs> kernels;
+    };
+
+    int maxLength = 0, length = 0;
+    std::array<std::vector<float>, numOutputs> head;
+    std::vector<Segment> segments;
+};
+
+//==============================================================================
+// One input, two outputs. The responses it plays belong to the caller, and have to stay put until canSwitch() says they're done with.
+class NonUniformConvolver
+{
+public:
+    static constexpr int numOutputs = ImpulseResponse::numOutputs;
+
+    ~NonUniformConvolver()
+    {
+        stopWorker();
+    }
+
+    // Allocates for responses of up to maxLength samples. Without the worker, every segment runs on the audio thread.
+    void prepare (int maxLength, bool useWorker)
+    {
+        stopWorker();
+
+        auto numSegments = NonUniformLayout::getNumSegments (maxLength);
+        segments.clear();
+
+        for (int s = 0; s < numSegments; ++s)
+        {
+            auto segment = std::make_unique<Segment>();
+            auto partitionSize = NonUniformLayout::getPartitionSize (s);
+
+            segment->partitionSize = partitionSize;
+            segment->inBackground = useWorker && s >= NonUniformLayout::firstBackgroundSegment;
+            segment->convolver.prepare (partitionSize, NonUniformLayout::getLength (s, maxLength));
+            segment->input.assign ((size_t) partitionSize, 0.0f);
+            segment->faded.assign ((size_t) partitionSize, 0.0f);
+
+            for (auto& input : segment->held)
+                input.assign ((size_t) partitionSize, 0.0f);
+
+            for (size_t ch = 0; ch < numOutputs; ++ch)
+            {
+                segment->output[ch].assign ((size_t) partitionSize, 0.0f);
+                segment->next[ch].assign ((size_t) partitionSize, 0.0f);
+            }
+
+            for (auto& job : segment->jobs)
+            {
+                job.input.assign ((size_t) partitionSize, 0.0f);
+
+                for (auto& output : job.output)
+                    output.assign ((size_t) partitionSize, 0.0f);
+            }
+
+            segments.push_back (std::move (segment));
+        }
+
+        current = previous = nullptr;
+        reset();
+
+        if (useWorker && numSegments > NonUniformLayout::firstBackgroundSegment)
+            startWorker();
+    }
+
+    // audio thread
+    void reset() noexcept
+    {
+        std::fill (headInput.begin(), headInput.end(), 0.0f);
+
+        for (auto& segment : segments)
+        {
+            auto& s = *segment;
+            std::fill (s.input.begin(), s.input.end(), 0.0f);
+
+            for (size_t ch = 0; ch < numOutputs; ++ch)
+            {
+                std::fill (s.output[ch].begin(), s.output[ch].end(), 0.0f);
+                std::fill (s.next[ch].begin(), s.next[ch].end(), 0.0f);
+            }
+
+            s.position = 0;
+
+            if (s.inBackground)
+            {
+                // whatever the worker still has is thrown away, and it clears its delay line before the next partition
+                s.outputDue = false;
+                s.numHeld = 0;
+                s.resetPending = true;
+            }
+            else
+            {
+                s.convolver.reset();
+            }
+        }
+    }
+
+    // True once the previous response is no longer used, by the audio thread or the worker. Only then can switchTo() be called.
+    bool canSwitch() noexcept
+    {
+        if (previous == nullptr)
+            return true;
+
+        if (headFadePending)
+            return false;
+
+        for (auto& segment : segments)
+            if (segment->fadePending || (segment->inBackground && segment->completed.load (std::memory_order_acquire) <= segment->fadeJob))
+                return false;
+
+        previous = nullptr;
+        return true;
+    }
+
+    // audio thread: starts playing this response, crossfading from the one before
+    void switchTo (const ImpulseResponse* response) noexcept
+    {
+        previous = current;
+        current = response;
+
+        if (previous == nullptr)
+            return;
+
+        headFadePending = true;
+
+        // a background segment's fade is the next job it's given that has an output
+        for (auto& segment : segments)
+            segment->fadePending = true;
+    }
+
+    // audio thread: adds the input convolved with the response to both outputs
+    void process (const float* input, float* const* outputs, int numSamples) noexcept
+    {
+        if (current == nullptr)
+            return;
+
+        for (int i = 0; i < numSamples;)
+        {
+            auto count = std::min (numSamples - i, headBlockSize);
+            float* chunk[] = { outputs[0] + i, outputs[1] + i };
+
+            processHead (input + i, chunk, count);
+            i += count;
+        }
+
+        for (int s = 0; s < (int) segments.size(); ++s)
+            processSegment (s, input, outputs, numSamples);
+    }
+
+    // partitions of the tail the worker didn't finish in time
+    int getNumLatePartitions() const noexcept            { return numLatePartitions; }
+
+private:
+    //==============================================================================
+    static constexpr int headBlockSize = 64;
+    static constexpr int numJobs = 4;
+
+    using Output = std::array<std::vector<float>, numOutputs>;
+
+    // a partition of input for the worker, and its output once it's done (unless it's only for the delay line)
+    struct Job
+    {
+        std::vector<float> input;
+        Output output;
+        const ImpulseResponse* from = nullptr;
+        const ImpulseResponse* to = nullptr;
+        bool resetFirst = false;
+        bool hasOutput = false;
+    };
+
+    struct Segment
+    {
+        int partitionSize = 0;
+        bool inBackground = false;
+
+        // the worker's when the segment is in the background
+        UniformConvolver convolver;
+        std::vector<float> faded;
+
+        // the audio thread's: input collected, output playing now, and the output due after it
+        std::vector<float> input;
+        Output output, next;
+        int position = 0;
+        bool fadePending = false;
+
+        // background segments only. The audio thread posts jobs in order, the worker completes them in order.
+        std::array<Job, numJobs> jobs;
+        std::atomic<unsigned int> posted { 0 }, completed { 0 };
+        unsigned int outputJob = 0, fadeJob = 0;
+        bool outputDue = false, outputPosted = false, resetPending = false;
+
+        // the audio thread's: partitions the queue had no room for, oldest first, still to go to the worker's delay line
+        std::array<std::vector<float>, numJobs> held;
+        int firstHeld = 0, numHeld = 0;
+    };
+
+    //==============================================================================
+    // direct form, a block at a time: each tap is a multiply-add across the block, which vectorises
+    void processHead (const float* input, float* const* outputs, int numSamples) noexcept
+    {
+        const int historyLength = NonUniformLayout::headLength - 1;
+        std::copy (input, input + numSamples, headInput.begin() + historyLength);
+
+        for (int ch = 0; ch < numOutputs; ++ch)
+        {
+            headTaps (current->getHead (ch), headOutput.data(), numSamples);
+
+            if (headFadePending)
+            {
+                headTaps (previous->getHead (ch), headFaded.data(), numSamples);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    auto gain = (float) (i + 1) / (float) numSamples;
+                    headOutput[(size_t) i] = headFaded[(size_t) i] + (headOutput[(size_t) i] - headFaded[(size_t) i]) * gain;
+                }
+            }
+
+            for (int i = 0; i < numSamples; ++i)
+                outputs[ch][i] += headOutput[(size_t) i];
+        }
+
+        headFadePending = false;
+        std::copy (headInput.begin() + numSamples, headInput.begin() + numSamples + historyLength, headInput.begin());
+    }
+
+    void headTaps (const float* taps, float* output, int numSamples) noexcept
+    {
+        const int historyLength = NonUniformLayout::headLength - 1;
+        std::fill (output, output + numSamples, 0.0f);
+
+        for (int k = 0; k < NonUniformLayout::headLength; ++k)
+        {
+            const auto tap = taps[k];
+            const auto* x = headInput.data() + historyLength - k;
+
+            for (int i = 0; i < numSamples; ++i)
+                output[i] += tap * x[i];
+        }
+    }
+
+    void processSegment (int index, const float* input, float* const* outputs, int numSamples) noexcept
+    {
+        auto& s = *segments[(size_t) index];
+
+        for (int i = 0; i < numSamples;)
+        {
+            auto count = std::min (numSamples - i, s.partitionSize - s.position);
+            std::copy (input + i, input + i + count, s.input.begin() + s.position);
+
+            for (size_t ch = 0; ch < numOutputs; ++ch)
+            {
+                const auto* source = s.output[ch].data() + s.position;
+                auto* dest = outputs[ch] + i;
+
+                for (int j = 0; j < count; ++j)
+                    dest[j] += source[j];
+            }
+
+            i += count;
+            s.position += count;
+
+            if (s.position == s.partitionSize)
+            {
+                s.position = 0;
+
+                if (s.inBackground)
+                    handOver (s);
+                else
+                    computePartition (index, s);
+            }
+        }
+    }
+
+    void computePartition (int index, Segment& s) noexcept
+    {
+        std::swap (s.output, s.next);
+        s.convolver.pushPartition (s.input.data());
+        convolve (s, index, s.fadePending ? previous : nullptr, *current, s.next);
+        s.fadePending = false;
+    }
+
+    // a partition boundary of a background segment: the output of the last partition is due, and this one goes to the worker
+    void handOver (Segment& s) noexcept
+    {
+        auto completed = s.completed.load (std::memory_order_acquire);
+
+        if (s.outputDue)
+        {
+            if (s.outputPosted && completed > s.outputJob)
+            {
+                for (size_t ch = 0; ch < numOutputs; ++ch)
+                    s.output[ch] = s.jobs[s.outputJob % numJobs].output[ch];
+            }
+            else
+            {
+                for (auto& output : s.output)
+                    std::fill (output.begin(), output.end(), 0.0f);
+
+                ++numLatePartitions;
+            }
+        }
+
+        auto posted = s.posted.load (std::memory_order_relaxed);
+        auto firstPosted = posted;
+        auto hasRoom = [&] { return posted - completed < (unsigned int) numJobs; };
+
+        // the partitions held back go first, so the worker's delay line gets every partition in order
+        while (s.numHeld > 0 && hasRoom())
+        {
+            postJob (s, posted++, s.held[(size_t) s.firstHeld], false);
+            s.firstHeld = (s.firstHeld + 1) % numJobs;
+            --s.numHeld;
+        }
+
+        s.outputDue = true;
+        s.outputPosted = s.numHeld == 0 && hasRoom();
+
+        if (s.outputPosted)
+        {
+            s.outputJob = posted;
+            postJob (s, posted++, s.input, true);
+        }
+        else
+        {
+            // The worker is more than the whole queue behind, so this partition's output is left out, and it's held back. If even that
+            // is full, the delay line can't be kept, so the worker clears it before the next partition.
+            if (s.numHeld == numJobs)
+            {
+                s.numHeld = 0;
+                s.resetPending = true;
+            }
+
+            s.held[(size_t) ((s.firstHeld + s.numHeld++) % numJobs)] = s.input;
+        }
+
+        if (posted != firstPosted)
+        {
+            s.posted.store (posted, std::memory_order_release);
+            workAvailable.post();
+        }
+    }
+
+    void postJob (Segment& s, unsigned int index, const std::vector<float>& input, bool hasOutput) noexcept
+    {
+        auto& job = s.jobs[index % numJobs];
+        job.input = input;
+        job.hasOutput = hasOutput;
+        job.from = hasOutput && s.fadePending ? previous : nullptr;
+        job.to = current;
+        job.resetFirst = s.resetPending;
+        s.resetPending = false;
+
+        if (hasOutput && s.fadePending)
+        {
+            s.fadeJob = index;
+            s.fadePending = false;
+        }
+    }
+
+    // this partition's output through the response, faded in from the previous one's if there is one
+    void convolve (Segment& s, int index, const ImpulseResponse* from, const ImpulseResponse& to, Output& output) noexcept
+    {
+        for (int ch = 0; ch < numOutputs; ++ch)
+        {
+            auto& dest = output[(size_t) ch];
+            convolveKernel (s.convolver, to.getKernel (index, ch), dest.data());
+
+            if (from == nullptr)
+                continue;
+
+            convolveKernel (s.convolver, from->getKernel (index, ch), s.faded.data());
+
+            for (int i = 0; i < s.partitionSize; ++i)
+            {
+                auto gain = (float) (i + 1) / (float) s.partitionSize;
+                dest[(size_t) i] = s.faded[(size_t) i] + (dest[(size_t) i] - s.faded[(size_t) i]) * gain;
+            }
+        }
+    }
+
+    // a response too short to reach this segment leaves it silent
+    static void convolveKernel (UniformConvolver& convolver, const PartitionedKernel& kernel, float* output) noexcept
+    {
+        if (kernel.getNumPartitions() > 0)
+            convolver.convolve (kernel, output);
+        else
+            std::fill (output, output + convolver.getPartitionSize(), 0.0f);
+    }
+
+    //==============================================================================
+    void startWorker()
+    {
+        workerShouldExit = false;
+
+        worker = std::thread ([this]
+        {
+            Trace::setThreadName ("Convolution worker");
+
+            for (;;)
+            {
+                workAvailable.wait();
+
+                if (workerShouldExit.load())
+                    break;
+
+                // the short partitions have the closest deadlines, so they go first
+                for (int index = 0; index < (int) segments.size(); ++index)
+                {
+                    auto& s = *segments[(size_t) index];
+
+                    if (! s.inBackground)
+                        continue;
+
+                    for (auto done = s.completed.load (std::memory_order_relaxed); done < s.posted.load (std::memory_order_acquire); ++done)
+                    {
+                        auto& job = s.jobs[done % numJobs];
+                        TraceScope span ("Reverb partition", "background", "segment", index);
+
+                        if (job.resetFirst)
+                            s.convolver.reset();
+
+                        s.convolver.pushPartition (job.input.data());
+
+                        if (job.hasOutput)
+                            convolve (s, index, job.from, *job.to, job.output);
+
+                        s.completed.store (done + 1, std::memory_order_release);
+                    }
+                }
+            }
+        });
+    }
+
+    void stopWorker()
+    {
+        if (! worker.joinable())
+            return;
+
+        workerShouldExit = true;
+        workAvailable.post();
+        worker.join();
+    }
+
+    //==============================================================================
+    const ImpulseResponse* current = nullptr;
+    const ImpulseResponse* previous = nullptr;
+
+    // the last 127 inputs, then the block
+    std::array<float, NonUniformLayout::headLength - 1 + headBlockSize> headInput {};
+    std::array<float, headBlockSize> headOutput {}, headFaded {};
+    bool headFadePending = false;
+
+    std::vector<std::unique_ptr<Segment>> segments;
+    int numLatePartitions = 0;
+
+    std::thread worker;
+    std::atomic<bool> workerShouldExit { false };
+    Semaphore workAvailable;
+};
+
+} // namespace theknob
@@ -0,0 +1,213 @@
+//
+//  Parameters.h
+//  TheKnobDSP
+//
+//  Created by Vou Theophanous on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+/*
+ =================================Mode/FX Descriptions=================================
+ 
+ There are 3 FX modes: Violet, Teal, and Crimson. They are each a unique combination (with a unique order) of a filter, some EQ, some reverb, some delay, and some distortion. Every mode's chain ends with some more EQ to add some extra unique flavour.
+ 
+ -The Filter is the same for all modes: HPF that goes from 10 Hz to 150 Hz.
+ -The EQ is also the same for all modes:
+    -Boost at 250 Hz. Q goes from 2.0 to 1.0, Gain goes from 1.0 to 2.0 (0 dB to 6 dB).
+    -Boost at 16 kHz. Q goes from 2.0 to 1.0, Gain goes from 1.0 to 2.0 (0 dB to 6 dB).
+    -Reduction at 400 Hz. Q goes from 2.0 to 1.0, Gain goes from 1.0 to 0.5 (0 dB to -6 dB).
+ -The Special EQ is custom to each mode.
+ -The Reverb chain is: HPF -> LPF -> Delay -> Gain Reduction
+    -HPF goes from 10 Hz to 300 Hz.
+    -LPF goes from 20 kHz to 3500 Hz.
+    -Gain reduction of -6 dB.
+ -The Delay chain is: HPF -> LPF -> Delay -> LPF
+    -HPF goes from 10 Hz to 400 Hz.
+    -LPF goes from 20 kHz to 3500 Hz.
+    -The Delay parameters are custom to each mode.
+    -First-order LPF at 1000 Hz.
+ -The Distortion parameters are custom to each mode.
+ 
+ ---------------------------------Violet---------------------------------
+ Chain: Filter -> Distortion -> Reverb -> Delay -> EQ -> Special EQ
+ 
+ -Filter: see above
+ -Distortion:
+    -Pre Gain: 0 dB to 10 dB
+    -Post Gain: Pre Gain * -0.75
+    -Waveshaper Transfer Function: tanh(sin(x))
+ -Reverb:
+    -Common parameters: see above
+    -Custom parameters:
+        -Room Size: 0 to 0.5
+        -Damping: 1 to 0
+        -Wet Level: 0 to 0.5
+        -Dry Level: 1 - Wet Level
+        -Width: 0 to 0.5
+        -Freeze Mode: 0 to 0.35
+ -Delay:
+    -Common parameters: see above
+    -Custom parameters:
+        -Delay time L channel: 0.7
+        -Delay time R channel: 0.7
+        -Wet Level: 0 to 0.6
+        -Feedback: 0 to 0.6
+ -EQ: see above
+ -Special EQ:
+    -Reduction at 400 Hz, Q = 1, Gain from 0 dB to -3 dB
+    -Boost at 10 kHz, Q = 0.71, Gain from 0 dB to 3 dB
+ 
+ ---------------------------------Teal---------------------------------
+ Chain: Filter -> EQ -> Distortion -> Delay -> Reverb -> Special EQ
+ 
+ -Filter: see above
+ -EQ: see above
+ -Distortion:
+    -Pre Gain: 0 dB to 15 dB
+    -Post Gain: Pre Gain * -0.75
+    -Waveshaper Transfer Function: tanh(x)
+ -Delay:
+    -Common parameters: see above
+    -Custom parameters:
+        -Delay time L channel: 0.2
+        -Delay time R channel: 0.2
+        -Wet Level: 0 to 0.5
+        -Feedback: 0 to 0.75
+ -Reverb:
+    -Common parameters: see above
+    -Custom parameters:
+        -Room Size: 0 to 0.75
+        -Damping: 1 to 0
+        -Wet Level: 0 to 0.8
+        -Dry Level: 1 - Wet Level
+        -Width: 0 to 0.75
+        -Freeze Mode: 0 to 0.1
+ -Special EQ:
+    -Boost at 1000 Hz, Q = 2.11, Gain from 0 dB to 3 dB
+    -Boost at 10 kHz, Q = 0.71, Gain from 0 dB to 3 dB
+ 
+ ---------------------------------Crimson---------------------------------
+ Chain: Filter -> EQ -> Delay -> Reverb -> Distortion -> Special EQ
+ 
+ -Filter: see above
+ -EQ: see above
+ -Delay:
+    -Common parameters: see above
+    -Custom parameters:
+        -Delay time L channel: 1.0
+        -Delay time R channel: 1.0
+        -Wet Level: 0 to 1.0
+        -Feedback: 0 to 0.25
+ -Reverb:
+    -Common parameters: see above
+    -Custom parameters:
+        -Room Size: 0 to 0.9
+        -Damping: 0 to 1
+        -Wet Level: 0 to 1.0
+        -Dry Level: 1 - Wet Level
+        -Width: 0 to 0.9
+        -Freeze Mode: 0 to 0.1
+ -Distortion:
+    -Pre Gain: 0 dB to 10 dB
+    -Post Gain: Pre Gain * -0.75
+    -Waveshaper Transfer Function: tanh(x)
+ -Special EQ:
+    -HPF from 10 Hz to 111 Hz, Q = 0.71
+    -LPF from 20 kHz to 2500 Hz, Q = 0.66
+    -Boost at 177 Hz, Q = 0.71, Gain from 0 dB to 4 dB
+    -Boost at 1777 Hz, Q = 0.71, Gain from 0 dB to 5 dB
+ 
+ */
+
+//==============================================================================
+// Bump this whenever a change alters the sound, so anything holding on to rendered audio (theknob_render's cache) knows it's stale
+const int DSP_VERSION = 3;
+
+enum MODE
+{
+    VIOLET,
+    TEAL,
+    CRIMSON
+};
+
+//==============================================================================
+// KNOB
+const float KNOB_MIN_VALUE = 0.0;
+const float KNOB_MAX_VALUE = 100.0;
+const float KNOB_DEFAULT_VALUE = 0.0;
+
+// FILTER
+const float HPF_FREQ_MIN_VALUE = 10.0;
+const float HPF_FREQ_MAX_VALUE = 150.0;
+
+// EQ
+const float EQ_GAIN_MIN_VALUE = 1.0;
+const float EQ_GAIN_MAX_VALUE = 3.0;
+const float EQ_Q_MIN_VALUE = 2.0;
+const float EQ_Q_MAX_VALUE = 1.0;
+
+// DELAY
+const std::array<float, 3> DELAY_TIME_L = { 0.7, 0.2, 1.0 }; // one for each mode
+const std::array<float, 3> DELAY_TIME_R = { 0.7, 0.2, 1.0 }; // one for each mode
+const std::array<float, 3> DELAY_FEEDBACK_MAX_VALUE = { 0.6, 0.75, 0.25 }; // one for each mode
+const std::array<float, 3> DELAY_WET_LEVEL_MAX_VALUE = { 0.6, 0.5, 1.0 }; // one for each mode
+const float DELAY_HPF_FREQ_MIN_VALUE = 10.0;
+const float DELAY_HPF_FREQ_MAX_VALUE = 400.0;
+const float DELAY_LPF_FREQ_MIN_VALUE = 20000.0;
+const float DELAY_LPF_FREQ_MAX_VALUE = 3500.0;
+
+// REVERB
+const std::array<float, 3> REVERB_FREEZE_MAX_VALUE = { 0.35, 0.1, 0.1 }; // one for each mode
+const std::array<float, 3> REVERB_WET_LEVEL_MAX_VALUE = { 0.5, 0.8, 1.0 }; // one for each mode
+const std::array<float, 3> REVERB_ROOM_SIZE_MAX_VALUE = { 0.5, 0.75, 0.9 }; // one for each mode
+const std::array<float, 3> REVERB_WIDTH_MAX_VALUE = { 0.5, 0.75, 0.9 }; // one for each mode
+
+// DISTORTION
+const std::array<float, 3> DIST_INPUT_GAIN_MIN_VALUE = { 0.0, 0.0, 0.0 }; // one for each mode
+const std::array<float, 3> DIST_INPUT_GAIN_MAX_VALUE = { 10.0, 15.0, 10.0 }; // one for each mode
+
+//==============================================================================
+inline float mapKnobValueToRange(float x, float rangeStart, float rangeEnd)
+{
+    return rangeStart + (x - KNOB_MIN_VALUE) * (rangeEnd - rangeStart) / (KNOB_MAX_VALUE - KNOB_MIN_VALUE);
+}
+
+inline float normalizeKnobValue(float x)
+{
+    return mapKnobValueToRange(x, 0.0, 1.0);
+}
+
+//==============================================================================
+// How long the reverb takes to decay by decayDb: the comb feedback is roomSize * 0.28 + 0.7, and its longest comb is 1617 + 23 samples
+// at 44.1k (the same time at any rate). Freeze only engages from 0.5, which no mode reaches.
+inline double getReverbTailLengthSeconds(int mode, float knob, float decayDb)
+{
+    double combFeedback = mapKnobValueToRange(knob, 0, REVERB_ROOM_SIZE_MAX_VALUE[mode]) * 0.28 + 0.7;
+    double longestCombSeconds = (1617 + 23) / 44100.0;
+    double allpassSeconds = (556 + 441 + 341 + 225 + 4 * 23) / 44100.0;
+    return decayDb / (-20.0 * std::log10(combFeedback)) * longestCombSeconds + allpassSeconds;
+}
+
+// How long the chain takes to forget its input: the time for the delay's feedback loop and then the reverb's longest comb to decay by decayDb.
+// Both are upper bounds, the tanh and the filters inside the loops only ever take energy out.
+inline double getTailLengthSeconds(int mode, float knob, float decayDb)
+{
+    // delay: every repeat is at most `feedback` times the one before
+    double delayTime = std::max(DELAY_TIME_L[mode], DELAY_TIME_R[mode]);
+    double feedback = mapKnobValueToRange(knob, 0, DELAY_FEEDBACK_MAX_VALUE[mode]);
+    double delayRepeats = feedback > 0 ? decayDb / (-20.0 * std::log10(feedback)) : 0.0;
+    double delayTail = (1.0 + delayRepeats) * delayTime;
+
+    double reverbTail = getReverbTailLengthSeconds(mode, knob, decayDb);
+
+    // the filters and EQs settle within a few hundred milliseconds, even at their lowest corners
+    const double filterSettleSeconds = 0.5;
+
+    return delayTail + reverbTail + filterSettleSeconds;
+}
+
@@ -0,0 +1,128 @@
+//
+//  QualityGovernor.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "Stages.h"
+#include <algorithm>
+#include <array>
+
+namespace theknob
+{
+
+/*
+ =================================QualityGovernor=================================
+
+ Picks the engine's QualityTier from how long its blocks take, so an instance that's about to drop out gives up some quality instead.
+ Give it each block's load (the time the block took over the time it plays for, so 1 is the whole budget) and pass what update() returns
+ to Engine::setQualityTier().
+
+ -The load is smoothed over smoothingSeconds, so one slow block (a page fault, another thread getting the core) doesn't change anything.
+ -Over overloadLoad for overloadSeconds steps down a tier. Then nothing changes for settleSeconds, while the crossfade (which runs both
+  versions) finishes and the load settles at the new tier.
+ -It steps back up once the load it would have at the tier above is under headroomLoad for headroomSeconds. It learns what each tier
+  costs from the load before and after each step, and until it has, takes the tier above to cost defaultCostRatio times as much. The
+  gap between overloadLoad and headroomLoad keeps it from going back and forth.
+
+ It only does arithmetic, so it's real-time safe, and belongs to the thread that processes.
+ */
+class QualityGovernor
+{
+public:
+    struct Settings
+    {
+        float overloadLoad      = 0.8f;
+        double overloadSeconds  = 0.5;
+        float headroomLoad      = 0.5f;
+        double headroomSeconds  = 5.0;
+        double smoothingSeconds = 0.1;
+        double settleSeconds    = 0.3;
+    };
+
+    static constexpr float defaultCostRatio = 1.5f;
+
+    QualityGovernor() = default;
+    explicit QualityGovernor (const Settings& newSettings) noexcept  : settings (newSettings) {}
+
+    // Starts again at the full tier, with nothing measured
+    void reset() noexcept
+    {
+        tier = fullQualityTier;
+        load = 0.0f;
+        overloadTime = headroomTime = settleTime = 0.0;
+        costRatios.fill (defaultCostRatio);
+    }
+
+    // Takes a block's load and how long the block plays for, and returns the tier to run the next block at
+    int update (float blockLoad, double blockSeconds) noexcept
+    {
+        if (! (blockSeconds > 0.0) || ! (blockLoad >= 0.0f))
+            return tier;
+
+        auto amount = (float) std::min (1.0, blockSeconds / settings.smoothingSeconds);
+        load += (blockLoad - load) * amount;
+
+        if (settleTime > 0.0)
+        {
+            settleTime -= blockSeconds;
+
+            if (settleTime <= 0.0)
+                learnCostRatio();
+
+            return tier;
+        }
+
+        overloadTime = load > settings.overloadLoad ? overloadTime + blockSeconds : 0.0;
+
+        auto loadAbove = tier > fullQualityTier ? load * costRatios[(size_t) tier - 1] : 0.0f;
+        headroomTime = tier > fullQualityTier && loadAbove < settings.headroomLoad ? headroomTime + blockSeconds : 0.0;
+
+        if (overloadTime >= settings.overloadSeconds && tier < numQualityTiers - 1)
+            changeTier (tier + 1);
+        else if (headroomTime >= settings.headroomSeconds)
+            changeTier (tier - 1);
+
+        return tier;
+    }
+
+    int getTier() const noexcept                         { return tier; }
+
+    // The smoothed load, 1 being the whole of each block's time
+    float getLoad() const noexcept                       { return load; }
+
+    // How many times as much the tier above this one has been measured to cost
+    float getCostRatio (int belowTier) const noexcept    { return costRatios[(size_t) std::clamp (belowTier, 0, numQualityTiers - 2)]; }
+
+private:
+    void changeTier (int newTier) noexcept
+    {
+        previousTier = tier;
+        previousLoad = load;
+        tier = newTier;
+        overloadTime = headroomTime = 0.0;
+        settleTime = settings.settleSeconds;
+    }
+
+    // the same audio at two tiers, a moment apart: the ratio of the loads is what the better one costs over the cheaper one
+    void learnCostRatio() noexcept
+    {
+        auto better = std::min (tier, previousTier);
+        auto betterLoad = tier == better ? load : previousLoad;
+        auto cheaperLoad = tier == better ? previousLoad : load;
+
+        if (cheaperLoad > 0.0f)
+            costRatios[(size_t) better] = std::clamp (betterLoad / cheaperLoad, 1.0f, 4.0f);
+    }
+
+    Settings settings;
+    int tier = fullQualityTier, previousTier = fullQualityTier;
+    float load = 0.0f, previousLoad = 0.0f;
+    double overloadTime = 0.0, headroomTime = 0.0, settleTime = 0.0;
+    std::array<float, numQualityTiers - 1> costRatios { defaultCostRatio, defaultCostRatio };
+};
+
+} // namespace theknob
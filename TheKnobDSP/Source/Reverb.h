@@ -0,0 +1,429 @@
+//
+//  Reverb.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "Kernels.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace theknob
+{
+
+//==============================================================================
+// A value that ramps linearly to each new target over a fixed number of samples
+class LinearSmoothedValue
+{
+public:
+    void reset (double sampleRate, double rampLengthInSeconds) noexcept
+    {
+        stepsToTarget = (int) std::floor (rampLengthInSeconds * sampleRate);
+        setCurrentAndTargetValue (target);
+    }
+
+    void setCurrentAndTargetValue (float newValue) noexcept
+    {
+        target = current = newValue;
+        countdown = 0;
+    }
+
+    void setTargetValue (float newValue) noexcept
+    {
+        if (newValue == target)
+            return;
+
+        if (stepsToTarget <= 0)
+        {
+            setCurrentAndTargetValue (newValue);
+            return;
+        }
+
+        target = newValue;
+        countdown = stepsToTarget;
+        step = (target - current) / (float) countdown;
+    }
+
+    float getNextValue() noexcept
+    {
+        if (countdown <= 0)
+            return target;
+
+        --countdown;
+        current = countdown > 0 ? current + step : target;
+        return current;
+    }
+
+    float getTargetValue() const noexcept                { return target; }
+    bool isSmoothing() const noexcept                    { return countdown > 0; }
+
+    // Moves on by numSamples without returning the values in between
+    void skip (int numSamples) noexcept
+    {
+        if (countdown <= 0 || numSamples <= 0)
+            return;
+
+        countdown -= numSamples;
+        current = countdown > 0 ? current + step * (float) numSamples : target;
+    }
+
+    // the ramp length is set by reset()
+    void visitState (StateArchive& archive) noexcept    { archive (current, target, step, countdown); }
+
+private:
+    float current = 0, target = 0, step = 0;
+    int countdown = 0, stepsToTarget = 0;
+};
+
+//==============================================================================
+/*
+ Jezar's Freeverb: eight damped combs in parallel into four allpasses, per channel, with the right channel's delays 23 samples longer.
+
+ This is the same algorithm, tunings and parameter mapping as juce::Reverb (which TheKnob used before the DSP moved out of the plug-in),
+ including its 10 ms parameter smoothing, so it sounds identical. The combs are run together by the comb kernel, a chunk at a time.
+
+ The allpasses run one sample at a time, one after another, so they're most of what the reverb costs beyond the combs. A light reverb
+ (setLightAllPasses()) only runs the first two on each channel: the same tail at the same level, just less diffuse.
+ */
+class Reverb
+{
+public:
+    struct Parameters
+    {
+        float roomSize   = 0.5f;
+        float damping    = 0.5f;
+        float wetLevel   = 0.33f;
+        float dryLevel   = 0.4f;
+        float width      = 1.0f;
+        float freezeMode = 0.0f;
+    };
+
+    enum { numCombs = 8, numAllPasses = 4, numLightAllPasses = 2, numChannels = 2 };
+
+    // how long the parameters take to ramp to new values
+    static constexpr double smoothTime = 0.01;
+
+    // What the parameters set: the gain into the combs (straight away), and what the smoothed values ramp to
+    struct Targets
+    {
+        float gain, damping, feedback, dryGain, wetGain1, wetGain2;
+    };
+
+    static Targets getTargets (const Parameters& params) noexcept
+    {
+        const float wet = params.wetLevel * wetScaleFactor;
+        auto frozen = isFrozen (params.freezeMode);
+
+        return { frozen ? 0.0f : fixedGain,
+                 frozen ? 0.0f : params.damping * dampScaleFactor,
+                 frozen ? 1.0f : params.roomSize * roomScaleFactor + roomOffset,
+                 params.dryLevel * dryScaleFactor,
+                 0.5f * wet * (1.0f + params.width),
+                 0.5f * wet * (1.0f - params.width) };
+    }
+
+    // The combs' lengths at this rate (the left channel's eight, then the right's), and the allpasses' (each channel's four)
+    static std::array<int, CombBank::numCombs> getCombSizes (double sampleRate) noexcept
+    {
+        static const short combTunings[] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 };
+        const int intSampleRate = (int) sampleRate;
+
+        std::array<int, CombBank::numCombs> combSizes;
+
+        for (int i = 0; i < numCombs; ++i)
+        {
+            combSizes[(size_t) i] = (intSampleRate * combTunings[i]) / 44100;
+            combSizes[(size_t) (i + numCombs)] = (intSampleRate * (combTunings[i] + stereoSpread)) / 44100;
+        }
+
+        return combSizes;
+    }
+
+    static std::array<std::array<int, numAllPasses>, numChannels> getAllPassSizes (double sampleRate) noexcept
+    {
+        static const short allPassTunings[] = { 556, 441, 341, 225 };
+        const int intSampleRate = (int) sampleRate;
+
+        std::array<std::array<int, numAllPasses>, numChannels> allPassSizes;
+
+        for (int i = 0; i < numAllPasses; ++i)
+        {
+            allPassSizes[0][(size_t) i] = (intSampleRate * allPassTunings[i]) / 44100;
+            allPassSizes[1][(size_t) i] = (intSampleRate * (allPassTunings[i] + stereoSpread)) / 44100;
+        }
+
+        return allPassSizes;
+    }
+
+    //==============================================================================
+    Reverb()
+    {
+        setParameters (Parameters());
+        setSampleRate (44100.0);
+    }
+
+    void setParameters (const Parameters& newParams)
+    {
+        auto targets = getTargets (newParams);
+        dryGain.setTargetValue (targets.dryGain);
+        wetGain1.setTargetValue (targets.wetGain1);
+        wetGain2.setTargetValue (targets.wetGain2);
+
+        gain = targets.gain;
+        parameters = newParams;
+        damping.setTargetValue (targets.damping);
+        feedback.setTargetValue (targets.feedback);
+    }
+
+    // Allocates: call it from prepare
+    void setSampleRate (double sampleRate)
+    {
+        combs.setSizes (getCombSizes (sampleRate));
+
+        auto allPassSizes = getAllPassSizes (sampleRate);
+
+        for (size_t j = 0; j < numChannels; ++j)
+            for (size_t i = 0; i < numAllPasses; ++i)
+                allPass[j][i].setSize (allPassSizes[j][i]);
+
+        damping .reset (sampleRate, smoothTime);
+        feedback.reset (sampleRate, smoothTime);
+        dryGain .reset (sampleRate, smoothTime);
+        wetGain1.reset (sampleRate, smoothTime);
+        wetGain2.reset (sampleRate, smoothTime);
+        lightness.reset (sampleRate, lightFadeTime);
+    }
+
+    // Runs two allpasses on each channel instead of four, crossfading over 50 ms. Real-time safe.
+    void setLightAllPasses (bool shouldBeLight) noexcept
+    {
+        auto target = shouldBeLight ? 1.0f : 0.0f;
+
+        if (target == lightness.getTargetValue())
+            return;
+
+        // the last two haven't been running, so they start again from silence (the fade covers them filling up)
+        if (! shouldBeLight && ! lightness.isSmoothing())
+            for (int j = 0; j < numChannels; ++j)
+                for (int k = numLightAllPasses; k < numAllPasses; ++k)
+                    allPass[(size_t) j][(size_t) k].clear();
+
+        lightness.setTargetValue (target);
+    }
+
+    void reset() noexcept
+    {
+        combs.clear();
+
+        for (int j = 0; j < numChannels; ++j)
+            for (auto& a : allPass[(size_t) j])
+                a.clear();
+    }
+
+    void visitState (StateArchive& archive) noexcept
+    {
+        archive (parameters, gain, combs, allPass, damping, feedback, dryGain, wetGain1, wetGain2, lightness);
+    }
+
+    // A bound on how much louder than its input the wet output can ever get: L + R into eight combs, each at most 1 / (1 - feedback)
+    // louder, into four allpasses, each at most 3 times louder. Infinite when frozen, since then the combs never forget.
+    float getMaxWetGain() const noexcept
+    {
+        if (isFrozen (parameters.freezeMode))
+            return std::numeric_limits<float>::infinity();
+
+        auto roomFeedback = parameters.roomSize * roomScaleFactor + roomOffset;
+        auto wet = parameters.wetLevel * wetScaleFactor * std::max (1.0f, std::abs (parameters.width));
+        return wet * 2.0f * fixedGain * (float) numCombs / (1.0f - roomFeedback) * 81.0f;
+    }
+
+    // What processStereo() does when the combs and allpasses are silent: only the dry signal, with the smoothing carried on
+    void processDry (float* left, float* right, int numSamples) noexcept
+    {
+        skipWetSmoothing (numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float dry = dryGain.getNextValue();
+            left[i] *= dry;
+            right[i] *= dry;
+        }
+    }
+
+    // Carries the smoothing on by numSamples, for when even the dry signal is made somewhere else
+    void skipSmoothing (int numSamples) noexcept
+    {
+        skipWetSmoothing (numSamples);
+        dryGain.skip (numSamples);
+    }
+
+    void processStereo (float* left, float* right, int numSamples) noexcept
+    {
+        auto& kernels = getKernels();
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            auto count = std::min ((int) chunkSize, numSamples - start);
+            auto* l = left + start;
+            auto* r = right + start;
+
+            for (int i = 0; i < count; ++i)
+            {
+                combInput[(size_t) i] = (l[i] + r[i]) * gain;
+                combDamping[(size_t) i] = damping.getNextValue();
+                combFeedback[(size_t) i] = feedback.getNextValue();
+            }
+
+            kernels.combs (combs, combInput.data(), combDamping.data(), combFeedback.data(), combLeft.data(), combRight.data(), count);
+
+            if (lightness.isSmoothing() || lightness.getTargetValue() != 0.0f)
+            {
+                processLightAllPasses (count);
+            }
+            else
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    for (int j = 0; j < numAllPasses; ++j)
+                    {
+                        combLeft[(size_t) i] = allPass[0][(size_t) j].process (combLeft[(size_t) i]);
+                        combRight[(size_t) i] = allPass[1][(size_t) j].process (combRight[(size_t) i]);
+                    }
+                }
+            }
+
+            for (int i = 0; i < count; ++i)
+            {
+                const float outL = combLeft[(size_t) i], outR = combRight[(size_t) i];
+                const float dry  = dryGain.getNextValue();
+                const float wet1 = wetGain1.getNextValue();
+                const float wet2 = wetGain2.getNextValue();
+
+                l[i] = outL * wet1 + outR * wet2 + l[i] * dry;
+                r[i] = outR * wet1 + outL * wet2 + r[i] * dry;
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    static bool isFrozen (float freezeMode) noexcept  { return freezeMode >= 0.5f; }
+
+    void skipWetSmoothing (int numSamples) noexcept
+    {
+        damping.skip (numSamples);
+        feedback.skip (numSamples);
+        wetGain1.skip (numSamples);
+        wetGain2.skip (numSamples);
+        lightness.skip (numSamples);
+    }
+
+    // The allpasses on the combs' output in place, for a light reverb or one fading to or from light: the output after the first two,
+    // mixed with the output after all four by how light it is
+    void processLightAllPasses (int count) noexcept
+    {
+        auto fading = lightness.isSmoothing();
+
+        for (int i = 0; i < count; ++i)
+        {
+            float* out[] = { &combLeft[(size_t) i], &combRight[(size_t) i] };
+            const float light = fading ? lightness.getNextValue() : 1.0f;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto& channelAllPasses = allPass[(size_t) ch];
+                auto& sample = *out[ch];
+
+                for (int j = 0; j < numLightAllPasses; ++j)
+                    sample = channelAllPasses[(size_t) j].process (sample);
+
+                if (fading)
+                {
+                    auto full = sample;
+
+                    for (int j = numLightAllPasses; j < numAllPasses; ++j)
+                        full = channelAllPasses[(size_t) j].process (full);
+
+                    sample = full + (sample - full) * light;
+                }
+            }
+        }
+    }
+
+    // adding and taking away a small offset flushes denormals to zero on any FPU
+    static float undenormalise (float x) noexcept
+    {
+        x += 0.1f;
+        x -= 0.1f;
+        return x;
+    }
+
+    //==============================================================================
+    class AllPassFilter
+    {
+    public:
+        void setSize (int size)
+        {
+            if (size != (int) buffer.size())
+            {
+                bufferIndex = 0;
+                buffer.assign ((size_t) size, 0.0f);
+            }
+
+            clear();
+        }
+
+        void clear() noexcept
+        {
+            std::fill (buffer.begin(), buffer.end(), 0.0f);
+        }
+
+        void visitState (StateArchive& archive) noexcept { archive (buffer, bufferIndex); }
+
+        float process (float input) noexcept
+        {
+            const float bufferedValue = buffer[(size_t) bufferIndex];
+            buffer[(size_t) bufferIndex] = undenormalise (input + (bufferedValue * 0.5f));
+
+            if (++bufferIndex == (int) buffer.size())
+                bufferIndex = 0;
+
+            return bufferedValue - input;
+        }
+
+    private:
+        std::vector<float> buffer;
+        int bufferIndex = 0;
+    };
+
+    //==============================================================================
+    enum { chunkSize = 256, stereoSpread = 23 };
+
+    static constexpr float wetScaleFactor = 3.0f;
+    static constexpr float dryScaleFactor = 2.0f;
+    static constexpr float roomScaleFactor = 0.28f;
+    static constexpr float roomOffset = 0.7f;
+    static constexpr float dampScaleFactor = 0.4f;
+    static constexpr double lightFadeTime = 0.05;
+    static constexpr float fixedGain = 0.015f;
+
+    Parameters parameters;
+    float gain = 0.0f;
+
+    CombBank combs;
+    std::array<float, chunkSize> combInput {}, combDamping {}, combFeedback {}, combLeft {}, combRight {};
+    std::array<std::array<AllPassFilter, numAllPasses>, numChannels> allPass;
+
+    LinearSmoothedValue damping, feedback, dryGain, wetGain1, wetGain2;
+
+    // 0 runs all four allpasses, 1 the first two
+    LinearSmoothedValue lightness;
+};
+
+} // namespace theknob
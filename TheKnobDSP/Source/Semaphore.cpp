@@ -0,0 +1,84 @@
+//
+//  Semaphore.cpp
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#include "Semaphore.h"
+
+#if defined (_WIN32)
+ #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+ #endif
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #include <climits>
+#elif defined (__APPLE__)
+ #include <dispatch/dispatch.h>
+#else
+ #include <cerrno>
+ #include <semaphore.h>
+#endif
+
+namespace theknob
+{
+
+#if defined (_WIN32)
+
+Semaphore::Semaphore()                 { native = CreateSemaphoreW (nullptr, 0, LONG_MAX, nullptr); }
+Semaphore::~Semaphore()                { CloseHandle (static_cast<HANDLE> (native)); }
+static void signal (void* native)      { ReleaseSemaphore (static_cast<HANDLE> (native), 1, nullptr); }
+static void block (void* native)       { WaitForSingleObject (static_cast<HANDLE> (native), INFINITE); }
+
+#elif defined (__APPLE__)
+
+Semaphore::Semaphore()                 { native = dispatch_semaphore_create (0); }
+Semaphore::~Semaphore()                { dispatch_release (static_cast<dispatch_semaphore_t> (native)); }
+static void signal (void* native)      { dispatch_semaphore_signal (static_cast<dispatch_semaphore_t> (native)); }
+static void block (void* native)       { dispatch_semaphore_wait (static_cast<dispatch_semaphore_t> (native), DISPATCH_TIME_FOREVER); }
+
+#else
+
+Semaphore::Semaphore()
+{
+    auto* semaphore = new sem_t;
+    sem_init (semaphore, 0, 0);
+    native = semaphore;
+}
+
+Semaphore::~Semaphore()
+{
+    auto* semaphore = static_cast<sem_t*> (native);
+    sem_destroy (semaphore);
+    delete semaphore;
+}
+
+static void signal (void* native)      { sem_post (static_cast<sem_t*> (native)); }
+
+static void block (void* native)
+{
+    // a signal handler can interrupt the wait
+    while (sem_wait (static_cast<sem_t*> (native)) != 0 && errno == EINTR)
+    {}
+}
+
+#endif
+
+//==============================================================================
+void Semaphore::post() noexcept
+{
+    if (count.fetch_add (1, std::memory_order_release) < 0)
+        signal (native);
+}
+
+void Semaphore::wait() noexcept
+{
+    if (count.fetch_sub (1, std::memory_order_acquire) < 1)
+        block (native);
+}
+
+} // namespace theknob
@@ -0,0 +1,46 @@
+//
+//  Semaphore.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <atomic>
+
+namespace theknob
+{
+
+/*
+ =================================Semaphore=================================
+
+ What the library's background threads sleep on until the audio thread has work for them.
+
+ -post() never locks, so the audio thread can call it. The count lives in an atomic, and the OS semaphore (a POSIX semaphore, a
+  dispatch semaphore on Apple platforms, a Win32 one on Windows) is only signalled when a thread is actually waiting on it.
+ -Every post() lets one wait() through. A thread that drains all of its work after waking can find nothing to do on the next few
+  wakes, which is cheap, but it never misses one.
+ */
+class Semaphore
+{
+public:
+    Semaphore();
+    ~Semaphore();
+
+    // any thread, the audio thread included
+    void post() noexcept;
+
+    // blocks until there's a post() no other wait() has taken
+    void wait() noexcept;
+
+private:
+    // posts minus waits: below zero, that many threads are waiting on the OS semaphore
+    std::atomic<int> count { 0 };
+    void* native = nullptr;
+
+    Semaphore (const Semaphore&) = delete;
+    Semaphore& operator= (const Semaphore&) = delete;
+};
+
+} // namespace theknob
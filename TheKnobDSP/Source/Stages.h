@@ -0,0 +1,921 @@
+//
+//  Stages.h
+//  TheKnobDSP
+//
+//  Created by Vou Theophanous on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include "Parameters.h"
+#include "Filters.h"
+#include "Reverb.h"
+#include "Delay.h"
+#include "Multirate.h"
+#include <cstdint>
+#include <limits>
+
+/*
+ =================================Stages=================================
+
+ The six effects every mode's chain is built from (see Parameters.h for what each one does in each mode). They all work the same way:
+
+ -prepare() allocates whatever the stage needs for the sample rate, and clears it.
+ -setParameters() maps the knob and mode onto the stage's settings. It doesn't allocate, and is only called when they change. The
+  mapping itself is the static design(), which the BatchEngine shares.
+ -process() works in place on two channels of any length.
+ -visitState() hands everything setParameters() and process() change to a StateArchive, for the engine's snapshots.
+
+ The filter, EQ and special EQ stages are linear, and can also report their magnitude response with getMagnitudeForFrequency(), for drawing.
+
+ The reverb and delay can run their wet paths at 44.1 or 48 kHz inside when the sample rate is 2, 4 or 8 times that (setReducedRate()),
+ through the half-band filters in Multirate.h. Their filters and dry paths stay at the full rate. The delay takes the round trip off its
+ delay times, so it's still exactly on time. The reverb can't, so it delays its dry path to match, and reports that with
+ getLatencySamples().
+
+ Parts of a stage that make no audible difference are left out (elided), down to a threshold the engine sets (setElisionThreshold(), as
+ a gain: 0 never elides anything):
+
+ -The reverb's and delay's wet paths ring on after their input stops, so they're skipped once their input has been too quiet to be heard
+  through them for as long as their tails take to decay below the threshold (TailElision). Their state is cleared then, and they start
+  again from it as soon as the input isn't quiet, so coming back is just as inaudible as leaving.
+ -The filter stage's high-pass, the EQs and the distortion are never close to doing nothing, and never elided. Even at a knob of 1 the
+  EQs' peaks are 0.04 dB or more (-46 dB from doing nothing), which no threshold that's meant to be inaudible would leave out.
+
+ Some stages have cheaper versions, for when there isn't the CPU to run the full chain (QualityTier). The engine picks a tier for all of
+ them with setQualityTier():
+
+ -fastSaturationTier saturates the distortion and the delay's repeats with a vectorised rational tanh instead of std::tanh, within 4e-7
+  of it. They're the two most expensive stages, and it takes about a third off the whole chain without an audible difference, so it
+  switches straight away.
+ -economyTier also only runs two of the reverb's four allpasses on each channel: the tail is the same length and level, but less
+  diffuse, and the combs carry on through the 50 ms crossfade. And it makes the filter stage's high-pass and crimson's special EQ's
+  high- and low-pass first order instead of second, crossfading over 50 ms (TierCrossfade) from filters that start at silence.
+
+ */
+
+namespace theknob
+{
+
+// How much of the chain's quality is traded for CPU, from none to the most. Each tier includes the savings of the ones before it.
+enum QualityTier
+{
+    fullQualityTier,
+    fastSaturationTier,
+    economyTier,
+    numQualityTiers
+};
+
+//==============================================================================
+// Switches a stage between its full and its cheaper version without a click: for fadeSeconds both run, and the output fades from the
+// version going out to the one coming in
+class TierCrossfade
+{
+public:
+    static constexpr double fadeSeconds = 0.05;
+
+    void prepare (double sampleRate) noexcept
+    {
+        length = std::max (1, (int) std::lround (sampleRate * fadeSeconds));
+        remaining = 0;
+    }
+
+    // Returns true if the version coming in wasn't running before, so has to be cleared first
+    bool setCheaper (bool shouldBeCheaper) noexcept
+    {
+        if (shouldBeCheaper == cheaper)
+            return false;
+
+        // turning back halfway through a fade fades back from where it got to
+        auto wasRunning = remaining > 0;
+        remaining = wasRunning ? length - remaining : length;
+        cheaper = shouldBeCheaper;
+        return ! wasRunning;
+    }
+
+    bool isCheaper() const noexcept                      { return cheaper; }
+    bool isFading() const noexcept                       { return remaining > 0; }
+
+    // Ends the fade straight away, for a stage that has nothing running to fade
+    void finish() noexcept                               { remaining = 0; }
+
+    // How much of the version going out is in the next sample
+    float getNextOutgoingGain() noexcept
+    {
+        return remaining > 0 ? (float) remaining-- / (float) length : 0.0f;
+    }
+
+    // Runs processCurrent in place, and while fading, processOutgoing on a copy of the same input, mixed in. Both are called with
+    // (float* const* channels, int numSamples).
+    template <typename ProcessCurrent, typename ProcessOutgoing>
+    void process (float* const* channels, int numSamples, ProcessCurrent&& processCurrent, ProcessOutgoing&& processOutgoing) noexcept
+    {
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            float* chunk[] = { channels[0] + start, channels[1] + start };
+
+            if (remaining == 0)
+            {
+                processCurrent (chunk, numSamples - start);
+                return;
+            }
+
+            auto count = std::min (chunkSize, numSamples - start);
+            float* outgoing[] = { scratch[0].data(), scratch[1].data() };
+
+            for (size_t ch = 0; ch < 2; ++ch)
+                std::copy (chunk[ch], chunk[ch] + count, outgoing[ch]);
+
+            processCurrent (chunk, count);
+            processOutgoing (outgoing, count);
+
+            for (int i = 0; i < count; ++i)
+            {
+                auto gain = getNextOutgoingGain();
+
+                for (size_t ch = 0; ch < 2; ++ch)
+                    chunk[ch][i] += (outgoing[ch][i] - chunk[ch][i]) * gain;
+            }
+        }
+    }
+
+    void visitState (StateArchive& archive) noexcept    { archive (cheaper, remaining); }
+
+private:
+    static constexpr int chunkSize = 256;
+
+    bool cheaper = false;
+    int length = 1, remaining = 0;
+    std::array<std::array<float, chunkSize>, 2> scratch {};
+};
+
+//==============================================================================
+// When a stage with a tail can stop running its wet path, and has to start again
+class TailElision
+{
+public:
+    enum Action
+    {
+        run,
+        clearAndSkip,   // the first block skipped: clear the wet path's state, so it starts again from nothing
+        skip
+    };
+
+    // threshold is the level below which the wet path can't be heard (0 never elides), maxGain the most it can amplify its input, and
+    // tailSeconds how long it takes, after a full-scale input, to decay by thresholdDb
+    void setParameters (float threshold, float maxGain, double tailSeconds, double sampleRate) noexcept
+    {
+        quietLimit = threshold > 0.0f && maxGain > 0.0f ? threshold / maxGain : 0.0f;
+        tailSamples = threshold > 0.0f && tailSeconds < 3600.0 ? (int64_t) std::ceil (tailSeconds * sampleRate) : std::numeric_limits<int64_t>::max();
+
+        // the tail so far was counted with the old settings
+        if (! elided)
+            quietSamples = 0;
+    }
+
+    void reset() noexcept
+    {
+        quietSamples = 0;
+        elided = false;
+    }
+
+    // Looks at the stage's input for this block
+    Action update (const float* const* channels, int numSamples) noexcept
+    {
+        float peak = 0.0f;
+
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                peak = std::max (peak, std::abs (channels[ch][i]));
+
+        if (peak > quietLimit || quietLimit == 0.0f)
+        {
+            reset();
+            return run;
+        }
+
+        if (elided)
+            return skip;
+
+        // only skip once the last sample that could be heard has rung out, counting up to the start of this block
+        auto rungOut = quietSamples >= tailSamples;
+        quietSamples += numSamples;
+
+        if (! rungOut)
+            return run;
+
+        elided = true;
+        return clearAndSkip;
+    }
+
+    bool isElided() const noexcept                       { return elided; }
+
+    void visitState (StateArchive& archive) noexcept    { archive (quietLimit, tailSamples, quietSamples, elided); }
+
+private:
+    float quietLimit = 0.0f;
+    int64_t tailSamples = std::numeric_limits<int64_t>::max();
+    int64_t quietSamples = 0;
+    bool elided = false;
+};
+
+//==============================================================================
+class FilterStage
+{
+public:
+    void prepare (double newSampleRate)                  { sampleRate = newSampleRate; crossfade.prepare (sampleRate); reset(); }
+
+    void reset() noexcept
+    {
+        filter.reset();
+        firstOrderFilter.reset();
+    }
+
+    void visitState (StateArchive& archive) noexcept    { archive (filter, firstOrderFilter, crossfade); }
+
+    void setQualityTier (int tier) noexcept
+    {
+        if (crossfade.setCheaper (tier >= economyTier))
+            getFilter (crossfade.isCheaper()).reset();
+    }
+
+    struct Design
+    {
+        IIRCoefficients highPass, firstOrderHighPass;
+    };
+
+    static Design design (double sampleRate, float knob, int) noexcept
+    {
+        float frequency = mapKnobValueToRange(knob, HPF_FREQ_MIN_VALUE, HPF_FREQ_MAX_VALUE);
+        return { IIRCoefficients::makeHighPass (sampleRate, frequency), IIRCoefficients::makeFirstOrderHighPass (sampleRate, frequency) };
+    }
+
+    void setParameters (float knob, int mode) noexcept
+    {
+        auto d = design (sampleRate, knob, mode);
+        filter.setCoefficients (d.highPass);
+        firstOrderFilter.setCoefficients (d.firstOrderHighPass);
+    }
+
+    void process (float* const* channels, int numSamples) noexcept
+    {
+        crossfade.process (channels, numSamples,
+                           [this] (float* const* c, int n) { getFilter (crossfade.isCheaper()).process (c, n); },
+                           [this] (float* const* c, int n) { getFilter (! crossfade.isCheaper()).process (c, n); });
+    }
+
+    double getMagnitudeForFrequency (double frequency) const noexcept
+    {
+        const auto& current = crossfade.isCheaper() ? firstOrderFilter : filter;
+        return current.getCoefficients().getMagnitudeForFrequency (frequency, sampleRate);
+    }
+
+private:
+    StereoIIRFilter& getFilter (bool firstOrder) noexcept { return firstOrder ? firstOrderFilter : filter; }
+
+    double sampleRate = 44100.0;
+    StereoIIRFilter filter, firstOrderFilter;
+    TierCrossfade crossfade;
+};
+
+//==============================================================================
+class EQStage
+{
+public:
+    void prepare (double newSampleRate)                  { sampleRate = newSampleRate; reset(); }
+
+    void reset() noexcept
+    {
+        filter1.reset();
+        filter3.reset();
+        filter4.reset();
+    }
+
+    void visitState (StateArchive& archive) noexcept    { archive (filter1, filter3, filter4); }
+
+    // the three peak filters, in the order they run, and their gains
+    struct Design
+    {
+        std::array<IIRCoefficients, 3> filters;
+        std::array<float, 3> gains;
+    };
+
+    static Design design (double sampleRate, float knob, int) noexcept
+    {
+        float gain = mapKnobValueToRange(knob, EQ_GAIN_MIN_VALUE, EQ_GAIN_MAX_VALUE);
+        float q = mapKnobValueToRange(knob, EQ_Q_MIN_VALUE, EQ_Q_MAX_VALUE);
+
+        Design d;
+        d.gains = { gain, gain, 1/(gain) };
+        // boost at 250 Hz
+        d.filters[0] = IIRCoefficients::makePeakFilter (sampleRate, 250, q, d.gains[0]);
+        // boost at 16k Hz
+        d.filters[1] = IIRCoefficients::makePeakFilter (sampleRate, 16000, q, d.gains[1]);
+        // remove at 400 Hz
+        d.filters[2] = IIRCoefficients::makePeakFilter (sampleRate, 400, q, d.gains[2]);
+        return d;
+    }
+
+    void setParameters (float knob, int mode) noexcept
+    {
+        auto d = design (sampleRate, knob, mode);
+        filter1.setCoefficients (d.filters[0]);
+        filter3.setCoefficients (d.filters[1]);
+        filter4.setCoefficients (d.filters[2]);
+    }
+
+    void process (float* const* channels, int numSamples) noexcept
+    {
+        filter1.process (channels, numSamples);
+        filter3.process (channels, numSamples);
+        filter4.process (channels, numSamples);
+    }
+
+    double getMagnitudeForFrequency (double frequency) const noexcept
+    {
+        return filter1.getCoefficients().getMagnitudeForFrequency (frequency, sampleRate)
+             * filter3.getCoefficients().getMagnitudeForFrequency (frequency, sampleRate)
+             * filter4.getCoefficients().getMagnitudeForFrequency (frequency, sampleRate);
+    }
+
+private:
+    double sampleRate = 44100.0;
+    StereoIIRFilter filter1, filter3, filter4;
+};
+
+//==============================================================================
+class SpecialEQStage
+{
+public:
+    void prepare (double newSampleRate)                  { sampleRate = newSampleRate; crossfade.prepare (sampleRate); reset(); }
+
+    void reset() noexcept
+    {
+        filter1.reset();
+        filter2.reset();
+        filter3.reset();
+        filter4.reset();
+        firstOrderFilter3.reset();
+        firstOrderFilter4.reset();
+    }
+
+    void visitState (StateArchive& archive) noexcept
+    {
+        archive (mode, filter1, filter2, filter3, filter4, firstOrderFilter3, firstOrderFilter4, crossfade);
+    }
+
+    // only crimson's high- and low-pass have a cheaper version
+    void setQualityTier (int tier) noexcept
+    {
+        if (crossfade.setCheaper (tier >= economyTier))
+        {
+            getFilter3 (crossfade.isCheaper()).reset();
+            getFilter4 (crossfade.isCheaper()).reset();
+        }
+    }
+
+    // the two peak filters and their gains, and crimson's high- and low-pass (left as they are in the other modes)
+    struct Design
+    {
+        std::array<IIRCoefficients, 2> peaks;
+        std::array<float, 2> gains { EQ_GAIN_MIN_VALUE, EQ_GAIN_MIN_VALUE };
+        IIRCoefficients highPass, lowPass, firstOrderHighPass, firstOrderLowPass;
+    };
+
+    static Design design (double sampleRate, float knob, int mode) noexcept
+    {
+        Design d;
+        float cutoff3;
+        float cutoff4;
+
+        switch(mode)
+        {
+            case VIOLET:
+                d.gains[0] = mapKnobValueToRange(knob, EQ_GAIN_MIN_VALUE, 0.5);
+                d.gains[1] = mapKnobValueToRange(knob, EQ_GAIN_MIN_VALUE, 1.5);
+                d.peaks[0] = IIRCoefficients::makePeakFilter (sampleRate, 400, 1, d.gains[0]); //-3db
+                d.peaks[1] = IIRCoefficients::makePeakFilter (sampleRate, 10000, 0.71f, d.gains[1]); //3db
+                break;
+
+            case TEAL:
+                d.gains[0] = mapKnobValueToRange(knob, EQ_GAIN_MIN_VALUE, 1.5);
+                d.gains[1] = mapKnobValueToRange(knob, EQ_GAIN_MIN_VALUE, 1.5);
+                d.peaks[0] = IIRCoefficients::makePeakFilter (sampleRate, 1000, 2.11f, d.gains[0]); //3db
+                d.peaks[1] = IIRCoefficients::makePeakFilter (sampleRate, 10000, 0.71f, d.gains[1]); //3db
+                break;
+
+            case CRIMSON:
+                d.gains[0] = mapKnobValueToRange(knob, EQ_GAIN_MIN_VALUE, 1.67f);
+                d.gains[1] = mapKnobValueToRange(knob, EQ_GAIN_MIN_VALUE, 1.83f);
+                cutoff3 = mapKnobValueToRange(knob, 10, 111);
+                cutoff4 = mapKnobValueToRange(knob, 20000, 2500);
+                d.peaks[0] = IIRCoefficients::makePeakFilter (sampleRate, 177, 0.71f, d.gains[0]); //4db
+                d.peaks[1] = IIRCoefficients::makePeakFilter (sampleRate, 1777, 0.71f, d.gains[1]); //5db
+                d.highPass = IIRCoefficients::makeHighPass (sampleRate, cutoff3, 0.71f);
+                d.lowPass = IIRCoefficients::makeLowPass (sampleRate, cutoff4, 0.66f);
+                d.firstOrderHighPass = IIRCoefficients::makeFirstOrderHighPass (sampleRate, cutoff3);
+                d.firstOrderLowPass = IIRCoefficients::makeFirstOrderLowPass (sampleRate, cutoff4);
+                break;
+        }
+
+        return d;
+    }
+
+    void setParameters (float knob, int newMode) noexcept
+    {
+        mode = newMode;
+        auto d = design (sampleRate, knob, mode);
+        filter1.setCoefficients (d.peaks[0]);
+        filter2.setCoefficients (d.peaks[1]);
+
+        if (mode == CRIMSON)
+        {
+            filter3.setCoefficients (d.highPass);
+            filter4.setCoefficients (d.lowPass);
+            firstOrderFilter3.setCoefficients (d.firstOrderHighPass);
+            firstOrderFilter4.setCoefficients (d.firstOrderLowPass);
+        }
+    }
+
+    void process (float* const* channels, int numSamples) noexcept
+    {
+        filter1.process (channels, numSamples);
+        filter2.process (channels, numSamples);
+
+        if (mode != CRIMSON)
+        {
+            crossfade.finish();
+            return;
+        }
+
+        auto processFilters = [this] (bool firstOrder, float* const* c, int n)
+        {
+            getFilter3 (firstOrder).process (c, n);
+            getFilter4 (firstOrder).process (c, n);
+        };
+
+        crossfade.process (channels, numSamples,
+                           [&] (float* const* c, int n) { processFilters (crossfade.isCheaper(), c, n); },
+                           [&] (float* const* c, int n) { processFilters (! crossfade.isCheaper(), c, n); });
+    }
+
+    double getMagnitudeForFrequency (double frequency) const noexcept
+    {
+        auto magnitude = filter1.getCoefficients().getMagnitudeForFrequency (frequency, sampleRate)
+                       * filter2.getCoefficients().getMagnitudeForFrequency (frequency, sampleRate);
+
+        if (mode == CRIMSON)
+        {
+            const auto& highPass = crossfade.isCheaper() ? firstOrderFilter3 : filter3;
+            const auto& lowPass = crossfade.isCheaper() ? firstOrderFilter4 : filter4;
+            magnitude *= highPass.getCoefficients().getMagnitudeForFrequency (frequency, sampleRate)
+                       * lowPass.getCoefficients().getMagnitudeForFrequency (frequency, sampleRate);
+        }
+
+        return magnitude;
+    }
+
+private:
+    StereoIIRFilter& getFilter3 (bool firstOrder) noexcept { return firstOrder ? firstOrderFilter3 : filter3; }
+    StereoIIRFilter& getFilter4 (bool firstOrder) noexcept { return firstOrder ? firstOrderFilter4 : filter4; }
+
+    double sampleRate = 44100.0;
+    int mode = VIOLET;
+    StereoIIRFilter filter1, filter2, filter3, filter4;
+    StereoIIRFilter firstOrderFilter3, firstOrderFilter4;
+    TierCrossfade crossfade;
+};
+
+//==============================================================================
+// HPF -> LPF -> reverb -> -6 dB
+class ReverbStage
+{
+    // https://github.com/szkkng/simple-reverb
+public:
+    // Call before prepare()
+    void setReducedRate (bool shouldReduceRate) noexcept   { reduceRate = shouldReduceRate; }
+    void setElisionThreshold (float newThreshold) noexcept { elisionThreshold = newThreshold; }
+
+    void setQualityTier (int tier) noexcept              { reverb.setLightAllPasses (tier >= economyTier); }
+
+    void prepare (double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        factor = reduceRate ? getRateReductionFactor (sampleRate) : 1;
+        reverb.setSampleRate (sampleRate / factor);
+
+        decimator.prepare (factor, chunkSize);
+
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            interpolators[ch].prepare (factor, chunkSize / factor + 1);
+            dryLines[ch].assign ((size_t) (getLatencySamples() + chunkSize), 0.0f);
+        }
+
+        dryGain.reset (sampleRate, 0.01);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        hpf.reset();
+        lpf.reset();
+        clearWetPath();
+        elision.reset();
+
+        for (auto& line : dryLines)
+            std::fill (line.begin(), line.end(), 0.0f);
+    }
+
+    void visitState (StateArchive& archive) noexcept
+    {
+        archive (hpf, lpf, reverb, decimator, interpolators, dryLines, dryGain, elision);
+    }
+
+    // the delay of the wet path's round trip through the lower rate, which the dry path is delayed by to match
+    int getLatencySamples() const noexcept               { return factor > 1 ? Interpolator::getRoundTripLatency (factor) : 0; }
+
+    // -6dB to compensante for gain that the reverb effect adds
+    static inline const float outputGain = std::pow (10.0f, -6.0f * 0.05f);
+
+    struct Design
+    {
+        Reverb::Parameters reverb;
+        IIRCoefficients hpf, lpf;
+    };
+
+    static Design design (double sampleRate, float knob, int mode) noexcept
+    {
+        float normVal = normalizeKnobValue(knob);
+        Design d;
+
+        // reverb params
+        auto& params = d.reverb;
+        params.roomSize = mapKnobValueToRange(knob, 0, REVERB_ROOM_SIZE_MAX_VALUE[mode]);
+        params.damping = mode == CRIMSON ? normVal : 1 - normVal;
+        params.wetLevel = mapKnobValueToRange(knob, 0, REVERB_WET_LEVEL_MAX_VALUE[mode]);
+        params.dryLevel = 1 - params.wetLevel;
+        params.width = mapKnobValueToRange(knob, 0, REVERB_WIDTH_MAX_VALUE[mode]);
+        params.freezeMode = mapKnobValueToRange(knob, 0, REVERB_FREEZE_MAX_VALUE[mode]);
+
+        // filter params
+        float cutoff1 = mapKnobValueToRange(knob, 10, 300);
+        float cutoff2 = mapKnobValueToRange(knob, 20000, 3500);
+        d.hpf = IIRCoefficients::makeFirstOrderHighPass (sampleRate, cutoff1);
+        d.lpf = IIRCoefficients::makeFirstOrderLowPass (sampleRate, cutoff2);
+        return d;
+    }
+
+    void setParameters (float knob, int mode) noexcept
+    {
+        auto d = design (sampleRate, knob, mode);
+        auto& params = d.reverb;
+
+        // at a reduced rate the reverb only makes the wet signal, and the dry gain (the reverb's dry level * 2) is applied here
+        if (factor > 1)
+        {
+            dryGain.setTargetValue (params.dryLevel * 2.0f);
+            params.dryLevel = 0;
+        }
+
+        reverb.setParameters (params);
+
+        // the wet path rings for as long as the combs take to decay from the loudest it can get to the threshold, plus the allpasses'
+        // own ringing (half as loud every 579 samples at 44.1k, the longest) and the round trip
+        auto maxGain = reverb.getMaxWetGain() * outputGain;
+        auto decayDb = elisionThreshold > 0.0f ? std::max (0.0f, 20.0f * std::log10 (maxGain / elisionThreshold)) : 0.0f;
+        auto tailSeconds = getReverbTailLengthSeconds (mode, knob, decayDb) + decayDb / 6.02 * 579.0 / 44100.0 + getLatencySamples() / sampleRate;
+        elision.setParameters (elisionThreshold, maxGain, tailSeconds, sampleRate);
+
+        hpf.setCoefficients (d.hpf);
+        lpf.setCoefficients (d.lpf);
+    }
+
+    void process (float* const* channels, int numSamples) noexcept
+    {
+        hpf.process (channels, numSamples);
+        lpf.process (channels, numSamples);
+
+        auto action = elision.update (channels, numSamples);
+
+        if (action == TailElision::clearAndSkip)
+            clearWetPath();
+
+        if (factor > 1)
+        {
+            processReducedRate (channels, numSamples, action != TailElision::run);
+            return;
+        }
+
+        if (action == TailElision::run)
+            reverb.processStereo (channels[0], channels[1], numSamples);
+        else
+            reverb.processDry (channels[0], channels[1], numSamples);
+
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                channels[ch][i] *= outputGain;
+    }
+
+private:
+    void clearWetPath() noexcept
+    {
+        reverb.reset();
+        decimator.reset();
+
+        for (auto& interpolator : interpolators)
+            interpolator.reset();
+    }
+
+    void processReducedRate (float* const* channels, int numSamples, bool wetElided) noexcept
+    {
+        auto latency = getLatencySamples();
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            auto count = std::min (chunkSize, numSamples - start);
+            float* chunk[] = { channels[0] + start, channels[1] + start };
+
+            if (wetElided)
+            {
+                reverb.skipSmoothing (count / factor);
+
+                for (auto& channel : wet)
+                    std::fill (channel.begin(), channel.begin() + count, 0.0f);
+            }
+            else
+            {
+                // the reverb only hears L + R, so only that goes down
+                for (int i = 0; i < count; ++i)
+                    mono[(size_t) i] = chunk[0][i] + chunk[1][i];
+
+                auto numLowRate = decimator.process (mono.data(), count, low[0].data());
+                std::fill (low[1].begin(), low[1].begin() + numLowRate, 0.0f);
+                reverb.processStereo (low[0].data(), low[1].data(), numLowRate);
+
+                for (size_t ch = 0; ch < 2; ++ch)
+                    interpolators[ch].process (low[ch].data(), numLowRate, wet[ch].data(), count);
+            }
+
+            // each line holds the last latency samples of dry signal, then this chunk, so the delayed dry is its start
+            auto smoothing = dryGain.isSmoothing();
+            auto gain = dryGain.getTargetValue();
+
+            if (smoothing)
+                for (int i = 0; i < count; ++i)
+                    dryGains[(size_t) i] = dryGain.getNextValue();
+
+            for (size_t ch = 0; ch < 2; ++ch)
+            {
+                auto* line = dryLines[ch].data();
+                const auto* w = wet[ch].data();
+                auto* out = chunk[ch];
+
+                std::copy (out, out + count, line + latency);
+
+                if (smoothing)
+                {
+                    for (int i = 0; i < count; ++i)
+                        out[i] = (line[i] * dryGains[(size_t) i] + w[i]) * outputGain;
+                }
+                else
+                {
+                    for (int i = 0; i < count; ++i)
+                        out[i] = (line[i] * gain + w[i]) * outputGain;
+                }
+
+                std::copy (line + count, line + count + latency, line);
+            }
+        }
+    }
+
+    static constexpr int chunkSize = 256;
+
+    double sampleRate = 44100.0;
+    StereoIIRFilter hpf, lpf;
+    Reverb reverb;
+
+    // the reduced rate's
+    bool reduceRate = false;
+    int factor = 1;
+    Decimator decimator;
+    std::array<Interpolator, 2> interpolators;
+    std::array<std::vector<float>, 2> dryLines;
+    LinearSmoothedValue dryGain;
+    std::array<float, chunkSize> mono {}, dryGains {};
+    std::array<std::array<float, chunkSize + 1>, 2> low {};
+    std::array<std::array<float, chunkSize>, 2> wet {};
+
+    float elisionThreshold = 0.0f;
+    TailElision elision;
+};
+
+//==============================================================================
+// HPF -> LPF -> feedback delay
+class DelayStage
+{
+public:
+    // Call before prepare()
+    void setReducedRate (bool shouldReduceRate) noexcept   { reduceRate = shouldReduceRate; }
+    void setElisionThreshold (float newThreshold) noexcept { elisionThreshold = newThreshold; }
+
+    void prepare (double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        factor = reduceRate ? getRateReductionFactor (sampleRate) : 1;
+        delay.prepare (sampleRate / factor);
+
+        // at a reduced rate the delay only makes the wet signal, the dry one stays at the full rate
+        delay.setDryLevel (factor > 1 ? 0.0f : 1.0f);
+
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            decimators[ch].prepare (factor, chunkSize);
+            interpolators[ch].prepare (factor, chunkSize / factor + 1);
+        }
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        hpf.reset();
+        lpf.reset();
+        clearWetPath();
+        elision.reset();
+    }
+
+    void visitState (StateArchive& archive) noexcept    { archive (hpf, lpf, delay, decimators, interpolators, elision); }
+
+    void setQualityTier (int tier) noexcept              { delay.setApproximateTanh (tier >= fastSaturationTier); }
+
+    // the delay times are DELAY_TIME_L and DELAY_TIME_R
+    struct Design
+    {
+        float wetLevel, feedback;
+        IIRCoefficients hpf, lpf;
+    };
+
+    static Design design (double sampleRate, float knob, int mode) noexcept
+    {
+        Design d;
+        d.wetLevel = mapKnobValueToRange(knob, 0, DELAY_WET_LEVEL_MAX_VALUE[(size_t) mode]);
+        d.feedback = mapKnobValueToRange(knob, 0, DELAY_FEEDBACK_MAX_VALUE[(size_t) mode]);
+
+        // filter params
+        float hpfCutoff = mapKnobValueToRange(knob, DELAY_HPF_FREQ_MIN_VALUE, DELAY_HPF_FREQ_MAX_VALUE);
+        float lpfCutoff = mapKnobValueToRange(knob, DELAY_LPF_FREQ_MIN_VALUE, DELAY_LPF_FREQ_MAX_VALUE);
+        d.hpf = IIRCoefficients::makeFirstOrderHighPass (sampleRate, hpfCutoff);
+        d.lpf = IIRCoefficients::makeFirstOrderLowPass (sampleRate, lpfCutoff);
+        return d;
+    }
+
+    void setParameters (float knob, int mode) noexcept
+    {
+        auto d = design (sampleRate, knob, mode);
+
+        // delay params, less the round trip through the reduced rate
+        auto roundTrip = factor > 1 ? (float) (Interpolator::getRoundTripLatency (factor) / sampleRate) : 0.0f;
+        delay.setDelayTime(0, DELAY_TIME_L[(size_t) mode] - roundTrip);
+        delay.setDelayTime(1, DELAY_TIME_R[(size_t) mode] - roundTrip);
+        auto wetLevel = d.wetLevel;
+        auto feedback = d.feedback;
+        delay.setWetLevel(wetLevel);
+        delay.setFeedback(feedback);
+
+        // the tanh keeps what's in the lines below 1, and every repeat is at most `feedback` times the one before, so the repeats are
+        // below the threshold after this many of them
+        auto decayDb = elisionThreshold > 0.0f ? std::max (0.0f, 20.0f * std::log10 (wetLevel / elisionThreshold)) : 0.0f;
+        auto repeats = feedback > 0.0f ? decayDb / (-20.0f * std::log10 (feedback)) : 0.0f;
+        auto delayTime = std::max (DELAY_TIME_L[(size_t) mode], DELAY_TIME_R[(size_t) mode]);
+        elision.setParameters (elisionThreshold, wetLevel / (1.0f - feedback), (1.0 + repeats) * delayTime + roundTrip, sampleRate);
+
+        hpf.setCoefficients (d.hpf);
+        lpf.setCoefficients (d.lpf);
+    }
+
+    void process (float* const* channels, int numSamples) noexcept
+    {
+        hpf.process (channels, numSamples);
+        lpf.process (channels, numSamples);
+
+        // with the wet path skipped, the dry signal is all there is
+        auto action = elision.update (channels, numSamples);
+
+        if (action == TailElision::clearAndSkip)
+            clearWetPath();
+
+        if (action != TailElision::run)
+            return;
+
+        if (factor == 1)
+        {
+            delay.process (channels, numSamples);
+            return;
+        }
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            auto count = std::min (chunkSize, numSamples - start);
+            int numLowRate = 0;
+
+            for (size_t ch = 0; ch < 2; ++ch)
+                numLowRate = decimators[ch].process (channels[ch] + start, count, low[ch].data());
+
+            float* lowChannels[] = { low[0].data(), low[1].data() };
+            delay.process (lowChannels, numLowRate);
+
+            for (size_t ch = 0; ch < 2; ++ch)
+            {
+                interpolators[ch].process (low[ch].data(), numLowRate, wet.data(), count);
+
+                for (int i = 0; i < count; ++i)
+                    channels[ch][start + i] += wet[(size_t) i];
+            }
+        }
+    }
+
+private:
+    void clearWetPath() noexcept
+    {
+        delay.reset();
+
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            decimators[ch].reset();
+            interpolators[ch].reset();
+        }
+    }
+
+    static constexpr int chunkSize = 256;
+
+    double sampleRate = 44100.0;
+    StereoIIRFilter hpf, lpf;
+    FeedbackDelay delay;
+
+    // the reduced rate's
+    bool reduceRate = false;
+    int factor = 1;
+    std::array<Decimator, 2> decimators;
+    std::array<Interpolator, 2> interpolators;
+    std::array<std::array<float, chunkSize + 1>, 2> low {};
+    std::array<float, chunkSize> wet {};
+
+    float elisionThreshold = 0.0f;
+    TailElision elision;
+};
+
+//==============================================================================
+// pre gain -> waveshaper -> post gain
+class DistortionStage
+{
+public:
+    void prepare (double)                                {}
+    void reset() noexcept                                {}
+    void visitState (StateArchive& archive) noexcept    { archive (mode, preGain, postGain, approximateTanh); }
+
+    void setQualityTier (int tier) noexcept              { approximateTanh = tier >= fastSaturationTier; }
+
+    // the gains either side of the waveshaper
+    struct Design
+    {
+        float preGain, postGain;
+    };
+
+    static Design design (double, float knob, int mode) noexcept
+    {
+        float inputGain = mapKnobValueToRange(knob, DIST_INPUT_GAIN_MIN_VALUE[(size_t) mode], DIST_INPUT_GAIN_MAX_VALUE[(size_t) mode]);
+        return { decibelsToGain (inputGain), decibelsToGain ((float) (inputGain*-0.75)) };
+    }
+
+    void setParameters (float knob, int newMode) noexcept
+    {
+        mode = newMode;
+
+        auto d = design (0.0, knob, mode);
+        preGain = d.preGain;
+        postGain = d.postGain;
+    }
+
+    void process (float* const* channels, int numSamples) noexcept
+    {
+        auto& kernels = getKernels();
+
+        auto waveshape = approximateTanh ? kernels.waveshapeApproximate : kernels.waveshape;
+
+        for (int ch = 0; ch < 2; ++ch)
+            waveshape (channels[ch], numSamples, preGain, postGain, mode == VIOLET);
+    }
+
+private:
+    static float decibelsToGain (float decibels) noexcept
+    {
+        return decibels > -100.0f ? std::pow (10.0f, decibels * 0.05f) : 0.0f;
+    }
+
+    int mode = VIOLET;
+    float preGain = 1.0f, postGain = 1.0f;
+    bool approximateTanh = false;
+};
+
+} // namespace theknob
@@ -0,0 +1,153 @@
+//
+//  StateArchive.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace theknob
+{
+
+class StateArchive;
+
+// Whether a Type has a visitState (StateArchive&) of its own
+template <typename Type, typename = void>
+struct HasVisitState : std::false_type {};
+
+template <typename Type>
+struct HasVisitState<Type, std::void_t<decltype (std::declval<Type&>().visitState (std::declval<StateArchive&>()))>> : std::true_type {};
+
+/*
+ =================================StateArchive=================================
+
+ Copies the running state of the DSP classes to and from a flat block of memory, for Engine::saveState() and restoreState(). Every class
+ with state that changes as it runs has a visitState() that hands its members to the archive in a fixed order, and the same walk measures,
+ saves or restores them:
+
+ -Trivially copyable members are copied as they are, and std::vectors and std::arrays of them in one memcpy each, so the delay lines and
+  reverb combs (nearly all of the bytes) go at memcpy speed.
+ -Members with a visitState() of their own (or vectors and arrays of them) are walked into.
+ -Only what setParameters() and process() change is visited. What prepare() sets up (buffer sizes, the reverb's comb lengths, the
+  half-band taps) isn't, so state can only be restored into something prepared the same way. The engine checks that before it restores.
+ -Scratch buffers that every block overwrites before reading aren't part of the state, and aren't visited.
+
+ It never allocates: restoring copies into vectors that prepare() has already sized.
+ */
+class StateArchive
+{
+public:
+    // Counts the bytes the state takes, without copying anything
+    static StateArchive forMeasuring() noexcept                         { return StateArchive (measuring, nullptr, 0); }
+
+    // Copies everything visited into destination, which holds size bytes
+    static StateArchive forSaving (void* destination, size_t size) noexcept
+    {
+        return StateArchive (saving, static_cast<unsigned char*> (destination), size);
+    }
+
+    // Copies everything visited back out of source, which holds size bytes
+    static StateArchive forRestoring (const void* source, size_t size) noexcept
+    {
+        return StateArchive (restoring, static_cast<unsigned char*> (const_cast<void*> (source)), size);
+    }
+
+    template <typename... Types>
+    void operator() (Types&... values) noexcept
+    {
+        (visit (values), ...);
+    }
+
+    // The bytes visited so far, and whether they went past the end of the buffer (anything past it wasn't copied)
+    size_t getPosition() const noexcept                  { return position; }
+    bool hasOverflowed() const noexcept                  { return overflowed; }
+
+private:
+    enum Direction
+    {
+        measuring,
+        saving,
+        restoring
+    };
+
+    StateArchive (Direction newDirection, unsigned char* newData, size_t newSize) noexcept
+        : direction (newDirection), data (newData), size (newSize)
+    {
+    }
+
+    template <typename Type>
+    void visit (std::vector<Type>& values) noexcept
+    {
+        if constexpr (HasVisitState<Type>::value || ! std::is_trivially_copyable_v<Type>)
+        {
+            for (auto& value : values)
+                visit (value);
+        }
+        else
+        {
+            copy (values.data(), values.size() * sizeof (Type));
+        }
+    }
+
+    template <typename Type, size_t numValues>
+    void visit (std::array<Type, numValues>& values) noexcept
+    {
+        if constexpr (HasVisitState<Type>::value || ! std::is_trivially_copyable_v<Type>)
+        {
+            for (auto& value : values)
+                visit (value);
+        }
+        else
+        {
+            copy (values.data(), sizeof (values));
+        }
+    }
+
+    template <typename Type>
+    void visit (Type& value) noexcept
+    {
+        if constexpr (HasVisitState<Type>::value)
+        {
+            value.visitState (*this);
+        }
+        else
+        {
+            static_assert (std::is_trivially_copyable_v<Type>, "give this type a visitState()");
+            copy (&value, sizeof (Type));
+        }
+    }
+
+    void copy (void* value, size_t numBytes) noexcept
+    {
+        if (numBytes == 0)
+            return;
+
+        if (direction != measuring)
+        {
+            if (numBytes > size || position > size - numBytes)
+                overflowed = true;
+            else if (direction == saving)
+                std::memcpy (data + position, value, numBytes);
+            else
+                std::memcpy (value, data + position, numBytes);
+        }
+
+        position += numBytes;
+    }
+
+    Direction direction;
+    unsigned char* data;
+    size_t size;
+    size_t position = 0;
+    bool overflowed = false;
+};
+
+} // namespace theknob
@@ -0,0 +1,273 @@
+//
+//  Trace.cpp
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+
+namespace theknob
+{
+
+std::atomic<Trace*> Trace::active { nullptr };
+std::atomic<uint64_t> Trace::lastSession { 0 };
+
+thread_local Trace::ThreadBuffer* Trace::threadBuffer = nullptr;
+thread_local uint64_t Trace::threadSession = 0;
+thread_local const char* Trace::threadName = nullptr;
+
+Trace::~Trace()
+{
+    stop();
+}
+
+//==============================================================================
+bool Trace::start (const std::string& path, int eventsPerThread)
+{
+    if (file != nullptr || getActive() != nullptr)
+        return false;
+
+    file = std::fopen (path.c_str(), "wb");
+
+    if (file == nullptr)
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock (buffersLock);
+        buffers.clear();
+    }
+
+    // a new session, so no thread takes a ring from an earlier one for its own
+    session = ++lastSession;
+    eventsPerBuffer = std::max (1024, eventsPerThread);
+    startTime = std::chrono::steady_clock::now();
+
+    std::fputs ("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+    std::fputs ("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"TheKnob\"}}", file);
+
+    // published last, so a thread that sees this trace sees everything above
+    Trace* none = nullptr;
+
+    if (! active.compare_exchange_strong (none, this))
+    {
+        std::fclose (file);
+        file = nullptr;
+        return false;
+    }
+
+    writerShouldExit = false;
+    writerThread = std::thread ([this] { runWriter(); });
+    return true;
+}
+
+int64_t Trace::stop()
+{
+    if (file == nullptr)
+        return 0;
+
+    Trace* self = this;
+    active.compare_exchange_strong (self, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock (writerLock);
+        writerShouldExit = true;
+    }
+
+    writerWakeUp.notify_all();
+
+    if (writerThread.joinable())
+        writerThread.join();
+
+    drain();
+
+    int64_t dropped = 0;
+    std::lock_guard<std::mutex> lock (buffersLock);
+
+    for (auto& buffer : buffers)
+    {
+        dropped += buffer->dropped.load();
+
+        if (buffer->threadName[0] != 0)
+        {
+            std::fprintf (file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", buffer->threadId);
+            writeString (buffer->threadName.data());
+            std::fputs ("}}", file);
+        }
+    }
+
+    std::fputs ("\n]}\n", file);
+    std::fclose (file);
+    file = nullptr;
+    return dropped;
+}
+
+const char* Trace::intern (const std::string& name)
+{
+    std::lock_guard<std::mutex> lock (buffersLock);
+    internedNames.push_back (name);
+    return internedNames.back().c_str();
+}
+
+//==============================================================================
+int64_t Trace::now() const noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Trace::span (const char* name, const char* category, int64_t startNs, int64_t endNs, const char* argName, int64_t arg) noexcept
+{
+    record ({ name, category, argName, startNs, std::max ((int64_t) 0, endNs - startNs), arg });
+}
+
+void Trace::instant (const char* name, const char* category, const char* argName, int64_t arg) noexcept
+{
+    record ({ name, category, argName, now(), -1, arg });
+}
+
+void Trace::setThreadName (const char* name) noexcept
+{
+    threadName = name;
+
+    if (auto* trace = getActive())
+        if (threadBuffer != nullptr && threadSession == trace->session)
+            threadBuffer->setThreadName (name);
+}
+
+void Trace::ThreadBuffer::setThreadName (const char* name) noexcept
+{
+    threadName.fill (0);
+
+    if (name != nullptr)
+        std::strncpy (threadName.data(), name, threadName.size() - 1);
+}
+
+Trace::ThreadBuffer* Trace::getThreadBuffer() noexcept
+{
+    if (threadSession == session && threadBuffer != nullptr)
+        return threadBuffer;
+
+    // the first event this thread records into this trace: the only time it allocates or locks
+    try
+    {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->events.resize ((size_t) eventsPerBuffer);
+        buffer->setThreadName (threadName);
+
+        std::lock_guard<std::mutex> lock (buffersLock);
+        buffer->threadId = (int) buffers.size() + 1;
+        buffers.push_back (std::move (buffer));
+        threadBuffer = buffers.back().get();
+        threadSession = session;
+        return threadBuffer;
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void Trace::record (const Event& event) noexcept
+{
+    auto* buffer = getThreadBuffer();
+
+    if (buffer == nullptr)
+        return;
+
+    auto written = buffer->written.load (std::memory_order_relaxed);
+
+    if (written - buffer->read.load (std::memory_order_acquire) >= buffer->events.size())
+    {
+        buffer->dropped.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer->events[(size_t) (written % buffer->events.size())] = event;
+    buffer->written.store (written + 1, std::memory_order_release);
+}
+
+//==============================================================================
+void Trace::runWriter()
+{
+    std::unique_lock<std::mutex> lock (writerLock);
+
+    while (! writerShouldExit)
+    {
+        writerWakeUp.wait_for (lock, std::chrono::milliseconds (writerIntervalMilliseconds));
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void Trace::drain()
+{
+    std::vector<ThreadBuffer*> toDrain;
+
+    {
+        std::lock_guard<std::mutex> lock (buffersLock);
+
+        for (auto& buffer : buffers)
+            toDrain.push_back (buffer.get());
+    }
+
+    for (auto* buffer : toDrain)
+    {
+        auto read = buffer->read.load (std::memory_order_relaxed);
+        auto written = buffer->written.load (std::memory_order_acquire);
+
+        for (; read != written; ++read)
+            writeEvent (buffer->events[(size_t) (read % buffer->events.size())], buffer->threadId);
+
+        buffer->read.store (read, std::memory_order_release);
+    }
+
+    std::fflush (file);
+}
+
+void Trace::writeEvent (const Event& event, int threadId)
+{
+    std::fputs (",\n{\"name\":", file);
+    writeString (event.name);
+    std::fputs (",\"cat\":", file);
+    writeString (event.category);
+
+    // microseconds, to the nanosecond
+    if (event.duration < 0)
+        std::fprintf (file, ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f", (double) event.start * 1.0e-3);
+    else
+        std::fprintf (file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", (double) event.start * 1.0e-3, (double) event.duration * 1.0e-3);
+
+    std::fprintf (file, ",\"pid\":1,\"tid\":%d", threadId);
+
+    if (event.argName != nullptr)
+    {
+        std::fputs (",\"args\":{", file);
+        writeString (event.argName);
+        std::fprintf (file, ":%lld}", (long long) event.arg);
+    }
+
+    std::fputc ('}', file);
+}
+
+void Trace::writeString (const char* text)
+{
+    std::fputc ('"', file);
+
+    for (auto* c = text != nullptr ? text : ""; *c != 0; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            std::fprintf (file, "\\%c", *c);
+        else if ((unsigned char) *c < 0x20)
+            std::fprintf (file, "\\u%04x", (unsigned int) (unsigned char) *c);
+        else
+            std::fputc (*c, file);
+    }
+
+    std::fputc ('"', file);
+}
+
+} // namespace theknob
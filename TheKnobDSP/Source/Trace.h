@@ -0,0 +1,164 @@
+//
+//  Trace.h
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace theknob
+{
+
+/*
+ =================================Trace=================================
+
+ A timeline of what every thread did and when, written as a Chrome trace-event JSON file (chrome://tracing and ui.perfetto.dev both open
+ it): spans with a start and a duration, and instant events.
+
+ -Each thread records into a ring of its own, with one writer (that thread) and one reader (the trace's writer thread), so recording an
+  event takes no locks and never allocates. Only a thread's first event in a trace registers its ring, under a lock.
+ -The writer thread drains the rings into the file every few milliseconds. If a ring fills up before then, the events that don't fit are
+  dropped and counted.
+ -With no trace recording, a TraceScope costs one atomic load. The engine times every stage it runs with one.
+
+ One trace records at a time, and every TraceScope in the process records into it. Names, categories and argument names have to outlive
+ the trace: string literals, or strings from intern().
+ */
+class Trace
+{
+public:
+    Trace() = default;
+    ~Trace();
+
+    static constexpr int defaultEventsPerThread = 1 << 16;
+
+    // Creates the file and starts recording into it. Fails if the file can't be created, or another trace is already recording.
+    bool start (const std::string& path, int eventsPerThread = defaultEventsPerThread);
+
+    // Stops recording, writes out what's left and closes the file. Returns how many events were dropped. Threads still inside a
+    // TraceScope when it stops lose that span, but the trace has to outlive them.
+    int64_t stop();
+
+    bool isRecording() const noexcept                    { return getActive() == this; }
+
+    // A copy of name that lasts as long as the trace. It locks, so keep it off the hot path.
+    const char* intern (const std::string& name);
+
+    //==============================================================================
+    // The trace that's recording, if there is one
+    static Trace* getActive() noexcept                   { return active.load (std::memory_order_acquire); }
+
+    // Nanoseconds since the recording trace started
+    int64_t now() const noexcept;
+
+    // A span from startNs to endNs on the calling thread, with an optional number (argName, arg) attached
+    void span (const char* name, const char* category, int64_t startNs, int64_t endNs, const char* argName = nullptr, int64_t arg = 0) noexcept;
+
+    // Something that happened now, on the calling thread
+    void instant (const char* name, const char* category, const char* argName = nullptr, int64_t arg = 0) noexcept;
+
+    // The name the calling thread gets in traces it records into from now on. It's copied when the thread first records into one, and
+    // has to last until then (or until the thread finishes). Costs nothing when not tracing.
+    static void setThreadName (const char* name) noexcept;
+
+private:
+    //==============================================================================
+    struct Event
+    {
+        const char* name = nullptr;
+        const char* category = nullptr;
+        const char* argName = nullptr;
+        int64_t start = 0;
+        int64_t duration = -1;  // -1 for an instant event
+        int64_t arg = 0;
+    };
+
+    struct ThreadBuffer
+    {
+        std::vector<Event> events;
+        std::atomic<uint64_t> written { 0 }, read { 0 };
+        std::atomic<int64_t> dropped { 0 };
+        int threadId = 0;
+        std::array<char, 64> threadName {};
+
+        void setThreadName (const char* name) noexcept;
+    };
+
+    ThreadBuffer* getThreadBuffer() noexcept;
+    void record (const Event& event) noexcept;
+    void runWriter();
+    void drain();
+    void writeEvent (const Event& event, int threadId);
+    void writeString (const char* text);
+
+    //==============================================================================
+    static std::atomic<Trace*> active;
+    static std::atomic<uint64_t> lastSession;
+
+    // the ring the calling thread records into, and the session (one per start()) it belongs to
+    static thread_local ThreadBuffer* threadBuffer;
+    static thread_local uint64_t threadSession;
+    static thread_local const char* threadName;
+
+    uint64_t session = 0;
+    std::chrono::steady_clock::time_point startTime;
+    int eventsPerBuffer = defaultEventsPerThread;
+
+    std::mutex buffersLock;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::deque<std::string> internedNames;
+
+    std::FILE* file = nullptr;
+
+    std::thread writerThread;
+    std::mutex writerLock;
+    std::condition_variable writerWakeUp;
+    bool writerShouldExit = false;
+    static constexpr int writerIntervalMilliseconds = 20;
+};
+
+//==============================================================================
+// Times the scope it's declared in as a span on the recording trace, if there is one
+class TraceScope
+{
+public:
+    TraceScope (const char* spanName, const char* spanCategory, const char* spanArgName = nullptr, int64_t spanArg = 0) noexcept
+        : trace (Trace::getActive()), name (spanName), category (spanCategory), argName (spanArgName), arg (spanArg)
+    {
+        if (trace != nullptr)
+            start = trace->now();
+    }
+
+    ~TraceScope()
+    {
+        if (trace != nullptr)
+            trace->span (name, category, start, trace->now(), argName, arg);
+    }
+
+private:
+    Trace* trace;
+    const char* name;
+    const char* category;
+    const char* argName;
+    int64_t arg;
+    int64_t start = 0;
+
+    TraceScope (const TraceScope&) = delete;
+    TraceScope& operator= (const TraceScope&) = delete;
+};
+
+} // namespace theknob
@@ -0,0 +1,226 @@
+//
+//  theknob_dsp.cpp
+//  TheKnobDSP
+//
+//  Created by agent on 2026-10-18.
+//  Copyright © 2026 VOU. All rights reserved.
+//
+
+#include "../include/theknob_dsp.h"
+#include "Engine.h"
+#include "Kernels.h"
+#include "NoDenormals.h"
+#include "QualityGovernor.h"
+#include <chrono>
+#include <new>
+
+struct theknob_engine
+{
+    theknob::Engine engine;
+
+    // for THEKNOB_QUALITY_AUTO
+    bool automaticQuality = false;
+    theknob::QualityGovernor governor;
+    double sampleRate = 0.0;
+
+    // Runs a block, and times it when the governor's choosing the tier
+    template <typename ProcessBlock>
+    void run (int numSamples, ProcessBlock&& processBlock)
+    {
+        if (! automaticQuality || sampleRate <= 0.0)
+        {
+            processBlock();
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        processBlock();
+        auto elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+
+        auto blockSeconds = numSamples / sampleRate;
+        engine.setQualityTier (governor.update ((float) (elapsed / blockSeconds), blockSeconds));
+    }
+};
+
+//==============================================================================
+theknob_engine* theknob_create (void)
+{
+    return new (std::nothrow) theknob_engine();
+}
+
+void theknob_destroy (theknob_engine* engine)
+{
+    delete engine;
+}
+
+int theknob_prepare (theknob_engine* engine, double sample_rate, int max_block_size)
+{
+    if (engine == nullptr || ! (sample_rate > 0.0) || max_block_size <= 0)
+        return -1;
+
+    try
+    {
+        engine->engine.prepare (sample_rate, max_block_size);
+        engine->sampleRate = sample_rate;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+void theknob_set_params (theknob_engine* engine, float knob, int mode)
+{
+    if (engine != nullptr)
+        engine->engine.setParameters (knob, mode);
+}
+
+void theknob_process (theknob_engine* engine, float* const* channels, int num_channels, int num_samples)
+{
+    if (engine == nullptr || channels == nullptr || num_channels < 1 || num_samples <= 0)
+        return;
+
+    theknob::ScopedNoDenormals noDenormals;
+    engine->run (num_samples, [&] { engine->engine.process (channels, num_channels > 2 ? 2 : num_channels, num_samples); });
+}
+
+void theknob_process_with_changes (theknob_engine* engine, float* const* channels, int num_channels, int num_samples,
+                                   const theknob_param_change* changes, int num_changes)
+{
+    if (engine == nullptr || channels == nullptr || num_channels < 1 || num_samples <= 0)
+        return;
+
+    if (changes == nullptr)
+        num_changes = 0;
+
+    theknob::ScopedNoDenormals noDenormals;
+    num_channels = num_channels > 2 ? 2 : num_channels;
+
+    engine->run (num_samples, [&]
+    {
+        // the changes are converted a batch at a time, and each batch runs up to where the next one starts
+        constexpr int batchSize = 32;
+        theknob::ParameterChange batch[batchSize];
+        int position = 0, next = 0;
+
+        do
+        {
+            auto count = std::min (batchSize, num_changes - next);
+
+            for (int i = 0; i < count; ++i)
+                batch[i] = { changes[next + i].sample_offset - position, changes[next + i].knob, changes[next + i].mode };
+
+            next += count;
+            auto end = next < num_changes ? std::clamp (changes[next].sample_offset, position, num_samples) : num_samples;
+
+            float* range[] = { channels[0] + position, num_channels == 2 ? channels[1] + position : nullptr };
+            engine->engine.process (range, num_channels, end - position, batch, count);
+            position = end;
+        }
+        while (next < num_changes);
+    });
+}
+
+void theknob_set_linear_phase_eq (theknob_engine* engine, int enabled)
+{
+    if (engine != nullptr)
+        engine->engine.setLinearPhaseEQ (enabled != 0);
+}
+
+void theknob_set_convolution_reverb (theknob_engine* engine, int enabled)
+{
+    if (engine != nullptr)
+        engine->engine.setConvolutionReverb (enabled != 0);
+}
+
+void theknob_set_impulse_response (theknob_engine* engine, const float* const* channels, int num_channels, int length)
+{
+    if (engine != nullptr)
+        engine->engine.setImpulseResponse (channels, num_channels, length);
+}
+
+void theknob_set_reduced_rate_wet_paths (theknob_engine* engine, int enabled)
+{
+    if (engine != nullptr)
+        engine->engine.setReducedRateWetPaths (enabled != 0);
+}
+
+void theknob_set_elision_threshold (theknob_engine* engine, float threshold_db)
+{
+    if (engine != nullptr)
+        engine->engine.setElisionThreshold (threshold_db);
+}
+
+void theknob_set_quality (theknob_engine* engine, int quality)
+{
+    if (engine == nullptr)
+        return;
+
+    engine->automaticQuality = quality == THEKNOB_QUALITY_AUTO;
+
+    // automatic starts again from the top, with nothing measured
+    if (engine->automaticQuality)
+    {
+        engine->governor.reset();
+        quality = engine->governor.getTier();
+    }
+
+    engine->engine.setQualityTier (quality);
+}
+
+int theknob_get_quality_tier (const theknob_engine* engine)
+{
+    return engine != nullptr ? engine->engine.getQualityTier() : THEKNOB_QUALITY_FULL;
+}
+
+int theknob_get_latency_samples (const theknob_engine* engine)
+{
+    return engine != nullptr ? engine->engine.getLatencySamples() : 0;
+}
+
+void theknob_reset (theknob_engine* engine)
+{
+    if (engine != nullptr)
+        engine->engine.reset();
+}
+
+size_t theknob_get_state_size (const theknob_engine* engine)
+{
+    return engine != nullptr ? engine->engine.getStateSize() : 0;
+}
+
+int theknob_save_state (const theknob_engine* engine, void* buffer, size_t size)
+{
+    return engine != nullptr && engine->engine.saveState (buffer, size) ? 0 : -1;
+}
+
+int theknob_restore_state (theknob_engine* engine, const void* buffer, size_t size)
+{
+    return engine != nullptr && engine->engine.restoreState (buffer, size) ? 0 : -1;
+}
+
+double theknob_get_tail_seconds (const theknob_engine* engine, float decay_db)
+{
+    if (engine == nullptr || engine->engine.isBypassed())
+        return 0.0;
+
+    return getTailLengthSeconds (engine->engine.getMode(), engine->engine.getKnob(), decay_db);
+}
+
+int theknob_get_dsp_version (void)
+{
+    return DSP_VERSION;
+}
+
+const char* theknob_get_isa (void)
+{
+    return theknob::getIsaName (theknob::getKernels().isa);
+}
+
+int theknob_set_isa (const char* isa)
+{
+    theknob::Isa found;
+    return theknob::findIsa (isa, found) && theknob::setKernelIsa (found) ? 0 : -1;
+}
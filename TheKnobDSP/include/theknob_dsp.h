@@ -0,0 +1,143 @@
+/*
+    theknob_dsp.h
+    TheKnobDSP
+
+    Created by agent on 2026-10-18.
+    Copyright © 2026 VOU. All rights reserved.
+
+    The C interface to TheKnob's DSP engine, for hosts that can't (or don't want to) use the C++ classes.
+
+    -theknob_create() and theknob_prepare() allocate; everything else is real-time safe and never allocates.
+    -theknob_set_params(), theknob_process() and theknob_reset() mustn't be called at the same time as each other on the same engine.
+    -theknob_process() works in place on the caller's buffers: one (mono) or two (stereo, non-interleaved) channels of any length.
+*/
+
+#ifndef THEKNOB_DSP_H
+#define THEKNOB_DSP_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct theknob_engine theknob_engine;
+
+enum
+{
+    THEKNOB_MODE_VIOLET  = 0,
+    THEKNOB_MODE_TEAL    = 1,
+    THEKNOB_MODE_CRIMSON = 2
+};
+
+/* theknob_set_quality(): the automatic choice, then the tiers from the full chain to the cheapest */
+enum
+{
+    THEKNOB_QUALITY_AUTO            = -1,
+    THEKNOB_QUALITY_FULL            = 0,
+    THEKNOB_QUALITY_FAST_SATURATION = 1,
+    THEKNOB_QUALITY_ECONOMY         = 2
+};
+
+#define THEKNOB_KNOB_MIN 0.0f
+#define THEKNOB_KNOB_MAX 100.0f
+
+/* A new knob and mode, from sample_offset samples into the block on */
+typedef struct theknob_param_change
+{
+    int sample_offset;
+    float knob;
+    int mode;
+} theknob_param_change;
+
+/* Returns NULL if it runs out of memory. The engine starts bypassed (knob 0, Violet). */
+theknob_engine* theknob_create (void);
+
+void theknob_destroy (theknob_engine* engine);
+
+/* Returns 0 on success, or -1 for bad arguments or if it runs out of memory. Clears the delay and reverb tails. */
+int theknob_prepare (theknob_engine* engine, double sample_rate, int max_block_size);
+
+/* knob goes from 0 to 100 (below 1 bypasses everything), mode is one of THEKNOB_MODE_*. Out of range values are clamped. */
+void theknob_set_params (theknob_engine* engine, float knob, int mode);
+
+/* channels holds num_channels pointers (1 or 2) to num_samples floats each, which are processed in place */
+void theknob_process (theknob_engine* engine, float* const* channels, int num_channels, int num_samples);
+
+/* The same, applying each change at its offset, for sample-accurate automation. changes holds num_changes changes in order of
+   sample_offset; the last of several at the same offset wins. The block is only split where a change alters the knob or the mode. */
+void theknob_process_with_changes (theknob_engine* engine, float* const* channels, int num_channels, int num_samples,
+                                   const theknob_param_change* changes, int num_changes);
+
+/* Runs the EQ and special EQ as linear-phase FIRs (designed on a thread the engine owns), or back as IIR filters. Takes effect at the next
+   theknob_prepare(). */
+void theknob_set_linear_phase_eq (theknob_engine* engine, int enabled);
+
+/* Plays the reverb from impulse responses (captured from the algorithmic reverb, or the one set below) on a zero-latency partitioned
+   convolution, or back as the algorithmic reverb. Takes effect at the next theknob_prepare(). */
+void theknob_set_convolution_reverb (theknob_engine* engine, int enabled);
+
+/* The response the convolution reverb plays instead of the captured ones: num_channels channels of length samples, at the rate the engine
+   will be prepared at (only the first two channels and 10 seconds are used). It's copied. num_channels 0 goes back to the captured ones.
+   Takes effect at the next theknob_prepare(). */
+void theknob_set_impulse_response (theknob_engine* engine, const float* const* channels, int num_channels, int length);
+
+/* Runs the reverb's and delay's wet paths at 44.1 or 48 kHz inside when the engine is prepared at 2, 4 or 8 times that. At 192 kHz the
+   two stages take about a third less CPU, and the whole engine 10-20% less. The reverb adds up to 302 samples of latency. Takes effect
+   at the next theknob_prepare(). */
+void theknob_set_reduced_rate_wet_paths (theknob_engine* engine, int enabled);
+
+/* Leaves out the parts of the chain that change the output by less than threshold_db (-120 by default): the reverb's and delay's wet
+   paths once their tails have rung out, so silence costs next to nothing. -INFINITY never leaves anything out. Takes effect at the
+   next theknob_prepare(). */
+void theknob_set_elision_threshold (theknob_engine* engine, float threshold_db);
+
+/* Trades some of the sound for CPU. THEKNOB_QUALITY_FAST_SATURATION runs the distortion and the delay's saturation with an approximate
+   tanh (within -75 dB of the full chain, for about a third less CPU), and THEKNOB_QUALITY_ECONOMY also makes the reverb less diffuse and
+   some of the filters first order. THEKNOB_QUALITY_AUTO times every theknob_process() against the block's length and steps down a tier
+   when the engine uses more than 80% of the time it has for half a second, and back up when there's room again: only use it in real
+   time. Changes crossfade, and it's real-time safe. THEKNOB_QUALITY_FULL is the default. */
+void theknob_set_quality (theknob_engine* engine, int quality);
+
+/* The tier the engine is running at (THEKNOB_QUALITY_FULL to THEKNOB_QUALITY_ECONOMY), which THEKNOB_QUALITY_AUTO changes */
+int theknob_get_quality_tier (const theknob_engine* engine);
+
+/* How late the output is, in samples: 0, about 100 ms with the linear-phase EQ, plus the reduced-rate reverb's round trip */
+int theknob_get_latency_samples (const theknob_engine* engine);
+
+/* Clears the delay and reverb tails and the filter states */
+void theknob_reset (theknob_engine* engine);
+
+/* How many bytes theknob_save_state() writes, once prepared: about 900 KB at 48 kHz, most of it the delay lines. 0 with the linear-phase
+   EQ or the convolution reverb, which can't be saved. */
+size_t theknob_get_state_size (const theknob_engine* engine);
+
+/* Copies everything the engine is running with (the knob and mode, delay lines, reverb, filter states and smoothing) into buffer, which
+   holds size bytes, at about the speed of a memcpy. Real-time safe, with the same rules as theknob_process(). Returns 0, or -1 if it
+   doesn't fit or can't be saved. */
+int theknob_save_state (const theknob_engine* engine, void* buffer, size_t size);
+
+/* Puts back a state from theknob_save_state(), so the engine carries on bit for bit as the saved one did. It has to come from an engine
+   prepared at the same sample rate with the same settings and DSP version. Real-time safe. Returns 0, or -1 (changing nothing) if it
+   doesn't match. */
+int theknob_restore_state (theknob_engine* engine, const void* buffer, size_t size);
+
+/* How long the output takes to decay by decay_db after the input stops, with the current settings */
+double theknob_get_tail_seconds (const theknob_engine* engine, float decay_db);
+
+/* Changes whenever an update changes the sound */
+int theknob_get_dsp_version (void);
+
+/* The instruction set every engine's inner loops run with: "scalar", "sse2", "avx2", "avx512" or "neon". It's the best one the CPU has,
+   unless the THEKNOB_ISA environment variable names another. Every one gives the same output. */
+const char* theknob_get_isa (void);
+
+/* Switches every engine to one of the names above, from their next process call on. Returns 0, or -1 if the name is unknown or the CPU
+   can't run it. */
+int theknob_set_isa (const char* isa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THEKNOB_DSP_H */